@@ -0,0 +1,301 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "adler32.hpp"
+#include <initializer_list>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KVS_ADLER32_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define KVS_ADLER32_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace score::mw::per::kvs
+{
+
+namespace
+{
+
+constexpr uint32_t ADLER32_BASE = 65521U;
+/* Largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits into 32 bits, the sums are reduced at least
+ * every NMAX bytes */
+constexpr std::size_t ADLER32_NMAX = 5552U;
+/* Bytes per vector step, NMAX_BLOCKS steps fit into NMAX */
+constexpr std::size_t ADLER32_BLOCK = 32U;
+constexpr std::size_t ADLER32_NMAX_BLOCKS = ADLER32_NMAX / ADLER32_BLOCK;
+
+using Adler32Fn = uint32_t (*)(uint32_t, const uint8_t*, std::size_t);
+
+uint32_t adler32_scalar(uint32_t adler, const uint8_t* data, std::size_t size)
+{
+    uint32_t a = adler & 0xFFFFU;
+    uint32_t b = adler >> 16;
+
+    /* Process in blocks of NMAX bytes to reduce the modulo operations */
+    while (size > 0U)
+    {
+        const std::size_t tlen = (size > ADLER32_NMAX) ? ADLER32_NMAX : size;
+        size -= tlen;
+        for (std::size_t j = 0U; j < tlen; ++j)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= ADLER32_BASE;
+        b %= ADLER32_BASE;
+    }
+    return (b << 16) | a;
+}
+
+/* The vector implementations process whole 32-byte blocks, each block adds
+ *   a += sum(x[i]),  b += 32 * a_before + sum((32 - i) * x[i])
+ * with the per-block a_before summed up in a separate vector. The tail is handled by the scalar loop. */
+
+#if defined(KVS_ADLER32_X86)
+
+__attribute__((target("sse4.1"))) uint32_t adler32_sse41(uint32_t adler, const uint8_t* data, std::size_t size)
+{
+    uint32_t a = adler & 0xFFFFU;
+    uint32_t b = adler >> 16;
+    std::size_t blocks = size / ADLER32_BLOCK;
+    size -= blocks * ADLER32_BLOCK;
+
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    while (blocks > 0U)
+    {
+        std::size_t n = (blocks > ADLER32_NMAX_BLOCKS) ? ADLER32_NMAX_BLOCKS : blocks;
+        blocks -= n;
+
+        __m128i v_prev = _mm_cvtsi32_si128(static_cast<int>(a * static_cast<uint32_t>(n)));
+        __m128i v_a = zero;
+        __m128i v_b = _mm_cvtsi32_si128(static_cast<int>(b));
+        do
+        {
+            const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+            v_prev = _mm_add_epi32(v_prev, v_a);
+            v_a = _mm_add_epi32(v_a, _mm_sad_epu8(bytes1, zero));
+            v_b = _mm_add_epi32(v_b, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            v_a = _mm_add_epi32(v_a, _mm_sad_epu8(bytes2, zero));
+            v_b = _mm_add_epi32(v_b, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+            data += ADLER32_BLOCK;
+        } while (--n > 0U);
+        v_b = _mm_add_epi32(v_b, _mm_slli_epi32(v_prev, 5));
+
+        /* Horizontal sums, wrap-around of the lanes cancels out in the 32-bit total */
+        v_a = _mm_add_epi32(v_a, _mm_shuffle_epi32(v_a, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_a = _mm_add_epi32(v_a, _mm_shuffle_epi32(v_a, _MM_SHUFFLE(1, 0, 3, 2)));
+        a += static_cast<uint32_t>(_mm_cvtsi128_si32(v_a));
+        v_b = _mm_add_epi32(v_b, _mm_shuffle_epi32(v_b, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_b = _mm_add_epi32(v_b, _mm_shuffle_epi32(v_b, _MM_SHUFFLE(1, 0, 3, 2)));
+        b = static_cast<uint32_t>(_mm_cvtsi128_si32(v_b));
+        a %= ADLER32_BASE;
+        b %= ADLER32_BASE;
+    }
+    return adler32_scalar((b << 16) | a, data, size);
+}
+
+__attribute__((target("avx2"))) uint32_t adler32_avx2(uint32_t adler, const uint8_t* data, std::size_t size)
+{
+    uint32_t a = adler & 0xFFFFU;
+    uint32_t b = adler >> 16;
+    std::size_t blocks = size / ADLER32_BLOCK;
+    size -= blocks * ADLER32_BLOCK;
+
+    const __m256i tap = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                         16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    while (blocks > 0U)
+    {
+        std::size_t n = (blocks > ADLER32_NMAX_BLOCKS) ? ADLER32_NMAX_BLOCKS : blocks;
+        blocks -= n;
+
+        __m256i v_prev = _mm256_setr_epi32(static_cast<int>(a * static_cast<uint32_t>(n)), 0, 0, 0, 0, 0, 0, 0);
+        __m256i v_a = zero;
+        __m256i v_b = _mm256_setr_epi32(static_cast<int>(b), 0, 0, 0, 0, 0, 0, 0);
+        do
+        {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+            v_prev = _mm256_add_epi32(v_prev, v_a);
+            v_a = _mm256_add_epi32(v_a, _mm256_sad_epu8(bytes, zero));
+            v_b = _mm256_add_epi32(v_b, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, tap), ones));
+            data += ADLER32_BLOCK;
+        } while (--n > 0U);
+        v_b = _mm256_add_epi32(v_b, _mm256_slli_epi32(v_prev, 5));
+
+        /* Horizontal sums, wrap-around of the lanes cancels out in the 32-bit total */
+        __m128i sum_a = _mm_add_epi32(_mm256_castsi256_si128(v_a), _mm256_extracti128_si256(v_a, 1));
+        sum_a = _mm_add_epi32(sum_a, _mm_shuffle_epi32(sum_a, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum_a = _mm_add_epi32(sum_a, _mm_shuffle_epi32(sum_a, _MM_SHUFFLE(1, 0, 3, 2)));
+        a += static_cast<uint32_t>(_mm_cvtsi128_si32(sum_a));
+        __m128i sum_b = _mm_add_epi32(_mm256_castsi256_si128(v_b), _mm256_extracti128_si256(v_b, 1));
+        sum_b = _mm_add_epi32(sum_b, _mm_shuffle_epi32(sum_b, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum_b = _mm_add_epi32(sum_b, _mm_shuffle_epi32(sum_b, _MM_SHUFFLE(1, 0, 3, 2)));
+        b = static_cast<uint32_t>(_mm_cvtsi128_si32(sum_b));
+        a %= ADLER32_BASE;
+        b %= ADLER32_BASE;
+    }
+    return adler32_scalar((b << 16) | a, data, size);
+}
+
+#endif /* KVS_ADLER32_X86 */
+
+#if defined(KVS_ADLER32_NEON)
+
+uint32_t adler32_neon(uint32_t adler, const uint8_t* data, std::size_t size)
+{
+    static const uint16_t taps[ADLER32_BLOCK] = {32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                                 16, 15, 14, 13, 12, 11, 10, 9,  8,  7,  6,  5,  4,  3,  2,  1};
+    uint32_t a = adler & 0xFFFFU;
+    uint32_t b = adler >> 16;
+    std::size_t blocks = size / ADLER32_BLOCK;
+    size -= blocks * ADLER32_BLOCK;
+
+    while (blocks > 0U)
+    {
+        std::size_t n = (blocks > ADLER32_NMAX_BLOCKS) ? ADLER32_NMAX_BLOCKS : blocks;
+        blocks -= n;
+
+        uint32x4_t v_prev = vsetq_lane_u32(a * static_cast<uint32_t>(n), vdupq_n_u32(0U), 0);
+        uint32x4_t v_a = vdupq_n_u32(0U);
+        /* Per column byte sums, at most NMAX_BLOCKS * 255 and therefore no 16-bit overflow */
+        uint16x8_t column1 = vdupq_n_u16(0U);
+        uint16x8_t column2 = vdupq_n_u16(0U);
+        uint16x8_t column3 = vdupq_n_u16(0U);
+        uint16x8_t column4 = vdupq_n_u16(0U);
+        do
+        {
+            const uint8x16_t bytes1 = vld1q_u8(data);
+            const uint8x16_t bytes2 = vld1q_u8(data + 16);
+            v_prev = vaddq_u32(v_prev, v_a);
+            v_a = vpadalq_u16(v_a, vpadalq_u8(vpaddlq_u8(bytes1), bytes2));
+            column1 = vaddw_u8(column1, vget_low_u8(bytes1));
+            column2 = vaddw_u8(column2, vget_high_u8(bytes1));
+            column3 = vaddw_u8(column3, vget_low_u8(bytes2));
+            column4 = vaddw_u8(column4, vget_high_u8(bytes2));
+            data += ADLER32_BLOCK;
+        } while (--n > 0U);
+
+        uint32x4_t v_b = vshlq_n_u32(v_prev, 5);
+        v_b = vmlal_u16(v_b, vget_low_u16(column1), vld1_u16(&taps[0]));
+        v_b = vmlal_u16(v_b, vget_high_u16(column1), vld1_u16(&taps[4]));
+        v_b = vmlal_u16(v_b, vget_low_u16(column2), vld1_u16(&taps[8]));
+        v_b = vmlal_u16(v_b, vget_high_u16(column2), vld1_u16(&taps[12]));
+        v_b = vmlal_u16(v_b, vget_low_u16(column3), vld1_u16(&taps[16]));
+        v_b = vmlal_u16(v_b, vget_high_u16(column3), vld1_u16(&taps[20]));
+        v_b = vmlal_u16(v_b, vget_low_u16(column4), vld1_u16(&taps[24]));
+        v_b = vmlal_u16(v_b, vget_high_u16(column4), vld1_u16(&taps[28]));
+
+        a += vaddvq_u32(v_a);
+        b += vaddvq_u32(v_b);
+        a %= ADLER32_BASE;
+        b %= ADLER32_BASE;
+    }
+    return adler32_scalar((b << 16) | a, data, size);
+}
+
+#endif /* KVS_ADLER32_NEON */
+
+Adler32Fn adler32_function(Adler32Impl impl)
+{
+    Adler32Fn fn = &adler32_scalar;
+    if (adler32_supported(impl))
+    {
+        switch (impl)
+        {
+#if defined(KVS_ADLER32_X86)
+            case Adler32Impl::Sse41:
+                fn = &adler32_sse41;
+                break;
+            case Adler32Impl::Avx2:
+                fn = &adler32_avx2;
+                break;
+#endif
+#if defined(KVS_ADLER32_NEON)
+            case Adler32Impl::Neon:
+                fn = &adler32_neon;
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+    return fn;
+}
+
+Adler32Impl adler32_select()
+{
+    Adler32Impl impl = Adler32Impl::Scalar;
+    for (const Adler32Impl candidate : {Adler32Impl::Avx2, Adler32Impl::Neon, Adler32Impl::Sse41})
+    {
+        if (adler32_supported(candidate))
+        {
+            impl = candidate;
+            break;
+        }
+    }
+    return impl;
+}
+
+}  // namespace
+
+bool adler32_supported(Adler32Impl impl)
+{
+    bool supported = false;
+    switch (impl)
+    {
+        case Adler32Impl::Scalar:
+            supported = true;
+            break;
+#if defined(KVS_ADLER32_X86)
+        case Adler32Impl::Sse41:
+            supported = __builtin_cpu_supports("sse4.1");
+            break;
+        case Adler32Impl::Avx2:
+            supported = __builtin_cpu_supports("avx2");
+            break;
+#endif
+#if defined(KVS_ADLER32_NEON)
+        case Adler32Impl::Neon:
+            supported = true; /* Mandatory on aarch64 */
+            break;
+#endif
+        default:
+            break;
+    }
+    return supported;
+}
+
+Adler32Impl adler32_active_impl()
+{
+    static const Adler32Impl active = adler32_select();
+    return active;
+}
+
+uint32_t adler32_update(uint32_t adler, const void* data, std::size_t size)
+{
+    static const Adler32Fn active = adler32_function(adler32_active_impl());
+    return active(adler, static_cast<const uint8_t*>(data), size);
+}
+
+uint32_t adler32_update(Adler32Impl impl, uint32_t adler, const void* data, std::size_t size)
+{
+    return adler32_function(impl)(adler, static_cast<const uint8_t*>(data), size);
+}
+
+} /* namespace score::mw::per::kvs */
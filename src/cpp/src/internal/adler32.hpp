@@ -0,0 +1,55 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_ADLER32_HPP
+#define SCORE_LIB_KVS_INTERNAL_ADLER32_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Adler-32 checksum with vectorised implementations.
+ *
+ * The implementation is selected once at runtime from the instruction sets supported by the CPU:
+ * AVX2 or SSE4.1 on x86_64, NEON on aarch64 (always present there), the scalar loop otherwise.
+ * All implementations produce bit-identical results.
+ */
+
+namespace score::mw::per::kvs
+{
+
+enum class Adler32Impl
+{
+    Scalar,
+    Sse41,
+    Avx2,
+    Neon,
+};
+
+/* Initial value of an Adler-32 checksum */
+constexpr uint32_t ADLER32_INIT = 1U;
+
+/* Returns true if the implementation is compiled in and supported by the CPU */
+bool adler32_supported(Adler32Impl impl);
+
+/* Implementation used by adler32_update */
+Adler32Impl adler32_active_impl();
+
+/* Continue the checksum `adler` over `size` bytes of `data` */
+uint32_t adler32_update(uint32_t adler, const void* data, std::size_t size);
+
+/* Same with an explicit implementation, unsupported implementations fall back to the scalar loop */
+uint32_t adler32_update(Adler32Impl impl, uint32_t adler, const void* data, std::size_t size);
+
+} /* namespace score::mw::per::kvs */
+
+#endif  // SCORE_LIB_KVS_INTERNAL_ADLER32_HPP
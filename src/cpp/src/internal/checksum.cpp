@@ -0,0 +1,433 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "checksum.hpp"
+#include "adler32.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KVS_CRC32C_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define KVS_CRC32C_ARM 1
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace score::mw::per::kvs
+{
+
+namespace
+{
+
+/*********************** CRC-32C *********************/
+
+constexpr uint32_t CRC32C_POLY = 0x82F63B78U; /* Reflected Castagnoli polynomial */
+
+/* Slicing-by-8 tables of the software implementation */
+std::array<std::array<uint32_t, 256>, 8> make_crc32c_tables()
+{
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0U; i < 256U; ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 1U) ? ((crc >> 1) ^ CRC32C_POLY) : (crc >> 1);
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0U; i < 256U; ++i)
+    {
+        for (std::size_t t = 1U; t < 8U; ++t)
+        {
+            tables[t][i] = (tables[t - 1U][i] >> 8) ^ tables[0][tables[t - 1U][i] & 0xFFU];
+        }
+    }
+    return tables;
+}
+
+uint32_t crc32c_software(uint32_t crc, const uint8_t* data, std::size_t size)
+{
+    static const auto tables = make_crc32c_tables();
+    while (size >= 8U)
+    {
+        uint32_t low = 0U;
+        uint32_t high = 0U;
+        std::memcpy(&low, data, 4U);
+        std::memcpy(&high, data + 4U, 4U);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        low = __builtin_bswap32(low);
+        high = __builtin_bswap32(high);
+#endif
+        low ^= crc;
+        crc = tables[7][low & 0xFFU] ^ tables[6][(low >> 8) & 0xFFU] ^ tables[5][(low >> 16) & 0xFFU] ^
+              tables[4][low >> 24] ^ tables[3][high & 0xFFU] ^ tables[2][(high >> 8) & 0xFFU] ^
+              tables[1][(high >> 16) & 0xFFU] ^ tables[0][high >> 24];
+        data += 8U;
+        size -= 8U;
+    }
+    while (size > 0U)
+    {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *data++) & 0xFFU];
+        --size;
+    }
+    return crc;
+}
+
+#if defined(KVS_CRC32C_X86)
+
+__attribute__((target("sse4.2"))) uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data, std::size_t size)
+{
+    uint64_t crc64 = crc;
+    while (size >= 8U)
+    {
+        uint64_t word = 0U;
+        std::memcpy(&word, data, 8U);
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8U;
+        size -= 8U;
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc64);
+    while (size > 0U)
+    {
+        crc32 = _mm_crc32_u8(crc32, *data++);
+        --size;
+    }
+    return crc32;
+}
+
+bool crc32c_detect_hardware()
+{
+    return __builtin_cpu_supports("sse4.2");
+}
+
+#elif defined(KVS_CRC32C_ARM)
+
+__attribute__((target("+crc"))) uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data, std::size_t size)
+{
+    while (size >= 8U)
+    {
+        uint64_t word = 0U;
+        std::memcpy(&word, data, 8U);
+        crc = __crc32cd(crc, word);
+        data += 8U;
+        size -= 8U;
+    }
+    while (size > 0U)
+    {
+        crc = __crc32cb(crc, *data++);
+        --size;
+    }
+    return crc;
+}
+
+bool crc32c_detect_hardware()
+{
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0U;
+}
+
+#else
+
+uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data, std::size_t size)
+{
+    return crc32c_software(crc, data, size);
+}
+
+bool crc32c_detect_hardware()
+{
+    return false;
+}
+
+#endif
+
+/*********************** xxHash64 *********************/
+
+constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl64(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t read64_le(const uint8_t* data)
+{
+    uint64_t value = 0U;
+    std::memcpy(&value, data, 8U);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+inline uint32_t read32_le(const uint8_t* data)
+{
+    uint32_t value = 0U;
+    std::memcpy(&value, data, 4U);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+inline uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t value)
+{
+    acc ^= xxh64_round(0U, value);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+/*********************** Strategies *********************/
+
+class Adler32Checksum final : public ChecksumStrategy
+{
+  public:
+    KvsChecksum algorithm() const override
+    {
+        return KvsChecksum::Adler32;
+    }
+
+    std::size_t digest_size() const override
+    {
+        return 4U;
+    }
+
+    void update(const void* data, std::size_t size) override
+    {
+        state = adler32_update(state, data, size);
+    }
+
+    uint64_t digest() const override
+    {
+        return state;
+    }
+
+  private:
+    uint32_t state = ADLER32_INIT;
+};
+
+class Crc32cChecksum final : public ChecksumStrategy
+{
+  public:
+    KvsChecksum algorithm() const override
+    {
+        return KvsChecksum::Crc32c;
+    }
+
+    std::size_t digest_size() const override
+    {
+        return 4U;
+    }
+
+    void update(const void* data, std::size_t size) override
+    {
+        state = crc32c_update(state, data, size, crc32c_hardware_supported());
+    }
+
+    uint64_t digest() const override
+    {
+        return state;
+    }
+
+  private:
+    uint32_t state = 0U;
+};
+
+class XxHash64Checksum final : public ChecksumStrategy
+{
+  public:
+    KvsChecksum algorithm() const override
+    {
+        return KvsChecksum::XxHash64;
+    }
+
+    std::size_t digest_size() const override
+    {
+        return 8U;
+    }
+
+    void update(const void* data, std::size_t size) override
+    {
+        const uint8_t* input = static_cast<const uint8_t*>(data);
+        total_size += size;
+
+        /* Complete a buffered stripe first */
+        if (buffered > 0U)
+        {
+            const std::size_t fill = std::min(size, STRIPE - buffered);
+            std::memcpy(buffer.data() + buffered, input, fill);
+            buffered += fill;
+            input += fill;
+            size -= fill;
+            if (buffered < STRIPE)
+            {
+                return;
+            }
+            consume_stripe(buffer.data());
+            buffered = 0U;
+        }
+        while (size >= STRIPE)
+        {
+            consume_stripe(input);
+            input += STRIPE;
+            size -= STRIPE;
+        }
+        if (size > 0U)
+        {
+            std::memcpy(buffer.data(), input, size);
+            buffered = size;
+        }
+    }
+
+    uint64_t digest() const override
+    {
+        uint64_t hash = 0U;
+        if (total_size >= STRIPE)
+        {
+            hash = rotl64(acc[0], 1) + rotl64(acc[1], 7) + rotl64(acc[2], 12) + rotl64(acc[3], 18);
+            for (const uint64_t lane : acc)
+            {
+                hash = xxh64_merge_round(hash, lane);
+            }
+        }
+        else
+        {
+            hash = XXH_PRIME64_5;
+        }
+        hash += total_size;
+
+        /* Remaining bytes of the last partial stripe */
+        const uint8_t* tail = buffer.data();
+        std::size_t remaining = buffered;
+        while (remaining >= 8U)
+        {
+            hash ^= xxh64_round(0U, read64_le(tail));
+            hash = rotl64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+            tail += 8U;
+            remaining -= 8U;
+        }
+        if (remaining >= 4U)
+        {
+            hash ^= static_cast<uint64_t>(read32_le(tail)) * XXH_PRIME64_1;
+            hash = rotl64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+            tail += 4U;
+            remaining -= 4U;
+        }
+        while (remaining > 0U)
+        {
+            hash ^= static_cast<uint64_t>(*tail) * XXH_PRIME64_5;
+            hash = rotl64(hash, 11) * XXH_PRIME64_1;
+            ++tail;
+            --remaining;
+        }
+
+        /* Avalanche */
+        hash ^= hash >> 33;
+        hash *= XXH_PRIME64_2;
+        hash ^= hash >> 29;
+        hash *= XXH_PRIME64_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+  private:
+    static constexpr std::size_t STRIPE = 32U;
+
+    void consume_stripe(const uint8_t* stripe)
+    {
+        acc[0] = xxh64_round(acc[0], read64_le(stripe));
+        acc[1] = xxh64_round(acc[1], read64_le(stripe + 8U));
+        acc[2] = xxh64_round(acc[2], read64_le(stripe + 16U));
+        acc[3] = xxh64_round(acc[3], read64_le(stripe + 24U));
+    }
+
+    std::array<uint64_t, 4> acc = {XXH_PRIME64_1 + XXH_PRIME64_2, XXH_PRIME64_2, 0U, 0ULL - XXH_PRIME64_1};
+    std::array<uint8_t, STRIPE> buffer{};
+    std::size_t buffered = 0U;
+    uint64_t total_size = 0U;
+};
+
+}  // namespace
+
+bool crc32c_hardware_supported()
+{
+    static const bool supported = crc32c_detect_hardware();
+    return supported;
+}
+
+uint32_t crc32c_update(uint32_t crc, const void* data, std::size_t size, bool hardware)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    crc = (hardware && crc32c_hardware_supported()) ? crc32c_hardware(crc, bytes, size)
+                                                    : crc32c_software(crc, bytes, size);
+    return ~crc;
+}
+
+std::unique_ptr<ChecksumStrategy> make_checksum(KvsChecksum algorithm)
+{
+    std::unique_ptr<ChecksumStrategy> checksum;
+    switch (algorithm)
+    {
+        case KvsChecksum::Adler32:
+            checksum = std::make_unique<Adler32Checksum>();
+            break;
+        case KvsChecksum::Crc32c:
+            checksum = std::make_unique<Crc32cChecksum>();
+            break;
+        case KvsChecksum::XxHash64:
+            checksum = std::make_unique<XxHash64Checksum>();
+            break;
+        default:
+            break;
+    }
+    return checksum;
+}
+
+uint64_t calculate_checksum(KvsChecksum algorithm, const void* data, std::size_t size)
+{
+    uint64_t value = 0U;
+    switch (algorithm)
+    {
+        case KvsChecksum::Adler32:
+            value = adler32_update(ADLER32_INIT, data, size);
+            break;
+        case KvsChecksum::Crc32c:
+            value = crc32c_update(0U, data, size, true);
+            break;
+        case KvsChecksum::XxHash64:
+        {
+            XxHash64Checksum checksum; /* No allocation for short inputs */
+            checksum.update(data, size);
+            value = checksum.digest();
+            break;
+        }
+        default:
+            break;
+    }
+    return value;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,66 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_CHECKSUM_HPP
+#define SCORE_LIB_KVS_INTERNAL_CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace score::mw::per::kvs
+{
+
+/* Checksum algorithm of the hash files, the value is stored in tagged hash files */
+enum class KvsChecksum : uint8_t
+{
+    Adler32 = 1,  /* Adler-32, written as legacy 4-byte hash file readable by all KVS versions */
+    Crc32c = 2,   /* CRC-32C (Castagnoli), hardware accelerated with SSE4.2 or the ARMv8 CRC extension */
+    XxHash64 = 3, /* xxHash64 with seed 0 */
+};
+
+/**
+ * @class ChecksumStrategy
+ * @brief Streaming computation of one checksum algorithm.
+ *
+ * Data can be fed in any number of update calls, digest() returns the checksum of all data so far.
+ */
+class ChecksumStrategy
+{
+  public:
+    virtual ~ChecksumStrategy() = default;
+
+    virtual KvsChecksum algorithm() const = 0;
+
+    /* Number of significant bytes of the digest (4 or 8) */
+    virtual std::size_t digest_size() const = 0;
+
+    virtual void update(const void* data, std::size_t size) = 0;
+
+    virtual uint64_t digest() const = 0;
+};
+
+/* Create a streaming checksum, nullptr for an unknown algorithm */
+std::unique_ptr<ChecksumStrategy> make_checksum(KvsChecksum algorithm);
+
+/* Checksum of a whole buffer, 0 for an unknown algorithm */
+uint64_t calculate_checksum(KvsChecksum algorithm, const void* data, std::size_t size);
+
+/* Returns true if CRC-32C is computed with CPU instructions instead of the lookup table */
+bool crc32c_hardware_supported();
+
+/* CRC-32C with an explicit implementation, used by tests and benchmarks */
+uint32_t crc32c_update(uint32_t crc, const void* data, std::size_t size, bool hardware);
+
+} /* namespace score::mw::per::kvs */
+
+#endif  // SCORE_LIB_KVS_INTERNAL_CHECKSUM_HPP
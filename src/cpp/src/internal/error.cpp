@@ -84,6 +84,9 @@ std::string_view MyErrorDomain::MessageFor(const score::result::ErrorCode& code)
         case ErrorCode::InvalidValueType:
             msg = "Invalid value type";
             break;
+        case ErrorCode::InvalidArgument:
+            msg = "Invalid argument";
+            break;
         default:
             msg = "Unknown Error!";
             break;
@@ -83,6 +83,9 @@ enum class ErrorCode : score::result::ErrorCode
 
     /* Invalid value type*/
     InvalidValueType,
+
+    /* Invalid argument*/
+    InvalidArgument,
 };
 
 class MyErrorDomain final : public score::result::ErrorDomain
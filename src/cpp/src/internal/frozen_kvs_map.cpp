@@ -0,0 +1,350 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "frozen_kvs_map.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace score::mw::per::kvs
+{
+
+namespace
+{
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+constexpr std::size_t KEYS_PER_BUCKET = 4U;
+constexpr uint32_t MAX_SEED = 1U << 20;
+
+/* splitmix64 finalizer */
+uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+uint64_t hash_key(std::string_view key, uint64_t salt)
+{
+    uint64_t hash = FNV_OFFSET_BASIS ^ salt;
+    for (const char c : key)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FNV_PRIME;
+    }
+    return mix64(hash);
+}
+
+/* Maps a 32 bit value to [0, n) without a division */
+std::size_t reduce(uint64_t x, std::size_t n)
+{
+    return static_cast<std::size_t>((static_cast<uint64_t>(static_cast<uint32_t>(x)) * n) >> 32);
+}
+
+std::size_t bucket_of(uint64_t hash, std::size_t bucket_count)
+{
+    return reduce(hash >> 32, bucket_count);
+}
+
+std::size_t slot_of(uint64_t hash, uint32_t seed, std::size_t slot_count)
+{
+    return reduce(mix64(hash ^ seed), slot_count);
+}
+
+uint64_t hash_value(const KvsValue& value)
+{
+    uint64_t hash = mix64(static_cast<uint64_t>(value.getType()) + 1U);
+    switch (value.getType())
+    {
+        case KvsValue::Type::i32:
+            hash ^= mix64(static_cast<uint64_t>(std::get<int32_t>(value.getValue())));
+            break;
+        case KvsValue::Type::u32:
+            hash ^= mix64(std::get<uint32_t>(value.getValue()));
+            break;
+        case KvsValue::Type::i64:
+            hash ^= mix64(static_cast<uint64_t>(std::get<int64_t>(value.getValue())));
+            break;
+        case KvsValue::Type::u64:
+            hash ^= mix64(std::get<uint64_t>(value.getValue()));
+            break;
+        case KvsValue::Type::f64:
+        {
+            const double number = std::get<double>(value.getValue());
+            uint64_t bits = 0U;
+            static_assert(sizeof(bits) == sizeof(number), "Unexpected double size");
+            (void)std::memcpy(&bits, &number, sizeof(bits));
+            hash ^= mix64(bits);
+            break;
+        }
+        case KvsValue::Type::Boolean:
+            hash ^= mix64(std::get<bool>(value.getValue()) ? 1U : 0U);
+            break;
+        case KvsValue::Type::String:
+            hash ^= hash_key(std::get<std::string>(value.getValue()), 0U);
+            break;
+        case KvsValue::Type::Array:
+            for (const auto& element : std::get<KvsValue::Array>(value.getValue()))
+            {
+                hash = mix64(hash ^ hash_value(*element));
+            }
+            break;
+        case KvsValue::Type::Object:
+            /* Order-independent */
+            for (const auto& element : std::get<KvsValue::Object>(value.getValue()))
+            {
+                hash += mix64(hash_key(element.first, 0U) ^ hash_value(*element.second));
+            }
+            break;
+        case KvsValue::Type::Null:
+        default:
+            break;
+    }
+    return hash;
+}
+
+bool equal_value(const KvsValue& lhs, const KvsValue& rhs)
+{
+    bool equal = false;
+    if (lhs.getType() != rhs.getType())
+    {
+        equal = false;
+    }
+    else if (lhs.getType() == KvsValue::Type::Array)
+    {
+        const auto& lhs_array = std::get<KvsValue::Array>(lhs.getValue());
+        const auto& rhs_array = std::get<KvsValue::Array>(rhs.getValue());
+        equal = (lhs_array.size() == rhs_array.size());
+        for (std::size_t i = 0U; equal && (i < lhs_array.size()); ++i)
+        {
+            equal = equal_value(*lhs_array[i], *rhs_array[i]);
+        }
+    }
+    else if (lhs.getType() == KvsValue::Type::Object)
+    {
+        const auto& lhs_object = std::get<KvsValue::Object>(lhs.getValue());
+        const auto& rhs_object = std::get<KvsValue::Object>(rhs.getValue());
+        equal = (lhs_object.size() == rhs_object.size());
+        for (auto it = lhs_object.begin(); equal && (it != lhs_object.end()); ++it)
+        {
+            auto search = rhs_object.find(it->first);
+            equal = (search != rhs_object.end()) && equal_value(*it->second, *search->second);
+        }
+    }
+    else
+    {
+        /* Scalar types compare directly */
+        equal = (lhs.getValue() == rhs.getValue());
+    }
+    return equal;
+}
+
+uint64_t fingerprint_of(const FrozenKvsMap::Map& map)
+{
+    uint64_t fingerprint = mix64(map.size());
+    for (const auto& element : map)
+    {
+        fingerprint += mix64(hash_key(element.first, 0U) ^ hash_value(element.second));
+    }
+    return fingerprint;
+}
+
+}  // namespace
+
+FrozenKvsMap::FrozenKvsMap() : table(empty_table()) {}
+
+FrozenKvsMap::FrozenKvsMap(const Map& map) : table(build(map)) {}
+
+FrozenKvsMap::FrozenKvsMap(FrozenKvsMap&& other) noexcept : table(std::move(other.table))
+{
+    other.table = empty_table();
+}
+
+FrozenKvsMap& FrozenKvsMap::operator=(FrozenKvsMap&& other) noexcept
+{
+    if (this != &other)
+    {
+        table = std::move(other.table);
+        other.table = empty_table();
+    }
+    return *this;
+}
+
+const std::shared_ptr<const FrozenKvsMap::Table>& FrozenKvsMap::empty_table()
+{
+    static const std::shared_ptr<const Table> empty = std::make_shared<const Table>();
+    return empty;
+}
+
+/* Build a minimal perfect hash table (hash and displace) */
+std::shared_ptr<const FrozenKvsMap::Table> FrozenKvsMap::build(const Map& map)
+{
+    auto result = std::make_shared<Table>();
+    const std::size_t slot_count = map.size();
+    result->fingerprint = fingerprint_of(map);
+
+    bool built = (slot_count == 0U);
+    while (!built)
+    {
+        const std::size_t bucket_count = std::max<std::size_t>(1U, slot_count / KEYS_PER_BUCKET);
+        std::vector<std::vector<std::pair<uint64_t, const Map::value_type*>>> buckets(bucket_count);
+        for (const auto& element : map)
+        {
+            const uint64_t hash = hash_key(element.first, result->salt);
+            buckets[bucket_of(hash, bucket_count)].emplace_back(hash, &element);
+        }
+
+        /* Place the largest buckets first, while most slots are still free */
+        std::vector<std::size_t> order(bucket_count);
+        for (std::size_t i = 0U; i < bucket_count; ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&buckets](std::size_t lhs, std::size_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+
+        std::vector<uint32_t> seeds(bucket_count, 0U);
+        std::vector<const Map::value_type*> placed(slot_count, nullptr);
+        std::vector<uint64_t> hashes(slot_count, 0U);
+        std::vector<std::size_t> slots;
+        bool failed = false;
+        for (std::size_t i = 0U; (!failed) && (i < bucket_count) && (!buckets[order[i]].empty()); ++i)
+        {
+            const auto& bucket = buckets[order[i]];
+            bool found = false;
+            for (uint32_t seed = 1U; (!found) && (seed < MAX_SEED); ++seed)
+            {
+                slots.clear();
+                found = true;
+                for (const auto& key : bucket)
+                {
+                    const std::size_t slot = slot_of(key.first, seed, slot_count);
+                    if ((placed[slot] != nullptr) || (std::find(slots.begin(), slots.end(), slot) != slots.end()))
+                    {
+                        found = false;
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (found)
+                {
+                    seeds[order[i]] = seed;
+                    for (std::size_t k = 0U; k < bucket.size(); ++k)
+                    {
+                        placed[slots[k]] = bucket[k].second;
+                        hashes[slots[k]] = bucket[k].first;
+                    }
+                }
+            }
+            failed = !found;
+        }
+
+        if (failed)
+        {
+            /* Retry with a different key hash */
+            ++result->salt;
+        }
+        else
+        {
+            result->seeds = std::move(seeds);
+            result->hashes = std::move(hashes);
+            result->entries.reserve(slot_count);
+            for (const auto* element : placed)
+            {
+                result->entries.emplace_back(element->first, element->second);
+            }
+            built = true;
+        }
+    }
+
+    return result;
+}
+
+FrozenKvsMap FrozenKvsMap::intern(const Map& map)
+{
+    static std::mutex registry_mutex;
+    static std::unordered_multimap<uint64_t, std::weak_ptr<const Table>> registry;
+
+    const uint64_t fingerprint = fingerprint_of(map);
+    std::shared_ptr<const Table> shared;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto range = registry.equal_range(fingerprint);
+    for (auto it = range.first; it != range.second;)
+    {
+        std::shared_ptr<const Table> candidate = it->second.lock();
+        if (!candidate)
+        {
+            it = registry.erase(it);
+            continue;
+        }
+        if ((!shared) && (candidate->entries.size() == map.size()))
+        {
+            FrozenKvsMap frozen(candidate);
+            bool equal = true;
+            for (auto element = map.begin(); equal && (element != map.end()); ++element)
+            {
+                const KvsValue* value = frozen.find(element->first);
+                equal = (value != nullptr) && equal_value(*value, element->second);
+            }
+            if (equal)
+            {
+                shared = std::move(candidate);
+            }
+        }
+        ++it;
+    }
+
+    if (!shared)
+    {
+        shared = build(map);
+        registry.emplace(fingerprint, shared);
+    }
+
+    return FrozenKvsMap(std::move(shared));
+}
+
+/* One hash, one seed load and one slot compare */
+const KvsValue* FrozenKvsMap::find(std::string_view key) const
+{
+    const KvsValue* result = nullptr;
+    const std::size_t slot_count = table->entries.size();
+    if (slot_count != 0U)
+    {
+        const uint64_t hash = hash_key(key, table->salt);
+        const uint32_t seed = table->seeds[bucket_of(hash, table->seeds.size())];
+        const std::size_t slot = slot_of(hash, seed, slot_count);
+        if ((table->hashes[slot] == hash) && (table->entries[slot].first == key))
+        {
+            result = &table->entries[slot].second;
+        }
+    }
+    return result;
+}
+
+FrozenKvsMap::Map FrozenKvsMap::to_map() const
+{
+    Map map;
+    map.reserve(table->entries.size());
+    for (const auto& entry : table->entries)
+    {
+        map.emplace(entry.first, entry.second);
+    }
+    return map;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,137 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_FROZEN_KVS_MAP_HPP
+#define SCORE_LIB_KVS_INTERNAL_FROZEN_KVS_MAP_HPP
+
+#include "kvsvalue.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+/**
+ * @class FrozenKvsMap
+ * @brief Immutable key-value table with a minimal perfect hash, used for the default values.
+ *
+ * The table is built once (hash and displace): every key maps to exactly one slot through a
+ * per-bucket seed, so a lookup is one hash of the key, one seed load and one slot compare
+ * without chaining. Keys, full hashes and values are stored in flat arrays indexed by slot.
+ *
+ * The table is never modified after construction, so lookups need no locking. Copies share the
+ * same table. `intern()` additionally shares the table between all instances that are built from
+ * identical content, e.g. several Kvs instances with the same defaults file.
+ */
+class FrozenKvsMap final
+{
+  public:
+    using Map = std::unordered_map<std::string, KvsValue>;
+    using Entry = std::pair<std::string, KvsValue>;
+
+    /**
+     * @brief Creates an empty table.
+     */
+    FrozenKvsMap();
+
+    /**
+     * @brief Freezes the content of a map into a new table.
+     */
+    explicit FrozenKvsMap(const Map& map);
+
+    FrozenKvsMap(const FrozenKvsMap& other) = default;
+    FrozenKvsMap& operator=(const FrozenKvsMap& other) = default;
+
+    /* A moved-from table is empty */
+    FrozenKvsMap(FrozenKvsMap&& other) noexcept;
+    FrozenKvsMap& operator=(FrozenKvsMap&& other) noexcept;
+
+    ~FrozenKvsMap() = default;
+
+    /**
+     * @brief Freezes the content of a map, reusing an existing table with identical content.
+     */
+    static FrozenKvsMap intern(const Map& map);
+
+    /**
+     * @brief Looks up a key.
+     *
+     * @return Pointer to the value (valid as long as a copy of this table exists), or nullptr.
+     */
+    const KvsValue* find(std::string_view key) const;
+
+    std::size_t count(std::string_view key) const
+    {
+        return (find(key) != nullptr) ? 1U : 0U;
+    }
+
+    std::size_t size() const
+    {
+        return table->entries.size();
+    }
+
+    bool empty() const
+    {
+        return table->entries.empty();
+    }
+
+    /* Entries in slot order */
+    std::vector<Entry>::const_iterator begin() const
+    {
+        return table->entries.cbegin();
+    }
+
+    std::vector<Entry>::const_iterator end() const
+    {
+        return table->entries.cend();
+    }
+
+    /**
+     * @brief Copies the content back into a mutable map.
+     */
+    Map to_map() const;
+
+    /**
+     * @brief Checks if both objects share the same table.
+     */
+    bool shares_table_with(const FrozenKvsMap& other) const
+    {
+        return table == other.table;
+    }
+
+  private:
+    struct Table
+    {
+        uint64_t salt = 0U;            ///< Salt of the key hash, changed if a build attempt failed
+        uint64_t fingerprint = 0U;     ///< Order-independent content hash, used by intern()
+        std::vector<uint32_t> seeds;   ///< Displacement seed per bucket
+        std::vector<uint64_t> hashes;  ///< Full key hash per slot, checked before the key compare
+        std::vector<Entry> entries;    ///< Key and value per slot
+    };
+
+    explicit FrozenKvsMap(std::shared_ptr<const Table> shared_table) : table(std::move(shared_table)) {}
+
+    static std::shared_ptr<const Table> build(const Map& map);
+    static const std::shared_ptr<const Table>& empty_table();
+
+    std::shared_ptr<const Table> table;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif  // SCORE_LIB_KVS_INTERNAL_FROZEN_KVS_MAP_HPP
@@ -0,0 +1,132 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "group_commit.hpp"
+#include <unistd.h>  // fdatasync(), close()
+#include <algorithm>
+
+namespace score::mw::per::kvs
+{
+
+GroupCommitter& GroupCommitter::instance()
+{
+    static GroupCommitter committer;
+    return committer;
+}
+
+GroupCommitter::~GroupCommitter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+    (void)sync_pending();
+}
+
+void GroupCommitter::submit(int fd,
+                            std::size_t bytes,
+                            std::chrono::milliseconds interval,
+                            std::size_t limit,
+                            std::shared_ptr<std::atomic<bool>> failed)
+{
+    const auto file_deadline = std::chrono::steady_clock::now() + interval;
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool earlier_deadline = true;
+        if (pending_fds.empty())
+        {
+            deadline = file_deadline;
+            byte_limit = limit;
+        }
+        else
+        {
+            earlier_deadline = (file_deadline < deadline);
+            deadline = std::min(deadline, file_deadline);
+            byte_limit = std::min(byte_limit, limit);
+        }
+        pending_fds.push_back(PendingFile{fd, std::move(failed)});
+        pending_bytes += bytes;
+        notify = earlier_deadline || sync_due();
+
+        if (!worker.joinable())
+        {
+            worker = std::thread(&GroupCommitter::run, this);
+        }
+    }
+    /* The worker waits for the earliest deadline, it must be woken up if that moved or the byte limit is exceeded */
+    if (notify)
+    {
+        wakeup.notify_one();
+    }
+}
+
+std::size_t GroupCommitter::sync_pending()
+{
+    std::vector<PendingFile> files;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        files.swap(pending_fds);
+        pending_bytes = 0U;
+    }
+    for (const auto& file : files)
+    {
+        if ((::fdatasync(file.fd) != 0) && (file.failed != nullptr))
+        {
+            file.failed->store(true);
+        }
+        (void)::close(file.fd);
+    }
+    return files.size();
+}
+
+std::size_t GroupCommitter::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending_fds.size();
+}
+
+/* mutex must be held */
+bool GroupCommitter::sync_due() const
+{
+    return (!pending_fds.empty()) &&
+           ((pending_bytes >= byte_limit) || (std::chrono::steady_clock::now() >= deadline));
+}
+
+void GroupCommitter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop)
+    {
+        if (pending_fds.empty())
+        {
+            wakeup.wait(lock);
+        }
+        else if (!sync_due())
+        {
+            (void)wakeup.wait_until(lock, deadline);
+        }
+        else
+        {
+            lock.unlock();
+            (void)sync_pending();
+            lock.lock();
+        }
+    }
+}
+
+} /* namespace score::mw::per::kvs */
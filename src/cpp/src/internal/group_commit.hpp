@@ -0,0 +1,100 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_GROUP_COMMIT_HPP
+#define SCORE_LIB_KVS_INTERNAL_GROUP_COMMIT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+/**
+ * @class GroupCommitter
+ * @brief Process-wide batching of file syncs for the GroupCommit durability mode.
+ *
+ * Writers hand over a duplicated file descriptor of a written (but not yet synced) file. A
+ * background thread syncs all pending files together once the earliest deadline of a pending
+ * file passed or the pending bytes reached the smallest byte limit of all submitters, then closes
+ * the descriptors. Pending files are synced on destruction at process exit. A failed sync is
+ * reported through the flag handed over with the descriptor, the submitter fails its next write.
+ */
+class GroupCommitter final
+{
+  public:
+    static GroupCommitter& instance();
+
+    GroupCommitter(const GroupCommitter&) = delete;
+    GroupCommitter& operator=(const GroupCommitter&) = delete;
+    ~GroupCommitter();
+
+    /**
+     * @brief Queues a file descriptor for a batched sync. Takes ownership of the descriptor.
+     *
+     * @param fd Descriptor of the written file.
+     * @param bytes Number of bytes written since the last sync.
+     * @param interval Maximum time until the file is synced.
+     * @param byte_limit Pending bytes that trigger a sync.
+     * @param failed Optional flag that is set if the sync of the file fails.
+     */
+    void submit(int fd,
+                std::size_t bytes,
+                std::chrono::milliseconds interval,
+                std::size_t byte_limit,
+                std::shared_ptr<std::atomic<bool>> failed = nullptr);
+
+    /**
+     * @brief Syncs and closes all pending files immediately.
+     * @return Number of files synced.
+     */
+    std::size_t sync_pending();
+
+    /**
+     * @brief Returns the number of files waiting for a sync.
+     */
+    std::size_t pending() const;
+
+  private:
+    GroupCommitter() = default;
+
+    void run();
+    bool sync_due() const;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+    bool stop = false;
+
+    /* Pending file and the flag of its submitter */
+    struct PendingFile
+    {
+        int fd;
+        std::shared_ptr<std::atomic<bool>> failed;
+    };
+
+    /* Pending batch, guarded by mutex */
+    std::vector<PendingFile> pending_fds;
+    std::size_t pending_bytes = 0U;
+    std::size_t byte_limit = 0U;
+    std::chrono::steady_clock::time_point deadline{};
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif  // SCORE_LIB_KVS_INTERNAL_GROUP_COMMIT_HPP
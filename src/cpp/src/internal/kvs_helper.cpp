@@ -11,35 +11,70 @@
  * SPDX-License-Identifier: Apache-2.0
  ********************************************************************************/
 #include "kvs_helper.hpp"
+#include "adler32.hpp"
+#include "lz_block.hpp"
+#include <fcntl.h>     // open()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>    // read(), close()
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <iterator>
 
 namespace score::mw::per::kvs
 {
 
 /*********************** Hash Functions *********************/
-/*Adler 32 checksum algorithm*/
-// Optimized version: processes data in blocks to reduce modulo operations
-uint32_t calculate_hash_adler32(const std::string& data)
+namespace
+{
+constexpr std::array<uint8_t, 4> HASH_FILE_MAGIC = {'K', 'V', 'S', 'H'};
+constexpr uint8_t HASH_FILE_VERSION = 1U;
+constexpr uint8_t HASH_FILE_VERSION_RECORDS = 2U; /* With per-record digests */
+constexpr std::size_t HASH_FILE_HEADER_SIZE = 6U; /* Magic, version, algorithm */
+constexpr std::array<uint8_t, 4> MANIFEST_MAGIC = {'K', 'V', 'S', 'M'};
+constexpr uint8_t MANIFEST_VERSION = 1U;
+constexpr std::size_t MANIFEST_HEADER_SIZE = 9U; /* Magic, version, entry count */
+constexpr std::size_t MANIFEST_ENTRY_SIZE = 26U;
+constexpr std::size_t MANIFEST_CRC_SIZE = 4U;
+constexpr std::array<uint8_t, 4> COMPRESSED_FILE_MAGIC = {'K', 'V', 'S', 'Z'};
+constexpr uint8_t COMPRESSED_FILE_VERSION = 1U;
+constexpr uint8_t COMPRESSED_FILE_CODEC_LZ = 1U;
+constexpr std::size_t COMPRESSED_FILE_HEADER_SIZE = 14U; /* Magic, version, codec, text size */
+constexpr std::array<uint8_t, 4> SLOT_MAGIC = {'K', 'V', 'S', 'S'};
+constexpr uint8_t SLOT_VERSION = 1U;
+constexpr std::size_t SLOT_DIGEST_POS = 24U; /* The digest covers the header bytes before it */
+
+/* Append a big-endian value of `size` bytes */
+void append_be(std::vector<uint8_t>& bytes, uint64_t value, std::size_t size)
 {
-    constexpr size_t ADLER32_NMAX = 5552;
-    constexpr uint32_t ADLER32_BASE = 65521;
-    uint32_t a = 1, b = 0;
-    size_t len = data.size();
-    size_t i = 0;
+    for (std::size_t i = size; i > 0U; --i)
+    {
+        bytes.push_back(static_cast<uint8_t>((value >> ((i - 1U) * 8U)) & 0xFFU));
+    }
+}
 
-    // Process in blocks of 5552 bytes (as recommended for Adler-32)
-    while (len > 0)
+/* Read a big-endian value of `size` bytes, false if the data is too short */
+bool read_be(const std::string& bytes, std::size_t& pos, std::size_t size, uint64_t& value)
+{
+    bool valid = (bytes.size() >= pos) && ((bytes.size() - pos) >= size);
+    if (valid)
     {
-        size_t tlen = len > ADLER32_NMAX ? ADLER32_NMAX : len;
-        len -= tlen;
-        for (size_t j = 0; j < tlen; ++j, ++i)
+        value = 0U;
+        for (std::size_t i = 0U; i < size; ++i)
         {
-            a += static_cast<unsigned char>(data[i]);
-            b += a;
+            value = (value << 8) | static_cast<uint8_t>(bytes[pos + i]);
         }
-        a %= ADLER32_BASE;
-        b %= ADLER32_BASE;
+        pos += size;
     }
-    return (b << 16) | a;
+    return valid;
+}
+}  // namespace
+
+/*Adler 32 checksum algorithm, vectorised if supported by the CPU*/
+uint32_t calculate_hash_adler32(const std::string& data)
+{
+    return adler32_update(ADLER32_INIT, data.data(), data.size());
 }
 
 /*Parse Adler32 checksum Byte-Array to uint32 */
@@ -74,24 +109,462 @@ std::array<uint8_t, 4> get_hash_bytes(const std::string& data)
     return value;
 }
 
-/* Wrapper Function to check, if Hash is valid*/
+/* Wrapper Function to check, if Hash is valid. The algorithm is taken from the hash file. */
 bool check_hash(const std::string& data_calculate, std::istream& data_parse)
 {
-    bool result;
-    uint32_t calculated_hash = calculate_hash_adler32(data_calculate);
-    uint32_t parsed_hash = parse_hash_adler32(data_parse);
-    if (calculated_hash == parsed_hash)
+    bool result = false;
+    const std::string bytes((std::istreambuf_iterator<char>(data_parse)), std::istreambuf_iterator<char>());
+    const std::optional<HashFileInfo> parsed = parse_hash_file(bytes);
+    if (parsed.has_value())
+    {
+        const uint64_t calculated_hash =
+            calculate_checksum(parsed->algorithm, data_calculate.data(), data_calculate.size());
+        result = (calculated_hash == parsed->digest);
+    }
+
+    return result;
+}
+
+/* Hash file bytes of data. Adler-32 without records keeps the legacy format, everything else is tagged. */
+std::vector<uint8_t> get_hash_file_bytes(const std::string& data,
+                                         KvsChecksum algorithm,
+                                         bool records,
+                                         const std::string* stored)
+{
+    const std::string& file_bytes = (stored != nullptr) ? *stored : data;
+    std::vector<uint8_t> bytes;
+    score::Result<std::vector<JsonMemberRange>> members = std::vector<JsonMemberRange>{};
+    if (records)
+    {
+        members = index_json_object(data);
+    }
+    auto checksum = make_checksum(algorithm);
+    if ((algorithm == KvsChecksum::Adler32) && (!records))
+    {
+        const std::array<uint8_t, 4> legacy = get_hash_bytes(file_bytes);
+        bytes.assign(legacy.begin(), legacy.end());
+    }
+    else if ((checksum != nullptr) && members)
+    {
+        const std::size_t digest_size = checksum->digest_size();
+        checksum->update(file_bytes.data(), file_bytes.size());
+        bytes.assign(HASH_FILE_MAGIC.begin(), HASH_FILE_MAGIC.end());
+        bytes.push_back(records ? HASH_FILE_VERSION_RECORDS : HASH_FILE_VERSION);
+        bytes.push_back(static_cast<uint8_t>(algorithm));
+        append_be(bytes, checksum->digest(), digest_size);
+        if (records)
+        {
+            append_be(bytes, members.value().size(), 4U);
+            for (const auto& member : members.value())
+            {
+                append_be(bytes, member.key.size(), 4U);
+                bytes.insert(bytes.end(), member.key.begin(), member.key.end());
+                const uint64_t digest = calculate_checksum(algorithm, member.member.data(), member.member.size());
+                append_be(bytes, digest, digest_size);
+            }
+        }
+    }
+    else
+    {
+        /* Unknown algorithm or invalid JSON object, an empty hash file never validates */
+    }
+
+    return bytes;
+}
+
+/* Parse the contents of a hash file */
+std::optional<HashFileInfo> parse_hash_file(const std::string& bytes, bool records)
+{
+    std::optional<HashFileInfo> result;
+    const bool tagged = (bytes.size() > HASH_FILE_HEADER_SIZE) &&
+                        std::equal(HASH_FILE_MAGIC.begin(), HASH_FILE_MAGIC.end(), bytes.begin());
+    const uint8_t version = tagged ? static_cast<uint8_t>(bytes[HASH_FILE_MAGIC.size()]) : 0U;
+    if (!tagged)
+    {
+        /* Legacy Adler-32 */
+        std::istringstream in(bytes);
+        result = HashFileInfo{KvsChecksum::Adler32, parse_hash_adler32(in)};
+    }
+    else if ((version == HASH_FILE_VERSION) || (version == HASH_FILE_VERSION_RECORDS))
+    {
+        const auto algorithm = static_cast<KvsChecksum>(bytes[HASH_FILE_MAGIC.size() + 1U]);
+        auto checksum = make_checksum(algorithm);
+        std::size_t pos = HASH_FILE_HEADER_SIZE;
+        HashFileInfo info{algorithm, 0U};
+        bool valid = (checksum != nullptr) && read_be(bytes, pos, checksum->digest_size(), info.digest);
+        if (valid && (version == HASH_FILE_VERSION_RECORDS) && (!records))
+        {
+            info.has_records = true;
+            pos = bytes.size(); /* Table not needed */
+        }
+        else if (valid && (version == HASH_FILE_VERSION_RECORDS))
+        {
+            uint64_t count = 0U;
+            valid = read_be(bytes, pos, 4U, count);
+            info.has_records = true;
+            for (uint64_t i = 0U; valid && (i < count); ++i)
+            {
+                uint64_t key_size = 0U;
+                uint64_t digest = 0U;
+                valid = read_be(bytes, pos, 4U, key_size) && ((bytes.size() - pos) >= key_size);
+                if (valid)
+                {
+                    std::string key = bytes.substr(pos, key_size);
+                    pos += key_size;
+                    valid = read_be(bytes, pos, checksum->digest_size(), digest);
+                    info.records.insert_or_assign(std::move(key), digest);
+                }
+            }
+        }
+        if (valid && (pos == bytes.size()))
+        {
+            result = std::move(info);
+        }
+    }
+    else
+    {
+        /* Unknown format version */
+    }
+
+    return result;
+}
+
+/*********************** Snapshot Deltas *********************/
+bool kvsvalue_equal(const KvsValue& lhs, const KvsValue& rhs)
+{
+    bool result = (lhs.getType() == rhs.getType());
+    if (result && (lhs.getType() == KvsValue::Type::Array))
+    {
+        const auto& lhs_array = std::get<KvsValue::Array>(lhs.getValue());
+        const auto& rhs_array = std::get<KvsValue::Array>(rhs.getValue());
+        result = (lhs_array.size() == rhs_array.size());
+        for (std::size_t i = 0U; result && (i < lhs_array.size()); ++i)
+        {
+            result = (lhs_array[i] == rhs_array[i]) || kvsvalue_equal(*lhs_array[i], *rhs_array[i]);
+        }
+    }
+    else if (result && (lhs.getType() == KvsValue::Type::Object))
+    {
+        const auto& lhs_object = std::get<KvsValue::Object>(lhs.getValue());
+        const auto& rhs_object = std::get<KvsValue::Object>(rhs.getValue());
+        result = (lhs_object.size() == rhs_object.size());
+        for (auto it = lhs_object.begin(); result && (it != lhs_object.end()); ++it)
+        {
+            auto search = rhs_object.find(it->first);
+            result = (search != rhs_object.end()) &&
+                     ((it->second == search->second) || kvsvalue_equal(*it->second, *search->second));
+        }
+    }
+    else if (result)
     {
-        result = true;
+        result = (lhs.getValue() == rhs.getValue());
     }
     else
     {
-        result = false;
+        /* Different types */
     }
 
     return result;
 }
 
+/* Reverse delta that turns `newer` back into `older` */
+std::unordered_map<std::string, KvsValue> make_snapshot_delta(const std::unordered_map<std::string, KvsValue>& older,
+                                                              const std::unordered_map<std::string, KvsValue>& newer)
+{
+    std::unordered_map<std::string, KvsValue> delta;
+    for (const auto& [key, value] : older)
+    {
+        auto search = newer.find(key);
+        if ((search == newer.end()) || (!kvsvalue_equal(value, search->second)))
+        {
+            delta.emplace(key, value);
+        }
+    }
+    KvsValue::Array added;
+    for (const auto& [key, value] : newer)
+    {
+        if (older.find(key) == older.end())
+        {
+            added.push_back(std::make_shared<KvsValue>(key));
+        }
+    }
+    delta.emplace(std::string(KVS_DELTA_KEY), KvsValue(added));
+
+    return delta;
+}
+
+bool is_snapshot_delta(const std::unordered_map<std::string, KvsValue>& data)
+{
+    auto search = data.find(std::string(KVS_DELTA_KEY));
+    return (search != data.end()) && (search->second.getType() == KvsValue::Type::Array);
+}
+
+/* Turn the image of the next newer snapshot into the image of the delta snapshot */
+void apply_snapshot_delta(std::unordered_map<std::string, KvsValue>& image,
+                          std::unordered_map<std::string, KvsValue>&& delta)
+{
+    auto marker = delta.find(std::string(KVS_DELTA_KEY));
+    if (marker != delta.end())
+    {
+        for (const auto& key : std::get<KvsValue::Array>(marker->second.getValue()))
+        {
+            if (key->getType() == KvsValue::Type::String)
+            {
+                (void)image.erase(std::get<std::string>(key->getValue()));
+            }
+        }
+        (void)delta.erase(marker);
+    }
+    for (auto& [key, value] : delta)
+    {
+        image.insert_or_assign(key, std::move(value));
+    }
+}
+
+/*********************** Snapshot Manifest *********************/
+ManifestEntry get_manifest_entry(std::size_t size, const std::vector<uint8_t>& hash_bytes, KvsChecksum algorithm)
+{
+    const std::optional<HashFileInfo> hash_info =
+        parse_hash_file(std::string(hash_bytes.begin(), hash_bytes.end()), false);
+    ManifestEntry entry;
+    entry.present = true;
+    entry.size = size;
+    entry.algorithm = algorithm;
+    entry.digest = hash_info.has_value() ? hash_info->digest : 0U;
+    entry.created_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    return entry;
+}
+
+std::vector<uint8_t> get_manifest_bytes(const std::vector<ManifestEntry>& entries)
+{
+    std::vector<uint8_t> bytes(MANIFEST_MAGIC.begin(), MANIFEST_MAGIC.end());
+    bytes.push_back(MANIFEST_VERSION);
+    append_be(bytes, entries.size(), 4U);
+    for (const auto& entry : entries)
+    {
+        bytes.push_back(entry.present ? 1U : 0U);
+        append_be(bytes, entry.size, 8U);
+        bytes.push_back(static_cast<uint8_t>(entry.algorithm));
+        append_be(bytes, entry.digest, 8U);
+        append_be(bytes, static_cast<uint64_t>(entry.created_ns), 8U);
+    }
+    append_be(bytes, calculate_checksum(KvsChecksum::Crc32c, bytes.data(), bytes.size()), MANIFEST_CRC_SIZE);
+
+    return bytes;
+}
+
+std::optional<std::vector<ManifestEntry>> parse_manifest(const std::string& bytes)
+{
+    std::optional<std::vector<ManifestEntry>> result;
+    std::size_t pos = MANIFEST_MAGIC.size() + 1U;
+    uint64_t count = 0U;
+    uint64_t crc = 0U;
+    std::size_t crc_pos = bytes.size() - MANIFEST_CRC_SIZE;
+    bool valid = (bytes.size() >= (MANIFEST_HEADER_SIZE + MANIFEST_CRC_SIZE)) &&
+                 std::equal(MANIFEST_MAGIC.begin(), MANIFEST_MAGIC.end(), bytes.begin()) &&
+                 (static_cast<uint8_t>(bytes[MANIFEST_MAGIC.size()]) == MANIFEST_VERSION) &&
+                 read_be(bytes, crc_pos, MANIFEST_CRC_SIZE, crc) &&
+                 (calculate_checksum(KvsChecksum::Crc32c, bytes.data(), bytes.size() - MANIFEST_CRC_SIZE) == crc) &&
+                 read_be(bytes, pos, 4U, count) &&
+                 ((bytes.size() - MANIFEST_HEADER_SIZE - MANIFEST_CRC_SIZE) == (count * MANIFEST_ENTRY_SIZE));
+    if (valid)
+    {
+        std::vector<ManifestEntry> entries(static_cast<std::size_t>(count));
+        for (auto& entry : entries)
+        {
+            uint64_t present = 0U;
+            uint64_t algorithm = 0U;
+            uint64_t created = 0U;
+            valid = valid && read_be(bytes, pos, 1U, present) && read_be(bytes, pos, 8U, entry.size) &&
+                    read_be(bytes, pos, 1U, algorithm) && read_be(bytes, pos, 8U, entry.digest) &&
+                    read_be(bytes, pos, 8U, created);
+            entry.present = (present != 0U);
+            entry.algorithm = static_cast<KvsChecksum>(algorithm);
+            entry.created_ns = static_cast<int64_t>(created);
+        }
+        if (valid && ((pos + MANIFEST_CRC_SIZE) == bytes.size()))
+        {
+            result = std::move(entries);
+        }
+    }
+
+    return result;
+}
+
+/*********************** Compressed Files *********************/
+std::string compress_json_file(const std::string& json)
+{
+    std::vector<uint8_t> header(COMPRESSED_FILE_MAGIC.begin(), COMPRESSED_FILE_MAGIC.end());
+    header.push_back(COMPRESSED_FILE_VERSION);
+    header.push_back(COMPRESSED_FILE_CODEC_LZ);
+    append_be(header, json.size(), 8U);
+    std::string bytes(header.begin(), header.end());
+    bytes.resize(COMPRESSED_FILE_HEADER_SIZE + lz_block_bound(json.size()));
+    const std::size_t block_size = lz_block_compress(json.data(), json.size(), &bytes[COMPRESSED_FILE_HEADER_SIZE]);
+    bytes.resize(COMPRESSED_FILE_HEADER_SIZE + block_size);
+    return bytes;
+}
+
+bool is_compressed_json_file(const std::string& bytes)
+{
+    return (bytes.size() >= COMPRESSED_FILE_MAGIC.size()) &&
+           std::equal(COMPRESSED_FILE_MAGIC.begin(), COMPRESSED_FILE_MAGIC.end(), bytes.begin(),
+                      [](uint8_t magic, char byte) {
+                          return magic == static_cast<uint8_t>(byte);
+                      });
+}
+
+bool decompress_json_file(std::string& bytes)
+{
+    bool result = !is_compressed_json_file(bytes);
+    std::size_t pos = COMPRESSED_FILE_MAGIC.size();
+    uint64_t version = 0U;
+    uint64_t codec = 0U;
+    uint64_t size = 0U;
+    if ((!result) && read_be(bytes, pos, 1U, version) && read_be(bytes, pos, 1U, codec) &&
+        read_be(bytes, pos, 8U, size) && (version == COMPRESSED_FILE_VERSION) && (codec == COMPRESSED_FILE_CODEC_LZ) &&
+        (size <= (bytes.size() * 255U))) /* Bound of the codec, rejects damaged sizes before allocating */
+    {
+        std::string json(static_cast<std::size_t>(size), '\0');
+        result = lz_block_decompress(bytes.data() + pos, bytes.size() - pos, json.data(), json.size());
+        if (result)
+        {
+            bytes = std::move(json);
+        }
+    }
+
+    return result;
+}
+
+/* Read a file in chunks and update the checksum with each chunk right after it was read, so the
+ * data is only touched once until it is parsed */
+bool read_file_hashed(const std::string& path, std::string& data, ChecksumStrategy* checksum)
+{
+    constexpr std::size_t READ_CHUNK_SIZE = 64U * 1024U;
+    bool result = false;
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        struct stat file_stat = {};
+        if ((::fstat(fd, &file_stat) == 0) && S_ISREG(file_stat.st_mode))
+        {
+            data.clear();
+            data.reserve(static_cast<std::size_t>(file_stat.st_size));
+            result = true;
+            while (result)
+            {
+                const std::size_t offset = data.size();
+                data.resize(offset + READ_CHUNK_SIZE);
+                const ssize_t bytes = ::read(fd, &data[offset], READ_CHUNK_SIZE);
+                if (bytes > 0)
+                {
+                    data.resize(offset + static_cast<std::size_t>(bytes));
+                    if (checksum != nullptr)
+                    {
+                        checksum->update(data.data() + offset, static_cast<std::size_t>(bytes));
+                    }
+                }
+                else
+                {
+                    data.resize(offset);
+                    if (bytes == 0)
+                    {
+                        break; /* End of file */
+                    }
+                    result = (errno == EINTR);
+                }
+            }
+        }
+        (void)::close(fd);
+    }
+
+    return result;
+}
+
+/*********************** A/B Slots *********************/
+std::vector<uint8_t> get_slot_header(const std::string& payload, uint64_t sequence, KvsChecksum algorithm)
+{
+    std::vector<uint8_t> header(SLOT_MAGIC.begin(), SLOT_MAGIC.end());
+    header.push_back(SLOT_VERSION);
+    header.push_back(static_cast<uint8_t>(algorithm));
+    append_be(header, 0U, 2U);
+    append_be(header, sequence, 8U);
+    append_be(header, payload.size(), 8U);
+    auto checksum = make_checksum(algorithm);
+    checksum->update(header.data(), header.size());
+    checksum->update(payload.data(), payload.size());
+    append_be(header, checksum->digest(), 8U);
+
+    return header;
+}
+
+std::optional<SlotHeader> parse_slot(const std::string& bytes)
+{
+    std::optional<SlotHeader> result;
+    SlotHeader header;
+    std::size_t pos = SLOT_MAGIC.size() + 4U;
+    uint64_t digest = 0U;
+    const bool tagged = (bytes.size() >= SLOT_HEADER_SIZE) &&
+                        std::equal(SLOT_MAGIC.begin(), SLOT_MAGIC.end(), bytes.begin()) &&
+                        (static_cast<uint8_t>(bytes[SLOT_MAGIC.size()]) == SLOT_VERSION);
+    auto checksum = tagged ? make_checksum(static_cast<KvsChecksum>(bytes[SLOT_MAGIC.size() + 1U])) : nullptr;
+    const bool valid = (checksum != nullptr) && read_be(bytes, pos, 8U, header.sequence) &&
+                       read_be(bytes, pos, 8U, header.size) && read_be(bytes, pos, 8U, digest) &&
+                       ((bytes.size() - SLOT_HEADER_SIZE) >= header.size);
+    if (valid)
+    {
+        checksum->update(bytes.data(), SLOT_DIGEST_POS);
+        checksum->update(bytes.data() + SLOT_HEADER_SIZE, static_cast<std::size_t>(header.size));
+        if (checksum->digest() == digest)
+        {
+            result = header;
+        }
+    }
+
+    return result;
+}
+
+bool is_empty_slot(const std::string& bytes)
+{
+    return std::all_of(bytes.begin(), bytes.begin() + std::min(bytes.size(), SLOT_HEADER_SIZE), [](char c) {
+        return c == '\0';
+    });
+}
+
+/*********************** Container Directory *********************/
+std::string get_container_directory(const std::vector<ContainerEntry>& entries)
+{
+    std::vector<uint8_t> bytes;
+    append_be(bytes, entries.size(), 4U);
+    for (const auto& entry : entries)
+    {
+        append_be(bytes, entry.key, 8U);
+        append_be(bytes, entry.offset, 8U);
+        append_be(bytes, entry.capacity, 8U);
+    }
+
+    return std::string(bytes.begin(), bytes.end());
+}
+
+bool parse_container_directory(const std::string& payload, std::vector<ContainerEntry>& entries)
+{
+    std::size_t pos = 0U;
+    uint64_t count = 0U;
+    bool valid = read_be(payload, pos, 4U, count) && (((payload.size() - pos) / 24U) >= count);
+    entries.clear();
+    for (uint64_t idx = 0U; valid && (idx < count); ++idx)
+    {
+        ContainerEntry entry;
+        valid = read_be(payload, pos, 8U, entry.key) && read_be(payload, pos, 8U, entry.offset) &&
+                read_be(payload, pos, 8U, entry.capacity);
+        entries.push_back(entry);
+    }
+
+    return valid;
+}
+
 /*********************** Standalone Helper Functions *********************/
 
 /* Helper Function for Any -> KVSValue conversion */
@@ -390,4 +863,486 @@ score::Result<score::json::Any> kvsvalue_to_any(const KvsValue& kv)
     return result;
 }
 
+/* Helper Function to derive the filename part of a scope segment from its prefix.
+ * Characters that are not safe in filenames are escaped as %XX, so different prefixes never share a
+ * segment. */
+std::string get_scope_segment_name(std::string_view prefix)
+{
+    static constexpr char hex_digits[] = "0123456789ABCDEF";
+    std::string name;
+    name.reserve(prefix.size());
+    for (const char c : prefix)
+    {
+        const auto uc = static_cast<unsigned char>(c);
+        if (std::isalnum(uc) || (c == '.') || (c == '-') || (c == '_'))
+        {
+            name.push_back(c);
+        }
+        else
+        {
+            name.push_back('%');
+            name.push_back(hex_digits[(uc >> 4) & 0x0F]);
+            name.push_back(hex_digits[uc & 0x0F]);
+        }
+    }
+    return name;
+}
+
+/* Helper Function to recover the prefix of a scope from the filename part of its segment, see
+ * get_scope_segment_name(). Returns no value for names that get_scope_segment_name() never creates. */
+std::optional<std::string> parse_scope_segment_name(std::string_view name)
+{
+    std::string prefix;
+    for (std::size_t pos = 0U; pos < name.size(); ++pos)
+    {
+        const auto uc = static_cast<unsigned char>(name[pos]);
+        const bool escaped = (uc == '%') && ((pos + 2U) < name.size()) &&
+                             std::isxdigit(static_cast<unsigned char>(name[pos + 1U])) &&
+                             std::isxdigit(static_cast<unsigned char>(name[pos + 2U]));
+        if (std::isalnum(uc) || (uc == '.') || (uc == '-') || (uc == '_'))
+        {
+            prefix.push_back(name[pos]);
+        }
+        else if (escaped)
+        {
+            prefix.push_back(static_cast<char>(std::stoi(std::string(name.substr(pos + 1U, 2U)), nullptr, 16)));
+            pos += 2U;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+    if (prefix.empty())
+    {
+        return std::nullopt;
+    }
+    return prefix;
+}
+
+/* Helper Function to convert a node of a build-time defaults image into a KvsValue.
+ * Child nodes must be stored behind their parent, which also rules out cycles. */
+score::Result<KvsValue> defaults_image_node_to_kvsvalue(const KvsDefaultsImage& image, uint32_t index)
+{
+    score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    const KvsDefaultsImageNode& node = image.nodes[index];
+    const bool is_container = (node.type == KvsValue::Type::Array) || (node.type == KvsValue::Type::Object);
+    const bool children_valid =
+        (node.child_count == 0U) || ((node.first_child > index) && (node.first_child <= image.node_count) &&
+                                     (node.child_count <= (image.node_count - node.first_child)));
+
+    if (is_container && (!children_valid))
+    {
+        result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }
+    else
+    {
+        switch (node.type)
+        {
+            case KvsValue::Type::i32:
+                result = KvsValue(static_cast<int32_t>(node.bits));
+                break;
+            case KvsValue::Type::u32:
+                result = KvsValue(static_cast<uint32_t>(node.bits));
+                break;
+            case KvsValue::Type::i64:
+                result = KvsValue(static_cast<int64_t>(node.bits));
+                break;
+            case KvsValue::Type::u64:
+                result = KvsValue(static_cast<uint64_t>(node.bits));
+                break;
+            case KvsValue::Type::f64:
+                result = KvsValue(node.number);
+                break;
+            case KvsValue::Type::Boolean:
+                result = KvsValue(node.bits != 0U);
+                break;
+            case KvsValue::Type::String:
+                result = KvsValue(std::string(node.text));
+                break;
+            case KvsValue::Type::Null:
+                result = KvsValue(nullptr);
+                break;
+            case KvsValue::Type::Array:
+            {
+                KvsValue::Array array;
+                array.reserve(node.child_count);
+                bool error = false;
+                for (uint32_t i = 0U; (!error) && (i < node.child_count); ++i)
+                {
+                    auto conv = defaults_image_node_to_kvsvalue(image, node.first_child + i);
+                    if (!conv)
+                    {
+                        result = conv;
+                        error = true;
+                    }
+                    else
+                    {
+                        array.emplace_back(std::make_shared<KvsValue>(std::move(conv.value())));
+                    }
+                }
+                if (!error)
+                {
+                    result = KvsValue(array);
+                }
+                break;
+            }
+            case KvsValue::Type::Object:
+            {
+                KvsValue::Object object;
+                bool error = false;
+                for (uint32_t i = 0U; (!error) && (i < node.child_count); ++i)
+                {
+                    auto conv = defaults_image_node_to_kvsvalue(image, node.first_child + i);
+                    if (!conv)
+                    {
+                        result = conv;
+                        error = true;
+                    }
+                    else
+                    {
+                        object.emplace(std::string(image.nodes[node.first_child + i].key),
+                                       std::make_shared<KvsValue>(std::move(conv.value())));
+                    }
+                }
+                if (!error)
+                {
+                    result = KvsValue(object);
+                }
+                break;
+            }
+            default:
+                result = score::MakeUnexpected(ErrorCode::InvalidValueType);
+                break;
+        }
+    }
+
+    return result;
+}
+
+/* Helper Function to convert a build-time defaults image into a map of default values */
+score::Result<std::unordered_map<std::string, KvsValue>> defaults_image_to_map(const KvsDefaultsImage& image)
+{
+    score::Result<std::unordered_map<std::string, KvsValue>> result =
+        score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unordered_map<std::string, KvsValue> map;
+
+    if ((image.root_count > image.node_count) || ((image.node_count != 0U) && (image.nodes == nullptr)))
+    {
+        result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }
+    else
+    {
+        bool error = false;
+        map.reserve(image.root_count);
+        for (uint32_t i = 0U; (!error) && (i < image.root_count); ++i)
+        {
+            auto conv = defaults_image_node_to_kvsvalue(image, i);
+            if (!conv)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*conv.error()));
+                error = true;
+            }
+            else
+            {
+                map.insert_or_assign(std::string(image.nodes[i].key), std::move(conv.value()));
+            }
+        }
+        if (!error)
+        {
+            result = std::move(map);
+        }
+    }
+
+    return result;
+}
+
+/*********************** Lazy JSON Indexing *********************/
+
+namespace
+{
+
+constexpr std::size_t json_npos = std::string_view::npos;
+
+bool is_json_whitespace(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+std::size_t skip_json_whitespace(std::string_view data, std::size_t pos)
+{
+    while ((pos < data.size()) && is_json_whitespace(data[pos]))
+    {
+        ++pos;
+    }
+    return pos;
+}
+
+/* Skip a JSON string starting at its opening quote, returns the position behind the closing quote */
+std::size_t skip_json_string(std::string_view data, std::size_t pos)
+{
+    std::size_t end = json_npos;
+    for (std::size_t i = pos + 1U; i < data.size(); ++i)
+    {
+        if (data[i] == '\\')
+        {
+            ++i;
+        }
+        else if (data[i] == '"')
+        {
+            end = i + 1U;
+            break;
+        }
+        else
+        {
+            /* Regular character */
+        }
+    }
+    return end;
+}
+
+/* Skip a JSON value without decoding it, containers are matched by their bracket depth */
+std::size_t skip_json_value(std::string_view data, std::size_t pos)
+{
+    std::size_t end = json_npos;
+    std::size_t depth = 0U;
+    std::size_t i = pos;
+    while ((i < data.size()) && (end == json_npos))
+    {
+        const char c = data[i];
+        if (c == '"')
+        {
+            i = skip_json_string(data, i);
+            if (i == json_npos)
+            {
+                break;
+            }
+            end = (depth == 0U) ? i : json_npos;
+        }
+        else if ((c == '{') || (c == '['))
+        {
+            ++depth;
+            ++i;
+        }
+        else if ((c == '}') || (c == ']'))
+        {
+            if (depth == 0U)
+            {
+                end = i; /* Primitive value at the end of the enclosing object */
+            }
+            else
+            {
+                --depth;
+                ++i;
+                end = (depth == 0U) ? i : json_npos;
+            }
+        }
+        else if ((depth == 0U) && ((c == ',') || is_json_whitespace(c)))
+        {
+            end = i;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    if ((end == json_npos) && (depth == 0U) && (i == data.size()) && (i > pos))
+    {
+        end = i;
+    }
+    return (end == pos) ? json_npos : end;
+}
+
+void append_utf8(std::string& out, uint32_t code_point)
+{
+    if (code_point < 0x80U)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800U)
+    {
+        out.push_back(static_cast<char>(0xC0U | (code_point >> 6U)));
+        out.push_back(static_cast<char>(0x80U | (code_point & 0x3FU)));
+    }
+    else if (code_point < 0x10000U)
+    {
+        out.push_back(static_cast<char>(0xE0U | (code_point >> 12U)));
+        out.push_back(static_cast<char>(0x80U | ((code_point >> 6U) & 0x3FU)));
+        out.push_back(static_cast<char>(0x80U | (code_point & 0x3FU)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0U | (code_point >> 18U)));
+        out.push_back(static_cast<char>(0x80U | ((code_point >> 12U) & 0x3FU)));
+        out.push_back(static_cast<char>(0x80U | ((code_point >> 6U) & 0x3FU)));
+        out.push_back(static_cast<char>(0x80U | (code_point & 0x3FU)));
+    }
+}
+
+bool parse_hex4(std::string_view data, std::size_t pos, uint32_t& value)
+{
+    bool valid = (pos + 4U) <= data.size();
+    value = 0U;
+    for (std::size_t i = pos; valid && (i < (pos + 4U)); ++i)
+    {
+        const auto c = static_cast<unsigned char>(data[i]);
+        valid = (std::isxdigit(c) != 0);
+        value = (value << 4U) | static_cast<uint32_t>(std::isdigit(c) ? (c - '0') : ((std::tolower(c) - 'a') + 10));
+    }
+    return valid;
+}
+
+/* Decode the content of a JSON string (without quotes) */
+bool unescape_json_string(std::string_view raw, std::string& out)
+{
+    bool valid = true;
+    out.clear();
+    out.reserve(raw.size());
+    for (std::size_t i = 0U; valid && (i < raw.size()); ++i)
+    {
+        if (raw[i] != '\\')
+        {
+            out.push_back(raw[i]);
+        }
+        else
+        {
+            ++i;
+            const char escaped = (i < raw.size()) ? raw[i] : '\0';
+            switch (escaped)
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    out.push_back(escaped);
+                    break;
+                case 'b':
+                    out.push_back('\b');
+                    break;
+                case 'f':
+                    out.push_back('\f');
+                    break;
+                case 'n':
+                    out.push_back('\n');
+                    break;
+                case 'r':
+                    out.push_back('\r');
+                    break;
+                case 't':
+                    out.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    uint32_t code_point = 0U;
+                    valid = parse_hex4(raw, i + 1U, code_point);
+                    i += 4U;
+                    if (valid && (code_point >= 0xD800U) && (code_point < 0xDC00U))
+                    {
+                        /* Surrogate pair */
+                        uint32_t low = 0U;
+                        valid = ((i + 2U) < raw.size()) && (raw[i + 1U] == '\\') && (raw[i + 2U] == 'u') &&
+                                parse_hex4(raw, i + 3U, low) && (low >= 0xDC00U) && (low < 0xE000U);
+                        code_point = 0x10000U + ((code_point - 0xD800U) << 10U) + (low - 0xDC00U);
+                        i += 6U;
+                    }
+                    if (valid)
+                    {
+                        append_utf8(out, code_point);
+                    }
+                    break;
+                }
+                default:
+                    valid = false;
+                    break;
+            }
+        }
+    }
+    return valid;
+}
+
+}  // namespace
+
+/* Helper Function to index the members of a JSON object without decoding their values. The
+ * values are only checked for balanced brackets and strings, they are validated on decoding. */
+score::Result<std::vector<JsonMemberRange>> index_json_object(std::string_view data)
+{
+    score::Result<std::vector<JsonMemberRange>> result = score::MakeUnexpected(ErrorCode::JsonParserError);
+    std::vector<JsonMemberRange> members;
+    bool valid = false;
+    std::size_t pos = skip_json_whitespace(data, 0U);
+    if ((pos < data.size()) && (data[pos] == '{'))
+    {
+        pos = skip_json_whitespace(data, pos + 1U);
+        valid = (pos < data.size()) && (data[pos] == '}');
+        while ((!valid) && (pos < data.size()) && (data[pos] == '"'))
+        {
+            const std::size_t member_start = pos;
+            const std::size_t key_end = skip_json_string(data, pos);
+            JsonMemberRange member;
+            if ((key_end == json_npos) ||
+                (!unescape_json_string(data.substr(pos + 1U, key_end - pos - 2U), member.key)))
+            {
+                break;
+            }
+            pos = skip_json_whitespace(data, key_end);
+            if ((pos >= data.size()) || (data[pos] != ':'))
+            {
+                break;
+            }
+            pos = skip_json_whitespace(data, pos + 1U);
+            const std::size_t value_end = skip_json_value(data, pos);
+            if (value_end == json_npos)
+            {
+                break;
+            }
+            member.member = data.substr(member_start, value_end - member_start);
+            member.value = data.substr(pos, value_end - pos);
+            members.push_back(std::move(member));
+
+            pos = skip_json_whitespace(data, value_end);
+            if ((pos < data.size()) && (data[pos] == ','))
+            {
+                pos = skip_json_whitespace(data, pos + 1U);
+            }
+            else
+            {
+                valid = (pos < data.size()) && (data[pos] == '}');
+                break;
+            }
+        }
+        valid = valid && (skip_json_whitespace(data, pos + 1U) == data.size());
+    }
+    if (valid)
+    {
+        result = std::move(members);
+    }
+
+    return result;
+}
+
+/* Helper Function to append verbatim members to a serialized JSON object */
+void append_json_members(std::string& buf, const std::vector<std::string_view>& members)
+{
+    const std::size_t close = buf.rfind('}');
+    if ((!members.empty()) && (close != std::string::npos))
+    {
+        const std::size_t open = buf.find('{');
+        bool empty = true;
+        for (std::size_t i = open + 1U; empty && (i < close); ++i)
+        {
+            empty = is_json_whitespace(buf[i]);
+        }
+        std::string appended;
+        for (const auto& member : members)
+        {
+            if (!empty)
+            {
+                appended += ",";
+            }
+            appended.append(member.data(), member.size());
+            empty = false;
+        }
+        buf.insert(close, appended);
+    }
+}
+
 } /* namespace score::mw::per::kvs */
@@ -13,11 +13,17 @@
 #ifndef SCORE_LIB_KVS_INTERNAL_KVS_HELPER_HPP
 #define SCORE_LIB_KVS_INTERNAL_KVS_HELPER_HPP
 
+#include "checksum.hpp"
 #include "error.hpp"
+#include "kvsdefaultsimage.hpp"
 #include "kvsvalue.hpp"
 #include "score/json/json_parser.h" /* For JSON Any Type */
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 /*
  * This header defines helper functions used internally by the Key-Value Store (KVS) implementation.
@@ -31,8 +37,109 @@ uint32_t calculate_hash_adler32(const std::string& data);
 std::array<uint8_t, 4> get_hash_bytes_adler32(uint32_t hash);
 std::array<uint8_t, 4> get_hash_bytes(const std::string& data);
 bool check_hash(const std::string& data_calculate, std::istream& data_parse);
+
+/* Hash file contents: the legacy 4-byte big-endian Adler-32, or a tagged header followed by the
+ * big-endian digest ("KVSH", format version, algorithm id). Format version 2 appends a table with
+ * the digest of every `"key": value` member of the JSON object. */
+struct HashFileInfo
+{
+    KvsChecksum algorithm;
+    uint64_t digest;
+    bool has_records = false;
+    std::unordered_map<std::string, uint64_t> records{};
+};
+/* With `stored`, the JSON file holds these bytes instead of `data` (compressed): the digest covers
+ * the stored bytes, the records the members of `data` */
+std::vector<uint8_t> get_hash_file_bytes(const std::string& data,
+                                         KvsChecksum algorithm,
+                                         bool records = false,
+                                         const std::string* stored = nullptr);
+/* With records false, the per-record table is skipped and not validated (only the digest is needed) */
+std::optional<HashFileInfo> parse_hash_file(const std::string& bytes, bool records = true);
+
+/* Snapshot manifest contents: "KVSM", format version, entry count, the entries and the CRC-32C of
+ * all preceding bytes. Entry n describes snapshot n of the main file. */
+struct ManifestEntry
+{
+    bool present = false;
+    uint64_t size = 0U;                           /* Size of the JSON file */
+    KvsChecksum algorithm = KvsChecksum::Adler32; /* Algorithm of the hash file */
+    uint64_t digest = 0U;                         /* Digest of the JSON file */
+    int64_t created_ns = 0;                       /* Creation time in nanoseconds since the epoch */
+};
+/* Entry of a JSON file written now with the given hash file */
+ManifestEntry get_manifest_entry(std::size_t size, const std::vector<uint8_t>& hash_bytes, KvsChecksum algorithm);
+std::vector<uint8_t> get_manifest_bytes(const std::vector<ManifestEntry>& entries);
+std::optional<std::vector<ManifestEntry>> parse_manifest(const std::string& bytes);
+
+/* Compressed JSON file contents: "KVSZ", format version, codec id, the size of the JSON text as
+ * 8 bytes big-endian and the compressed text (LZ block). JSON text never starts with the magic,
+ * so compressed files are recognized by their contents. */
+std::string compress_json_file(const std::string& json);
+bool is_compressed_json_file(const std::string& bytes);
+/* Replace compressed file contents by the JSON text, false if they cannot be decompressed. Plain
+ * JSON text is left unchanged. */
+bool decompress_json_file(std::string& bytes);
+
+/* A/B slot file contents: "KVSS", format version, algorithm id, 2 reserved bytes, the sequence
+ * number and the payload size as 8 bytes big-endian and the digest of the preceding header bytes
+ * and the payload as 8 bytes big-endian, followed by the payload (the stored JSON file contents).
+ * The payload may be followed by stale bytes of an earlier write. */
+inline constexpr std::size_t SLOT_HEADER_SIZE = 32U;
+struct SlotHeader
+{
+    uint64_t sequence = 0U; /* Incremented with every write, the newest valid slot is current */
+    uint64_t size = 0U;     /* Size of the payload */
+};
+std::vector<uint8_t> get_slot_header(const std::string& payload, uint64_t sequence, KvsChecksum algorithm);
+/* Header of a slot whose digest matches, nullopt if the slot is empty or damaged */
+std::optional<SlotHeader> parse_slot(const std::string& bytes);
+/* A preallocated slot that was never written is zero-filled */
+bool is_empty_slot(const std::string& bytes);
+
+/* Container directory: the entry count as 4 bytes big-endian, followed per segment by its key
+ * (instance ID << 1 | 1 for defaults), the file offset and the capacity of each of its two
+ * halves, each as 8 bytes big-endian. It is stored like a slot payload (see get_slot_header())
+ * in two alternating halves of CONTAINER_DIRECTORY_SIZE bytes at the start of the file. */
+inline constexpr std::size_t CONTAINER_DIRECTORY_SIZE = 4096U;
+struct ContainerEntry
+{
+    uint64_t key = 0U;
+    uint64_t offset = 0U;
+    uint64_t capacity = 0U;
+};
+std::string get_container_directory(const std::vector<ContainerEntry>& entries);
+/* False if the directory is truncated */
+bool parse_container_directory(const std::string& payload, std::vector<ContainerEntry>& entries);
+
+/* Read a whole file, feeding every chunk into the checksum (if any) while it is still cache-hot */
+bool read_file_hashed(const std::string& path, std::string& data, ChecksumStrategy* checksum);
 score::Result<KvsValue> any_to_kvsvalue(const score::json::Any& any);
 score::Result<score::json::Any> kvsvalue_to_any(const KvsValue& kv);
+std::string get_scope_segment_name(std::string_view prefix);
+std::optional<std::string> parse_scope_segment_name(std::string_view name);
+score::Result<KvsValue> defaults_image_node_to_kvsvalue(const KvsDefaultsImage& image, uint32_t index);
+score::Result<std::unordered_map<std::string, KvsValue>> defaults_image_to_map(const KvsDefaultsImage& image);
+
+/* Snapshots stored as reverse delta against the next newer snapshot: the values that differ from
+ * it, and the keys that are missing in the older snapshot as a string array under KVS_DELTA_KEY. */
+inline constexpr std::string_view KVS_DELTA_KEY{"__kvs_delta__"};
+bool kvsvalue_equal(const KvsValue& lhs, const KvsValue& rhs);
+std::unordered_map<std::string, KvsValue> make_snapshot_delta(const std::unordered_map<std::string, KvsValue>& older,
+                                                              const std::unordered_map<std::string, KvsValue>& newer);
+bool is_snapshot_delta(const std::unordered_map<std::string, KvsValue>& data);
+void apply_snapshot_delta(std::unordered_map<std::string, KvsValue>& image,
+                          std::unordered_map<std::string, KvsValue>&& delta);
+
+/* Member of a JSON object, referencing the original text */
+struct JsonMemberRange
+{
+    std::string key;         /* Decoded key */
+    std::string_view member; /* Verbatim `"key": value` text */
+    std::string_view value;  /* Verbatim value text */
+};
+score::Result<std::vector<JsonMemberRange>> index_json_object(std::string_view data);
+void append_json_members(std::string& buf, const std::vector<std::string_view>& members);
 
 } /* namespace score::mw::per::kvs */
 
@@ -0,0 +1,257 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "lz_block.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+namespace
+{
+constexpr std::size_t MIN_MATCH = 4U;
+constexpr std::size_t LAST_LITERALS = 5U; /* The last bytes are always literals */
+constexpr std::size_t MATCH_LIMIT = 12U;  /* No match starts within the last bytes */
+constexpr std::size_t MAX_OFFSET = 65535U;
+constexpr std::size_t HASH_LOG = 14U;
+constexpr std::size_t RUN_MASK = 15U;
+constexpr std::size_t WILD_COPY = 16U; /* Short copies move a fixed 16 bytes if the buffers allow it */
+
+uint32_t read32(const char* data)
+{
+    uint32_t value = 0U;
+    std::memcpy(&value, data, 4U);
+    return value;
+}
+
+uint32_t hash_sequence(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32U - HASH_LOG);
+}
+
+/* Number of equal bytes at `a` and `b`, `a` stops before `limit` */
+std::size_t count_match(const char* a, const char* b, const char* limit)
+{
+    const char* start = a;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    while ((limit - a) >= 8)
+    {
+        uint64_t lhs = 0U;
+        uint64_t rhs = 0U;
+        std::memcpy(&lhs, a, 8U);
+        std::memcpy(&rhs, b, 8U);
+        const uint64_t diff = lhs ^ rhs;
+        if (diff != 0U)
+        {
+            return static_cast<std::size_t>(a - start) + (static_cast<std::size_t>(__builtin_ctzll(diff)) / 8U);
+        }
+        a += 8;
+        b += 8;
+    }
+#endif
+    while ((a < limit) && (*a == *b))
+    {
+        ++a;
+        ++b;
+    }
+    return static_cast<std::size_t>(a - start);
+}
+
+/* Lengths from 15 are continued with bytes of 255 and a final byte below 255 */
+char* write_length(char* out, std::size_t length)
+{
+    while (length >= 255U)
+    {
+        *out++ = static_cast<char>(255U);
+        length -= 255U;
+    }
+    *out++ = static_cast<char>(length);
+    return out;
+}
+
+char* write_sequence(char* out,
+                     const char* literals,
+                     std::size_t literal_length,
+                     std::size_t offset,
+                     std::size_t match_length)
+{
+    char* token = out++;
+    uint8_t token_value = static_cast<uint8_t>(((literal_length < RUN_MASK) ? literal_length : RUN_MASK) << 4U);
+    if (literal_length >= RUN_MASK)
+    {
+        out = write_length(out, literal_length - RUN_MASK);
+    }
+    std::memcpy(out, literals, literal_length);
+    out += literal_length;
+    if (offset > 0U)
+    {
+        *out++ = static_cast<char>(offset & 0xFFU);
+        *out++ = static_cast<char>(offset >> 8U);
+        const std::size_t length = match_length - MIN_MATCH;
+        token_value = static_cast<uint8_t>(token_value | ((length < RUN_MASK) ? length : RUN_MASK));
+        if (length >= RUN_MASK)
+        {
+            out = write_length(out, length - RUN_MASK);
+        }
+    }
+    *token = static_cast<char>(token_value);
+    return out;
+}
+
+/* Read a continued length, false if the block ends within it */
+bool read_length(const uint8_t*& in, const uint8_t* end, std::size_t& length)
+{
+    bool result = true;
+    uint8_t byte = 255U;
+    while (result && (byte == 255U))
+    {
+        result = (in < end);
+        if (result)
+        {
+            byte = *in++;
+            length += byte;
+        }
+    }
+    return result;
+}
+}  // namespace
+
+std::size_t lz_block_bound(std::size_t size)
+{
+    return size + (size / 255U) + 16U;
+}
+
+std::size_t lz_block_compress(const char* src, std::size_t size, char* dst)
+{
+    char* out = dst;
+    std::size_t anchor = 0U;
+    if (size > MATCH_LIMIT)
+    {
+        std::vector<uint32_t> table(std::size_t{1U} << HASH_LOG, 0U);
+        const std::size_t match_start_limit = size - MATCH_LIMIT;
+        const char* match_end_limit = src + size - LAST_LITERALS;
+        std::size_t pos = 0U;
+        while (pos < match_start_limit)
+        {
+            const uint32_t sequence = read32(src + pos);
+            const uint32_t hash = hash_sequence(sequence);
+            const std::size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(pos);
+            if ((candidate < pos) && ((pos - candidate) <= MAX_OFFSET) && (read32(src + candidate) == sequence))
+            {
+                const std::size_t match_length =
+                    MIN_MATCH + count_match(src + pos + MIN_MATCH, src + candidate + MIN_MATCH, match_end_limit);
+                out = write_sequence(out, src + anchor, pos - anchor, pos - candidate, match_length);
+                pos += match_length;
+                anchor = pos;
+                if (pos < match_start_limit)
+                {
+                    table[hash_sequence(read32(src + pos - 2U))] = static_cast<uint32_t>(pos - 2U);
+                }
+            }
+            else
+            {
+                /* Skip faster through incompressible data */
+                pos += 1U + ((pos - anchor) >> 6U);
+            }
+        }
+    }
+    out = write_sequence(out, src + anchor, size - anchor, 0U, 0U);
+
+    return static_cast<std::size_t>(out - dst);
+}
+
+bool lz_block_decompress(const char* src, std::size_t size, char* dst, std::size_t dst_size)
+{
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+    const uint8_t* const in_end = in + size;
+    char* out = dst;
+    char* const out_end = dst + dst_size;
+    bool result = false;
+    bool decoding = true;
+    while (decoding)
+    {
+        decoding = (in < in_end);
+        const uint8_t token = decoding ? *in++ : 0U;
+        std::size_t literal_length = static_cast<std::size_t>(token >> 4U);
+        if (decoding && (literal_length == RUN_MASK))
+        {
+            decoding = read_length(in, in_end, literal_length);
+        }
+        decoding = decoding && (literal_length <= static_cast<std::size_t>(in_end - in)) &&
+                   (literal_length <= static_cast<std::size_t>(out_end - out));
+        if (decoding)
+        {
+            if ((literal_length <= WILD_COPY) && (static_cast<std::size_t>(in_end - in) >= WILD_COPY) &&
+                (static_cast<std::size_t>(out_end - out) >= WILD_COPY))
+            {
+                std::memcpy(out, in, WILD_COPY);
+            }
+            else
+            {
+                std::memcpy(out, in, literal_length);
+            }
+            in += literal_length;
+            out += literal_length;
+            if (in == in_end)
+            {
+                /* Last token */
+                result = (out == out_end);
+                decoding = false;
+            }
+        }
+        decoding = decoding && ((in_end - in) >= 2);
+        std::size_t offset = 0U;
+        if (decoding)
+        {
+            offset = static_cast<std::size_t>(in[0]) | (static_cast<std::size_t>(in[1]) << 8U);
+            in += 2;
+            decoding = (offset > 0U) && (offset <= static_cast<std::size_t>(out - dst));
+        }
+        std::size_t match_length = static_cast<std::size_t>(token & RUN_MASK);
+        if (decoding && (match_length == RUN_MASK))
+        {
+            decoding = read_length(in, in_end, match_length);
+        }
+        match_length += MIN_MATCH;
+        decoding = decoding && (match_length <= static_cast<std::size_t>(out_end - out));
+        if (decoding)
+        {
+            const char* match = out - offset;
+            if ((offset >= WILD_COPY) && (match_length <= WILD_COPY) &&
+                (static_cast<std::size_t>(out_end - out) >= WILD_COPY))
+            {
+                std::memcpy(out, match, WILD_COPY);
+                out += match_length;
+            }
+            else
+            {
+                /* Overlapping matches repeat the last `offset` bytes, the copied range doubles */
+                std::size_t remaining = match_length;
+                while (remaining > 0U)
+                {
+                    const std::size_t chunk = std::min(remaining, static_cast<std::size_t>(out - match));
+                    std::memcpy(out, match, chunk);
+                    out += chunk;
+                    remaining -= chunk;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+} /* namespace score::mw::per::kvs */
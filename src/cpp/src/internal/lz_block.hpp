@@ -0,0 +1,43 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_LZ_BLOCK_HPP
+#define SCORE_LIB_KVS_INTERNAL_LZ_BLOCK_HPP
+
+#include <cstddef>
+
+/*
+ * LZ77 block codec in the LZ4 block format.
+ *
+ * A block is a sequence of tokens, each with a run of literals followed by a match of at least 4
+ * bytes within the previous 64 KiB. The last token only holds literals. The compressor is a greedy
+ * single-pass matcher over a hash table, decompression is a bounds-checked copy loop, so damaged
+ * blocks are rejected instead of overrunning the output.
+ */
+
+namespace score::mw::per::kvs
+{
+
+/* Maximum compressed size of `size` bytes (incompressible input) */
+std::size_t lz_block_bound(std::size_t size);
+
+/* Compress `size` bytes of `src` into `dst` (at least lz_block_bound(size) bytes), returns the
+ * compressed size */
+std::size_t lz_block_compress(const char* src, std::size_t size, char* dst);
+
+/* Decompress a block into exactly `dst_size` bytes, false if the block is damaged or its
+ * decompressed size differs */
+bool lz_block_decompress(const char* src, std::size_t size, char* dst, std::size_t dst_size);
+
+} /* namespace score::mw::per::kvs */
+
+#endif  // SCORE_LIB_KVS_INTERNAL_LZ_BLOCK_HPP
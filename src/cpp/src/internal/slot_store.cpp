@@ -0,0 +1,150 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "slot_store.hpp"
+#include "kvs_helper.hpp"
+#include <fcntl.h>     // open(), posix_fallocate()
+#include <sys/stat.h>  // fstat()
+#include <sys/uio.h>   // pwritev()
+#include <unistd.h>    // pread(), fsync(), close()
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+namespace
+{
+
+/* Opens a slot file and preallocates it, a new or grown file is synced once so that later writes
+ * only change data blocks */
+int open_slot_file(const std::string& path, std::size_t capacity)
+{
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat info{};
+    if ((fd >= 0) && (::fstat(fd, &info) == 0) && (static_cast<std::size_t>(info.st_size) < capacity))
+    {
+        if ((::posix_fallocate(fd, 0, static_cast<off_t>(capacity)) != 0) || (::fsync(fd) != 0))
+        {
+            (void)::close(fd);
+            fd = -1;
+        }
+    }
+
+    return fd;
+}
+
+bool read_slot_file(int fd, std::string& bytes)
+{
+    struct stat info{};
+    bool result = (::fstat(fd, &info) == 0);
+    if (result)
+    {
+        bytes.resize(static_cast<std::size_t>(info.st_size));
+        std::size_t pos = 0U;
+        while (result && (pos < bytes.size()))
+        {
+            const ssize_t count = ::pread(fd, bytes.data() + pos, bytes.size() - pos, static_cast<off_t>(pos));
+            result = (count > 0);
+            pos += result ? static_cast<std::size_t>(count) : 0U;
+        }
+    }
+
+    return result;
+}
+
+} /* anonymous namespace */
+
+std::unique_ptr<SlotStore> SlotStore::open(const std::string& prefix, std::size_t capacity)
+{
+    std::unique_ptr<SlotStore> result(new SlotStore());
+    result->paths = {prefix + "_a.slot", prefix + "_b.slot"};
+    for (std::size_t idx = 0U; idx < result->fds.size(); ++idx)
+    {
+        result->fds[idx] = open_slot_file(result->paths[idx], capacity);
+    }
+    if ((result->fds[0] < 0) || (result->fds[1] < 0))
+    {
+        result.reset();
+    }
+
+    return result;
+}
+
+SlotStore::~SlotStore()
+{
+    for (const int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            (void)::close(fd);
+        }
+    }
+}
+
+SlotStore::LoadState SlotStore::load(std::string& payload)
+{
+    LoadState result = LoadState::Empty;
+    std::array<std::string, 2> bytes;
+    bool found = false;
+    for (std::size_t idx = 0U; idx < fds.size(); ++idx)
+    {
+        const bool read = read_slot_file(fds[idx], bytes[idx]);
+        const auto header = read ? parse_slot(bytes[idx]) : std::nullopt;
+        if (header.has_value() && (!found || (header->sequence > active_sequence)))
+        {
+            found = true;
+            active = idx;
+            active_sequence = header->sequence;
+            payload.assign(bytes[idx], SLOT_HEADER_SIZE, static_cast<std::size_t>(header->size));
+        }
+        else if (!header.has_value() && (!read || !is_empty_slot(bytes[idx])))
+        {
+            result = LoadState::Corrupted;
+        }
+    }
+    /* A damaged slot next to a valid one is an interrupted write of the newer data */
+    if (found)
+    {
+        result = LoadState::Valid;
+    }
+
+    return result;
+}
+
+int SlotStore::write(const std::string& payload, KvsChecksum algorithm)
+{
+    const std::size_t target = 1U - active;
+    std::vector<uint8_t> header = get_slot_header(payload, active_sequence + 1U, algorithm);
+    std::array<struct iovec, 2> iov{{{header.data(), header.size()},
+                                     {const_cast<char*>(payload.data()), payload.size()}}};
+    const ssize_t written = ::pwritev(fds[target], iov.data(), static_cast<int>(iov.size()), 0);
+
+    return (written == static_cast<ssize_t>(header.size() + payload.size())) ? fds[target] : -1;
+}
+
+void SlotStore::commit()
+{
+    active = 1U - active;
+    ++active_sequence;
+}
+
+const std::string& SlotStore::path() const
+{
+    return paths[1U - active];
+}
+
+uint64_t SlotStore::sequence() const
+{
+    return active_sequence;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,103 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_SLOT_STORE_HPP
+#define SCORE_LIB_KVS_INTERNAL_SLOT_STORE_HPP
+
+#include "checksum.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace score::mw::per::kvs
+{
+
+/**
+ * @class SlotStore
+ * @brief Double-buffered persistence of the KVS file in two preallocated slot files.
+ *
+ * The files `<prefix>_a.slot` and `<prefix>_b.slot` are created once with their full capacity
+ * and then only overwritten in place, alternating between them. Each write carries a sequence
+ * number and a digest in its header (see get_slot_header()), the newest slot with a matching
+ * digest is the current one. A torn write therefore only damages the older slot, and a write
+ * needs neither a rename nor a size change of a file. A payload larger than the capacity grows
+ * the slot file.
+ */
+class SlotStore final
+{
+  public:
+    enum class LoadState
+    {
+        Empty = 0,     ///< Both slots were never written
+        Valid = 1,     ///< Payload of the newest valid slot was read
+        Corrupted = 2, ///< No slot has a matching digest, but at least one was written
+    };
+
+    /**
+     * @brief Opens the slot files of a prefix, creating and preallocating missing or short files.
+     *
+     * @param prefix Path prefix of the slot files.
+     * @param capacity Preallocated size of each slot file.
+     * @return Slot store, nullptr if a file could not be opened or preallocated.
+     */
+    static std::unique_ptr<SlotStore> open(const std::string& prefix, std::size_t capacity);
+
+    SlotStore(const SlotStore&) = delete;
+    SlotStore& operator=(const SlotStore&) = delete;
+    ~SlotStore();
+
+    /**
+     * @brief Reads both slots and selects the newest valid one as the active slot.
+     *
+     * @param payload Receives the payload of the active slot.
+     * @return State of the slots.
+     */
+    LoadState load(std::string& payload);
+
+    /**
+     * @brief Writes the payload with a single write call into the inactive slot, without syncing it.
+     *
+     * @param payload Stored JSON file contents.
+     * @param algorithm Algorithm of the slot digest.
+     * @return Descriptor of the written slot file (owned by the store), -1 on failure.
+     */
+    int write(const std::string& payload, KvsChecksum algorithm);
+
+    /**
+     * @brief Makes the last written slot the active one, once it is synced.
+     */
+    void commit();
+
+    /**
+     * @brief Returns the path of the slot the next write goes to.
+     */
+    const std::string& path() const;
+
+    /**
+     * @brief Returns the sequence number of the active slot, 0 if no slot was written yet.
+     */
+    uint64_t sequence() const;
+
+  private:
+    SlotStore() = default;
+
+    std::array<int, 2> fds{-1, -1};
+    std::array<std::string, 2> paths;
+    std::size_t active = 1U; /* The first write goes to slot a */
+    uint64_t active_sequence = 0U;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif  // SCORE_LIB_KVS_INTERNAL_SLOT_STORE_HPP
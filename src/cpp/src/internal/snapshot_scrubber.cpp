@@ -0,0 +1,251 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "snapshot_scrubber.hpp"
+#include "kvs_helper.hpp"
+#include <fcntl.h>     // open()
+#include <sys/stat.h>  // stat()
+#include <unistd.h>    // read(), close()
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+
+namespace score::mw::per::kvs
+{
+
+namespace
+{
+constexpr std::size_t SCRUB_CHUNK_SIZE = 64U * 1024U;
+
+enum class ScrubOutcome
+{
+    Valid,
+    Corrupted,
+    Aborted /* Missing file, read error or stopped by the pacer */
+};
+
+/* Stream the JSON file of a snapshot through the checksum of its hash file, the data is not kept */
+ScrubOutcome verify_snapshot_files(const std::string& prefix, const ScrubPacer& pacer)
+{
+    ScrubOutcome result = ScrubOutcome::Aborted;
+    std::ifstream hin(prefix + ".hash", std::ios::binary);
+    const std::string hash_bytes{std::istreambuf_iterator<char>(hin), std::istreambuf_iterator<char>()};
+    const std::optional<HashFileInfo> hash_info = hin ? parse_hash_file(hash_bytes) : std::nullopt;
+    std::unique_ptr<ChecksumStrategy> checksum = hash_info.has_value() ? make_checksum(hash_info->algorithm) : nullptr;
+    const int fd = (checksum != nullptr) ? ::open((prefix + ".json").c_str(), O_RDONLY | O_CLOEXEC) : -1;
+    if (fd >= 0)
+    {
+        std::array<char, SCRUB_CHUNK_SIZE> buffer;
+        bool reading = true;
+        while (reading)
+        {
+            const ssize_t bytes = ::read(fd, buffer.data(), buffer.size());
+            if (bytes > 0)
+            {
+                checksum->update(buffer.data(), static_cast<std::size_t>(bytes));
+                reading = (!pacer) || pacer(static_cast<std::size_t>(bytes));
+            }
+            else if (bytes == 0)
+            {
+                result = (checksum->digest() == hash_info->digest) ? ScrubOutcome::Valid : ScrubOutcome::Corrupted;
+                reading = false;
+            }
+            else
+            {
+                reading = (errno == EINTR);
+            }
+        }
+        (void)::close(fd);
+    }
+    else if (hash_info.has_value() && (checksum == nullptr))
+    {
+        result = ScrubOutcome::Corrupted; /* Unknown algorithm */
+    }
+    else
+    {
+        /* Missing files are not verified */
+    }
+
+    return result;
+}
+}  // namespace
+
+std::optional<ScrubStamp> get_scrub_stamp(const std::string& prefix)
+{
+    std::optional<ScrubStamp> result;
+    struct stat json_stat = {};
+    struct stat hash_stat = {};
+    if ((::stat((prefix + ".json").c_str(), &json_stat) == 0) && (::stat((prefix + ".hash").c_str(), &hash_stat) == 0))
+    {
+        auto mtime_ns = [](const struct stat& file_stat) {
+            return (static_cast<uint64_t>(file_stat.st_mtim.tv_sec) * 1000000000U) +
+                   static_cast<uint64_t>(file_stat.st_mtim.tv_nsec);
+        };
+        result = ScrubStamp{static_cast<uint64_t>(json_stat.st_dev),
+                            static_cast<uint64_t>(json_stat.st_ino),
+                            static_cast<uint64_t>(json_stat.st_size),
+                            mtime_ns(json_stat),
+                            static_cast<uint64_t>(hash_stat.st_dev),
+                            static_cast<uint64_t>(hash_stat.st_ino),
+                            static_cast<uint64_t>(hash_stat.st_size),
+                            mtime_ns(hash_stat)};
+    }
+    return result;
+}
+
+/*********************** Scrub Cache *********************/
+std::optional<ScrubResult> ScrubCache::lookup(const std::string& prefix) const
+{
+    std::optional<ScrubResult> result;
+    const std::optional<ScrubStamp> stamp = get_scrub_stamp(prefix);
+    if (stamp.has_value())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto search = results.find(stamp.value());
+        if (search != results.end())
+        {
+            result = search->second;
+        }
+    }
+    return result;
+}
+
+void ScrubCache::store(const ScrubStamp& stamp, const ScrubResult& result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    results.insert_or_assign(stamp, result);
+}
+
+void ScrubCache::retain(const std::vector<ScrubStamp>& stamps)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = results.begin(); it != results.end();)
+    {
+        if (std::find(stamps.begin(), stamps.end(), it->first) == stamps.end())
+        {
+            it = results.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+std::size_t verify_snapshots(const ScrubTarget& target, const ScrubPacer& pacer)
+{
+    std::size_t verified = 0U;
+    std::vector<ScrubStamp> stamps;
+    for (std::size_t idx = 1U; idx <= target.snapshots; ++idx)
+    {
+        const std::string prefix = target.prefix + "_" + std::to_string(idx);
+        const std::optional<ScrubStamp> stamp = get_scrub_stamp(prefix);
+        const ScrubOutcome outcome = stamp.has_value() ? verify_snapshot_files(prefix, pacer) : ScrubOutcome::Aborted;
+        if (outcome != ScrubOutcome::Aborted)
+        {
+            /* A flush may have rotated or rewritten the files meanwhile, the result is only valid
+             * for the files that were read */
+            if (get_scrub_stamp(prefix) == stamp)
+            {
+                target.cache->store(stamp.value(), ScrubResult{outcome == ScrubOutcome::Valid,
+                                                               std::chrono::system_clock::now()});
+                ++verified;
+            }
+        }
+        if (stamp.has_value())
+        {
+            stamps.push_back(stamp.value());
+        }
+    }
+    target.cache->retain(stamps);
+
+    return verified;
+}
+
+/*********************** Snapshot Scrubber *********************/
+SnapshotScrubber::SnapshotScrubber(std::chrono::milliseconds interval, std::size_t bytes_per_second)
+    : interval(interval), bytes_per_second(bytes_per_second)
+{
+}
+
+SnapshotScrubber::~SnapshotScrubber()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+void SnapshotScrubber::add(ScrubTarget target)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    targets.push_back(std::move(target));
+    if (!worker.joinable())
+    {
+        worker = std::thread(&SnapshotScrubber::run, this);
+    }
+}
+
+std::size_t SnapshotScrubber::passes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return completed_passes;
+}
+
+/* Wait until the bytes read in this pass fit into the budget, false if the scrubber is stopped */
+bool SnapshotScrubber::pace(std::size_t bytes)
+{
+    budget_bytes += bytes;
+    std::unique_lock<std::mutex> lock(mutex);
+    if (bytes_per_second > 0U)
+    {
+        const auto due = budget_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                            std::chrono::duration<double>(static_cast<double>(budget_bytes) /
+                                                                          static_cast<double>(bytes_per_second)));
+        (void)wakeup.wait_until(lock, due, [this]() {
+            return stop;
+        });
+    }
+    return !stop;
+}
+
+void SnapshotScrubber::run()
+{
+    const ScrubPacer pacer = [this](std::size_t bytes) {
+        return pace(bytes);
+    };
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop)
+    {
+        const std::vector<ScrubTarget> pass_targets = targets;
+        lock.unlock();
+        budget_start = std::chrono::steady_clock::now();
+        budget_bytes = 0U;
+        for (const auto& target : pass_targets)
+        {
+            (void)verify_snapshots(target, pacer);
+        }
+        lock.lock();
+        ++completed_passes;
+        (void)wakeup.wait_for(lock, interval, [this]() {
+            return stop;
+        });
+    }
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,148 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_SNAPSHOT_SCRUBBER_HPP
+#define SCORE_LIB_KVS_INTERNAL_SNAPSHOT_SCRUBBER_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+/* Identity of the JSON and hash file of a snapshot (device, inode, size and modification time of
+ * both). The rotation renames files, so a snapshot keeps its stamp when it moves to the next ID,
+ * while rewriting a file changes it. */
+using ScrubStamp = std::array<uint64_t, 8>;
+
+/* Returns the stamp of the files `<prefix>.json` and `<prefix>.hash`, nullopt if one is missing */
+std::optional<ScrubStamp> get_scrub_stamp(const std::string& prefix);
+
+/* Result of a snapshot verification */
+struct ScrubResult
+{
+    bool valid = false;
+    std::chrono::system_clock::time_point verified_at{};
+};
+
+/**
+ * @class ScrubCache
+ * @brief Verification results of the snapshots of one Kvs object, indexed by their file stamps.
+ */
+class ScrubCache final
+{
+  public:
+    /**
+     * @brief Returns the last result for the current files of a snapshot, nullopt if the files
+     *        are missing or were not verified in their current state.
+     */
+    std::optional<ScrubResult> lookup(const std::string& prefix) const;
+
+    void store(const ScrubStamp& stamp, const ScrubResult& result);
+
+    /**
+     * @brief Drops the results of all files that are no longer part of a snapshot.
+     */
+    void retain(const std::vector<ScrubStamp>& stamps);
+
+  private:
+    mutable std::mutex mutex;
+    std::map<ScrubStamp, ScrubResult> results;
+};
+
+/* Snapshots of one Kvs object to be verified */
+struct ScrubTarget
+{
+    std::string prefix;    ///< Filename prefix, snapshot n is stored in `<prefix>_<n>.json`
+    std::size_t snapshots; ///< Highest snapshot ID
+    std::shared_ptr<ScrubCache> cache;
+};
+
+/* Called with the number of bytes read, returns false to abort the verification */
+using ScrubPacer = std::function<bool(std::size_t)>;
+
+/**
+ * @brief Verifies all snapshots of a target against their hash files and stores the results.
+ *
+ * Results of files that were modified while they were read are discarded.
+ *
+ * @param pacer Called after every chunk read, may be empty.
+ * @return Number of verified snapshots.
+ */
+std::size_t verify_snapshots(const ScrubTarget& target, const ScrubPacer& pacer);
+
+/**
+ * @class SnapshotScrubber
+ * @brief Background thread that periodically verifies the snapshots of its targets.
+ *
+ * Each pass verifies all snapshots of all targets, the reads are paced to the byte budget. The
+ * targets share their caches with the Kvs objects, so the thread does not depend on the lifetime
+ * or the address of these objects. The thread is stopped on destruction.
+ */
+class SnapshotScrubber final
+{
+  public:
+    /**
+     * @param interval Pause between two passes.
+     * @param bytes_per_second Read budget, 0 for unlimited.
+     */
+    SnapshotScrubber(std::chrono::milliseconds interval, std::size_t bytes_per_second);
+
+    SnapshotScrubber(const SnapshotScrubber&) = delete;
+    SnapshotScrubber& operator=(const SnapshotScrubber&) = delete;
+    ~SnapshotScrubber();
+
+    /**
+     * @brief Adds a target, the thread is started with the first one.
+     */
+    void add(ScrubTarget target);
+
+    /**
+     * @brief Returns the number of completed passes.
+     */
+    std::size_t passes() const;
+
+  private:
+    void run();
+    bool pace(std::size_t bytes);
+
+    const std::chrono::milliseconds interval;
+    const std::size_t bytes_per_second;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+    bool stop = false;
+
+    /* Guarded by mutex */
+    std::vector<ScrubTarget> targets;
+    std::size_t completed_passes = 0U;
+
+    /* Byte budget of the current pass, only used by the worker */
+    std::chrono::steady_clock::time_point budget_start{};
+    std::size_t budget_bytes = 0U;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif  // SCORE_LIB_KVS_INTERNAL_SNAPSHOT_SCRUBBER_HPP
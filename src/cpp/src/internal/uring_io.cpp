@@ -0,0 +1,552 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "uring_io.hpp"
+
+#if defined(__linux__)
+#include <fcntl.h>            // AT_FDCWD, O_* flags
+#include <linux/io_uring.h>   // io_uring ABI
+#include <sys/mman.h>         // mmap(), munmap()
+#include <sys/stat.h>         // struct statx, STATX_SIZE
+#include <sys/syscall.h>      // __NR_io_uring_*
+#include <unistd.h>           // syscall(), close()
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#endif
+
+namespace score::mw::per::kvs
+{
+
+#if defined(__linux__)
+
+namespace
+{
+
+constexpr uint32_t kRingEntries = 32U;
+
+/* Operations used by flush and open, all must be supported by the kernel */
+constexpr uint8_t kRequiredOps[] = {IORING_OP_OPENAT,
+                                    IORING_OP_CLOSE,
+                                    IORING_OP_READ,
+                                    IORING_OP_WRITE,
+                                    IORING_OP_FSYNC,
+                                    IORING_OP_STATX,
+                                    IORING_OP_RENAMEAT};
+
+bool ops_supported(int ring_fd)
+{
+    constexpr std::size_t probe_ops = 256U;
+    std::vector<uint8_t> buffer(sizeof(io_uring_probe) + (probe_ops * sizeof(io_uring_probe_op)), 0U);
+    auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+    bool supported = false;
+    if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, probe_ops) == 0)
+    {
+        supported = true;
+        for (const uint8_t op : kRequiredOps)
+        {
+            supported = supported && (op <= probe->last_op) && ((probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0U);
+        }
+    }
+    return supported;
+}
+
+}  // namespace
+
+struct UringIo::Op
+{
+    uint8_t opcode = IORING_OP_NOP;
+    uint8_t sqe_flags = 0U; /* IOSQE_IO_LINK / IOSQE_IO_HARDLINK to the next op */
+    int fd = AT_FDCWD;
+    const char* path = nullptr;
+    const char* new_path = nullptr;
+    void* buf = nullptr;
+    uint32_t len = 0U;
+    uint32_t op_flags = 0U; /* open, fsync or statx flags */
+    int32_t res = -ECANCELED;
+};
+
+UringIo& UringIo::instance()
+{
+    static UringIo uring;
+    return uring;
+}
+
+UringIo::UringIo()
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    const int fd = static_cast<int>(::syscall(__NR_io_uring_setup, kRingEntries, &params));
+    if (fd < 0)
+    {
+        return;
+    }
+
+    sq_ring_size = params.sq_off.array + (params.sq_entries * sizeof(uint32_t));
+    cq_ring_size = params.cq_off.cqes + (params.cq_entries * sizeof(io_uring_cqe));
+    const bool single_mmap = ((params.features & IORING_FEAT_SINGLE_MMAP) != 0U);
+    if (single_mmap)
+    {
+        sq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        cq_ring_size = sq_ring_size;
+    }
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+    void* sq = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    void* cq = single_mmap ? sq
+                           : ::mmap(nullptr,
+                                    cq_ring_size,
+                                    PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE,
+                                    fd,
+                                    IORING_OFF_CQ_RING);
+    void* entries_map =
+        ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if ((sq == MAP_FAILED) || (cq == MAP_FAILED) || (entries_map == MAP_FAILED) || (!ops_supported(fd)))
+    {
+        if (entries_map != MAP_FAILED)
+        {
+            (void)::munmap(entries_map, sqes_size);
+        }
+        if ((cq != MAP_FAILED) && (!single_mmap))
+        {
+            (void)::munmap(cq, cq_ring_size);
+        }
+        if (sq != MAP_FAILED)
+        {
+            (void)::munmap(sq, sq_ring_size);
+        }
+        (void)::close(fd);
+        return;
+    }
+
+    sq_ring = sq;
+    cq_ring = cq;
+    sqes = entries_map;
+    auto* sq_base = static_cast<uint8_t*>(sq_ring);
+    auto* cq_base = static_cast<uint8_t*>(cq_ring);
+    sq_tail = reinterpret_cast<uint32_t*>(sq_base + params.sq_off.tail);
+    sq_mask = reinterpret_cast<uint32_t*>(sq_base + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<uint32_t*>(sq_base + params.sq_off.array);
+    cq_head = reinterpret_cast<uint32_t*>(cq_base + params.cq_off.head);
+    cq_tail = reinterpret_cast<uint32_t*>(cq_base + params.cq_off.tail);
+    cq_mask = reinterpret_cast<uint32_t*>(cq_base + params.cq_off.ring_mask);
+    cqes = cq_base + params.cq_off.cqes;
+    entries = params.sq_entries;
+    ring_fd = fd;
+}
+
+UringIo::~UringIo()
+{
+    if (sq_ring != nullptr)
+    {
+        (void)::munmap(sqes, sqes_size);
+        if (cq_ring != sq_ring)
+        {
+            (void)::munmap(cq_ring, cq_ring_size);
+        }
+        (void)::munmap(sq_ring, sq_ring_size);
+    }
+    if (ring_fd >= 0)
+    {
+        (void)::close(ring_fd);
+    }
+}
+
+bool UringIo::available() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return ring_fd >= 0;
+}
+
+/* Submit all ops and wait for their completion, mutex must be held */
+bool UringIo::submit(std::vector<Op>& ops)
+{
+    if ((ring_fd < 0) || ops.empty() || (ops.size() > entries))
+    {
+        return false;
+    }
+
+    auto* sqe_array = static_cast<io_uring_sqe*>(sqes);
+    uint32_t tail = *sq_tail;
+    for (std::size_t i = 0U; i < ops.size(); ++i)
+    {
+        const Op& op = ops[i];
+        const uint32_t index = tail & *sq_mask;
+        io_uring_sqe* sqe = &sqe_array[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = op.opcode;
+        sqe->flags = op.sqe_flags;
+        sqe->fd = op.fd;
+        sqe->user_data = i;
+        switch (op.opcode)
+        {
+            case IORING_OP_RENAMEAT:
+                sqe->addr = reinterpret_cast<uint64_t>(op.path);
+                sqe->len = static_cast<uint32_t>(AT_FDCWD);
+                sqe->addr2 = reinterpret_cast<uint64_t>(op.new_path);
+                break;
+            case IORING_OP_OPENAT:
+                sqe->addr = reinterpret_cast<uint64_t>(op.path);
+                sqe->len = 0666U;
+                sqe->open_flags = op.op_flags;
+                break;
+            case IORING_OP_STATX:
+                sqe->addr = reinterpret_cast<uint64_t>(op.path);
+                sqe->len = STATX_SIZE;
+                sqe->addr2 = reinterpret_cast<uint64_t>(op.buf);
+                sqe->statx_flags = op.op_flags;
+                break;
+            case IORING_OP_READ:
+            case IORING_OP_WRITE:
+                sqe->addr = reinterpret_cast<uint64_t>(op.buf);
+                sqe->len = op.len;
+                sqe->off = 0U;
+                break;
+            case IORING_OP_FSYNC:
+                sqe->fsync_flags = op.op_flags;
+                break;
+            default:
+                /* IORING_OP_CLOSE only needs the descriptor */
+                break;
+        }
+        sq_array[index] = index;
+        ++tail;
+    }
+    __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+    const auto count = static_cast<uint32_t>(ops.size());
+    uint32_t to_submit = count;
+    uint32_t completed = 0U;
+    bool broken = false;
+    while ((completed < count) && (!broken))
+    {
+        const long ret = ::syscall(
+            __NR_io_uring_enter, ring_fd, to_submit, count - completed, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (ret < 0)
+        {
+            broken = (errno != EINTR);
+        }
+        else if (static_cast<uint32_t>(ret) < to_submit)
+        {
+            /* Partly submitted ring, the remaining entries would leak into the next submission */
+            broken = true;
+        }
+        else
+        {
+            to_submit = 0U;
+        }
+
+        uint32_t head = *cq_head;
+        const uint32_t cq_tail_value = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        while (head != cq_tail_value)
+        {
+            const io_uring_cqe& cqe = static_cast<io_uring_cqe*>(cqes)[head & *cq_mask];
+            if (cqe.user_data < ops.size())
+            {
+                ops[cqe.user_data].res = cqe.res;
+            }
+            ++head;
+            ++completed;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    if (broken)
+    {
+        /* Do not reuse a ring in an unknown state, later calls fall back to synchronous I/O */
+        (void)::close(ring_fd);
+        ring_fd = -1;
+    }
+    return !broken;
+}
+
+bool UringIo::rename_chain(const std::vector<std::pair<std::string, std::string>>& renames, int& error)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    error = 0;
+    if ((ring_fd < 0) || renames.empty() || (renames.size() > entries))
+    {
+        return false;
+    }
+
+    /* The links only order the renames, the kernel does not cancel a chain on a failed rename */
+    std::vector<Op> ops(renames.size());
+    for (std::size_t i = 0U; i < ops.size(); ++i)
+    {
+        ops[i].opcode = IORING_OP_RENAMEAT;
+        ops[i].path = renames[i].first.c_str();
+        ops[i].new_path = renames[i].second.c_str();
+        ops[i].sqe_flags = ((i + 1U) < ops.size()) ? IOSQE_IO_LINK : 0U;
+    }
+    if (!submit(ops))
+    {
+        /* The ring broke during the submission, some files may already be renamed */
+        error = EIO;
+    }
+    else
+    {
+        for (const auto& op : ops)
+        {
+            if ((op.res < 0) && (op.res != -ENOENT) && (error == 0))
+            {
+                error = -op.res;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool UringIo::write_files(std::vector<UringWrite>& files, bool sync)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::size_t ops_per_file = sync ? 3U : 2U;
+    if ((ring_fd < 0) || files.empty() || ((files.size() * ops_per_file) > entries))
+    {
+        return false;
+    }
+    for (const auto& file : files)
+    {
+        if (file.size > std::numeric_limits<uint32_t>::max())
+        {
+            return false;
+        }
+    }
+
+    /* Open all files concurrently */
+    std::vector<Op> opens(files.size());
+    for (std::size_t i = 0U; i < files.size(); ++i)
+    {
+        opens[i].opcode = IORING_OP_OPENAT;
+        opens[i].path = files[i].path.c_str();
+        opens[i].op_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    }
+    if (!submit(opens))
+    {
+        return false;
+    }
+
+    /* Write, sync and close every file as one chain, the close runs even if a step failed */
+    std::vector<Op> ops;
+    ops.reserve(files.size() * ops_per_file);
+    for (std::size_t i = 0U; i < files.size(); ++i)
+    {
+        files[i].error = (opens[i].res < 0) ? -opens[i].res : 0;
+        if (opens[i].res >= 0)
+        {
+            Op write_op;
+            write_op.opcode = IORING_OP_WRITE;
+            write_op.sqe_flags = IOSQE_IO_HARDLINK;
+            write_op.fd = opens[i].res;
+            write_op.buf = const_cast<void*>(files[i].data);
+            write_op.len = static_cast<uint32_t>(files[i].size);
+            ops.push_back(write_op);
+            if (sync)
+            {
+                Op sync_op;
+                sync_op.opcode = IORING_OP_FSYNC;
+                sync_op.sqe_flags = IOSQE_IO_HARDLINK;
+                sync_op.fd = opens[i].res;
+                sync_op.op_flags = IORING_FSYNC_DATASYNC;
+                ops.push_back(sync_op);
+            }
+            Op close_op;
+            close_op.opcode = IORING_OP_CLOSE;
+            close_op.fd = opens[i].res;
+            ops.push_back(close_op);
+        }
+    }
+    if (ops.empty())
+    {
+        return true;
+    }
+    if (!submit(ops))
+    {
+        for (const auto& open : opens)
+        {
+            if (open.res >= 0)
+            {
+                (void)::close(open.res);
+            }
+        }
+        return false;
+    }
+
+    std::size_t op = 0U;
+    for (std::size_t i = 0U; i < files.size(); ++i)
+    {
+        if (opens[i].res >= 0)
+        {
+            const int32_t written = ops[op].res;
+            if (written < 0)
+            {
+                files[i].error = -written;
+            }
+            else if (static_cast<std::size_t>(written) != files[i].size)
+            {
+                files[i].error = EIO;
+            }
+            else if (sync && (ops[op + 1U].res < 0))
+            {
+                files[i].error = -ops[op + 1U].res;
+            }
+            else
+            {
+                /* Written */
+            }
+            op += ops_per_file;
+        }
+    }
+
+    return true;
+}
+
+bool UringIo::read_files(std::vector<UringRead>& files)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if ((ring_fd < 0) || files.empty() || ((files.size() * 2U) > entries))
+    {
+        return false;
+    }
+
+    /* Open and stat all files concurrently */
+    std::vector<struct statx> stats(files.size());
+    std::vector<Op> ops(files.size() * 2U);
+    for (std::size_t i = 0U; i < files.size(); ++i)
+    {
+        ops[2U * i].opcode = IORING_OP_OPENAT;
+        ops[2U * i].path = files[i].path.c_str();
+        ops[2U * i].op_flags = O_RDONLY | O_CLOEXEC;
+        ops[(2U * i) + 1U].opcode = IORING_OP_STATX;
+        ops[(2U * i) + 1U].path = files[i].path.c_str();
+        ops[(2U * i) + 1U].buf = &stats[i];
+    }
+    if (!submit(ops))
+    {
+        return false;
+    }
+
+    /* Read and close every opened file as one chain */
+    std::vector<Op> reads;
+    std::vector<std::size_t> read_index;
+    reads.reserve(files.size() * 2U);
+    for (std::size_t i = 0U; i < files.size(); ++i)
+    {
+        const int32_t fd = ops[2U * i].res;
+        const int32_t stat_res = ops[(2U * i) + 1U].res;
+        files[i].data.clear();
+        files[i].error = (fd < 0) ? -fd : ((stat_res < 0) ? -stat_res : 0);
+        if ((files[i].error == 0) && (stats[i].stx_size > std::numeric_limits<int32_t>::max()))
+        {
+            files[i].error = EFBIG;
+        }
+        if (fd >= 0)
+        {
+            if ((files[i].error == 0) && (stats[i].stx_size > 0U))
+            {
+                files[i].data.resize(static_cast<std::size_t>(stats[i].stx_size));
+                Op read_op;
+                read_op.opcode = IORING_OP_READ;
+                read_op.sqe_flags = IOSQE_IO_HARDLINK;
+                read_op.fd = fd;
+                read_op.buf = &files[i].data[0];
+                read_op.len = static_cast<uint32_t>(files[i].data.size());
+                reads.push_back(read_op);
+                read_index.push_back(i);
+            }
+            Op close_op;
+            close_op.opcode = IORING_OP_CLOSE;
+            close_op.fd = fd;
+            reads.push_back(close_op);
+        }
+    }
+    if ((!reads.empty()) && (!submit(reads)))
+    {
+        for (std::size_t i = 0U; i < files.size(); ++i)
+        {
+            if (ops[2U * i].res >= 0)
+            {
+                (void)::close(ops[2U * i].res);
+            }
+        }
+        return false;
+    }
+
+    std::size_t next_read = 0U;
+    for (const auto& read_op : reads)
+    {
+        if (read_op.opcode == IORING_OP_READ)
+        {
+            UringRead& file = files[read_index[next_read]];
+            if (read_op.res < 0)
+            {
+                file.error = -read_op.res;
+                file.data.clear();
+            }
+            else
+            {
+                file.data.resize(static_cast<std::size_t>(read_op.res));
+            }
+            ++next_read;
+        }
+    }
+
+    return true;
+}
+
+#else /* !__linux__ */
+
+struct UringIo::Op
+{
+};
+
+UringIo& UringIo::instance()
+{
+    static UringIo uring;
+    return uring;
+}
+
+UringIo::UringIo() = default;
+
+UringIo::~UringIo() = default;
+
+bool UringIo::available() const
+{
+    return false;
+}
+
+bool UringIo::submit(std::vector<Op>& /*ops*/)
+{
+    return false;
+}
+
+bool UringIo::rename_chain(const std::vector<std::pair<std::string, std::string>>& /*renames*/, int& error)
+{
+    error = 0;
+    return false;
+}
+
+bool UringIo::write_files(std::vector<UringWrite>& /*files*/, bool /*sync*/)
+{
+    return false;
+}
+
+bool UringIo::read_files(std::vector<UringRead>& /*files*/)
+{
+    return false;
+}
+
+#endif /* __linux__ */
+
+} /* namespace score::mw::per::kvs */
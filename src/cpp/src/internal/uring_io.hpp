@@ -0,0 +1,121 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_URING_IO_HPP
+#define SCORE_LIB_KVS_INTERNAL_URING_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+/* File to be written by UringIo::write_files */
+struct UringWrite
+{
+    std::string path;
+    const void* data = nullptr;
+    std::size_t size = 0U;
+    int error = 0; ///< errno of the first failed step, 0 on success
+};
+
+/* File to be read by UringIo::read_files */
+struct UringRead
+{
+    std::string path;
+    std::string data;
+    int error = 0; ///< errno of the first failed step, 0 on success
+};
+
+/**
+ * @class UringIo
+ * @brief Process-wide io_uring ring for the file operations of flush and open (Linux only).
+ *
+ * The ring is set up on first use with raw syscalls. If the kernel does not support io_uring or
+ * the required operations, available() returns false and every call returns false, so callers
+ * fall back to the synchronous file API. Submissions from different threads are serialized.
+ */
+class UringIo final
+{
+  public:
+    static UringIo& instance();
+
+    UringIo(const UringIo&) = delete;
+    UringIo& operator=(const UringIo&) = delete;
+    ~UringIo();
+
+    /**
+     * @brief Returns true if the ring is usable.
+     */
+    bool available() const;
+
+    /**
+     * @brief Renames files in the given order as one linked chain.
+     *
+     * A missing source file (ENOENT) is skipped. All renames are attempted, the first other error
+     * is reported.
+     *
+     * @param renames Pairs of old and new path.
+     * @param error errno of the first failed rename, 0 on success.
+     * @return False if the ring could not be used, nothing was renamed then. If the ring fails
+     *         during the chain, true is returned with error set to EIO.
+     */
+    bool rename_chain(const std::vector<std::pair<std::string, std::string>>& renames, int& error);
+
+    /**
+     * @brief Creates (or truncates) and writes files concurrently, each as a linked write, optional
+     *        data sync and close chain.
+     * @return False if the ring could not be used, the files must be written again then.
+     */
+    bool write_files(std::vector<UringWrite>& files, bool sync);
+
+    /**
+     * @brief Reads whole files concurrently.
+     * @return False if the ring could not be used.
+     */
+    bool read_files(std::vector<UringRead>& files);
+
+  private:
+    UringIo();
+
+    struct Op;
+    bool submit(std::vector<Op>& ops);
+
+    mutable std::mutex mutex;
+    int ring_fd = -1;
+    uint32_t entries = 0U;
+
+    /* Mapped ring memory */
+    void* sq_ring = nullptr;
+    std::size_t sq_ring_size = 0U;
+    void* cq_ring = nullptr;
+    std::size_t cq_ring_size = 0U;
+    void* sqes = nullptr;
+    std::size_t sqes_size = 0U;
+
+    /* Ring offsets */
+    uint32_t* sq_tail = nullptr;
+    uint32_t* sq_mask = nullptr;
+    uint32_t* sq_array = nullptr;
+    uint32_t* cq_head = nullptr;
+    uint32_t* cq_tail = nullptr;
+    uint32_t* cq_mask = nullptr;
+    void* cqes = nullptr;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif  // SCORE_LIB_KVS_INTERNAL_URING_IO_HPP
@@ -11,12 +11,29 @@
  * SPDX-License-Identifier: Apache-2.0
  ********************************************************************************/
 #include "kvs.hpp"
+#include "internal/group_commit.hpp"
 #include "internal/kvs_helper.hpp"
-#include <unistd.h>  // fileno(), fdatasync()
+#include "internal/slot_store.hpp"
+#include "internal/snapshot_scrubber.hpp"
+#include "internal/uring_io.hpp"
+#include "kvscontainer.hpp"
+#include "kvsflushscheduler.hpp"
+#include "kvsscope.hpp"
+#include <dirent.h>    // opendir(), readdir()
+#include <fcntl.h>     // open(), fallocate()
+#include <sys/stat.h>  // stat()
+#include <unistd.h>    // fileno(), fdatasync(), dup(), pwrite(), ftruncate()
 #include <cstdio>    // std::fopen, std::fwrite, std::fflush, std::fclose
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
 #include <fstream>
+#include <future>
 #include <iostream>
-#include <sstream>
+#include <iterator>
+#include <map>
+#include <thread>
 
 // TODO Default Value Handling TBD
 // TODO Add Score Logging
@@ -31,7 +48,23 @@ namespace score::mw::per::kvs
 
 /*********************** KVS Implementation *********************/
 Kvs::Kvs()
-    : filesystem(std::make_unique<score::filesystem::Filesystem>(
+    : main_dirty(false),
+      raw_checksum(KvsChecksum::Adler32),
+      record_checksums(false),
+      key_generation(1U),
+      group_commit_failed(std::make_shared<std::atomic<bool>>(false)),
+      io_backend(KvsIoBackend::Posix),
+      checksum(KvsChecksum::Adler32),
+      use_manifest(false),
+      compression(KvsCompression::None),
+      delta_snapshots(false),
+      slot_commit_pending(false),
+      container_key(0U),
+      scheduled_flush(false),
+      flush_class(KvsFlushClass::Normal),
+      scrub_cache(std::make_shared<ScrubCache>()),
+      scrub_max_age(KvsScrubPolicy{}.max_age),
+      filesystem(std::make_unique<score::filesystem::Filesystem>(
           score::filesystem::FilesystemFactory{}.CreateInstance())) /* Create Filesystem instance, noexcept call */
       ,
       parser(std::make_unique<score::json::JsonParser>()),
@@ -40,38 +73,105 @@ Kvs::Kvs()
 {
 }
 
-Kvs::Kvs(Kvs&& other) noexcept
-    : filename_prefix(std::move(other.filename_prefix)),
-      filesystem(std::move(other.filesystem)),
-      parser(std::move(other.parser)) /* Not absolutely necessary, because a new JSON writer/parser
-                                         object would also be okay*/
-      ,
-      writer(std::move(other.writer)),
-      logger(std::move(other.logger))
+Kvs::~Kvs()
 {
+    /* A flush still queued in the scheduler is written now */
+    if (scheduled_flush && KvsFlushScheduler::instance().remove(*this))
     {
-        std::lock_guard<std::mutex> lock(other.kvs_mutex);
-        kvs = std::move(other.kvs);
+        (void)flush_files(nullptr);
     }
+}
 
-    default_values = std::move(other.default_values);
+Kvs::Kvs(Kvs&& other) noexcept
+    : main_dirty(false),
+      raw_checksum(KvsChecksum::Adler32),
+      record_checksums(false),
+      key_generation(1U),
+      group_commit_failed(std::make_shared<std::atomic<bool>>(false)),
+      scheduled_flush(false)
+{
+    /* Members are only taken once a running scheduled flush of `other` finished */
+    *this = std::move(other);
 }
 
 Kvs& Kvs::operator=(Kvs&& other) noexcept
 {
     if (this != &other)
     {
+        /* A flush queued for the replaced contents is dropped */
+        if (scheduled_flush)
+        {
+            (void)KvsFlushScheduler::instance().remove(*this);
+        }
+        /* The scheduler may be writing `other`, its members are taken afterwards */
+        if (other.scheduled_flush)
+        {
+            KvsFlushScheduler::instance().hold(other);
+        }
         {
             std::lock_guard<std::mutex> lock_this(kvs_mutex);
             kvs.clear();
+            scopes.clear();
+            raw_values.clear();
+            raw_buffer.reset();
         }
-        default_values.clear();
+        default_values = FrozenKvsMap();
         filename_prefix = std::move(other.filename_prefix);
+        durability = other.durability;
+        std::swap(group_commit_failed, other.group_commit_failed);
+        io_backend = other.io_backend;
+        checksum = other.checksum;
+        snapshot_policy = other.snapshot_policy;
+        use_manifest = other.use_manifest;
+        compression = other.compression;
+        delta_snapshots = other.delta_snapshots;
+        aligned_writes = other.aligned_writes;
+        scheduled_flush = other.scheduled_flush;
+        flush_class = other.flush_class;
+        scrub_cache = std::move(other.scrub_cache);
+        scrubber = std::move(other.scrubber);
+        scrub_max_age = other.scrub_max_age;
 
         {
             std::lock_guard<std::mutex> lock_other(other.kvs_mutex);
             std::lock_guard<std::mutex> lock_this(kvs_mutex);
             kvs = std::move(other.kvs);
+            scopes = std::move(other.scopes);
+            interned_keys = std::move(other.interned_keys);
+            main_dirty = other.main_dirty;
+            raw_values = std::move(other.raw_values);
+            raw_buffer = std::move(other.raw_buffer);
+            raw_checksum = other.raw_checksum;
+            record_checksums = other.record_checksums;
+            corrupted = std::move(other.corrupted);
+            cached_versions = std::move(other.cached_versions);
+            snapshot_cache = other.snapshot_cache;
+            delta_base = std::move(other.delta_base);
+            current_text = std::move(other.current_text);
+            key_generation = std::max(key_generation, other.key_generation) + 1U;
+        }
+        {
+            std::lock_guard<std::mutex> lock_other(other.manifest_mutex);
+            std::lock_guard<std::mutex> lock_this(manifest_mutex);
+            manifest = std::move(other.manifest);
+        }
+        {
+            std::lock_guard<std::mutex> lock_other(other.slot_mutex);
+            std::lock_guard<std::mutex> lock_this(slot_mutex);
+            slots = std::move(other.slots);
+            slot_commit_pending = other.slot_commit_pending;
+            container = std::move(other.container);
+            container_key = other.container_key;
+        }
+        {
+            std::lock_guard<std::mutex> lock_other(other.write_stats_mutex);
+            std::lock_guard<std::mutex> lock_this(write_stats_mutex);
+            write_totals = other.write_totals;
+        }
+        if (scheduled_flush)
+        {
+            KvsFlushScheduler::instance().moved(other, *this);
+            other.scheduled_flush = false;
         }
         default_values = std::move(other.default_values);
 
@@ -85,11 +185,20 @@ Kvs& Kvs::operator=(Kvs&& other) noexcept
     return *this;
 }
 
-/* Helper Function to parse JSON data for open_json*/
-score::Result<std::unordered_map<std::string, KvsValue>> Kvs::parse_json_data(const std::string& data)
+/* Lock the instance. The scheduler thread writes instances with scheduled flushes, their methods
+ * wait for it. All other instances fail with MutexLockFailed while the lock is held. */
+std::unique_lock<std::mutex> Kvs::lock_instance()
+{
+    return scheduled_flush ? std::unique_lock<std::mutex>(kvs_mutex)
+                           : std::unique_lock<std::mutex>(kvs_mutex, std::try_to_lock);
+}
+
+/* Helper Function to parse JSON data for open_json, with the parser of the instance unless one is given */
+score::Result<std::unordered_map<std::string, KvsValue>> Kvs::parse_json_data(const std::string& data,
+                                                                              score::json::IJsonParser* json_parser)
 {
     score::Result<unordered_map<std::string, KvsValue>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    auto any_res = parser->FromBuffer(data);
+    auto any_res = ((json_parser != nullptr) ? json_parser : parser.get())->FromBuffer(data);
 
     if (!any_res)
     {
@@ -134,9 +243,166 @@ score::Result<std::unordered_map<std::string, KvsValue>> Kvs::parse_json_data(co
     return result;
 }
 
+/* Parse JSON data whose whole-file checksum failed, verifying every record against the record table.
+ * Records that fail (or are missing) are reported in corrupted_keys, the remaining ones are kept. */
+score::Result<std::unordered_map<std::string, KvsValue>> Kvs::parse_json_records(
+    const std::string& data,
+    const HashFileInfo& hash_info,
+    std::vector<std::string>& corrupted_keys)
+{
+    score::Result<unordered_map<std::string, KvsValue>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    auto index_res = index_json_object(data);
+    if (!index_res)
+    {
+        /* The object structure itself is damaged, the records cannot be separated */
+        result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }
+    else
+    {
+        std::unordered_map<std::string, KvsValue> result_value;
+        for (const auto& member : index_res.value())
+        {
+            auto record = hash_info.records.find(member.key);
+            bool valid = (record != hash_info.records.end()) &&
+                         (calculate_checksum(hash_info.algorithm, member.member.data(), member.member.size()) ==
+                          record->second);
+            if (valid)
+            {
+                auto any_res = parser->FromBuffer(member.value);
+                auto conv = any_res ? any_to_kvsvalue(any_res.value())
+                                    : score::Result<KvsValue>(score::MakeUnexpected(ErrorCode::JsonParserError));
+                valid = conv.has_value();
+                if (valid)
+                {
+                    result_value.emplace(member.key, std::move(conv.value()));
+                }
+            }
+            if (!valid)
+            {
+                logger->LogWarn() << "record of key '" << member.key << "' is corrupted";
+            }
+        }
+        /* Every key of the record table that was not kept is lost in this file */
+        for (const auto& [key, digest] : hash_info.records)
+        {
+            if (result_value.find(key) == result_value.end())
+            {
+                corrupted_keys.push_back(key);
+            }
+        }
+        result = std::move(result_value);
+    }
+
+    return result;
+}
+
+/* Recover the given keys from the newest snapshots holding a valid record and insert them into target.
+ * Keys without any valid copy are lost. Every key is reported in corrupted. Returns the recovered count. */
+size_t Kvs::recover_records(const score::filesystem::Path& prefix,
+                            const std::vector<std::string>& keys,
+                            std::unordered_map<std::string, KvsValue>& target)
+{
+    std::unordered_set<std::string> pending(keys.begin(), keys.end());
+    size_t recovered = 0U;
+    for (size_t idx = 1U; (idx <= snapshot_policy.max_count) && (!pending.empty()); ++idx)
+    {
+        const std::string snapshot_prefix = prefix.Native() + "_" + std::to_string(idx);
+        ifstream hin(snapshot_prefix + ".hash", ios::binary);
+        const std::string hash_bytes{istreambuf_iterator<char>(hin), istreambuf_iterator<char>()};
+        const std::optional<HashFileInfo> hash_info = hin ? parse_hash_file(hash_bytes) : std::nullopt;
+        std::string data;
+        std::unique_ptr<ChecksumStrategy> file_checksum;
+        if (hash_info.has_value() && (!hash_info->has_records))
+        {
+            /* Snapshots without records are only used if the whole file is valid */
+            file_checksum = make_checksum(hash_info->algorithm);
+        }
+        const bool file_found =
+            hash_info.has_value() && read_file_hashed(snapshot_prefix + ".json", data, file_checksum.get());
+        const bool file_valid = file_found &&
+                                ((file_checksum == nullptr) || (file_checksum->digest() == hash_info->digest)) &&
+                                decompress_json_file(data);
+        auto index_res = file_valid ? index_json_object(data)
+                                    : score::Result<std::vector<JsonMemberRange>>(score::MakeUnexpected(
+                                          ErrorCode::ValidationFailed));
+        if (index_res)
+        {
+            for (const auto& member : index_res.value())
+            {
+                bool valid = pending.find(member.key) != pending.end();
+                if (valid && hash_info->has_records)
+                {
+                    auto record = hash_info->records.find(member.key);
+                    valid = (record != hash_info->records.end()) &&
+                            (calculate_checksum(hash_info->algorithm, member.member.data(), member.member.size()) ==
+                             record->second);
+                }
+                auto any_res = valid ? parser->FromBuffer(member.value)
+                                     : score::Result<score::json::Any>(score::MakeUnexpected(ErrorCode::UnmappedError));
+                auto conv = any_res ? any_to_kvsvalue(any_res.value())
+                                    : score::Result<KvsValue>(score::MakeUnexpected(ErrorCode::JsonParserError));
+                if (conv)
+                {
+                    target.insert_or_assign(member.key, std::move(conv.value()));
+                    pending.erase(member.key);
+                    corrupted.push_back(KvsCorruptedRecord{member.key, idx});
+                    logger->LogWarn() << "recovered key '" << member.key << "' from snapshot " << idx;
+                    ++recovered;
+                }
+            }
+        }
+    }
+    for (const auto& key : keys)
+    {
+        if (pending.find(key) != pending.end())
+        {
+            corrupted.push_back(KvsCorruptedRecord{key, 0U});
+            logger->LogError() << "error: key '" << key << "' is corrupted and no snapshot holds a valid copy";
+        }
+    }
+
+    return recovered;
+}
+
+/* Verify the records of all lazily loaded values before they are re-emitted verbatim.
+ * kvs_mutex must be held by the caller. */
+void Kvs::verify_raw_values()
+{
+    std::vector<std::string> failed;
+    for (auto& [key, raw] : raw_values)
+    {
+        if (raw.verify)
+        {
+            if (calculate_checksum(raw_checksum, raw.member.data(), raw.member.size()) == raw.digest)
+            {
+                raw.verify = false;
+            }
+            else
+            {
+                failed.push_back(key);
+            }
+        }
+    }
+    if (!failed.empty())
+    {
+        for (const auto& key : failed)
+        {
+            (void)drop_raw_value(key);
+        }
+        (void)recover_records(filename_prefix, failed, kvs);
+        main_dirty = true;
+        ++key_generation;
+    }
+}
+
 /* Open and read JSON File */
 score::Result<std::unordered_map<string, KvsValue>> Kvs::open_json(const score::filesystem::Path& prefix,
-                                                                   OpenJsonNeedFile need_file)
+                                                                   OpenJsonNeedFile need_file,
+                                                                   const JsonFileContents* contents,
+                                                                   bool lazy,
+                                                                   std::vector<std::string>* corrupted_keys,
+                                                                   bool verified,
+                                                                   score::json::IJsonParser* json_parser)
 {
     score::filesystem::Path json_file = prefix.Native() + ".json";
     score::filesystem::Path hash_file = prefix.Native() + ".hash";
@@ -145,9 +411,53 @@ score::Result<std::unordered_map<string, KvsValue>> Kvs::open_json(const score::
     bool new_kvs = false; /* Flag to check if new KVS file is created*/
     score::Result<std::unordered_map<string, KvsValue>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
 
-    /* Read JSON file */
-    ifstream in(json_file.CStr());
-    if (!in)
+    /* Read the hash file first, its algorithm is needed to verify the JSON data while it is read */
+    bool hash_found = false;
+    std::string hash_bytes;
+    if (contents != nullptr)
+    {
+        hash_found = contents->hash_found;
+        hash_bytes = contents->hash;
+    }
+    else
+    {
+        ifstream hin(hash_file.CStr(), ios::binary);
+        if (hin)
+        {
+            hash_bytes.assign(istreambuf_iterator<char>(hin), istreambuf_iterator<char>());
+            hash_found = true;
+        }
+    }
+    const std::optional<HashFileInfo> hash_info = hash_found ? parse_hash_file(hash_bytes) : std::nullopt;
+    std::unique_ptr<ChecksumStrategy> checksum =
+        hash_info.has_value() ? make_checksum(hash_info->algorithm) : nullptr;
+
+    /* With per-record checksums, a damaged file only loses the damaged records. Lazily decoded
+     * records are verified on first access, the whole file is not hashed then. */
+    const bool verify_records = (corrupted_keys != nullptr) && hash_info.has_value() && hash_info->has_records;
+    const bool deferred_verify = verify_records && lazy;
+    bool record_fallback = false;
+    if (deferred_verify || verified)
+    {
+        checksum.reset();
+    }
+
+    /* Read JSON file (unless already read by the caller), the checksum is computed on the fly */
+    bool json_found = false;
+    if (contents != nullptr)
+    {
+        json_found = contents->json_found;
+        data = contents->json;
+        if (json_found && (checksum != nullptr))
+        {
+            checksum->update(data.data(), data.size());
+        }
+    }
+    else
+    {
+        json_found = read_file_hashed(json_file.Native(), data, checksum.get());
+    }
+    if (!json_found)
     {
         if (need_file == OpenJsonNeedFile::Required)
         {
@@ -162,43 +472,108 @@ score::Result<std::unordered_map<string, KvsValue>> Kvs::open_json(const score::
             result = score::Result<std::unordered_map<string, KvsValue>>({});
         }
     }
-    else
-    {
-        ostringstream ss;
-        ss << in.rdbuf();
-        data = ss.str();
-    }
 
     /* Verify JSON Hash */
     if ((!error) && (!new_kvs))
     {
-        ifstream hin(hash_file.CStr(), ios::binary);
-        if (!hin)
+        if (!hash_found)
         {
             logger->LogError() << "error: hash file " << hash_file << " could not be read";
             error = true;
             result = score::MakeUnexpected(ErrorCode::KvsHashFileReadError);
         }
-        else
+        else if (deferred_verify)
+        {
+            logger->LogInfo() << "JSON records are verified on first access";
+        }
+        else if (verified)
+        {
+            logger->LogInfo() << "JSON data was verified before it was read";
+        }
+        else if ((checksum == nullptr) || (checksum->digest() != hash_info->digest))
         {
-            bool valid_hash = check_hash(data, hin);
-            if (!valid_hash)
+            if (verify_records)
+            {
+                logger->LogWarn() << "KVS data corrupted (" << json_file << "), verifying the records";
+                record_fallback = true;
+            }
+            else
             {
                 logger->LogError() << "error: KVS data corrupted (" << json_file << ", " << hash_file << ")";
                 error = true;
                 result = score::MakeUnexpected(ErrorCode::ValidationFailed);
             }
-            else
+        }
+        else
+        {
+            logger->LogInfo() << "JSON data has valid hash";
+        }
+    }
+
+    /* Compressed files are verified before they are decompressed */
+    if ((!error) && (!new_kvs) && (!decompress_json_file(data)))
+    {
+        logger->LogError() << "error: compressed KVS data corrupted (" << json_file << ")";
+        error = true;
+        result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }
+
+    /* Index JSON Data, the values are decoded on first access */
+    if ((!error) && (!new_kvs) && lazy)
+    {
+        auto buffer = std::make_shared<const std::string>(std::move(data));
+        auto index_res = index_json_object(*buffer);
+        if (!index_res)
+        {
+            logger->LogError() << "error: indexing JSON data failed";
+            error = true;
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*index_res.error()));
+        }
+        else
+        {
+            raw_values.clear();
+            for (auto& member : index_res.value())
+            {
+                RawValue raw{member.member, member.value};
+                auto record = deferred_verify ? hash_info->records.find(member.key) : hash_info->records.end();
+                if (record != hash_info->records.end())
+                {
+                    raw.digest = record->second;
+                    raw.verify = true;
+                    raw_values.insert_or_assign(std::move(member.key), raw);
+                }
+                else if (deferred_verify)
+                {
+                    /* Damaged key, the original key is reported as missing below */
+                    corrupted_keys->push_back(std::move(member.key));
+                }
+                else
+                {
+                    raw_values.insert_or_assign(std::move(member.key), raw);
+                }
+            }
+            if (deferred_verify)
             {
-                logger->LogInfo() << "JSON data has valid hash";
+                for (const auto& [key, digest] : hash_info->records)
+                {
+                    if (raw_values.find(key) == raw_values.end())
+                    {
+                        corrupted_keys->push_back(key);
+                    }
+                }
+                raw_checksum = hash_info->algorithm;
             }
+            raw_buffer = raw_values.empty() ? nullptr : std::move(buffer);
+            result = score::Result<std::unordered_map<string, KvsValue>>({});
         }
     }
 
     /* Parse JSON Data */
-    if ((!error) && (!new_kvs))
+    if ((!error) && (!new_kvs) && (!lazy))
     {
-        auto parse_res = parse_json_data(data);
+        auto parse_res =
+            record_fallback ? parse_json_records(data, hash_info.value(), *corrupted_keys)
+                            : parse_json_data(data, json_parser);
         if (!parse_res)
         {
             logger->LogError() << "error: parsing JSON data failed";
@@ -214,11 +589,70 @@ score::Result<std::unordered_map<string, KvsValue>> Kvs::open_json(const score::
     return result;
 }
 
+/* Convert a build-time defaults image once per process, later instances share the frozen table */
+score::Result<FrozenKvsMap> Kvs::load_defaults_image(const KvsDefaultsImage& image)
+{
+    static std::mutex images_mutex;
+    static std::unordered_map<const KvsDefaultsImage*, FrozenKvsMap> images;
+
+    score::Result<FrozenKvsMap> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::lock_guard<std::mutex> lock(images_mutex);
+    auto search = images.find(&image);
+    if (search != images.end())
+    {
+        result = search->second;
+    }
+    else
+    {
+        auto map_res = defaults_image_to_map(image);
+        if (!map_res)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*map_res.error()));
+        }
+        else
+        {
+            FrozenKvsMap frozen = FrozenKvsMap::intern(map_res.value());
+            images.emplace(&image, frozen);
+            result = std::move(frozen);
+        }
+    }
+
+    return result;
+}
+
+/* Read the JSON and hash files of several storage segments concurrently with io_uring */
+bool Kvs::read_json_files_uring(const std::vector<score::filesystem::Path>& prefixes,
+                                std::vector<JsonFileContents>& contents)
+{
+    std::vector<UringRead> files(prefixes.size() * 2U);
+    for (std::size_t i = 0U; i < prefixes.size(); ++i)
+    {
+        files[2U * i].path = prefixes[i].Native() + ".json";
+        files[(2U * i) + 1U].path = prefixes[i].Native() + ".hash";
+    }
+
+    const bool read = UringIo::instance().read_files(files);
+    if (read)
+    {
+        contents.resize(prefixes.size());
+        for (std::size_t i = 0U; i < prefixes.size(); ++i)
+        {
+            contents[i].json_found = (files[2U * i].error == 0);
+            contents[i].json = std::move(files[2U * i].data);
+            contents[i].hash_found = (files[(2U * i) + 1U].error == 0);
+            contents[i].hash = std::move(files[(2U * i) + 1U].data);
+        }
+    }
+
+    return read;
+}
+
 /* Open KVS Instance */
 score::Result<Kvs> Kvs::open(const InstanceId& instance_id,
                              OpenNeedDefaults need_defaults,
                              OpenNeedKvs need_kvs,
-                             const std::string&& dir)
+                             const std::string&& dir,
+                             const KvsOpenOptions& options)
 {
     score::Result<Kvs> result =
         score::MakeUnexpected(ErrorCode::UnmappedError); /* Redundant initialization needed, since Resul<KVS> would call
@@ -230,9 +664,155 @@ score::Result<Kvs> Kvs::open(const InstanceId& instance_id,
     const score::filesystem::Path filename_kvs = filename_prefix.Native() + "_0";
 
     Kvs kvs; /* Create KVS instance */
-    auto default_res = kvs.open_json(
-        filename_default,
-        need_defaults == OpenNeedDefaults::Required ? OpenJsonNeedFile::Required : OpenJsonNeedFile::Optional);
+    if ((options.io_backend == KvsIoBackend::IoUring) && UringIo::instance().available())
+    {
+        kvs.io_backend = KvsIoBackend::IoUring;
+    }
+
+    /* With io_uring, the KVS and the defaults files are read concurrently up front. The files of a
+     * container instance were read with the container. */
+    std::vector<JsonFileContents> contents;
+    if ((kvs.io_backend == KvsIoBackend::IoUring) && (options.container == nullptr))
+    {
+        std::vector<score::filesystem::Path> prefixes{filename_kvs};
+        if (options.defaults_image == nullptr)
+        {
+            prefixes.push_back(filename_default);
+        }
+        if (!read_json_files_uring(prefixes, contents))
+        {
+            contents.clear();
+        }
+    }
+    const JsonFileContents* kvs_contents = contents.empty() ? nullptr : &contents[0];
+    const JsonFileContents* default_contents = (contents.size() > 1U) ? &contents[1] : nullptr;
+
+    /* Defaults stored in the container replace the defaults file, their digest was checked at read */
+    JsonFileContents container_defaults;
+    KvsContainer::LoadState defaults_state = KvsContainer::LoadState::Empty;
+    if ((options.container != nullptr) && (options.defaults_image == nullptr))
+    {
+        defaults_state =
+            options.container->load(KvsContainer::segment_key(instance_id, true), container_defaults.json);
+        if (defaults_state == KvsContainer::LoadState::Valid)
+        {
+            container_defaults.json_found = true;
+            container_defaults.hash_found = true;
+            default_contents = &container_defaults;
+        }
+    }
+    const bool defaults_verified = (defaults_state == KvsContainer::LoadState::Valid);
+
+    /* A large defaults file is parsed on a second thread with its own parser while the KVS file is
+     * loaded. A missing or small file is loaded inline, starting a thread costs more than parsing it. */
+    constexpr std::size_t async_defaults_size = 64U * 1024U;
+    const OpenJsonNeedFile need_default_file =
+        need_defaults == OpenNeedDefaults::Required ? OpenJsonNeedFile::Required : OpenJsonNeedFile::Optional;
+    std::future<score::Result<std::unordered_map<string, KvsValue>>> defaults_future;
+    if ((options.defaults_image == nullptr) && (defaults_state != KvsContainer::LoadState::Corrupted) &&
+        (std::thread::hardware_concurrency() > 1U))
+    {
+        std::size_t defaults_size = 0U;
+        struct stat info = {};
+        if (default_contents != nullptr)
+        {
+            defaults_size = default_contents->json.size();
+        }
+        else if (::stat((filename_default.Native() + ".json").c_str(), &info) == 0)
+        {
+            defaults_size = static_cast<std::size_t>(info.st_size);
+        }
+        if (defaults_size >= async_defaults_size)
+        {
+            /* Without lazy decoding, open_json() only uses the logger of the instance and the given parser */
+            defaults_future = std::async(
+                std::launch::async,
+                [&kvs, &filename_default, need_default_file, default_contents, defaults_verified]() {
+                    score::json::JsonParser defaults_parser;
+                    return kvs.open_json(filename_default, need_default_file, default_contents, false, nullptr,
+                                         defaults_verified, &defaults_parser);
+                });
+        }
+    }
+
+    /* In slot mode, the newest valid slot holds the KVS file. The KVS file is only read as long as
+     * no slot was written, its data then moves into the slots with the first flush. */
+    std::unique_ptr<SlotStore> slots;
+    SlotStore::LoadState slot_state = SlotStore::LoadState::Empty;
+    JsonFileContents slot_contents;
+    if (options.slots.capacity > 0U)
+    {
+        const bool dir_created = base_path.Empty() || kvs.filesystem->standard->CreateDirectories(base_path).has_value();
+        slots = dir_created ? SlotStore::open(filename_prefix.Native(), options.slots.capacity) : nullptr;
+        if (slots != nullptr)
+        {
+            slot_state = slots->load(slot_contents.json);
+            slot_contents.json_found = true;
+            slot_contents.hash_found = true;
+        }
+    }
+    else if (options.container != nullptr)
+    {
+        /* The KVS segment of a container is read like the slots */
+        const KvsContainer::LoadState state =
+            options.container->load(KvsContainer::segment_key(instance_id, false), slot_contents.json);
+        slot_state = (state == KvsContainer::LoadState::Valid)
+                         ? SlotStore::LoadState::Valid
+                         : ((state == KvsContainer::LoadState::Corrupted) ? SlotStore::LoadState::Corrupted
+                                                                          : SlotStore::LoadState::Empty);
+        slot_contents.json_found = true;
+        slot_contents.hash_found = true;
+    }
+
+    std::vector<std::string> corrupted_keys;
+    score::Result<std::unordered_map<string, KvsValue>> kvs_res = score::MakeUnexpected(ErrorCode::UnmappedError);
+    if ((options.slots.capacity > 0U) && (slots == nullptr))
+    {
+        kvs.logger->LogError() << "error: slot files of " << filename_prefix << " could not be opened";
+        kvs_res = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+    else if (slot_state == SlotStore::LoadState::Corrupted)
+    {
+        kvs.logger->LogError() << "error: no valid slot or container segment of " << filename_prefix;
+        kvs_res = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }
+    else if (slot_state == SlotStore::LoadState::Valid)
+    {
+        /* The slot or segment digest covers the data, there is no hash file */
+        kvs_res = kvs.open_json(filename_kvs, OpenJsonNeedFile::Required, &slot_contents, options.lazy_values,
+                                &corrupted_keys, true);
+    }
+    else
+    {
+        kvs_res = kvs.open_json(
+            filename_kvs, need_kvs == OpenNeedKvs::Required ? OpenJsonNeedFile::Required : OpenJsonNeedFile::Optional,
+            kvs_contents, options.lazy_values, &corrupted_keys);
+    }
+
+    score::Result<FrozenKvsMap> default_res = score::MakeUnexpected(ErrorCode::UnmappedError);
+    if (options.defaults_image != nullptr)
+    {
+        default_res = load_defaults_image(*options.defaults_image);
+    }
+    else if (defaults_state == KvsContainer::LoadState::Corrupted)
+    {
+        kvs.logger->LogError() << "error: no valid defaults segment of " << filename_prefix;
+        default_res = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }
+    else
+    {
+        auto json_res = defaults_future.valid() ? defaults_future.get()
+                                                : kvs.open_json(filename_default, need_default_file, default_contents,
+                                                                false, nullptr, defaults_verified);
+        if (!json_res)
+        {
+            default_res = score::MakeUnexpected(static_cast<ErrorCode>(*json_res.error()));
+        }
+        else
+        {
+            default_res = FrozenKvsMap::intern(json_res.value());
+        }
+    }
     if (!default_res)
     {
         result = score::MakeUnexpected(static_cast<ErrorCode>(
@@ -240,8 +820,6 @@ score::Result<Kvs> Kvs::open(const InstanceId& instance_id,
     }
     else
     {
-        auto kvs_res = kvs.open_json(
-            filename_kvs, need_kvs == OpenNeedKvs::Required ? OpenJsonNeedFile::Required : OpenJsonNeedFile::Optional);
         if (!kvs_res)
         {
             result = score::MakeUnexpected(static_cast<ErrorCode>(*kvs_res.error()));
@@ -251,8 +829,64 @@ score::Result<Kvs> Kvs::open(const InstanceId& instance_id,
             kvs.kvs = std::move(kvs_res.value());
             kvs.default_values = std::move(default_res.value());
             kvs.filename_prefix = filename_prefix;
+            kvs.durability = options.durability;
+            kvs.checksum = options.checksum;
+            kvs.record_checksums = options.record_checksums;
+            kvs.scrub_max_age = options.scrub_policy.max_age;
+            kvs.snapshot_cache = options.snapshot_cache;
+            kvs.snapshot_policy = options.snapshot_policy;
+            kvs.use_manifest = options.manifest;
+            kvs.compression = options.compression;
+            kvs.delta_snapshots = options.delta_snapshots;
+            kvs.aligned_writes = options.aligned_writes;
+            kvs.scheduled_flush = options.scheduled_flush;
+            kvs.flush_class = options.flush_class;
+            if ((slots != nullptr) || (options.container != nullptr))
+            {
+                /* Slot and container mode keep no snapshots, the other slot only protects against torn writes */
+                kvs.container = (slots == nullptr) ? options.container : nullptr;
+                kvs.slots = std::move(slots);
+                kvs.container_key = KvsContainer::segment_key(instance_id, false);
+                kvs.snapshot_policy.max_count = 0U;
+                kvs.snapshot_cache.versions = 0U;
+                kvs.use_manifest = false;
+                kvs.delta_snapshots = false;
+                kvs.main_dirty = (slot_state == SlotStore::LoadState::Empty);
+            }
+            if (kvs.use_manifest)
+            {
+                kvs.load_manifest();
+            }
+            if (options.scrub)
+            {
+                kvs.scrubber = std::make_unique<SnapshotScrubber>(options.scrub_policy.interval,
+                                                                  options.scrub_policy.bytes_per_second);
+                kvs.scrubber->add(
+                    ScrubTarget{filename_prefix.Native(), kvs.snapshot_policy.max_count, kvs.scrub_cache});
+            }
+            if (!corrupted_keys.empty())
+            {
+                /* The recovered records are written back on the next flush */
+                (void)kvs.recover_records(filename_prefix, corrupted_keys, kvs.kvs);
+                kvs.main_dirty = true;
+            }
+            else if (kvs.delta_snapshots && kvs.raw_values.empty())
+            {
+                /* Undecoded values are not copied, the base is then set by the first flush */
+                kvs.delta_base = std::make_shared<const std::unordered_map<std::string, KvsValue>>(kvs.kvs);
+            }
+            else
+            {
+                /* No delta snapshots or no known base */
+            }
+            auto scopes_res = kvs.open_scopes();
+            if (!scopes_res)
+            {
+                kvs.logger->LogError() << "error: scope segments of " << filename_prefix << " could not be loaded";
+                return score::MakeUnexpected(static_cast<ErrorCode>(*scopes_res.error()));
+            }
             kvs.logger->LogInfo() << "opened KVS: instance '" << instance_id.id << "'";
-            kvs.logger->LogInfo() << "max snapshot count: " << KVS_MAX_SNAPSHOTS;
+            kvs.logger->LogInfo() << "max snapshot count: " << kvs.snapshot_policy.max_count;
             result = std::move(kvs);
         }
     }
@@ -260,14 +894,61 @@ score::Result<Kvs> Kvs::open(const InstanceId& instance_id,
     return result;
 }
 
+/* Open several KVS Instances on a small worker pool */
+std::vector<score::Result<Kvs>> Kvs::open_many(const std::vector<InstanceId>& instance_ids,
+                                               OpenNeedDefaults need_defaults,
+                                               OpenNeedKvs need_kvs,
+                                               const std::string& dir,
+                                               const KvsOpenOptions& options)
+{
+    constexpr std::size_t max_workers = 4U;
+    std::vector<score::Result<Kvs>> results;
+    results.reserve(instance_ids.size());
+    for (std::size_t i = 0U; i < instance_ids.size(); ++i)
+    {
+        results.emplace_back(score::MakeUnexpected(ErrorCode::UnmappedError));
+    }
+
+    std::atomic<std::size_t> next{0U};
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < instance_ids.size(); i = next++)
+        {
+            results[i] = open(instance_ids[i], need_defaults, need_kvs, std::string(dir), options);
+        }
+    };
+
+    const std::size_t workers =
+        std::min({max_workers, instance_ids.size(), std::max<std::size_t>(1U, std::thread::hardware_concurrency())});
+    std::vector<std::thread> pool;
+    for (std::size_t i = 1U; i < workers; ++i)
+    {
+        pool.emplace_back(worker);
+    }
+    worker(); /* The calling thread is the first worker */
+    for (auto& thread : pool)
+    {
+        thread.join();
+    }
+
+    return results;
+}
+
 /* Reset KVS to initial state*/
 score::ResultBlank Kvs::reset()
 {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
+    std::unique_lock<std::mutex> lock = lock_instance();
     if (lock.owns_lock())
     {
         kvs.clear();
+        raw_values.clear();
+        raw_buffer.reset();
+        for (auto& [prefix, state] : scopes)
+        {
+            state.dirty = true;
+        }
+        main_dirty = true;
+        ++key_generation;
         result = score::ResultBlank{};
     }
     else
@@ -282,15 +963,19 @@ score::ResultBlank Kvs::reset()
 score::Result<std::vector<std::string>> Kvs::get_all_keys()
 {
     score::Result<std::vector<std::string>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
+    std::unique_lock<std::mutex> lock = lock_instance();
     if (lock.owns_lock())
     {
         std::vector<std::string> keys;
-        keys.reserve(kvs.size());
+        keys.reserve(kvs.size() + raw_values.size());
         for (const auto& [key, _] : kvs)
         {
             keys.emplace_back(key);
         }
+        for (const auto& [key, _] : raw_values)
+        {
+            keys.emplace_back(key);
+        }
         result = std::move(keys);
     }
     else
@@ -305,13 +990,12 @@ score::Result<std::vector<std::string>> Kvs::get_all_keys()
 score::Result<bool> Kvs::key_exists(const std::string_view key)
 {
     score::Result<bool> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
+    std::unique_lock<std::mutex> lock = lock_instance();
     if (lock.owns_lock())
     {
-        auto search =
-            kvs.find(std::string(key)); /* unordered_map find() needs string and doesnt work with string_view,
+        const std::string key_str(key); /* unordered_map find() needs string and doesnt work with string_view,
                                            workaround for c++20: heterogeneous lookup (applies to more functions) */
-        if (search != kvs.end())
+        if ((kvs.find(key_str) != kvs.end()) || (raw_values.find(key_str) != raw_values.end()))
         {
             result = true;
         }
@@ -332,20 +1016,30 @@ score::Result<bool> Kvs::key_exists(const std::string_view key)
 score::Result<KvsValue> Kvs::get_value(const std::string_view key)
 {
     score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock_kvs(kvs_mutex, std::try_to_lock);
+    std::unique_lock<std::mutex> lock_kvs = lock_instance();
     if (lock_kvs.owns_lock())
     {
-        auto search_kvs = kvs.find(std::string(key));
+        const std::string key_str(key);
+        auto search_kvs = kvs.find(key_str);
+        score::Result<KvsValue*> raw_res = static_cast<KvsValue*>(nullptr);
         if (search_kvs != kvs.end())
         {
             result = search_kvs->second;
         }
+        else if (!(raw_res = decode_raw_value(key_str)))
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*raw_res.error()));
+        }
+        else if (raw_res.value() != nullptr)
+        {
+            result = *raw_res.value();
+        }
         else
         {
-            auto search_default = default_values.find(std::string(key));
-            if (search_default != default_values.end())
+            const KvsValue* search_default = default_values.find(key);
+            if (search_default != nullptr)
             {
-                result = search_default->second;
+                result = *search_default;
             }
             else
             {
@@ -366,10 +1060,10 @@ score::Result<KvsValue> Kvs::get_default_value(const std::string_view key)
 {
     score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
 
-    auto search = default_values.find(std::string(key));
-    if (search != default_values.end())
+    const KvsValue* search = default_values.find(key);
+    if (search != nullptr)
     {
-        result = search->second;
+        result = *search;
     }
     else
     {
@@ -383,25 +1077,32 @@ score::Result<KvsValue> Kvs::get_default_value(const std::string_view key)
 score::ResultBlank Kvs::reset_key(const std::string_view key)
 {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock_kvs(kvs_mutex, std::try_to_lock);
+    std::unique_lock<std::mutex> lock_kvs = lock_instance();
     if (!lock_kvs.owns_lock())
     {
         result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
     }
     else
     {
-        auto search_default = default_values.find(std::string(key));
-        if (search_default == default_values.end())
+        if (default_values.find(key) == nullptr)
         {
             result = score::MakeUnexpected(ErrorCode::KeyDefaultNotFound);
         }
         else
         {
-            auto search_kvs = kvs.find(std::string(key));
+            const std::string key_str(key);
+            auto search_kvs = kvs.find(key_str);
             if (search_kvs != kvs.end())
             {
-                (void)kvs.erase(
-                    std::string(key)); /* Return Value ignored, since its already secured, that the key exists*/
+                (void)kvs.erase(search_kvs);
+                mark_dirty(key);
+                ++key_generation;
+                result = score::ResultBlank{};
+            }
+            else if (drop_raw_value(key_str)) /* Stored value was never decoded */
+            {
+                mark_dirty(key);
+                ++key_generation;
                 result = score::ResultBlank{};
             }
             else
@@ -418,10 +1119,10 @@ score::ResultBlank Kvs::reset_key(const std::string_view key)
 score::Result<bool> Kvs::is_value_default(const std::string_view key) const
 {
     std::string key_str{key};
-    if (kvs.find(key_str) != kvs.end()) {
+    if ((kvs.find(key_str) != kvs.end()) || (raw_values.find(key_str) != raw_values.end())) {
         return false;
     }
-    else if (default_values.find(key_str) != default_values.end()) {
+    else if (default_values.find(key) != nullptr) {
         return true;
     }
     else {
@@ -433,10 +1134,22 @@ score::Result<bool> Kvs::is_value_default(const std::string_view key) const
 score::ResultBlank Kvs::set_value(const std::string_view key, const KvsValue& value)
 {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock())
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (key == KVS_DELTA_KEY)
+    {
+        /* Reserved for the added keys of delta snapshots */
+        result = score::MakeUnexpected(ErrorCode::InvalidArgument);
+    }
+    else if (lock.owns_lock())
     {
-        kvs.insert_or_assign(std::string(key), value);
+        const std::string key_str(key);
+        const auto inserted = kvs.insert_or_assign(key_str, value).second;
+        if (inserted)
+        {
+            (void)drop_raw_value(key_str); /* Overwritten without decoding */
+            ++key_generation;              /* Handles of this key have no cached slot yet */
+        }
+        mark_dirty(key);
         result = score::ResultBlank{};
     }
     else
@@ -451,12 +1164,15 @@ score::ResultBlank Kvs::set_value(const std::string_view key, const KvsValue& va
 score::ResultBlank Kvs::remove_key(const std::string_view key)
 {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
+    std::unique_lock<std::mutex> lock = lock_instance();
     if (lock.owns_lock())
     {
-        const auto erased = kvs.erase(std::string(key));
-        if (erased > 0U)
+        const std::string key_str(key);
+        const bool erased = (kvs.erase(key_str) > 0U) || drop_raw_value(key_str);
+        if (erased)
         {
+            mark_dirty(key);
+            ++key_generation;
             result = score::ResultBlank{};
         }
         else
@@ -473,7 +1189,10 @@ score::ResultBlank Kvs::remove_key(const std::string_view key)
 }
 
 /* Helper: write data to a file and ensure it reaches physical storage.*/
-score::ResultBlank Kvs::write_and_sync(const std::string& path, const void* data, std::size_t size)
+score::ResultBlank Kvs::write_and_sync(const std::string& path,
+                                       const void* data,
+                                       std::size_t size,
+                                       std::vector<int>* deferred_fds)
 {
     auto file_deleter = [](std::FILE* f) {
         if (f != nullptr)
@@ -502,43 +1221,215 @@ score::ResultBlank Kvs::write_and_sync(const std::string& path, const void* data
         return score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
     }
 
-    /* Request the OS to commit the data from its buffers to physical storage */
-    if (::fdatasync(::fileno(file.get())) != 0)
+    /* The file was truncated on open, all of its blocks were allocated by this write */
+    struct stat info = {};
+    if (::fstat(::fileno(file.get()), &info) == 0)
     {
-        logger->LogError() << "Failed to sync file '" << path << "'";
-        return score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        count_write(size, size, static_cast<std::size_t>(info.st_blksize), static_cast<uint64_t>(info.st_blocks) * 512U);
+    }
+
+    return sync_written(::fileno(file.get()), path, size, deferred_fds);
+}
+
+/* Syncs a written file according to the durability policy, the descriptor stays owned by the caller */
+score::ResultBlank Kvs::sync_written(int file_fd,
+                                     const std::string& path,
+                                     std::size_t size,
+                                     std::vector<int>* deferred_fds)
+{
+    if ((deferred_fds != nullptr) && (durability.mode != KvsDurability::None))
+    {
+        /* Synced by the caller with a shared barrier (KvsGroup::flush_all) */
+        const int fd = ::dup(file_fd);
+        if (fd < 0)
+        {
+            logger->LogError() << "Failed to queue file '" << path << "' for sync";
+            return score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+        deferred_fds->push_back(fd);
+    }
+    else if (durability.mode == KvsDurability::GroupCommit)
+    {
+        /* A failed batched sync of an earlier write fails this one, the data stays marked modified */
+        if (group_commit_failed->exchange(false))
+        {
+            logger->LogError() << "Failed to sync an earlier write, file '" << path << "' is rewritten";
+            return score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+        /* Hand a duplicate of the descriptor to the process-wide batch, it is synced later */
+        const int fd = ::dup(file_fd);
+        if (fd < 0)
+        {
+            logger->LogError() << "Failed to queue file '" << path << "' for sync";
+            return score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+        GroupCommitter::instance().submit(
+            fd, size, durability.group_commit_interval, durability.group_commit_bytes, group_commit_failed);
+    }
+    else if (durability.mode == KvsDurability::Strict)
+    {
+        /* Request the OS to commit the data from its buffers to physical storage */
+        if (::fdatasync(file_fd) != 0)
+        {
+            logger->LogError() << "Failed to sync file '" << path << "'";
+            return score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+    }
+    else
+    {
+        /* KvsDurability::None: No sync */
     }
 
     return {};
 }
 
+/* Add a written file to the write statistics. `allocated` is the storage the filesystem newly
+ * allocated for the file, `size` the written bytes including padding. */
+void Kvs::count_write(std::size_t logical_size, std::size_t size, std::size_t block_size, uint64_t allocated)
+{
+    const uint64_t block = std::max<uint64_t>(block_size, 1U);
+    std::lock_guard<std::mutex> lock(write_stats_mutex);
+    ++write_totals.files;
+    write_totals.logical_bytes += logical_size;
+    write_totals.device_bytes += ((size + block - 1U) / block) * block;
+    write_totals.allocated_bytes += allocated;
+}
+
+/* Size of the next aligned image of a KVS file: the data rounded up to the block size, or the
+ * current file size if it is larger but within the preallocation. Keeping the size avoids a size
+ * update of the file on every flush. */
+std::size_t Kvs::aligned_file_size(const std::string& path, std::size_t size) const
+{
+    const std::size_t block = aligned_writes.block_size;
+    const std::size_t padded = ((size + block - 1U) / block) * block;
+    const std::size_t capacity = ((std::max(aligned_writes.preallocate, padded) + block - 1U) / block) * block;
+    std::size_t result = padded;
+    struct stat info = {};
+    if ((::stat(path.c_str(), &info) == 0) && (static_cast<std::size_t>(info.st_size) > padded))
+    {
+        result = std::min(static_cast<std::size_t>(info.st_size), capacity);
+    }
+
+    return result;
+}
+
+/* Overwrite a file in place within its preallocated extents, without truncating it first. The
+ * extents of the previous contents are reused, so the filesystem neither frees nor allocates
+ * blocks as long as the data fits into the preallocation. */
+score::ResultBlank Kvs::write_in_place(const std::string& path,
+                                       const std::string& data,
+                                       std::size_t logical_size,
+                                       std::vector<int>* deferred_fds)
+{
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        logger->LogError() << "Failed to open file '" << path << "'";
+        return score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    struct stat before = {};
+    struct stat after = {};
+    const std::size_t block = aligned_writes.block_size;
+    const std::size_t capacity = ((std::max(aligned_writes.preallocate, data.size()) + block - 1U) / block) * block;
+    const bool stated = (::fstat(fd, &before) == 0);
+    if (stated && ((static_cast<uint64_t>(before.st_blocks) * 512U) < capacity))
+    {
+        /* Reserve the extents without changing the file size. Filesystems without fallocate
+         * support allocate on write instead. */
+        (void)::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(capacity));
+    }
+    if (!stated || (::pwrite(fd, data.data(), data.size(), 0) != static_cast<ssize_t>(data.size())))
+    {
+        logger->LogError() << "Failed to write to file '" << path << "'";
+    }
+    /* The file only shrinks beyond the preallocation, see aligned_file_size() */
+    else if ((static_cast<std::size_t>(before.st_size) > data.size()) &&
+             (::ftruncate(fd, static_cast<off_t>(data.size())) != 0))
+    {
+        logger->LogError() << "Failed to truncate file '" << path << "'";
+    }
+    else
+    {
+        if (::fstat(fd, &after) == 0)
+        {
+            const uint64_t blocks = (after.st_blocks > before.st_blocks)
+                                        ? static_cast<uint64_t>(after.st_blocks - before.st_blocks)
+                                        : 0U;
+            count_write(logical_size, data.size(), static_cast<std::size_t>(after.st_blksize), blocks * 512U);
+        }
+        result = sync_written(fd, path, data.size(), deferred_fds);
+    }
+    (void)::close(fd);
+
+    return result;
+}
+
 /* Helper Function to write JSON data to a file for flush process (also adds Hash file)*/
 score::ResultBlank Kvs::write_json_data(const std::string& buf)
+{
+    return write_json_data(filename_prefix, buf);
+}
+
+/* Helper Function to write JSON data of a storage segment (main file or scope segment). With
+ * `written`, the metadata of the written file is returned for the manifest. */
+score::ResultBlank Kvs::write_json_data(const score::filesystem::Path& prefix,
+                                        const std::string& buf,
+                                        std::vector<int>* deferred_fds,
+                                        ManifestEntry* written)
 {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    score::filesystem::Path json_path{filename_prefix.Native() + "_0.json"};
+    score::filesystem::Path json_path{prefix.Native() + "_0.json"};
     score::filesystem::Path dir = json_path.ParentPath();
     if (!dir.Empty())
     {
+        /* Aligned files are padded with JSON whitespace, compressed files are written as they are */
+        const bool aligned = (aligned_writes.block_size > 0U) && (compression != KvsCompression::All);
+        std::string padded;
+        if (aligned)
+        {
+            /* Reuse the file dropped by the last snapshot rotation, see rotate_files() */
+            if (::access(json_path.CStr(), F_OK) != 0)
+            {
+                (void)std::rename((prefix.Native() + "_recycle.json").c_str(), json_path.CStr());
+            }
+            padded = buf;
+            padded.resize(aligned_file_size(json_path.Native(), buf.size()), ' ');
+        }
+
+        /* Compressed and padded files are hashed as stored */
+        const std::string compressed = (compression == KvsCompression::All) ? compress_json_file(buf) : std::string();
+        const std::string& stored = aligned ? padded : ((compression == KvsCompression::All) ? compressed : buf);
+        const std::vector<uint8_t> hash_bytes = get_hash_file_bytes(buf, checksum, record_checksums, &stored);
         const auto create_path_res = filesystem->standard->CreateDirectories(dir);
         if (!create_path_res.has_value())
         {
             result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
         }
+        else if ((!aligned) && (deferred_fds == nullptr) && write_json_files_uring(prefix, stored, hash_bytes, result))
+        {
+            /* JSON and hash file written with io_uring */
+        }
         else
         {
             /* Write JSON file */
-            result = write_and_sync(json_path.Native(), buf.data(), buf.size());
+            result = aligned ? write_in_place(json_path.Native(), stored, buf.size(), deferred_fds)
+                             : write_and_sync(json_path.Native(), stored.data(), stored.size(), deferred_fds);
             if (!result.has_value())
             {
                 return result;
             }
 
             /* Write Hash File */
-            std::array<uint8_t, 4> hash_bytes = get_hash_bytes(buf);
-            score::filesystem::Path fn_hash = filename_prefix.Native() + "_0.hash";
+            score::filesystem::Path fn_hash = prefix.Native() + "_0.hash";
+
+            result = write_and_sync(fn_hash.Native(), hash_bytes.data(), hash_bytes.size(), deferred_fds);
+        }
 
-            result = write_and_sync(fn_hash.Native(), hash_bytes.data(), hash_bytes.size());
+        if (result && (written != nullptr))
+        {
+            *written = get_manifest_entry(stored.size(), hash_bytes, checksum);
         }
     }
     else
@@ -550,265 +1441,2258 @@ score::ResultBlank Kvs::write_json_data(const std::string& buf)
     return result;
 }
 
-/* Flush the key-value store*/
-score::ResultBlank Kvs::flush()
+/* Write the main file into the inactive slot, which becomes the active slot once it is synced.
+ * A failed write leaves the active slot untouched, the next write retries the same slot. */
+score::ResultBlank Kvs::write_slot(const std::string& buf, std::vector<int>* deferred_fds)
 {
-    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    /* Create JSON Object */
-    score::json::Object root_obj;
-    bool error = false;
+    std::lock_guard<std::mutex> lock(slot_mutex);
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    const std::string compressed = (compression == KvsCompression::All) ? compress_json_file(buf) : std::string();
+    const std::string& stored = (compression == KvsCompression::All) ? compressed : buf;
+    slot_commit_pending = false; /* A pending half is overwritten */
+    const int fd = slots->write(stored, checksum);
+    if (fd < 0)
     {
-        std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-        if (lock.owns_lock())
+        logger->LogError() << "Failed to write slot file '" << slots->path() << "'";
+        return result;
+    }
+
+    /* Slot files are preallocated at open, a write within the capacity allocates nothing */
+    struct stat info = {};
+    if (::fstat(fd, &info) == 0)
+    {
+        count_write(stored.size(), SLOT_HEADER_SIZE + stored.size(), static_cast<std::size_t>(info.st_blksize), 0U);
+    }
+    if ((durability.mode == KvsDurability::GroupCommit) && (deferred_fds == nullptr))
+    {
+        /* The next write overwrites the other slot, so a slot is not left to a later batched sync */
+        if (::fdatasync(fd) == 0)
         {
-            for (const auto& [key, value] : kvs)
-            {
-                auto conv = kvsvalue_to_any(value);
-                if (!conv)
-                {
-                    result = score::MakeUnexpected(static_cast<ErrorCode>(*conv.error()));
-                    error = true;
-                    break;
-                }
-                else
-                {
-                    root_obj.emplace(key, std::move(conv.value()) /*emplace in map uses move operator*/
-                    );
-                }
-            }
+            slots->commit();
+            result = {};
         }
         else
         {
-            result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
-            error = true;
+            logger->LogError() << "Failed to sync file '" << slots->path() << "'";
         }
     }
-
-    if (!error)
+    else
     {
-        /* Serialize Buffer */
-        auto buf_res = writer->ToBuffer(root_obj);
-        if (!buf_res)
-        {
-            result = score::MakeUnexpected(ErrorCode::JsonGeneratorError);
-        }
-        else
+        result = sync_written(fd, slots->path(), SLOT_HEADER_SIZE + stored.size(), deferred_fds);
+        /* With a shared barrier, the half is activated once it is synced, see complete_deferred_flush() */
+        slot_commit_pending = result && (deferred_fds != nullptr) && (durability.mode != KvsDurability::None);
+        if (result && (!slot_commit_pending))
         {
-            /* Rotate Snapshots */
-            auto rotate_result = snapshot_rotate();
-            if (!rotate_result)
-            {
-                result = rotate_result;
-            }
-            else
-            {
-                /* Write JSON Data */
-                std::string buf = std::move(buf_res.value());
-                result = write_json_data(buf);
-            }
+            slots->commit();
         }
     }
 
     return result;
 }
 
-/* Retrieve the snapshot count*/
-score::Result<size_t> Kvs::snapshot_count() const
+/* Write the main file into the inactive half of its container segment, see write_slot(). The
+ * container file is shared, KvsGroup::flush_all() syncs it once for all of its instances. */
+score::ResultBlank Kvs::write_container(const std::string& buf, std::vector<int>* deferred_fds)
 {
-    score::Result<size_t> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    size_t count = 0;
-    bool error = false;
-    for (size_t idx = 0; idx < KVS_MAX_SNAPSHOTS; ++idx)
+    std::lock_guard<std::mutex> lock(slot_mutex);
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    const std::string compressed = (compression == KvsCompression::All) ? compress_json_file(buf) : std::string();
+    const std::string& stored = (compression == KvsCompression::All) ? compressed : buf;
+    slot_commit_pending = false; /* A pending half is overwritten */
+    const int fd = container->write(container_key, stored, checksum);
+    if (fd < 0)
     {
-        const score::filesystem::Path fname = filename_prefix.Native() + "_" + to_string(idx) + ".json";
-        const auto fname_exists_res = filesystem->standard->Exists(fname);
-        if (fname_exists_res)
+        logger->LogError() << "Failed to write container file '" << container->path() << "'";
+        return result;
+    }
+
+    struct stat info = {};
+    if (::fstat(fd, &info) == 0)
+    {
+        count_write(stored.size(), SLOT_HEADER_SIZE + stored.size(), static_cast<std::size_t>(info.st_blksize), 0U);
+    }
+    if ((durability.mode == KvsDurability::GroupCommit) && (deferred_fds == nullptr))
+    {
+        if (::fdatasync(fd) == 0)
         {
-            if (false == fname_exists_res.value())
-            {
-                break;
-            }
+            container->commit(container_key);
+            result = {};
         }
         else
         {
-            error = true;
-            break;
+            logger->LogError() << "Failed to sync file '" << container->path() << "'";
         }
-        count = idx + 1;
-    }
-    if (error)
-    {
-        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
     }
     else
     {
-        result = count;
+        result = sync_written(fd, container->path(), SLOT_HEADER_SIZE + stored.size(), deferred_fds);
+        /* With a shared barrier, the half is activated once it is synced, see complete_deferred_flush() */
+        slot_commit_pending = result && (deferred_fds != nullptr) && (durability.mode != KvsDurability::None);
+        if (result && (!slot_commit_pending))
+        {
+            container->commit(container_key);
+        }
     }
 
     return result;
 }
 
-/* Retrieve the max snapshot count*/
-size_t Kvs::snapshot_max_count() const
-{
-    return KVS_MAX_SNAPSHOTS;
-}
-
-/* Rotate Snapshots */
-score::ResultBlank Kvs::snapshot_rotate()
+/* Write the JSON and hash file of a storage segment concurrently with io_uring. Returns false if
+ * the synchronous path has to be used instead. */
+bool Kvs::write_json_files_uring(const score::filesystem::Path& prefix,
+                                 const std::string& buf,
+                                 const std::vector<uint8_t>& hash_bytes,
+                                 score::ResultBlank& result)
 {
-    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock())
+    bool written = false;
+    if ((io_backend == KvsIoBackend::IoUring) && (durability.mode != KvsDurability::GroupCommit))
     {
-        bool error = false;
-        for (size_t idx = KVS_MAX_SNAPSHOTS; idx > 0; --idx)
+        std::vector<UringWrite> files(2U);
+        files[0].path = prefix.Native() + "_0.json";
+        files[0].data = buf.data();
+        files[0].size = buf.size();
+        files[1].path = prefix.Native() + "_0.hash";
+        files[1].data = hash_bytes.data();
+        files[1].size = hash_bytes.size();
+
+        written = UringIo::instance().write_files(files, durability.mode == KvsDurability::Strict);
+        if (written)
         {
-            score::filesystem::Path hash_old = filename_prefix.Native() + "_" + to_string(idx - 1) + ".hash";
-            score::filesystem::Path hash_new = filename_prefix.Native() + "_" + to_string(idx) + ".hash";
-            score::filesystem::Path snap_old = filename_prefix.Native() + "_" + to_string(idx - 1) + ".json";
-            score::filesystem::Path snap_new = filename_prefix.Native() + "_" + to_string(idx) + ".json";
-
-            logger->LogInfo() << "rotating: " << snap_old << " -> " << snap_new;
-            /* Rename hash */
-            int32_t hash_rename = std::rename(hash_old.CStr(), hash_new.CStr());
-            if (0 != hash_rename)
+            result = score::ResultBlank{};
+            for (const auto& file : files)
             {
-                if (errno != ENOENT)
+                struct stat info = {};
+                if (file.error != 0)
                 {
-                    error = true;
-                    logger->LogError() << "error: could not rename hash file " << snap_old << ". Rename Errorcode "
-                                       << errno;
+                    logger->LogError() << "Failed to write file '" << file.path << "'. Errorcode " << file.error;
                     result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
                 }
-            }
-            if (!error)
-            {
-                /* Rename snapshot */
-                int32_t snap_rename = std::rename(snap_old.CStr(), snap_new.CStr());
-                if (0 != snap_rename)
+                else if (::stat(file.path.c_str(), &info) == 0)
                 {
-                    if (errno != ENOENT)
-                    {
-                        error = true;
-                        logger->LogError()
-                            << "error: could not rename snapshot file " << snap_old << ". Rename Errorcode " << errno;
-                        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
-                    }
+                    count_write(file.size, file.size, static_cast<std::size_t>(info.st_blksize),
+                                static_cast<uint64_t>(info.st_blocks) * 512U);
+                }
+                else
+                {
+                    /* Written, but not counted */
                 }
             }
-            if (error)
+        }
+    }
+
+    return written;
+}
+
+/* Helper Function to collect the JSON object of all keys owned by a storage segment (nullptr: main
+ * file). kvs_mutex must be held by the caller. */
+score::Result<score::json::Object> Kvs::collect_json_object(const ScopeState* owner,
+                                                            std::vector<std::string_view>* raw_members)
+{
+    score::Result<score::json::Object> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::json::Object root_obj;
+    bool error = false;
+    if (raw_members != nullptr)
+    {
+        /* Undecoded values are re-emitted verbatim */
+        for (const auto& [key, raw] : raw_values)
+        {
+            if (find_scope(key) == owner)
             {
-                break;
+                raw_members->push_back(raw.member);
             }
         }
-        if (!error)
+    }
+    for (const auto& [key, value] : kvs)
+    {
+        if (find_scope(key) == owner)
         {
-            result = score::ResultBlank{};
+            auto conv = kvsvalue_to_any(value);
+            if (!conv)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*conv.error()));
+                error = true;
+                break;
+            }
+            else
+            {
+                root_obj.emplace(key, std::move(conv.value()) /*emplace in map uses move operator*/
+                );
+            }
         }
     }
-    else
+    if (!error)
     {
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        result = std::move(root_obj);
     }
 
     return result;
 }
 
-/* Restore the key-value store from a snapshot*/
-score::ResultBlank Kvs::snapshot_restore(const SnapshotId& snapshot_id)
+/* Decode a lazily loaded value and move it into the map. Returns nullptr if the key has no raw value.
+ * kvs_mutex must be held by the caller. */
+score::Result<KvsValue*> Kvs::decode_raw_value(const std::string& key)
 {
-    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock())
+    score::Result<KvsValue*> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    auto search = raw_values.find(key);
+    if (search == raw_values.end())
     {
-        auto snapshot_count_res = snapshot_count();
-        if (!snapshot_count_res)
+        result = static_cast<KvsValue*>(nullptr);
+    }
+    else if (search->second.verify &&
+             (calculate_checksum(raw_checksum, search->second.member.data(), search->second.member.size()) !=
+              search->second.digest))
+    {
+        /* Corrupted record, replaced by the copy of the newest valid snapshot (if any) */
+        (void)drop_raw_value(key);
+        (void)recover_records(filename_prefix, {key}, kvs);
+        main_dirty = true;
+        ++key_generation;
+        auto recovered = kvs.find(key);
+        result = (recovered != kvs.end()) ? &recovered->second : nullptr;
+    }
+    else
+    {
+        auto any_res = parser->FromBuffer(search->second.value);
+        if (!any_res)
         {
-            result = score::MakeUnexpected(static_cast<ErrorCode>(*snapshot_count_res.error()));
+            logger->LogError() << "error: decoding value of key '" << key << "' failed";
+            result = score::MakeUnexpected(ErrorCode::JsonParserError);
         }
         else
         {
-            /* Fail if the snapshot ID is the current KVS */
-            if (0 == snapshot_id.id)
-            {
-                result = score::MakeUnexpected(ErrorCode::InvalidSnapshotId);
-            }
-            else if (snapshot_count_res.value() < snapshot_id.id)
+            auto value_res = any_to_kvsvalue(any_res.value());
+            if (!value_res)
             {
-                result = score::MakeUnexpected(ErrorCode::InvalidSnapshotId);
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*value_res.error()));
             }
             else
             {
-                score::filesystem::Path restore_path = filename_prefix.Native() + "_" + to_string(snapshot_id.id);
-                auto data_res = open_json(restore_path, OpenJsonNeedFile::Required);
-                if (!data_res)
-                {
-                    result = score::MakeUnexpected(static_cast<ErrorCode>(*data_res.error()));
-                }
-                else
-                {
-                    kvs = std::move(data_res.value());
-                    result = score::ResultBlank{};
-                }
+                KvsValue* slot = &kvs.insert_or_assign(key, std::move(value_res.value())).first->second;
+                (void)drop_raw_value(key);
+                ++key_generation; /* Handles of this key have no cached slot yet */
+                result = slot;
             }
         }
     }
-    else
-    {
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
-    }
 
     return result;
 }
 
-/* Get the filename for a snapshot*/
-score::Result<score::filesystem::Path> Kvs::get_kvs_filename(const SnapshotId& snapshot_id) const
+/* Decode all lazily loaded values with the given key prefix. kvs_mutex must be held by the caller. */
+score::ResultBlank Kvs::decode_raw_values(const std::string_view prefix)
 {
-    score::filesystem::Path filename = filename_prefix.Native() + "_" + std::to_string(snapshot_id.id) + ".json";
-    score::Result<score::filesystem::Path> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-
-    const auto fname_exists_res = filesystem->standard->Exists(filename);
-    if (fname_exists_res)
+    score::ResultBlank result = score::ResultBlank{};
+    std::vector<std::string> keys;
+    for (const auto& [key, raw] : raw_values)
     {
-        if (false == fname_exists_res.value())
-        {
-            result = score::MakeUnexpected(ErrorCode::FileNotFound);
-        }
-        else
+        if (key.compare(0, prefix.size(), prefix) == 0)
         {
-            result = filename;
+            keys.push_back(key);
         }
     }
-    else
+    for (const auto& key : keys)
     {
-        result = score::MakeUnexpected(static_cast<ErrorCode>(*fname_exists_res.error()));
+        auto decode_res = decode_raw_value(key);
+        if (!decode_res)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*decode_res.error()));
+            break;
+        }
     }
+
     return result;
 }
 
-/* Get the hash filename for a snapshot*/
-score::Result<score::filesystem::Path> Kvs::get_hash_filename(const SnapshotId& snapshot_id) const
+/* Drop the raw value of a key, the retained file is released with the last one. kvs_mutex must be held. */
+bool Kvs::drop_raw_value(const std::string& key)
 {
-    score::filesystem::Path filename = filename_prefix.Native() + "_" + std::to_string(snapshot_id.id) + ".hash";
-    score::Result<score::filesystem::Path> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    const bool dropped = raw_values.erase(key) > 0U;
+    if (dropped && raw_values.empty())
+    {
+        raw_buffer.reset();
+    }
+    return dropped;
+}
 
-    const auto fname_exists_res = filesystem->standard->Exists(filename);
-    if (fname_exists_res)
+/* Add a flushed version as file 0, the cached versions are rotated like the files. Versions beyond
+ * the count or the memory budget are dropped. kvs_mutex must be held by the caller. */
+void Kvs::cache_version(std::shared_ptr<const std::unordered_map<std::string, KvsValue>> data,
+                        size_t bytes,
+                        const RotationOutcome& outcome)
+{
+    if ((outcome.rotation == SnapshotRotation::None) && (!cached_versions.empty()))
+    {
+        cached_versions.pop_front();
+    }
+    else if ((outcome.rotation == SnapshotRotation::Replaced) && (cached_versions.size() > 1U))
+    {
+        cached_versions.erase(cached_versions.begin() + 1);
+    }
+    else
     {
-        if (false == fname_exists_res.value())
+        /* SnapshotRotation::Shifted */
+    }
+    cached_versions.push_front(CachedVersion{std::move(data), bytes});
+    const size_t max_versions = std::min<size_t>(snapshot_cache.versions, outcome.kept) + 1U;
+    size_t total_bytes = 0U;
+    size_t kept = 0U;
+    while ((kept < cached_versions.size()) && (kept < max_versions))
+    {
+        /* Versions sharing their map with the newer one are only counted once */
+        if ((kept == 0U) || (cached_versions[kept].data != cached_versions[kept - 1U].data))
         {
-            result = score::MakeUnexpected(ErrorCode::FileNotFound);
+            total_bytes += cached_versions[kept].bytes;
         }
-        else
+        if (total_bytes > snapshot_cache.max_bytes)
         {
-            result = filename;
+            break;
         }
+        ++kept;
     }
-    else
-    {
-        result = score::MakeUnexpected(static_cast<ErrorCode>(*fname_exists_res.error()));
+    cached_versions.resize(kept);
+}
+
+/* Flush the key-value store*/
+score::ResultBlank Kvs::flush()
+{
+    score::ResultBlank result = score::ResultBlank{};
+    if (scheduled_flush)
+    {
+        /* Written by the scheduler within its budget */
+        KvsFlushScheduler::instance().request(*this);
+    }
+    else
+    {
+        result = flush_files(nullptr);
+    }
+
+    return result;
+}
+
+/* Flush the main file and all modified scope segments. With deferred_fds, the written files are
+ * not synced but their descriptors are collected for a shared sync barrier. */
+score::ResultBlank Kvs::flush_files(std::vector<int>* deferred_fds)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    /* Create JSON Object */
+    score::json::Object root_obj;
+    std::vector<std::string> dirty_scopes;
+    std::shared_ptr<const std::string> retained_buffer; /* Keeps the raw members valid without the lock */
+    std::vector<std::string_view> raw_members;
+    std::shared_ptr<const std::unordered_map<std::string, KvsValue>> flushed_version; /* For cache and deltas */
+    std::shared_ptr<const std::unordered_map<std::string, KvsValue>> delta_older;     /* Current file before */
+    std::shared_ptr<const std::string> older_text;                                    /* Current file before */
+    std::shared_ptr<const std::string> written_text;
+    size_t flushed_bytes = 0U;
+    ManifestEntry written;
+    ManifestEntry snapshot_written;
+    RotationOutcome rotation;
+    DeferredFlush deferred;
+    std::vector<score::filesystem::Path> segment_prefixes; /* Rotated with the main file */
+    bool write_main = false;
+    bool error = false;
+    {
+        std::unique_lock<std::mutex> lock = lock_instance();
+        if (lock.owns_lock())
+        {
+            for (const auto& [prefix, state] : scopes)
+            {
+                if (state.dirty)
+                {
+                    dirty_scopes.push_back(prefix);
+                }
+                segment_prefixes.push_back(state.filename_prefix);
+            }
+            /* The main file is not rewritten if only scope segments were modified */
+            write_main = main_dirty || dirty_scopes.empty();
+        }
+        else
+        {
+            result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+            error = true;
+        }
+        if (write_main)
+        {
+            verify_raw_values();
+            retained_buffer = raw_buffer;
+            /* Versions with undecoded values or scope segments are restored from storage */
+            if (((snapshot_cache.versions > 0U) || delta_snapshots) && raw_values.empty() && scopes.empty())
+            {
+                if ((!main_dirty) && (!cached_versions.empty()))
+                {
+                    flushed_version = cached_versions.front().data;
+                }
+                else if ((!main_dirty) && (delta_base != nullptr))
+                {
+                    flushed_version = delta_base;
+                }
+                else
+                {
+                    flushed_version = std::make_shared<const std::unordered_map<std::string, KvsValue>>(kvs);
+                }
+            }
+            delta_older = delta_base;
+            older_text = current_text;
+            auto obj_res = collect_json_object(nullptr, &raw_members);
+            if (!obj_res)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*obj_res.error()));
+                error = true;
+            }
+            else
+            {
+                root_obj = std::move(obj_res.value());
+                main_dirty = false;
+            }
+        }
+    }
+
+    if ((!error) && (!write_main))
+    {
+        result = score::ResultBlank{};
+    }
+    else if (!error)
+    {
+        /* Serialize Buffer */
+        auto buf_res = writer->ToBuffer(root_obj);
+        if (!buf_res)
+        {
+            result = score::MakeUnexpected(ErrorCode::JsonGeneratorError);
+        }
+        else
+        {
+            /* Rotate Snapshots, slot and container mode keep none */
+            auto rotate_result =
+                ((slots == nullptr) && (container == nullptr)) ? snapshot_rotate(&rotation) : score::ResultBlank{};
+            /* The segments move along, so a snapshot ID covers the main file and all segments */
+            for (size_t idx = 0U; rotate_result && (idx < segment_prefixes.size()); ++idx)
+            {
+                rotate_result = rotate_files(segment_prefixes[idx], nullptr, &rotation);
+            }
+            if (!rotate_result)
+            {
+                result = rotate_result;
+            }
+            else
+            {
+                /* Write JSON Data */
+                std::string buf = std::move(buf_res.value());
+                append_json_members(buf, raw_members);
+                flushed_bytes = buf.size();
+                if (slots != nullptr)
+                {
+                    result = write_slot(buf, deferred_fds);
+                }
+                else if (container != nullptr)
+                {
+                    result = write_container(buf, deferred_fds);
+                }
+                else
+                {
+                    result = write_json_data(filename_prefix, buf, deferred_fds, &written);
+                }
+                if ((compression == KvsCompression::Snapshots) && (rotation.rotation != SnapshotRotation::None))
+                {
+                    written_text = std::make_shared<const std::string>(std::move(buf));
+                }
+            }
+        }
+
+        /* Replace the previous file, now snapshot 1, by its delta to the written file or by its
+         * compressed form. If that fails, snapshot 1 stays the previous file, which is restored as well. */
+        const std::string snapshot_path = filename_prefix.Native() + "_1.json";
+        struct stat snapshot_stat = {};
+        if (result && (rotation.rotation != SnapshotRotation::None) &&
+            (::stat(snapshot_path.c_str(), &snapshot_stat) == 0))
+        {
+            score::Result<std::string> snapshot_res = score::MakeUnexpected(ErrorCode::UnmappedError);
+            if ((delta_older != nullptr) && (flushed_version != nullptr))
+            {
+                snapshot_res = get_delta_buffer(make_snapshot_delta(*delta_older, *flushed_version));
+            }
+            else if ((compression == KvsCompression::Snapshots) && (older_text != nullptr))
+            {
+                /* Text of the previous file kept since its flush, compressed once */
+                snapshot_res = *older_text;
+            }
+            else if (compression == KvsCompression::Snapshots)
+            {
+                snapshot_res = read_plain_snapshot(filename_prefix.Native() + "_1");
+            }
+            else
+            {
+                /* Snapshot 1 is kept as written */
+            }
+            if (snapshot_res && (!replace_snapshot(snapshot_res.value(), &snapshot_written)))
+            {
+                logger->LogError() << "error: could not replace snapshot " << snapshot_path;
+            }
+        }
+
+        if (use_manifest)
+        {
+            /* After a failed rotation or write, the files are listed as found */
+            update_manifest(
+                result ? &written : nullptr, rotation, snapshot_written.present ? &snapshot_written : nullptr);
+            /* With a shared barrier, the manifest file is only replaced once the listed files are
+             * synced, see complete_deferred_flush() */
+            deferred.manifest = (deferred_fds != nullptr) && (durability.mode != KvsDurability::None);
+            auto manifest_res = deferred.manifest ? score::ResultBlank{} : write_manifest();
+            if (result)
+            {
+                result = manifest_res;
+            }
+        }
+
+        if (!result)
+        {
+            /* Main file was not persisted, keep it marked for the next flush */
+            std::lock_guard<std::mutex> lock(kvs_mutex);
+            main_dirty = true;
+            cached_versions.clear(); /* The snapshots may have been rotated nevertheless */
+            delta_base.reset();      /* The current file may have been written nevertheless */
+            current_text.reset();
+        }
+        else if ((snapshot_cache.versions > 0U) || delta_snapshots || (written_text != nullptr))
+        {
+            std::lock_guard<std::mutex> lock(kvs_mutex);
+            current_text = std::move(written_text);
+            if (delta_snapshots)
+            {
+                delta_base = flushed_version;
+            }
+            if ((flushed_version != nullptr) && (snapshot_cache.versions > 0U))
+            {
+                cache_version(std::move(flushed_version), flushed_bytes, rotation);
+            }
+            else
+            {
+                cached_versions.clear(); /* The cached versions no longer match the snapshot IDs */
+            }
+        }
+    }
+
+    /* Write modified scope segments, unmodified segments are not rewritten */
+    deferred.main = write_main && result;
+    /* Container segments are written in place, the main JSON file and scope segments are renamed */
+    deferred.renamed = deferred.main && (container == nullptr);
+    for (const auto& prefix : dirty_scopes)
+    {
+        if (!result)
+        {
+            break;
+        }
+        result = flush_scope(prefix, deferred_fds);
+        if (result)
+        {
+            deferred.scopes.push_back(prefix);
+            deferred.renamed = true;
+        }
+    }
+
+    if (deferred_fds != nullptr)
+    {
+        /* The written files are only persisted by the shared barrier, see complete_deferred_flush() */
+        std::lock_guard<std::mutex> lock(kvs_mutex);
+        deferred_flush = std::move(deferred);
+    }
+
+    return result;
+}
+
+/* Complete a flush with deferred syncs after the shared barrier. A written slot or container half
+ * becomes active and the manifest file is replaced once the files are synced. If the barrier
+ * failed, the written main file and scope segments are marked modified again for the next flush
+ * and the manifest lists the files as found. */
+score::ResultBlank Kvs::complete_deferred_flush(bool synced)
+{
+    score::ResultBlank result = score::ResultBlank{};
+    {
+        std::lock_guard<std::mutex> lock(slot_mutex);
+        if (slot_commit_pending && synced && (slots != nullptr))
+        {
+            slots->commit();
+        }
+        else if (slot_commit_pending && synced)
+        {
+            container->commit(container_key);
+        }
+        else
+        {
+            /* Nothing written in place, or the previous half stays active */
+        }
+        slot_commit_pending = false;
+    }
+    bool manifest_pending = false;
+    {
+        std::lock_guard<std::mutex> lock(kvs_mutex);
+        if (!synced)
+        {
+            if (deferred_flush.main)
+            {
+                main_dirty = true;
+                cached_versions.clear(); /* The snapshots may have been rotated nevertheless */
+                delta_base.reset();      /* The current file may have been written nevertheless */
+                current_text.reset();
+            }
+            for (const auto& prefix : deferred_flush.scopes)
+            {
+                auto search = scopes.find(prefix);
+                if (search != scopes.end())
+                {
+                    search->second.dirty = true;
+                }
+            }
+        }
+        manifest_pending = deferred_flush.manifest;
+        deferred_flush = DeferredFlush{};
+    }
+    if (manifest_pending)
+    {
+        if (!synced)
+        {
+            update_manifest(nullptr, RotationOutcome{});
+        }
+        result = write_manifest();
+    }
+
+    return result;
+}
+
+/* Check if the main file or a scope segment was modified since the last flush */
+score::Result<bool> Kvs::is_dirty()
+{
+    score::Result<bool> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (lock.owns_lock())
+    {
+        bool dirty = main_dirty;
+        for (const auto& [prefix, state] : scopes)
+        {
+            dirty = dirty || state.dirty;
+        }
+        result = dirty;
+    }
+    else
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Flush the storage segment of a single scope */
+score::ResultBlank Kvs::flush_scope(const std::string& prefix, std::vector<int>* deferred_fds)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::json::Object root_obj;
+    score::filesystem::Path segment_prefix;
+    bool write_needed = false;
+    {
+        std::unique_lock<std::mutex> lock = lock_instance();
+        if (lock.owns_lock())
+        {
+            auto search = scopes.find(prefix);
+            if (search == scopes.end())
+            {
+                result = score::MakeUnexpected(ErrorCode::InvalidArgument);
+            }
+            else if (!search->second.dirty)
+            {
+                result = score::ResultBlank{};
+            }
+            else
+            {
+                auto obj_res = collect_json_object(&search->second);
+                if (!obj_res)
+                {
+                    result = score::MakeUnexpected(static_cast<ErrorCode>(*obj_res.error()));
+                }
+                else
+                {
+                    root_obj = std::move(obj_res.value());
+                    segment_prefix = search->second.filename_prefix;
+                    search->second.dirty = false;
+                    write_needed = true;
+                }
+            }
+        }
+        else
+        {
+            result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        }
+    }
+
+    if (write_needed)
+    {
+        auto buf_res = writer->ToBuffer(root_obj);
+        if (!buf_res)
+        {
+            result = score::MakeUnexpected(ErrorCode::JsonGeneratorError);
+        }
+        else
+        {
+            /* Segments rotate with the main file (see flush_files()), the write replaces the current file */
+            result = write_json_data(segment_prefix, buf_res.value(), deferred_fds);
+        }
+
+        if (!result)
+        {
+            /* Segment was not persisted, keep it marked for the next flush */
+            std::lock_guard<std::mutex> lock(kvs_mutex);
+            scopes.at(prefix).dirty = true;
+        }
+    }
+
+    return result;
+}
+
+/* Retrieve the snapshot count*/
+score::Result<size_t> Kvs::snapshot_count() const
+{
+    score::Result<size_t> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    size_t count = 0;
+    bool error = false;
+    if (use_manifest)
+    {
+        std::lock_guard<std::mutex> lock(manifest_mutex);
+        while ((count < snapshot_policy.max_count) && manifest[count].present)
+        {
+            ++count;
+        }
+    }
+    for (size_t idx = 0; (!use_manifest) && (idx < snapshot_policy.max_count); ++idx)
+    {
+        const score::filesystem::Path fname = filename_prefix.Native() + "_" + to_string(idx) + ".json";
+        const auto fname_exists_res = filesystem->standard->Exists(fname);
+        if (fname_exists_res)
+        {
+            if (false == fname_exists_res.value())
+            {
+                break;
+            }
+        }
+        else
+        {
+            error = true;
+            break;
+        }
+        count = idx + 1;
+    }
+    if (error)
+    {
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+    else
+    {
+        result = count;
+    }
+
+    return result;
+}
+
+/* Retrieve the max snapshot count*/
+size_t Kvs::snapshot_max_count() const
+{
+    return snapshot_policy.max_count;
+}
+
+/* Retrieve the metadata of the existing snapshots */
+score::Result<std::vector<KvsSnapshotInfo>> Kvs::snapshot_info() const
+{
+    std::vector<ManifestEntry> entries;
+    if (use_manifest)
+    {
+        std::lock_guard<std::mutex> lock(manifest_mutex);
+        entries = manifest;
+    }
+    else
+    {
+        entries = probe_manifest();
+    }
+    std::vector<KvsSnapshotInfo> info;
+    for (size_t idx = 0U; idx < entries.size(); ++idx)
+    {
+        if (entries[idx].present)
+        {
+            const auto created = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(entries[idx].created_ns));
+            info.push_back(KvsSnapshotInfo{idx, static_cast<size_t>(entries[idx].size),
+                                           std::chrono::system_clock::time_point(created)});
+        }
+    }
+
+    return info;
+}
+
+/* Retrieve the durability policy */
+const KvsDurabilityPolicy& Kvs::durability_policy() const
+{
+    return durability;
+}
+
+/* Retrieve the I/O backend in use */
+KvsIoBackend Kvs::active_io_backend() const
+{
+    return io_backend;
+}
+
+KvsChecksum Kvs::checksum_algorithm() const
+{
+    return checksum;
+}
+
+/* Retrieve the bytes written since open */
+KvsWriteStats Kvs::write_stats() const
+{
+    std::lock_guard<std::mutex> lock(write_stats_mutex);
+    return write_totals;
+}
+
+/* Retrieve the cached verification state of the snapshots */
+score::Result<std::vector<KvsSnapshotStatus>> Kvs::snapshot_status()
+{
+    std::vector<KvsSnapshotStatus> status;
+    for (size_t idx = 1U; idx <= snapshot_policy.max_count; ++idx)
+    {
+        const std::string prefix = filename_prefix.Native() + "_" + to_string(idx);
+        KvsSnapshotStatus snapshot{idx, KvsSnapshotState::Unverified, {}};
+        const std::optional<ScrubResult> scrubbed = scrub_cache->lookup(prefix);
+        if (scrubbed.has_value())
+        {
+            snapshot.state = scrubbed->valid ? KvsSnapshotState::Valid : KvsSnapshotState::Corrupted;
+            snapshot.verified_at = scrubbed->verified_at;
+        }
+        else if (!get_scrub_stamp(prefix).has_value())
+        {
+            snapshot.state = KvsSnapshotState::Missing;
+        }
+        else
+        {
+            /* Not verified in its current state */
+        }
+        status.push_back(snapshot);
+    }
+
+    return status;
+}
+
+/* Verify all snapshots now, without the byte budget of the background scrubber */
+score::Result<std::vector<KvsSnapshotStatus>> Kvs::scrub_snapshots()
+{
+    (void)verify_snapshots(ScrubTarget{filename_prefix.Native(), snapshot_policy.max_count, scrub_cache},
+                           ScrubPacer{});
+    return snapshot_status();
+}
+
+/* Retrieve the records that failed their per-record checksum */
+score::Result<std::vector<KvsCorruptedRecord>> Kvs::corrupted_records()
+{
+    score::Result<std::vector<KvsCorruptedRecord>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (lock.owns_lock())
+    {
+        result = corrupted;
+    }
+    else
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Rotate Snapshots */
+score::ResultBlank Kvs::snapshot_rotate(RotationOutcome* outcome)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (lock.owns_lock())
+    {
+        result = rotate_files(filename_prefix, outcome);
+    }
+    else
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Rotate the snapshot files of a storage segment according to the snapshot policy. With a minimum
+ * interval, the current file replaces snapshot 1 while snapshot 1 is younger than the interval
+ * compared to snapshot 2, so older snapshots only move once per interval. Not with delta snapshots:
+ * snapshot 2 is a delta to the replaced snapshot 1.
+ * With `follow`, a scope segment repeats the rotation of the main file. Missing files of a scope
+ * segment are moved as gaps, see find_segment_file(). */
+score::ResultBlank Kvs::rotate_files(const score::filesystem::Path& prefix,
+                                     RotationOutcome* outcome,
+                                     const RotationOutcome* follow)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    bool error = false;
+    bool rotated = false;
+    RotationOutcome rotation{SnapshotRotation::Shifted, snapshot_policy.max_count};
+    size_t shift = snapshot_policy.max_count; /* Highest snapshot ID written by the rotation */
+    if (follow != nullptr)
+    {
+        rotation = *follow;
+        shift = (rotation.rotation == SnapshotRotation::None)
+                    ? 0U
+                    : ((rotation.rotation == SnapshotRotation::Replaced) ? 1U : snapshot_policy.max_count);
+    }
+    else if (snapshot_policy.max_count == 0U)
+    {
+        rotation.rotation = SnapshotRotation::None;
+    }
+    else if ((snapshot_policy.max_count > 1U) && (snapshot_policy.min_interval.count() > 0) && (!delta_snapshots))
+    {
+        struct stat newer = {};
+        struct stat older = {};
+        if ((::stat((prefix.Native() + "_1.json").c_str(), &newer) == 0) &&
+            (::stat((prefix.Native() + "_2.json").c_str(), &older) == 0))
+        {
+            const auto age = std::chrono::seconds(newer.st_mtim.tv_sec - older.st_mtim.tv_sec) +
+                             std::chrono::nanoseconds(newer.st_mtim.tv_nsec - older.st_mtim.tv_nsec);
+            if (age < snapshot_policy.min_interval)
+            {
+                rotation.rotation = SnapshotRotation::Replaced;
+                shift = 1U;
+            }
+        }
+    }
+    else
+    {
+        /* Count only, all snapshots move */
+    }
+    if ((follow == nullptr) && (shift > 0U) && (aligned_writes.block_size > 0U) && (compression != KvsCompression::All))
+    {
+        /* Keep the dropped snapshot file instead of letting the rotation delete it, the next
+         * KVS file is written into its extents (see write_json_data()). Scope segments are
+         * sparse, the file at the shift position may be the only copy of a clean segment. */
+        (void)std::rename((prefix.Native() + "_" + to_string(shift) + ".json").c_str(),
+                          (prefix.Native() + "_recycle.json").c_str());
+    }
+    if (io_backend == KvsIoBackend::IoUring)
+    {
+        /* Submit all renames as one linked chain, oldest snapshot first */
+        std::vector<std::pair<std::string, std::string>> renames;
+        for (size_t idx = shift; idx > 0; --idx)
+        {
+            renames.emplace_back(prefix.Native() + "_" + to_string(idx - 1) + ".hash",
+                                 prefix.Native() + "_" + to_string(idx) + ".hash");
+            renames.emplace_back(prefix.Native() + "_" + to_string(idx - 1) + ".json",
+                                 prefix.Native() + "_" + to_string(idx) + ".json");
+        }
+        int rename_error = 0;
+        rotated = renames.empty() || UringIo::instance().rename_chain(renames, rename_error);
+        if (rotated && (rename_error != 0))
+        {
+            error = true;
+            logger->LogError() << "error: could not rotate snapshots of " << prefix << ". Rename Errorcode "
+                               << rename_error;
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+    }
+    for (size_t idx = shift; (!rotated) && (idx > 0); --idx)
+    {
+        score::filesystem::Path hash_old = prefix.Native() + "_" + to_string(idx - 1) + ".hash";
+        score::filesystem::Path hash_new = prefix.Native() + "_" + to_string(idx) + ".hash";
+        score::filesystem::Path snap_old = prefix.Native() + "_" + to_string(idx - 1) + ".json";
+        score::filesystem::Path snap_new = prefix.Native() + "_" + to_string(idx) + ".json";
+
+        logger->LogInfo() << "rotating: " << snap_old << " -> " << snap_new;
+        /* Rename hash */
+        int32_t hash_rename = std::rename(hash_old.CStr(), hash_new.CStr());
+        if (0 != hash_rename)
+        {
+            if (errno != ENOENT)
+            {
+                error = true;
+                logger->LogError() << "error: could not rename hash file " << snap_old << ". Rename Errorcode "
+                                   << errno;
+                result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+            }
+        }
+        if (!error)
+        {
+            /* Rename snapshot */
+            int32_t snap_rename = std::rename(snap_old.CStr(), snap_new.CStr());
+            if (0 != snap_rename)
+            {
+                if (errno != ENOENT)
+                {
+                    error = true;
+                    logger->LogError() << "error: could not rename snapshot file " << snap_old
+                                       << ". Rename Errorcode " << errno;
+                    result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+                }
+            }
+        }
+        if (error)
+        {
+            break;
+        }
+    }
+    if (!error)
+    {
+        if ((follow != nullptr) && (rotation.kept < snapshot_policy.max_count))
+        {
+            trim_segment_snapshots(prefix, rotation.kept);
+        }
+        else if ((snapshot_policy.max_bytes > 0U) && (rotation.rotation != SnapshotRotation::None))
+        {
+            rotation.kept = prune_snapshots(prefix);
+        }
+        if (outcome != nullptr)
+        {
+            *outcome = rotation;
+        }
+        result = score::ResultBlank{};
+    }
+
+    return result;
+}
+
+/* Remove the oldest snapshots of a storage segment until the snapshot files fit into the byte
+ * budget. No file is renamed. Returns the number of snapshots kept. */
+size_t Kvs::prune_snapshots(const score::filesystem::Path& prefix)
+{
+    size_t kept = 0U;
+    uint64_t total_bytes = 0U;
+    bool pruning = false;
+    for (size_t idx = 1U; idx <= snapshot_policy.max_count; ++idx)
+    {
+        const std::string json_path = prefix.Native() + "_" + to_string(idx) + ".json";
+        const std::string hash_path = prefix.Native() + "_" + to_string(idx) + ".hash";
+        struct stat json_stat = {};
+        struct stat hash_stat = {};
+        if (::stat(json_path.c_str(), &json_stat) != 0)
+        {
+            break;
+        }
+        if (!pruning)
+        {
+            total_bytes += static_cast<uint64_t>(json_stat.st_size);
+            if (::stat(hash_path.c_str(), &hash_stat) == 0)
+            {
+                total_bytes += static_cast<uint64_t>(hash_stat.st_size);
+            }
+            pruning = (total_bytes > snapshot_policy.max_bytes);
+        }
+        if (pruning)
+        {
+            logger->LogInfo() << "pruning snapshot: " << json_path;
+            (void)std::remove(hash_path.c_str());
+            (void)std::remove(json_path.c_str());
+        }
+        else
+        {
+            kept = idx;
+        }
+    }
+
+    return kept;
+}
+
+/* Remove the snapshots of a scope segment above `kept`, the main file kept no older ones. A missing
+ * file of snapshot `kept` is replaced by the oldest removed file, which holds its data. */
+void Kvs::trim_segment_snapshots(const score::filesystem::Path& prefix, size_t kept)
+{
+    const std::string kept_path = prefix.Native() + "_" + to_string(kept);
+    bool found = (::access((kept_path + ".json").c_str(), F_OK) == 0);
+    for (size_t idx = kept + 1U; idx <= snapshot_policy.max_count; ++idx)
+    {
+        const std::string path = prefix.Native() + "_" + to_string(idx);
+        if (::access((path + ".json").c_str(), F_OK) != 0)
+        {
+            continue;
+        }
+        if (!found)
+        {
+            (void)std::rename((path + ".hash").c_str(), (kept_path + ".hash").c_str());
+            found = (std::rename((path + ".json").c_str(), (kept_path + ".json").c_str()) == 0);
+        }
+        if (::access((path + ".json").c_str(), F_OK) == 0)
+        {
+            logger->LogInfo() << "pruning snapshot: " << path << ".json";
+            (void)std::remove((path + ".hash").c_str());
+            (void)std::remove((path + ".json").c_str());
+        }
+    }
+}
+
+/* Find the file holding snapshot `snapshot_id` of a scope segment. Segment files are only written
+ * when the scope was modified, a missing file holds the same data as the next older one. */
+std::optional<size_t> Kvs::find_segment_file(const score::filesystem::Path& prefix, size_t snapshot_id) const
+{
+    std::optional<size_t> result;
+    for (size_t idx = snapshot_id; (!result.has_value()) && (idx <= std::max(snapshot_id, snapshot_policy.max_count));
+         ++idx)
+    {
+        if (::access((prefix.Native() + "_" + to_string(idx) + ".json").c_str(), F_OK) == 0)
+        {
+            result = idx;
+        }
+    }
+
+    return result;
+}
+
+/* Restore the key-value store from a snapshot*/
+score::ResultBlank Kvs::snapshot_restore(const SnapshotId& snapshot_id)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (lock.owns_lock())
+    {
+        if ((0U != snapshot_id.id) && scopes.empty() && (snapshot_id.id < cached_versions.size()))
+        {
+            /* Cached version, the storage is not accessed */
+            kvs = *cached_versions[snapshot_id.id].data;
+            raw_values.clear();
+            raw_buffer.reset();
+            main_dirty = true;
+            ++key_generation;
+            result = score::ResultBlank{};
+        }
+        else
+        {
+            auto snapshot_count_res = snapshot_count();
+            if (!snapshot_count_res)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*snapshot_count_res.error()));
+            }
+            else
+            {
+                /* Fail if the snapshot ID is the current KVS */
+                if (0 == snapshot_id.id)
+                {
+                    result = score::MakeUnexpected(ErrorCode::InvalidSnapshotId);
+                }
+                else if (snapshot_count_res.value() < snapshot_id.id)
+                {
+                    result = score::MakeUnexpected(ErrorCode::InvalidSnapshotId);
+                }
+                else
+                {
+                    auto data_res = load_snapshot_image(snapshot_id.id);
+                    if (!data_res)
+                    {
+                        result = score::MakeUnexpected(static_cast<ErrorCode>(*data_res.error()));
+                    }
+                    else if (scopes.empty())
+                    {
+                        kvs = std::move(data_res.value());
+                        raw_values.clear();
+                        raw_buffer.reset();
+                        main_dirty = true;
+                        ++key_generation;
+                        result = score::ResultBlank{};
+                    }
+                    else
+                    {
+                        result = restore_scopes(snapshot_id, std::move(data_res.value()));
+                        if (result)
+                        {
+                            raw_values.clear();
+                            raw_buffer.reset();
+                        }
+                        main_dirty = true;
+                        ++key_generation;
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Read a snapshot file of the main file, a recently verified snapshot is only parsed */
+score::Result<std::unordered_map<std::string, KvsValue>> Kvs::open_snapshot(size_t snapshot_id)
+{
+    score::filesystem::Path restore_path = filename_prefix.Native() + "_" + to_string(snapshot_id);
+    const std::optional<ScrubResult> scrubbed = scrub_cache->lookup(restore_path.Native());
+    const bool verified = scrubbed.has_value() && scrubbed->valid &&
+                          ((std::chrono::system_clock::now() - scrubbed->verified_at) <= scrub_max_age);
+    return open_json(restore_path, OpenJsonNeedFile::Required, nullptr, false, nullptr, verified);
+}
+
+/* Reconstruct a delta snapshot: starting from the current file, the newer snapshots are applied
+ * from snapshot 1 down to the requested one. A full snapshot in between replaces the image.
+ * kvs_mutex must be held by the caller. */
+score::Result<std::unordered_map<std::string, KvsValue>> Kvs::load_delta_snapshot(
+    size_t snapshot_id,
+    std::unordered_map<std::string, KvsValue>&& data)
+{
+    score::Result<std::unordered_map<std::string, KvsValue>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unordered_map<std::string, KvsValue> image;
+    bool error = false;
+    if (delta_base != nullptr)
+    {
+        image = *delta_base;
+    }
+    else
+    {
+        auto base_res = open_json(filename_prefix.Native() + "_0", OpenJsonNeedFile::Required);
+        if (!base_res)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*base_res.error()));
+            error = true;
+        }
+        else
+        {
+            image = std::move(base_res.value());
+        }
+    }
+    for (size_t idx = 1U; (!error) && (idx <= snapshot_id); ++idx)
+    {
+        auto snapshot_res = (idx == snapshot_id) ? score::Result<std::unordered_map<std::string, KvsValue>>(
+                                                       std::move(data))
+                                                 : open_snapshot(idx);
+        if (!snapshot_res)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*snapshot_res.error()));
+            error = true;
+        }
+        else if (is_snapshot_delta(snapshot_res.value()))
+        {
+            apply_snapshot_delta(image, std::move(snapshot_res.value()));
+        }
+        else
+        {
+            image = std::move(snapshot_res.value());
+        }
+    }
+    if (!error)
+    {
+        result = std::move(image);
+    }
+
+    return result;
+}
+
+/* Read the full contents of a snapshot, delta snapshots are reconstructed.
+ * kvs_mutex must be held by the caller. */
+score::Result<std::unordered_map<std::string, KvsValue>> Kvs::load_snapshot_image(size_t snapshot_id)
+{
+    auto result = open_snapshot(snapshot_id);
+    if (result && is_snapshot_delta(result.value()))
+    {
+        result = load_delta_snapshot(snapshot_id, std::move(result.value()));
+    }
+
+    return result;
+}
+
+/* Read the verified and decompressed JSON text of a snapshot (0 is the current file) */
+score::Result<std::string> Kvs::read_snapshot_text(size_t snapshot_id)
+{
+    score::Result<std::string> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    const std::string prefix = filename_prefix.Native() + "_" + std::to_string(snapshot_id);
+    std::ifstream hin(prefix + ".hash", std::ios::binary);
+    const std::string hash_bytes{std::istreambuf_iterator<char>(hin), std::istreambuf_iterator<char>()};
+    const std::optional<HashFileInfo> hash_info = hin ? parse_hash_file(hash_bytes, false) : std::nullopt;
+    const std::optional<ScrubResult> scrubbed = scrub_cache->lookup(prefix);
+    const bool verified = scrubbed.has_value() && scrubbed->valid &&
+                          ((std::chrono::system_clock::now() - scrubbed->verified_at) <= scrub_max_age);
+    std::unique_ptr<ChecksumStrategy> file_checksum =
+        (hash_info.has_value() && (!verified)) ? make_checksum(hash_info->algorithm) : nullptr;
+    std::string data;
+    if (!hash_info.has_value())
+    {
+        logger->LogError() << "error: hash file " << prefix << ".hash could not be read";
+        result = score::MakeUnexpected(ErrorCode::KvsHashFileReadError);
+    }
+    else if (!read_file_hashed(prefix + ".json", data, file_checksum.get()))
+    {
+        logger->LogError() << "error: file " << prefix << ".json could not be read";
+        result = score::MakeUnexpected(ErrorCode::KvsFileReadError);
+    }
+    else if (((file_checksum != nullptr) && (file_checksum->digest() != hash_info->digest)) ||
+             (!decompress_json_file(data)))
+    {
+        logger->LogError() << "error: KVS data corrupted (" << prefix << ".json)";
+        result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }
+    else
+    {
+        result = std::move(data);
+    }
+
+    return result;
+}
+
+/* Decode two JSON values and compare them, the text of equal values may differ in its formatting
+ * or member order */
+score::Result<bool> Kvs::json_values_equal(std::string_view lhs, std::string_view rhs)
+{
+    score::Result<bool> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    auto lhs_any = parser->FromBuffer(lhs);
+    auto rhs_any = parser->FromBuffer(rhs);
+    if ((!lhs_any) || (!rhs_any))
+    {
+        result = score::MakeUnexpected(ErrorCode::JsonParserError);
+    }
+    else
+    {
+        auto lhs_value = any_to_kvsvalue(lhs_any.value());
+        auto rhs_value = any_to_kvsvalue(rhs_any.value());
+        if (!lhs_value)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*lhs_value.error()));
+        }
+        else if (!rhs_value)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*rhs_value.error()));
+        }
+        else
+        {
+            result = kvsvalue_equal(lhs_value.value(), rhs_value.value());
+        }
+    }
+
+    return result;
+}
+
+/* Compare the decoded contents of two snapshots, used if one of them is a delta snapshot.
+ * kvs_mutex must be held by the caller. */
+score::ResultBlank Kvs::diff_snapshot_images(size_t from, size_t to, const KvsDiffVisitor& visitor)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    auto from_res = load_snapshot_image(from);
+    auto to_res = load_snapshot_image(to);
+    if (!from_res)
+    {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*from_res.error()));
+    }
+    else if (!to_res)
+    {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*to_res.error()));
+    }
+    else
+    {
+        for (const auto& [key, value] : from_res.value())
+        {
+            auto search = to_res.value().find(key);
+            if (search == to_res.value().end())
+            {
+                visitor(key, KvsDiffKind::Removed);
+            }
+            else if (!kvsvalue_equal(value, search->second))
+            {
+                visitor(key, KvsDiffKind::Changed);
+            }
+        }
+        for (const auto& [key, value] : to_res.value())
+        {
+            if (from_res.value().find(key) == from_res.value().end())
+            {
+                visitor(key, KvsDiffKind::Added);
+            }
+        }
+        result = score::ResultBlank{};
+    }
+
+    return result;
+}
+
+/* Compare two snapshots key by key */
+score::ResultBlank Kvs::snapshot_diff(const SnapshotId& from, const SnapshotId& to, const KvsDiffVisitor& visitor)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (lock.owns_lock())
+    {
+        auto snapshot_count_res = snapshot_count();
+        score::Result<std::string> from_text = score::MakeUnexpected(ErrorCode::UnmappedError);
+        score::Result<std::string> to_text = score::MakeUnexpected(ErrorCode::UnmappedError);
+        if (!snapshot_count_res)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*snapshot_count_res.error()));
+        }
+        else if ((snapshot_count_res.value() < from.id) || (snapshot_count_res.value() < to.id))
+        {
+            result = score::MakeUnexpected(ErrorCode::InvalidSnapshotId);
+        }
+        else
+        {
+            from_text = read_snapshot_text(from.id);
+            to_text = read_snapshot_text(to.id);
+            if (!from_text)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*from_text.error()));
+            }
+            else if (!to_text)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*to_text.error()));
+            }
+        }
+
+        if (from_text && to_text)
+        {
+            auto from_index = index_json_object(from_text.value());
+            auto to_index = index_json_object(to_text.value());
+            /* Delta snapshots only hold the differences to the next newer snapshot */
+            const auto is_delta = [](const std::vector<JsonMemberRange>& members) {
+                return std::any_of(members.begin(), members.end(), [](const JsonMemberRange& member) {
+                    return member.key == KVS_DELTA_KEY;
+                });
+            };
+            if ((!from_index) || (!to_index))
+            {
+                result = score::MakeUnexpected(ErrorCode::JsonParserError);
+            }
+            else if (is_delta(from_index.value()) || is_delta(to_index.value()))
+            {
+                result = diff_snapshot_images(from.id, to.id, visitor);
+            }
+            else
+            {
+                result = diff_snapshot_members(from_index.value(), to_index.value(), visitor);
+            }
+        }
+    }
+    else
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Compare the members of two snapshots without decoding them, by their verbatim value text.
+ * Values with a different text are decoded to confirm the change. */
+score::ResultBlank Kvs::diff_snapshot_members(const std::vector<JsonMemberRange>& from_members,
+                                              const std::vector<JsonMemberRange>& to_members,
+                                              const KvsDiffVisitor& visitor)
+{
+    score::ResultBlank result = score::ResultBlank{};
+    std::unordered_map<std::string_view, std::string_view> pending;
+    for (const auto& member : to_members)
+    {
+        pending.emplace(member.key, member.value);
+    }
+    for (const auto& member : from_members)
+    {
+        auto search = pending.find(member.key);
+        if (search == pending.end())
+        {
+            visitor(member.key, KvsDiffKind::Removed);
+        }
+        else
+        {
+            if (member.value != search->second)
+            {
+                auto equal_res = json_values_equal(member.value, search->second);
+                if (!equal_res)
+                {
+                    result = score::MakeUnexpected(static_cast<ErrorCode>(*equal_res.error()));
+                    break;
+                }
+                if (!equal_res.value())
+                {
+                    visitor(member.key, KvsDiffKind::Changed);
+                }
+            }
+            pending.erase(search);
+        }
+    }
+    for (const auto& member : to_members)
+    {
+        if (result && (pending.find(member.key) != pending.end()))
+        {
+            visitor(member.key, KvsDiffKind::Added);
+        }
+    }
+
+    return result;
+}
+
+score::Result<KvsSnapshotDiff> Kvs::snapshot_diff(const SnapshotId& from, const SnapshotId& to)
+{
+    score::Result<KvsSnapshotDiff> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    KvsSnapshotDiff diff;
+    auto diff_res = snapshot_diff(from, to, [&diff](std::string_view key, KvsDiffKind kind) {
+        std::vector<std::string>& keys = (kind == KvsDiffKind::Added)     ? diff.added
+                                         : (kind == KvsDiffKind::Removed) ? diff.removed
+                                                                          : diff.changed;
+        keys.emplace_back(key);
+    });
+    if (!diff_res)
+    {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*diff_res.error()));
+    }
+    else
+    {
+        std::sort(diff.added.begin(), diff.added.end());
+        std::sort(diff.removed.begin(), diff.removed.end());
+        std::sort(diff.changed.begin(), diff.changed.end());
+        result = std::move(diff);
+    }
+
+    return result;
+}
+
+/* Serialize a snapshot delta */
+score::Result<std::string> Kvs::get_delta_buffer(const std::unordered_map<std::string, KvsValue>& delta)
+{
+    score::Result<std::string> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::json::Object root_obj;
+    bool error = false;
+    for (const auto& [key, value] : delta)
+    {
+        auto conv = kvsvalue_to_any(value);
+        if (!conv)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*conv.error()));
+            error = true;
+            break;
+        }
+        root_obj.emplace(key, std::move(conv.value()));
+    }
+    if (!error)
+    {
+        auto buf_res = writer->ToBuffer(root_obj);
+        if (!buf_res)
+        {
+            result = score::MakeUnexpected(ErrorCode::JsonGeneratorError);
+        }
+        else
+        {
+            result = std::move(buf_res.value());
+        }
+    }
+
+    return result;
+}
+
+/* Read the JSON text of a valid, uncompressed snapshot to compress it. Damaged snapshots are not
+ * rewritten, a new hash file would hide the damage. */
+score::Result<std::string> Kvs::read_plain_snapshot(const std::string& prefix)
+{
+    score::Result<std::string> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::ifstream hin(prefix + ".hash", std::ios::binary);
+    const std::string hash_bytes{std::istreambuf_iterator<char>(hin), std::istreambuf_iterator<char>()};
+    const std::optional<HashFileInfo> hash_info = hin ? parse_hash_file(hash_bytes, false) : std::nullopt;
+    std::unique_ptr<ChecksumStrategy> file_checksum =
+        hash_info.has_value() ? make_checksum(hash_info->algorithm) : nullptr;
+    std::string data;
+    if ((file_checksum == nullptr) || (!read_file_hashed(prefix + ".json", data, file_checksum.get())))
+    {
+        result = score::MakeUnexpected(ErrorCode::KvsFileReadError);
+    }
+    else if (file_checksum->digest() != hash_info->digest)
+    {
+        result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }
+    else if (is_compressed_json_file(data))
+    {
+        result = score::MakeUnexpected(ErrorCode::InvalidArgument); /* Already compressed */
+    }
+    else
+    {
+        result = std::move(data);
+    }
+
+    return result;
+}
+
+/* Replace snapshot 1 of the main file by `buf` (a delta or its own JSON text), compressed unless
+ * the compression is disabled. Both files are written to temporary files and renamed, the JSON file
+ * first: until the hash file is renamed as well, snapshot 1 fails its verification instead of
+ * being restored with the wrong contents. The temporary files are synced before the rename, also
+ * with deferred_fds or group commits: a later sync would only reach them after the rename. */
+score::ResultBlank Kvs::replace_snapshot(const std::string& buf, ManifestEntry* written)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    const std::string compressed = (compression != KvsCompression::None) ? compress_json_file(buf) : std::string();
+    const std::string& stored = (compression != KvsCompression::None) ? compressed : buf;
+    const std::vector<uint8_t> hash_bytes = get_hash_file_bytes(buf, checksum, record_checksums, &stored);
+    const std::string json_path = filename_prefix.Native() + "_1.json";
+    const std::string hash_path = filename_prefix.Native() + "_1.hash";
+    std::vector<int> tmp_fds; /* Collected according to the durability policy, synced right away */
+    result = write_and_sync(json_path + ".tmp", stored.data(), stored.size(), &tmp_fds);
+    if (result)
+    {
+        result = write_and_sync(hash_path + ".tmp", hash_bytes.data(), hash_bytes.size(), &tmp_fds);
+    }
+    for (const int fd : tmp_fds)
+    {
+        if (result && (::fdatasync(fd) != 0))
+        {
+            logger->LogError() << "Failed to sync file '" << json_path << ".tmp'";
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+        (void)::close(fd);
+    }
+    if (result && ((std::rename((json_path + ".tmp").c_str(), json_path.c_str()) != 0) ||
+                   (std::rename((hash_path + ".tmp").c_str(), hash_path.c_str()) != 0)))
+    {
+        logger->LogError() << "error: could not replace snapshot " << json_path << ". Rename Errorcode " << errno;
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+    if (result)
+    {
+        *written = get_manifest_entry(stored.size(), hash_bytes, checksum);
+    }
+
+    return result;
+}
+
+/* Get the filename for a snapshot*/
+score::Result<score::filesystem::Path> Kvs::get_kvs_filename(const SnapshotId& snapshot_id) const
+{
+    score::filesystem::Path filename = filename_prefix.Native() + "_" + std::to_string(snapshot_id.id) + ".json";
+    score::Result<score::filesystem::Path> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    if (use_manifest)
+    {
+        std::lock_guard<std::mutex> lock(manifest_mutex);
+        if ((snapshot_id.id < manifest.size()) && manifest[snapshot_id.id].present)
+        {
+            result = filename;
+        }
+        else
+        {
+            result = score::MakeUnexpected(ErrorCode::FileNotFound);
+        }
+    }
+    else
+    {
+        const auto fname_exists_res = filesystem->standard->Exists(filename);
+        if (fname_exists_res)
+        {
+            if (false == fname_exists_res.value())
+            {
+                result = score::MakeUnexpected(ErrorCode::FileNotFound);
+            }
+            else
+            {
+                result = filename;
+            }
+        }
+        else
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*fname_exists_res.error()));
+        }
+    }
+    return result;
+}
+
+/* Get the hash filename for a snapshot*/
+score::Result<score::filesystem::Path> Kvs::get_hash_filename(const SnapshotId& snapshot_id) const
+{
+    score::filesystem::Path filename = filename_prefix.Native() + "_" + std::to_string(snapshot_id.id) + ".hash";
+    score::Result<score::filesystem::Path> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    if (use_manifest)
+    {
+        std::lock_guard<std::mutex> lock(manifest_mutex);
+        if ((snapshot_id.id < manifest.size()) && manifest[snapshot_id.id].present)
+        {
+            result = filename;
+        }
+        else
+        {
+            result = score::MakeUnexpected(ErrorCode::FileNotFound);
+        }
+    }
+    else
+    {
+        const auto fname_exists_res = filesystem->standard->Exists(filename);
+        if (fname_exists_res)
+        {
+            if (false == fname_exists_res.value())
+            {
+                result = score::MakeUnexpected(ErrorCode::FileNotFound);
+            }
+            else
+            {
+                result = filename;
+            }
+        }
+        else
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*fname_exists_res.error()));
+        }
+    }
+    return result;
+}
+
+/*********************** Snapshot Manifest *********************/
+
+/* Read the metadata of a snapshot from its files (the creation time is the modification time) */
+ManifestEntry Kvs::probe_manifest_entry(size_t snapshot_id) const
+{
+    ManifestEntry entry;
+    const std::string prefix = filename_prefix.Native() + "_" + to_string(snapshot_id);
+    struct stat json_stat = {};
+    if (::stat((prefix + ".json").c_str(), &json_stat) == 0)
+    {
+        std::ifstream hin(prefix + ".hash", std::ios::binary);
+        const std::string hash_bytes{std::istreambuf_iterator<char>(hin), std::istreambuf_iterator<char>()};
+        const std::optional<HashFileInfo> hash_info = hin ? parse_hash_file(hash_bytes, false) : std::nullopt;
+        entry.present = true;
+        entry.size = static_cast<uint64_t>(json_stat.st_size);
+        entry.created_ns = (static_cast<int64_t>(json_stat.st_mtim.tv_sec) * 1000000000) +
+                           static_cast<int64_t>(json_stat.st_mtim.tv_nsec);
+        if (hash_info.has_value())
+        {
+            entry.algorithm = hash_info->algorithm;
+            entry.digest = hash_info->digest;
+        }
+    }
+
+    return entry;
+}
+
+/* Read the metadata of all snapshots 0 to snapshot_max_count() from their files */
+std::vector<ManifestEntry> Kvs::probe_manifest() const
+{
+    std::vector<ManifestEntry> entries;
+    for (size_t idx = 0U; idx <= snapshot_policy.max_count; ++idx)
+    {
+        entries.push_back(probe_manifest_entry(idx));
     }
+
+    return entries;
+}
+
+/* Load the manifest at open. It is rebuilt from the files if it is missing, damaged or does not
+ * describe the current KVS file (e.g. after a flush of an instance without manifest). */
+void Kvs::load_manifest()
+{
+    std::ifstream in(filename_prefix.Native() + ".manifest", std::ios::binary);
+    const std::string bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    std::optional<std::vector<ManifestEntry>> loaded = in ? parse_manifest(bytes) : std::nullopt;
+    const ManifestEntry current = probe_manifest_entry(0U);
+    const bool valid = loaded.has_value() && (loaded->size() == (snapshot_policy.max_count + 1U)) &&
+                       (loaded->front().present == current.present) &&
+                       ((!current.present) ||
+                        ((loaded->front().size == current.size) && (loaded->front().algorithm == current.algorithm) &&
+                         (loaded->front().digest == current.digest)));
+
+    std::lock_guard<std::mutex> lock(manifest_mutex);
+    if (valid)
+    {
+        manifest = std::move(loaded.value());
+    }
+    else
+    {
+        logger->LogInfo() << "rebuilding snapshot manifest of " << filename_prefix;
+        manifest = probe_manifest();
+    }
+}
+
+/* Update the manifest after a flush of the main file. Without `written`, the flush failed and the
+ * manifest is rebuilt from the files. `replaced` is the entry of snapshot 1 if it was rewritten
+ * after the rotation. */
+void Kvs::update_manifest(const ManifestEntry* written, const RotationOutcome& outcome, const ManifestEntry* replaced)
+{
+    std::lock_guard<std::mutex> lock(manifest_mutex);
+    if (written != nullptr)
+    {
+        /* Same rotation as the files */
+        if (outcome.rotation == SnapshotRotation::Shifted)
+        {
+            std::rotate(manifest.begin(), manifest.end() - 1, manifest.end());
+        }
+        else if (outcome.rotation == SnapshotRotation::Replaced)
+        {
+            manifest[1] = manifest[0];
+        }
+        else
+        {
+            /* SnapshotRotation::None: Current file overwritten */
+        }
+        manifest.front() = *written;
+        if ((replaced != nullptr) && (manifest.size() > 1U))
+        {
+            manifest[1] = *replaced;
+        }
+        for (size_t idx = outcome.kept + 1U; idx < manifest.size(); ++idx)
+        {
+            manifest[idx] = ManifestEntry{};
+        }
+    }
+    else
+    {
+        manifest = probe_manifest();
+    }
+}
+
+/* Replace the manifest file. It is written to a temporary file that is synced before the rename,
+ * then the directory is synced, so the manifest is replaced atomically and durably. */
+score::ResultBlank Kvs::write_manifest()
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::vector<uint8_t> bytes;
+    {
+        std::lock_guard<std::mutex> lock(manifest_mutex);
+        bytes = get_manifest_bytes(manifest);
+    }
+
+    const std::string path = filename_prefix.Native() + ".manifest";
+    const std::string tmp_path = path + ".tmp";
+    std::vector<int> tmp_fds; /* Collected according to the durability policy, synced right away */
+    result = write_and_sync(tmp_path, bytes.data(), bytes.size(), &tmp_fds);
+    for (const int fd : tmp_fds)
+    {
+        if (result && (::fdatasync(fd) != 0))
+        {
+            logger->LogError() << "Failed to sync file '" << tmp_path << "'";
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+        (void)::close(fd);
+    }
+    if (result && (std::rename(tmp_path.c_str(), path.c_str()) != 0))
+    {
+        logger->LogError() << "error: could not replace manifest " << path << ". Rename Errorcode " << errno;
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+    if (result && (!tmp_fds.empty()))
+    {
+        const std::string dir = filename_prefix.ParentPath().Native();
+        const int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if ((dir_fd < 0) || (::fsync(dir_fd) != 0))
+        {
+            logger->LogError() << "Failed to sync the directory of manifest " << path;
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+        if (dir_fd >= 0)
+        {
+            (void)::close(dir_fd);
+        }
+    }
+
+    return result;
+}
+
+/*********************** KVS Scope Handling *********************/
+
+/* Find the scope owning a key (longest matching prefix). kvs_mutex must be held by the caller. */
+Kvs::ScopeState* Kvs::find_scope(const std::string_view key)
+{
+    ScopeState* owner = nullptr;
+    size_t owner_prefix_len = 0;
+    for (auto& [prefix, state] : scopes)
+    {
+        if ((prefix.size() > owner_prefix_len) && (key.substr(0, prefix.size()) == prefix))
+        {
+            owner = &state;
+            owner_prefix_len = prefix.size();
+        }
+    }
+    return owner;
+}
+
+/* Mark the segment owning a key as modified. kvs_mutex must be held by the caller. */
+void Kvs::mark_dirty(const std::string_view key)
+{
+    ScopeState* owner = find_scope(key);
+    if (owner != nullptr)
+    {
+        owner->dirty = true;
+    }
+    else
+    {
+        main_dirty = true;
+    }
+}
+
+/* Restore the scope segments for a snapshot. kvs_mutex must be held by the caller.
+ * Scopes without a segment file for the snapshot did not exist then, their keys are taken from
+ * the main file of the snapshot. */
+score::ResultBlank Kvs::restore_scopes(const SnapshotId& snapshot_id, std::unordered_map<std::string, KvsValue>&& data)
+{
+    score::ResultBlank result = score::ResultBlank{};
+    std::unordered_map<std::string, KvsValue> restored;
+    for (auto& [key, value] : data)
+    {
+        if (find_scope(key) == nullptr)
+        {
+            restored.emplace(key, std::move(value));
+        }
+    }
+
+    for (auto& [prefix, state] : scopes)
+    {
+        const std::optional<size_t> segment_id = find_segment_file(state.filename_prefix, snapshot_id.id);
+        if (segment_id.has_value())
+        {
+            auto segment_res = open_json(state.filename_prefix.Native() + "_" + to_string(*segment_id),
+                                         OpenJsonNeedFile::Required);
+            if (!segment_res)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*segment_res.error()));
+                break;
+            }
+            for (auto& [key, value] : segment_res.value())
+            {
+                if (find_scope(key) == &state)
+                {
+                    restored.emplace(key, std::move(value));
+                }
+            }
+        }
+        else
+        {
+            logger->LogInfo() << "no snapshot " << snapshot_id.id << " for scope '" << prefix
+                              << "', using the main file";
+            for (auto& [key, value] : data)
+            {
+                if (find_scope(key) == &state)
+                {
+                    restored.emplace(key, std::move(value));
+                }
+            }
+        }
+        state.dirty = true;
+    }
+
+    if (result)
+    {
+        kvs = std::move(restored);
+    }
+
+    return result;
+}
+
+/* Register all scopes with a segment in the storage directory, so scoped keys are visible right
+ * after open. Shorter prefixes are loaded first, the scope with the longest prefix owns a key.
+ * Snapshot files above the maximum count, left by a policy with more snapshots, are removed. The
+ * rotation and pruning only reach IDs up to the maximum count. */
+score::ResultBlank Kvs::open_scopes()
+{
+    score::ResultBlank result = score::ResultBlank{};
+    const std::string& native = filename_prefix.Native();
+    const std::size_t separator = native.find_last_of('/');
+    const std::string dir = (separator == std::string::npos) ? std::string(".") : native.substr(0U, separator);
+    const std::string basename = (separator == std::string::npos) ? native : native.substr(separator + 1U);
+    const std::string marker = basename + "_scope_";
+
+    std::vector<std::string> prefixes;
+    std::map<std::string, std::vector<size_t>> stale; /* Snapshot IDs above the maximum count per file prefix */
+    DIR* handle = ::opendir(dir.c_str());
+    for (const struct dirent* entry = (handle != nullptr) ? ::readdir(handle) : nullptr; entry != nullptr;
+         entry = ::readdir(handle))
+    {
+        /* <basename>_<snapshot id>.json or <marker><segment name>_<snapshot id>.json, and their hash files */
+        const std::string name(entry->d_name);
+        const std::size_t id_pos = name.rfind('_');
+        const bool json = (name.size() > 5U) && (name.compare(name.size() - 5U, 5U, ".json") == 0);
+        const bool hash = (name.size() > 5U) && (name.compare(name.size() - 5U, 5U, ".hash") == 0);
+        const bool numbered = (json || hash) && (id_pos != std::string::npos) && (name.size() > (id_pos + 6U)) &&
+                              (name.find_first_not_of("0123456789", id_pos + 1U) == (name.size() - 5U));
+        const bool main_file = numbered && (id_pos == basename.size()) && (name.compare(0U, id_pos, basename) == 0);
+        const bool segment_file =
+            numbered && (name.compare(0U, marker.size(), marker) == 0) && (id_pos > marker.size());
+        const size_t snapshot_id =
+            (main_file || segment_file) ? static_cast<size_t>(std::strtoull(name.c_str() + id_pos + 1U, nullptr, 10))
+                                        : 0U;
+        const auto prefix = (segment_file && json)
+                                ? parse_scope_segment_name(std::string_view(name).substr(marker.size(),
+                                                                                         id_pos - marker.size()))
+                                : std::nullopt;
+        if ((main_file || segment_file) && (snapshot_id > snapshot_policy.max_count))
+        {
+            stale[name.substr(0U, id_pos)].push_back(snapshot_id);
+        }
+        else if (prefix.has_value() && (std::find(prefixes.begin(), prefixes.end(), *prefix) == prefixes.end()))
+        {
+            prefixes.push_back(*prefix);
+        }
+        else
+        {
+            /* Other file, or a further file of a known segment */
+        }
+    }
+    if (handle != nullptr)
+    {
+        (void)::closedir(handle);
+    }
+
+    for (auto& [file_prefix, ids] : stale)
+    {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        const std::string path = dir + "/" + file_prefix;
+        const std::string kept_path = path + "_" + to_string(snapshot_policy.max_count);
+        if ((file_prefix != basename) && (::access((kept_path + ".json").c_str(), F_OK) != 0) &&
+            (::access((path + "_" + to_string(ids.front()) + ".json").c_str(), F_OK) == 0))
+        {
+            /* A missing segment file holds the data of the next older one, see find_segment_file() */
+            (void)std::rename((path + "_" + to_string(ids.front()) + ".hash").c_str(), (kept_path + ".hash").c_str());
+            (void)std::rename((path + "_" + to_string(ids.front()) + ".json").c_str(), (kept_path + ".json").c_str());
+            const std::optional<std::string> scope_prefix =
+                parse_scope_segment_name(std::string_view(file_prefix).substr(marker.size()));
+            if (scope_prefix.has_value() &&
+                (std::find(prefixes.begin(), prefixes.end(), *scope_prefix) == prefixes.end()))
+            {
+                prefixes.push_back(*scope_prefix);
+            }
+        }
+        for (const size_t idx : ids)
+        {
+            logger->LogInfo() << "pruning snapshot: " << path << "_" << to_string(idx) << ".json";
+            (void)std::remove((path + "_" + to_string(idx) + ".hash").c_str());
+            (void)std::remove((path + "_" + to_string(idx) + ".json").c_str());
+        }
+    }
+
+    std::sort(prefixes.begin(), prefixes.end(), [](const std::string& lhs, const std::string& rhs) {
+        return (lhs.size() < rhs.size()) || ((lhs.size() == rhs.size()) && (lhs < rhs));
+    });
+    for (const auto& prefix : prefixes)
+    {
+        result = load_scope(prefix);
+        if (!result)
+        {
+            break;
+        }
+    }
+
+    return result;
+}
+
+/* Load the segment of a scope and register the scope. kvs_mutex must be held by the caller. */
+score::ResultBlank Kvs::load_scope(const std::string& prefix)
+{
+    score::ResultBlank result = score::ResultBlank{};
+    const score::filesystem::Path segment_prefix =
+        filename_prefix.Native() + "_scope_" + get_scope_segment_name(prefix);
+    const std::optional<size_t> segment_id = find_segment_file(segment_prefix, 0U);
+    std::vector<std::string> corrupted_keys;
+    auto segment_res = open_json(segment_prefix.Native() + "_" + to_string(segment_id.value_or(0U)),
+                                 OpenJsonNeedFile::Optional,
+                                 nullptr,
+                                 false,
+                                 &corrupted_keys);
+    score::ResultBlank decode_res = score::ResultBlank{};
+    if (!segment_res)
+    {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*segment_res.error()));
+    }
+    else if (!(decode_res = decode_raw_values(prefix)))
+    {
+        /* Scoped keys are tracked per segment and must be decoded before the migration */
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*decode_res.error()));
+    }
+    else
+    {
+        /* Keys with this prefix that are not stored in the segment yet (e.g. stored in the main
+         * file or an enclosing scope) are migrated on the next flush */
+        bool migrated = false;
+        if (!corrupted_keys.empty())
+        {
+            /* Recovered records are written back with the segment */
+            (void)recover_records(segment_prefix, corrupted_keys, segment_res.value());
+            migrated = true;
+        }
+        for (const auto& [key, value] : kvs)
+        {
+            if ((key.compare(0, prefix.size(), prefix) == 0) &&
+                (segment_res.value().find(key) == segment_res.value().end()))
+            {
+                mark_dirty(key);
+                migrated = true;
+            }
+        }
+        for (auto& [key, value] : segment_res.value())
+        {
+            if (key.compare(0, prefix.size(), prefix) == 0)
+            {
+                kvs.insert_or_assign(key, std::move(value));
+            }
+        }
+        scopes.emplace(prefix, ScopeState{segment_prefix, migrated});
+        ++key_generation; /* Owning scope of cached keys may have changed */
+        logger->LogInfo() << "opened scope '" << prefix << "': " << segment_prefix;
+    }
+
+    return result;
+}
+
+/* Create a namespaced sub-view of the KVS */
+score::Result<KvsScope> Kvs::scope(const std::string_view prefix)
+{
+    score::Result<KvsScope> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    if (prefix.empty())
+    {
+        result = score::MakeUnexpected(ErrorCode::InvalidArgument);
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock = lock_instance();
+        if (!lock.owns_lock())
+        {
+            result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        }
+        else
+        {
+            std::string prefix_str(prefix);
+            /* Scopes with a segment were registered at open, a new scope starts without one */
+            auto load_res = (scopes.find(prefix_str) == scopes.end()) ? load_scope(prefix_str) : score::ResultBlank{};
+            if (!load_res)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*load_res.error()));
+            }
+            else
+            {
+                result = KvsScope(*this, std::move(prefix_str));
+            }
+        }
+    }
+
+    return result;
+}
+
+/*********************** KVS Key Handles *********************/
+
+/* Create a precompiled key handle */
+score::Result<KeyHandle> Kvs::key(const std::string_view key)
+{
+    score::Result<KeyHandle> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (key == KVS_DELTA_KEY)
+    {
+        result = score::MakeUnexpected(ErrorCode::InvalidArgument); /* Reserved, see set_value() */
+    }
+    else if (lock.owns_lock())
+    {
+        const auto interned = interned_keys.emplace(key).first; /* Node based, reference stays valid */
+        KeyHandle handle(*this, *interned);
+        auto resolve_res = resolve_key(handle);
+        if (!resolve_res)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*resolve_res.error()));
+        }
+        else
+        {
+            result = handle;
+        }
+    }
+    else
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Resolve the cached slots of a handle if the key generation changed, decoding a lazily loaded value.
+ * kvs_mutex must be held. */
+score::ResultBlank Kvs::resolve_key(const KeyHandle& handle)
+{
+    score::ResultBlank result = score::ResultBlank{};
+    if (handle.generation != key_generation)
+    {
+        auto search_kvs = kvs.find(*handle.name);
+        if (search_kvs != kvs.end())
+        {
+            handle.slot = &search_kvs->second;
+        }
+        else
+        {
+            auto raw_res = decode_raw_value(*handle.name);
+            if (!raw_res)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*raw_res.error()));
+            }
+            handle.slot = raw_res ? raw_res.value() : nullptr;
+        }
+        handle.default_slot = default_values.find(*handle.name);
+        ScopeState* owner = find_scope(*handle.name);
+        handle.scope_dirty = (owner != nullptr) ? &owner->dirty : nullptr;
+        handle.generation = result ? key_generation : (key_generation - 1U);
+    }
+    return result;
+}
+
+/* Retrieve the value of a precompiled key */
+score::Result<KvsValue> Kvs::get_value(const KeyHandle& handle)
+{
+    score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::ResultBlank resolve_res = score::ResultBlank{};
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (!lock.owns_lock())
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+    else if (handle.owner != this)
+    {
+        result = score::MakeUnexpected(ErrorCode::InvalidArgument);
+    }
+    else if (!(resolve_res = resolve_key(handle)))
+    {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*resolve_res.error()));
+    }
+    else
+    {
+        if (handle.slot != nullptr)
+        {
+            result = *handle.slot;
+        }
+        else if (handle.default_slot != nullptr)
+        {
+            result = *handle.default_slot;
+        }
+        else
+        {
+            result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+        }
+    }
+
+    return result;
+}
+
+/* Set the value of a precompiled key */
+score::ResultBlank Kvs::set_value(const KeyHandle& handle, const KvsValue& value)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::ResultBlank resolve_res = score::ResultBlank{};
+    std::unique_lock<std::mutex> lock = lock_instance();
+    if (!lock.owns_lock())
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+    else if (handle.owner != this)
+    {
+        result = score::MakeUnexpected(ErrorCode::InvalidArgument);
+    }
+    else if (!(resolve_res = resolve_key(handle)))
+    {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*resolve_res.error()));
+    }
+    else
+    {
+        if (handle.slot != nullptr)
+        {
+            *handle.slot = value;
+        }
+        else
+        {
+            handle.slot = &kvs.insert_or_assign(*handle.name, value).first->second;
+            ++key_generation; /* Other handles of this key have no cached slot yet */
+            handle.generation = key_generation;
+        }
+        if (handle.scope_dirty != nullptr)
+        {
+            *handle.scope_dirty = true;
+        }
+        else
+        {
+            main_dirty = true;
+        }
+        result = score::ResultBlank{};
+    }
+
     return result;
 }
 
@@ -13,7 +13,10 @@
 #ifndef SCORE_LIB_KVS_KVS_HPP
 #define SCORE_LIB_KVS_KVS_HPP
 
+#include "internal/checksum.hpp"
 #include "internal/error.hpp"
+#include "internal/frozen_kvs_map.hpp"
+#include "kvsdefaultsimage.hpp"
 #include "kvsvalue.hpp"
 #include "score/filesystem/filesystem.h"
 #include "score/json/json_parser.h"
@@ -21,11 +24,17 @@
 #include "score/mw/log/logger.h"
 #include "score/result/result.h"
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #define KVS_MAX_SNAPSHOTS 3
@@ -59,6 +68,52 @@ struct SnapshotId
     }
 };
 
+class Kvs;
+class KvsScope;
+class KvsContainer;
+class KvsFlushScheduler;
+struct HashFileInfo;
+struct JsonMemberRange;
+struct ManifestEntry;
+class ScrubCache;
+class SlotStore;
+class SnapshotScrubber;
+
+/**
+ * @class KeyHandle
+ * @brief Precompiled key of a Kvs object, created by Kvs::key().
+ *
+ * The handle references the interned key and caches the slots of the written value, the default
+ * value and the dirty flag of the owning scope. The cache is tagged with the key generation of the
+ * Kvs object and is resolved again if the generation changed. Copying a handle is cheap (no
+ * string copy).
+ */
+class KeyHandle final
+{
+  public:
+    /**
+     * @brief Returns the key referenced by this handle.
+     */
+    const std::string& key() const
+    {
+        return *name;
+    }
+
+  private:
+    friend class Kvs;
+
+    KeyHandle(const Kvs& owner, const std::string& name) : owner(&owner), name(&name) {}
+
+    const Kvs* owner;        ///< Kvs object the handle belongs to
+    const std::string* name; ///< Interned key (owned by the Kvs object)
+
+    /* Cached slots, valid while generation equals the key generation of the Kvs object */
+    mutable uint64_t generation = 0;
+    mutable KvsValue* slot = nullptr;
+    mutable const KvsValue* default_slot = nullptr;
+    mutable bool* scope_dirty = nullptr; ///< Dirty flag of the owning scope, if any
+};
+
 /* Need-Defaults flag*/
 enum class OpenNeedDefaults
 {
@@ -73,6 +128,197 @@ enum class OpenNeedKvs
     Required = 1  /* Required: KVS must be already exist*/
 };
 
+/* Durability mode of written files */
+enum class KvsDurability
+{
+    Strict = 0,      /* Strict: Every written file is synced to storage before flush returns */
+    GroupCommit = 1, /* GroupCommit: Syncs are batched process-wide, bounded by time and pending bytes */
+    None = 2         /* None: Files are not synced, the OS decides when data reaches storage */
+};
+
+/**
+ * @brief Durability policy of a Kvs object.
+ */
+struct KvsDurabilityPolicy
+{
+    KvsDurability mode = KvsDurability::Strict;
+    std::chrono::milliseconds group_commit_interval{100}; ///< GroupCommit: Maximum delay of a sync
+    std::size_t group_commit_bytes = 1024U * 1024U;       ///< GroupCommit: Pending bytes that force a sync
+};
+
+/* I/O backend used for flush and open */
+enum class KvsIoBackend
+{
+    Posix = 0,  /* Posix: Synchronous file API */
+    IoUring = 1 /* IoUring: Batched io_uring submissions (Linux), falls back to Posix if unsupported */
+};
+
+/* Compression of written storage files */
+enum class KvsCompression
+{
+    None = 0,      /* None: All files are plain JSON */
+    Snapshots = 1, /* Snapshots: Snapshot 1 is compressed after each flush, the current file stays plain JSON */
+    All = 2        /* All: The current file is written compressed, so are all snapshots */
+};
+
+/**
+ * @brief Record of a storage file that failed its per-record checksum.
+ */
+struct KvsCorruptedRecord
+{
+    std::string key;
+    size_t recovered_from = 0U; ///< Snapshot ID the value was recovered from, 0 if it was lost
+};
+
+/**
+ * @brief Background verification of the snapshots of a Kvs object (see KvsBuilder::scrubber()).
+ */
+struct KvsScrubPolicy
+{
+    std::chrono::milliseconds interval{60000};    ///< Pause between two verification passes
+    std::size_t bytes_per_second = 1024U * 1024U; ///< Read budget of the scrubber, 0 for unlimited
+    std::chrono::milliseconds max_age{600000};    ///< Restore trusts verifications up to this age
+};
+
+/* Verification state of a snapshot */
+enum class KvsSnapshotState
+{
+    Unverified = 0, /* Unverified: Not verified yet, or modified since the last verification */
+    Valid = 1,      /* Valid: The data matches the hash file */
+    Corrupted = 2,  /* Corrupted: The data does not match the hash file */
+    Missing = 3     /* Missing: The snapshot does not exist */
+};
+
+/**
+ * @brief Verification result of a snapshot.
+ */
+struct KvsSnapshotStatus
+{
+    size_t id = 0U;
+    KvsSnapshotState state = KvsSnapshotState::Unverified;
+    std::chrono::system_clock::time_point verified_at{}; ///< Time of the verification, if verified
+};
+
+/**
+ * @brief In-memory cache of flushed versions for Kvs::snapshot_restore (see KvsBuilder::snapshot_cache()).
+ */
+struct KvsSnapshotCachePolicy
+{
+    std::size_t versions = 0U;                  ///< Snapshots restorable from memory, 0 disables the cache
+    std::size_t max_bytes = 4U * 1024U * 1024U; ///< Memory budget, estimated from the serialized size
+};
+
+/**
+ * @brief Retention of the snapshots of a Kvs object (see KvsBuilder::snapshot_policy()).
+ *
+ * All limits apply together, the default keeps KVS_MAX_SNAPSHOTS snapshots.
+ */
+struct KvsSnapshotPolicy
+{
+    std::size_t max_count = KVS_MAX_SNAPSHOTS; ///< Snapshots kept, 0 disables the snapshots
+    std::size_t max_bytes = 0U;                ///< Total size of the snapshot files, 0 for unlimited
+    std::chrono::milliseconds min_interval{0}; ///< Minimum age difference of snapshots 2 and up
+};
+
+/**
+ * @brief Metadata of an existing snapshot (see Kvs::snapshot_info()).
+ */
+struct KvsSnapshotInfo
+{
+    size_t id = 0U;                                  ///< Snapshot ID, 0 is the current KVS file
+    size_t size = 0U;                                ///< Size of the JSON file in bytes
+    std::chrono::system_clock::time_point created{}; ///< Time the file was written
+};
+
+/**
+ * @brief A/B slot persistence of the main file (see KvsBuilder::slots()).
+ *
+ * The main file is written alternately in place into two preallocated slot files instead of
+ * rotating JSON files, a flush then only writes and syncs one file. Slot mode keeps no snapshots.
+ */
+struct KvsSlotPolicy
+{
+    std::size_t capacity = 0U; ///< Preallocated size of each slot file, 0 disables the slots
+};
+
+/**
+ * @brief Preallocated, block-aligned writes of the KVS file (see KvsBuilder::aligned_writes()).
+ */
+struct KvsAlignedWritePolicy
+{
+    std::size_t block_size = 0U;  ///< Alignment of the written file size, 0 disables aligned writes
+    std::size_t preallocate = 0U; ///< Extents reserved for the KVS file, rounded up to block_size
+};
+
+/**
+ * @brief Bytes written by a Kvs object since it was opened (see Kvs::write_stats()).
+ *
+ * The block layer writes whole filesystem blocks, so `device_bytes / logical_bytes` is the write
+ * amplification of the data itself. Filesystem metadata is not included, but `allocated_bytes`
+ * shows how many blocks the filesystem had to allocate for the writes.
+ */
+struct KvsWriteStats
+{
+    uint64_t files = 0U;           ///< Number of written files
+    uint64_t logical_bytes = 0U;   ///< Bytes of the written contents, without padding
+    uint64_t device_bytes = 0U;    ///< Written bytes rounded up to whole filesystem blocks
+    uint64_t allocated_bytes = 0U; ///< Storage newly allocated by the filesystem for the writes
+};
+
+/* Priority of an instance in the flush scheduler (see KvsBuilder::scheduled_flush()) */
+enum class KvsFlushClass
+{
+    Critical = 0,  /* Critical: Flushed before all other pending instances */
+    Normal = 1,    /* Normal: Flushed after pending critical instances */
+    Background = 2 /* Background: Flushed when no other instance is pending */
+};
+
+/* Change of a key between two snapshots */
+enum class KvsDiffKind
+{
+    Added = 0,   /* Added: The key only exists in the target snapshot */
+    Removed = 1, /* Removed: The key only exists in the source snapshot */
+    Changed = 2  /* Changed: The key exists in both snapshots with different values */
+};
+
+/* Called by Kvs::snapshot_diff() once per added, removed or changed key */
+using KvsDiffVisitor = std::function<void(std::string_view key, KvsDiffKind kind)>;
+
+/**
+ * @brief Key-level changes between two snapshots (see Kvs::snapshot_diff()).
+ */
+struct KvsSnapshotDiff
+{
+    std::vector<std::string> added;   ///< Keys only stored in the target snapshot, sorted
+    std::vector<std::string> removed; ///< Keys only stored in the source snapshot, sorted
+    std::vector<std::string> changed; ///< Keys stored in both snapshots with different values, sorted
+};
+
+/**
+ * @brief Additional options for Kvs::open, usually set through the KvsBuilder.
+ */
+struct KvsOpenOptions
+{
+    const KvsDefaultsImage* defaults_image = nullptr;  ///< Build-time defaults, replaces the defaults file
+    KvsDurabilityPolicy durability;                    ///< Durability of flushed files
+    KvsIoBackend io_backend = KvsIoBackend::Posix;     ///< Requested I/O backend
+    bool lazy_values = false;                          ///< Decode values of the KVS file on first access
+    KvsChecksum checksum = KvsChecksum::Adler32;       ///< Checksum algorithm of written hash files
+    bool record_checksums = false;                     ///< Write a checksum per key into the hash files
+    bool scrub = false;                                ///< Verify the snapshots in the background
+    KvsScrubPolicy scrub_policy;                       ///< Schedule of the background verification
+    KvsSnapshotCachePolicy snapshot_cache;             ///< Flushed versions kept in memory for restore
+    bool manifest = false;                             ///< Keep a manifest of the snapshots
+    KvsSnapshotPolicy snapshot_policy;                 ///< Retention of the snapshots
+    bool delta_snapshots = false;                      ///< Store snapshots as delta to the next newer one
+    KvsCompression compression = KvsCompression::None; ///< Compression of written files
+    KvsSlotPolicy slots;                               ///< A/B slot persistence of the main file
+    KvsAlignedWritePolicy aligned_writes;              ///< Preallocated, block-aligned KVS files
+    bool scheduled_flush = false;                      ///< flush() is queued in the KvsFlushScheduler
+    KvsFlushClass flush_class = KvsFlushClass::Normal; ///< Priority in the KvsFlushScheduler
+    std::shared_ptr<KvsContainer> container;           ///< Container of the main and defaults files
+};
+
 /* Need-File flag */
 enum class OpenJsonNeedFile
 {
@@ -91,6 +337,7 @@ enum class OpenJsonNeedFile
  *
  * Public Methods:
  * - `open`: Opens the KVS with a specified instance ID and flags.
+ * - `open_many`: Opens several KVS instances concurrently.
  * - `reset`: Resets the KVS to its initial state.
  * - `get_all_keys`: Retrieves all keys stored in the KVS (only written keys, not defaults).
  * - `key_exists`: Checks if a specific key exists in the KVS (only written keys).
@@ -105,25 +352,67 @@ enum class OpenJsonNeedFile
  * - `flush_default`: Flushes the default values to storage.
  * - `snapshot_count`: Retrieves the number of available snapshots.
  * - `snapshot_max_count`: Retrieves the maximum number of snapshots allowed.
+ * - `snapshot_info`: Retrieves the size and creation time of the existing snapshots.
+ * - `durability_policy`: Retrieves the durability policy in effect.
+ * - `active_io_backend`: Retrieves the I/O backend in use.
+ * - `checksum_algorithm`: Retrieves the checksum algorithm of written hash files.
+ * - `write_stats`: Retrieves the logical and block-level bytes written since open.
+ * - `corrupted_records`: Retrieves the keys that failed their per-record checksum.
+ * - `snapshot_status`: Retrieves the cached verification state of the snapshots.
+ * - `scrub_snapshots`: Verifies all snapshots against their hash files.
  * - `snapshot_restore`: Restores the KVS from a specified snapshot.
+ * - `snapshot_diff`: Lists the keys added, removed or changed between two snapshots.
  * - `get_kvs_filename`: Retrieves the filename (path) associated with a snapshot.
  * - `get_hash_filename`: Retrieves the hashname (path) associated with a snapshot.
+ * - `scope`: Returns a namespaced sub-view (KvsScope) with its own storage segment.
+ * - `key`: Returns a precompiled KeyHandle for repeated lookups of the same key.
  *
  * Private Methods:
- * - `snapshot_rotate`: Rotates the snapshots, ensuring that the maximum count is maintained.
+ * - `snapshot_rotate`: Rotates the snapshots, ensuring that the snapshot policy is maintained.
  * - `parse_json_data`: Parses JSON data into an unordered map of key-value pairs.
  * - `open_json`: Opens a JSON file and returns its contents as an unordered map of key-value pairs.
  * - `write_json_data`: Writes the provided data to a JSON file.
+ * - `flush_scope`: Flushes the storage segment of a single scope.
+ * - `flush_files`: Flushes the main file and modified scope segments, optionally deferring the sync.
+ * - `complete_deferred_flush`: Completes a flush with deferred syncs after the shared barrier.
+ * - `open_scopes`: Registers the scopes with a segment in the storage directory when opening and
+ *   removes snapshots above the maximum count.
  *
  * Private Members:
  * - `kvs_mutex`: A mutex for ensuring thread safety.
  * - `kvs`: An unordered map for storing key-value pairs.
  * - `default_mutex`: A mutex for default value operations.
- * - `default_values`: An unordered map for storing optional default values.
+ * - `default_values`: An immutable perfect-hash table of the optional default values. It is
+ *   frozen after open, read without locking and shared between instances with identical defaults.
  * - `filename_prefix`: A path prefix for filenames associated with snapshots.
  * - `filesystem`: A unique pointer to a filesystem handler for file operations.
  * - `parser`: A unique pointer to a JSON parser for reading KVS data.
  * - `writer`: A unique pointer to a JSON writer for writing KVS data.
+ * - `scopes`: Registered scopes with their segment prefix and dirty flag.
+ * - `main_dirty`: Set when the main file was modified since the last flush.
+ * - `raw_values`: Undecoded values of a lazily opened KVS file, as ranges of `raw_buffer`. A key is
+ *   either stored in `kvs` or in `raw_values`, never in both.
+ * - `record_checksums`: Write per-record checksums, `corrupted` lists the records that failed them.
+ * - `interned_keys`: Keys referenced by KeyHandles.
+ * - `key_generation`: Incremented whenever cached KeyHandle slots may have become invalid.
+ * - `durability`: Durability policy applied by `write_and_sync`.
+ * - `io_backend`: I/O backend in use, resolved at open.
+ * - `checksum`: Checksum algorithm of written hash files, read hash files are checked with the
+ *   algorithm they are tagged with.
+ * - `scrub_cache`: Verification results of the snapshots, shared with the background scrubber.
+ * - `scrubber`: Background thread verifying the snapshots, if enabled.
+ * - `cached_versions`: Recently flushed versions of the main file, index 0 is the current file
+ *   and index n is snapshot n. Unchanged versions share their map.
+ * - `manifest`: Metadata of the snapshot files if the manifest is enabled, entry n is snapshot n.
+ * - `compression`: Compression of written files, compressed files are read in every mode.
+ * - `delta_base`: Contents of the current file if delta snapshots are enabled and the contents are
+ *   known, the base for writing and restoring delta snapshots.
+ * - `slots`: Slot files the main file is written to in slot mode, nullptr otherwise.
+ * - `container`: Container file holding the main file as segment `container_key`, nullptr otherwise.
+ * - `aligned_writes`: Block size and preallocation of the KVS files written in place.
+ * - `write_totals`: Bytes written since open, see `write_stats`.
+ * - `scheduled_flush`: `flush` is queued in the KvsFlushScheduler with the priority `flush_class`.
+ *   `kvs_mutex` is then waited for instead of failing with MutexLockFailed, see `lock_instance`.
  *
  * ----------------Notice----------------
  * - Blank should be used instead of void for Result class
@@ -143,6 +432,8 @@ class Kvs final
     Kvs(Kvs&& other) noexcept;
     Kvs& operator=(Kvs&& other) noexcept;
 
+    ~Kvs();
+
     /**
      * @brief Opens the key-value store with the specified instance ID and flags.
      *
@@ -161,6 +452,8 @@ class Kvs final
      *                 - OpenNeedKvs::Optional: An empty KVS will be used if no KVS exists.
      * @param dir The directory path where the KVS files are located. It is passed as an rvalue
      * reference to avoid unnecessary copying. Use "" or "." for the current directory.
+     * @param options Additional options. If a defaults image is set, the defaults file is not read
+     *                and need_defaults is ignored.
      * @return A Result object containing either:
      *         - A Kvs object if the operation is successful.
      *         - An ErrorCode if an error occurs during the operation.
@@ -172,7 +465,28 @@ class Kvs final
     static score::Result<Kvs> open(const InstanceId& instance_id,
                                    OpenNeedDefaults need_defaults,
                                    OpenNeedKvs need_kvs,
-                                   const std::string&& dir);
+                                   const std::string&& dir,
+                                   const KvsOpenOptions& options = KvsOpenOptions{});
+
+    /**
+     * @brief Opens several key-value stores of the same directory concurrently.
+     *
+     * The instances are opened with Kvs::open on a small worker pool (at most one worker per
+     * hardware thread and four workers in total), e.g. to shorten the start-up of applications
+     * with many instances.
+     *
+     * @param instance_ids The instance IDs to open.
+     * @param need_defaults Defaults flag applied to all instances (see Kvs::open).
+     * @param need_kvs KVS flag applied to all instances (see Kvs::open).
+     * @param dir The directory path where the KVS files are located.
+     * @param options Additional options applied to all instances.
+     * @return One result per instance ID, in the order of instance_ids.
+     */
+    static std::vector<score::Result<Kvs>> open_many(const std::vector<InstanceId>& instance_ids,
+                                                     OpenNeedDefaults need_defaults,
+                                                     OpenNeedKvs need_kvs,
+                                                     const std::string& dir,
+                                                     const KvsOpenOptions& options = KvsOpenOptions{});
 
     /**
      * @brief Resets a key-value-storage to its initial state
@@ -268,7 +582,8 @@ class Kvs final
      *
      * @return A score::Result object that indicates the success or failure of the operation.
      *         - On success: Returns a blank score::Result.
-     *         - On failure: Returns an ErrorCode describing the error.
+     *         - On failure: Returns an ErrorCode describing the error. ErrorCode::InvalidArgument
+     *           is returned for the key `__kvs_delta__`, which is reserved for delta snapshots.
      */
     score::ResultBlank set_value(const std::string_view key, const KvsValue& value);
 
@@ -287,6 +602,10 @@ class Kvs final
      * @brief Flushes the key-value store, ensuring that all pending changes
      *        are written to the underlying storage.
      *
+     * For instances opened with KvsBuilder::scheduled_flush(), the flush is only queued in the
+     * KvsFlushScheduler and written within its I/O budget. Repeated calls before it was written
+     * are merged into one flush.
+     *
      * @return A score::Result object that indicates the success or failure of the operation.
      *         - On success: Returns a blank score::Result.
      *         - On failure: Returns an ErrorCode describing the error.
@@ -306,18 +625,101 @@ class Kvs final
      * @brief Retrieves the maximum number of snapshots that can be stored.
      *
      * This function returns the upper limit on the number of snapshots
-     * that the key-value store can maintain at any given time.
+     * that the key-value store can maintain at any given time. It is set per instance with
+     * KvsBuilder::snapshot_policy() and defaults to KVS_MAX_SNAPSHOTS.
      *
      * @return The maximum count of snapshots as a size_t value.
      */
     size_t snapshot_max_count() const;
 
+    /**
+     * @brief Retrieves the size and creation time of the existing snapshots.
+     *
+     * With KvsBuilder::manifest(), the metadata is read from the manifest without accessing the
+     * storage. Otherwise the files are probed on every call.
+     *
+     * @return The existing snapshots (including the current file as ID 0), ordered by ID, or an
+     * error code.
+     */
+    score::Result<std::vector<KvsSnapshotInfo>> snapshot_info() const;
+
+    /**
+     * @brief Returns the durability policy in effect for this Kvs object.
+     *
+     * The policy is selected with KvsBuilder::durability() and defaults to KvsDurability::Strict.
+     * With KvsDurability::GroupCommit, a successful flush() only guarantees that the data was
+     * handed to the OS; it reaches storage within the configured interval or byte limit.
+     */
+    const KvsDurabilityPolicy& durability_policy() const;
+
+    /**
+     * @brief Returns the I/O backend in use for this Kvs object.
+     *
+     * KvsIoBackend::IoUring is only in use if it was requested with KvsBuilder::io_backend() and
+     * the kernel supports it, otherwise the Kvs object falls back to KvsIoBackend::Posix.
+     */
+    KvsIoBackend active_io_backend() const;
+
+    /**
+     * @brief Returns the checksum algorithm of the hash files written by this Kvs object.
+     *
+     * The algorithm is selected with KvsBuilder::checksum() and defaults to KvsChecksum::Adler32.
+     * Hash files are always validated with the algorithm they were written with.
+     */
+    KvsChecksum checksum_algorithm() const;
+
+    /**
+     * @brief Returns the bytes written by this Kvs object since it was opened.
+     *
+     * Counts every written storage file (KVS, hash, snapshot, manifest and slot files). With
+     * KvsBuilder::aligned_writes(), the KVS file is overwritten within its preallocated extents,
+     * which shows as `allocated_bytes` staying unchanged over flushes.
+     */
+    KvsWriteStats write_stats() const;
+
+    /**
+     * @brief Returns the keys that failed their per-record checksum since the store was opened.
+     *
+     * Files written with KvsBuilder::record_checksums() carry a checksum per key. If such a file
+     * is damaged, only the affected keys are dropped and recovered from the newest snapshot that
+     * holds a valid copy, instead of failing the whole file. With lazy values, the records are
+     * verified on first access (or on the next flush) and corruption is reported from then on.
+     *
+     * @return The corrupted keys with the snapshot they were recovered from, or an error code.
+     */
+    score::Result<std::vector<KvsCorruptedRecord>> corrupted_records();
+
+    /**
+     * @brief Returns the verification state of the snapshots 1 to snapshot_max_count().
+     *
+     * The results are cached per snapshot file and remain valid when the rotation moves a
+     * snapshot to the next ID. A snapshot whose files were modified after its verification is
+     * reported as unverified. The results come from scrub_snapshots() or from the background
+     * scrubber (see KvsBuilder::scrubber()), this call does not read the snapshot data.
+     *
+     * @return The state of each snapshot, or an error code.
+     */
+    score::Result<std::vector<KvsSnapshotStatus>> snapshot_status();
+
+    /**
+     * @brief Verifies all snapshots against their hash files on the calling thread.
+     *
+     * The reads are not limited by the byte budget of the background scrubber.
+     *
+     * @return The state of each snapshot after the verification, see snapshot_status().
+     */
+    score::Result<std::vector<KvsSnapshotStatus>> scrub_snapshots();
+
     /**
      * @brief Restores the state of the key-value store from a specified snapshot.
      *
      * This function attempts to restore the key-value store to the state
      * captured in the snapshot identified by the given snapshot ID. If the
      * restoration process fails, an appropriate error code is returned.
+     * A snapshot that was verified within KvsScrubPolicy::max_age and not modified since then is
+     * parsed without hashing it again. With KvsBuilder::snapshot_cache(), recently flushed versions
+     * are restored from memory without accessing the storage. Delta snapshots (see
+     * KvsBuilder::delta_snapshots()) are reconstructed from the current file and all newer snapshots.
      *
      * @param snapshot_id The identifier of the snapshot to restore from.
      * @return score::ResultBlank
@@ -326,6 +728,33 @@ class Kvs final
      */
     score::ResultBlank snapshot_restore(const SnapshotId& snapshot_id);
 
+    /**
+     * @brief Compares two snapshots of the main file key by key.
+     *
+     * Both snapshots are read from storage and verified against their hash files, snapshot ID 0
+     * is the current KVS file. The files are only indexed, the values of a key are compared by
+     * their JSON text and only decoded if the text differs, to confirm the change. Delta
+     * snapshots (see KvsBuilder::delta_snapshots()) are reconstructed and compared value by value.
+     * Keys owned by scopes are not compared.
+     *
+     * @param from The source snapshot, e.g. the one a rollback would restore.
+     * @param to The target snapshot.
+     * @param visitor Called for every added, removed or changed key while the snapshots are
+     *                compared. It must not access this Kvs object.
+     * @return score::ResultBlank
+     *         - On success: An empty score::Result, all changes were visited.
+     *         - On failure: An error code, the visitor may have been called for some keys.
+     */
+    score::ResultBlank snapshot_diff(const SnapshotId& from, const SnapshotId& to, const KvsDiffVisitor& visitor);
+
+    /**
+     * @brief Compares two snapshots of the main file key by key, see snapshot_diff(const SnapshotId&,
+     * const SnapshotId&, const KvsDiffVisitor&).
+     *
+     * @return The added, removed and changed keys, or an error code.
+     */
+    score::Result<KvsSnapshotDiff> snapshot_diff(const SnapshotId& from, const SnapshotId& to);
+
     /**
      * @brief Retrieves the filename associated with a given snapshot ID in the key-value store.
      *
@@ -352,7 +781,102 @@ class Kvs final
      */
     score::Result<score::filesystem::Path> get_hash_filename(const SnapshotId& snapshot_id) const;
 
+    /**
+     * @brief Returns a namespaced sub-view of the key-value store.
+     *
+     * All keys accessed through the returned KvsScope are prefixed with `prefix`. Keys owned by
+     * a scope are persisted in a separate storage segment (`kvs_<id>_scope_<name>_0.json`) with
+     * its own hash file, so `KvsScope::flush()` only rewrites that segment and `flush()` only
+     * rewrites segments of scopes that were modified since their last flush. The main file is not
+     * rewritten if only segments were modified. The snapshots of the segments rotate with the main
+     * file, so a snapshot ID restores the main file and all segments at the same point in time.
+     * If several scopes match a key, the scope with the longest prefix owns it.
+     *
+     * The segments found in the storage directory are loaded when the KVS is opened. Keys with the
+     * prefix that are still stored in the main file are migrated into the segment on the next
+     * flush.
+     *
+     * @param prefix The key prefix of the scope (e.g. "calib."). Must not be empty.
+     * @return score::Result<KvsScope>
+     *         - On success: A handle to the scope. The handle must not outlive this Kvs object.
+     *         - On failure: An ErrorCode describing the reason for the failure.
+     */
+    score::Result<KvsScope> scope(const std::string_view prefix);
+
+    /**
+     * @brief Creates a precompiled handle for a key.
+     *
+     * The key is interned in the Kvs object and the handle caches the storage slot of the
+     * written value and of the default value. get_value(const KeyHandle&) and
+     * set_value(const KeyHandle&, const KvsValue&) go straight to the cached slot without
+     * building a string, hashing or probing the maps again. The cached slots are revalidated
+     * automatically after operations that may invalidate them (e.g. reset(), remove_key() or
+     * snapshot_restore()).
+     *
+     * @param key The key to create a handle for.
+     * @return score::Result<KeyHandle>
+     *         - On success: The handle. It is only valid for this Kvs object and must not be used
+     *           after the Kvs object was moved or destroyed.
+     *         - On failure: An ErrorCode describing the reason for the failure, see set_value()
+     *           for the reserved key.
+     */
+    score::Result<KeyHandle> key(const std::string_view key);
+
+    /**
+     * @brief Retrieves the value of a precompiled key. See get_value(const std::string_view).
+     *
+     * @param handle Handle created by key() of this Kvs object.
+     * @return A score::Result object containing either the retrieved value (KvsValue) or an
+     * ErrorCode if the operation fails. ErrorCode::InvalidArgument is returned for handles of
+     * another Kvs object.
+     */
+    score::Result<KvsValue> get_value(const KeyHandle& handle);
+
+    /**
+     * @brief Stores a value for a precompiled key. See set_value(const std::string_view, const KvsValue&).
+     *
+     * @param handle Handle created by key() of this Kvs object.
+     * @param value The value to be stored.
+     * @return A score::Result object that indicates the success or failure of the operation.
+     *         ErrorCode::InvalidArgument is returned for handles of another Kvs object.
+     */
+    score::ResultBlank set_value(const KeyHandle& handle, const KvsValue& value);
+
   private:
+    friend class KvsScope;
+    friend class KvsGroup;
+    friend class KvsFlushScheduler;
+    friend class KeyHandle;
+
+    /* State of a registered scope */
+    struct ScopeState
+    {
+        score::filesystem::Path filename_prefix; /* Filename prefix of the scope segment */
+        bool dirty;                              /* Segment modified since last flush */
+    };
+
+    /* Rotation of the snapshot files of a storage segment on flush */
+    enum class SnapshotRotation
+    {
+        None = 0,     /* Snapshots disabled, the current file is overwritten */
+        Replaced = 1, /* The current file replaced snapshot 1, older snapshots were kept */
+        Shifted = 2   /* All snapshots moved to the next ID */
+    };
+    struct RotationOutcome
+    {
+        SnapshotRotation rotation = SnapshotRotation::None;
+        size_t kept = 0U; /* Snapshots 1 to kept may exist after the byte budget was applied */
+    };
+
+    /* Contents of a JSON file and its hash file, read before open_json */
+    struct JsonFileContents
+    {
+        bool json_found = false;
+        std::string json;
+        bool hash_found = false;
+        std::string hash;
+    };
+
     /* Private constructor to prevent direct instantiation */
     Kvs();
 
@@ -361,11 +885,112 @@ class Kvs final
     std::unordered_map<std::string, KvsValue> kvs;
 
     /* Optional default values */
-    std::unordered_map<std::string, KvsValue> default_values;
+    FrozenKvsMap default_values;
+
+    /* Registered scopes, indexed by key prefix (guarded by kvs_mutex) */
+    std::unordered_map<std::string, ScopeState> scopes;
+
+    /* Main file modified since the last flush (guarded by kvs_mutex) */
+    bool main_dirty;
+
+    /* Lazily decoded values: verbatim member and value text in the retained file (guarded by kvs_mutex) */
+    struct RawValue
+    {
+        std::string_view member; /* `"key": value`, re-emitted on flush */
+        std::string_view value;  /* Decoded on first access */
+        uint64_t digest = 0U;    /* Record checksum of member */
+        bool verify = false;     /* Record checksum not verified yet */
+    };
+    std::unordered_map<std::string, RawValue> raw_values;
+    std::shared_ptr<const std::string> raw_buffer;
+    KvsChecksum raw_checksum;
+
+    /* Per-record checksums (written and found corrupted, guarded by kvs_mutex) */
+    bool record_checksums;
+    std::vector<KvsCorruptedRecord> corrupted;
+
+    /* Precompiled key handling (guarded by kvs_mutex) */
+    std::unordered_set<std::string> interned_keys;
+    uint64_t key_generation;
+
+    /* Files written by the last flush with deferred syncs, until the shared barrier completed
+     * (guarded by kvs_mutex) */
+    struct DeferredFlush
+    {
+        bool main = false;               /* Main file written */
+        std::vector<std::string> scopes; /* Prefixes of the written scope segments */
+        bool renamed = false;            /* Files replaced by a rename, their directory needs a sync */
+        bool manifest = false;           /* Manifest file not written yet */
+    };
+    DeferredFlush deferred_flush;
 
     /* Filename prefix */
     score::filesystem::Path filename_prefix;
 
+    /* Durability of written files, set by the GroupCommitter if a batched sync failed */
+    KvsDurabilityPolicy durability;
+    std::shared_ptr<std::atomic<bool>> group_commit_failed;
+
+    /* I/O backend in use */
+    KvsIoBackend io_backend;
+
+    /* Checksum algorithm of written hash files */
+    KvsChecksum checksum;
+
+    /* Flushed versions kept for snapshot_restore (guarded by kvs_mutex) */
+    struct CachedVersion
+    {
+        std::shared_ptr<const std::unordered_map<std::string, KvsValue>> data;
+        size_t bytes; /* Serialized size, used as memory estimate */
+    };
+    std::deque<CachedVersion> cached_versions;
+    KvsSnapshotCachePolicy snapshot_cache;
+
+    /* Retention of the snapshots */
+    KvsSnapshotPolicy snapshot_policy;
+
+    /* Snapshot manifest of the main file, entry n is snapshot n (guarded by manifest_mutex) */
+    bool use_manifest;
+    mutable std::mutex manifest_mutex;
+    std::vector<ManifestEntry> manifest;
+
+    /* Compression of written files */
+    KvsCompression compression;
+
+    /* Delta snapshots, base is the contents of the current file (guarded by kvs_mutex) */
+    bool delta_snapshots;
+    std::shared_ptr<const std::unordered_map<std::string, KvsValue>> delta_base;
+
+    /* Text of the current file with KvsCompression::Snapshots, compressed when the rotation makes it
+     * snapshot 1 instead of reading it back (guarded by kvs_mutex) */
+    std::shared_ptr<const std::string> current_text;
+
+    /* A/B slot files of the main file (guarded by slot_mutex, which also serializes slot writes).
+     * A slot or container half written with a deferred sync is activated after the shared barrier. */
+    mutable std::mutex slot_mutex;
+    std::unique_ptr<SlotStore> slots;
+    bool slot_commit_pending;
+
+    /* Container of the main file (writes serialized by slot_mutex) */
+    std::shared_ptr<KvsContainer> container;
+    uint64_t container_key;
+
+    /* Preallocated, block-aligned writes of the KVS files */
+    KvsAlignedWritePolicy aligned_writes;
+
+    /* flush() is queued in the KvsFlushScheduler with this priority */
+    bool scheduled_flush;
+    KvsFlushClass flush_class;
+
+    /* Bytes written since open (guarded by write_stats_mutex) */
+    mutable std::mutex write_stats_mutex;
+    KvsWriteStats write_totals;
+
+    /* Snapshot verification */
+    std::shared_ptr<ScrubCache> scrub_cache;
+    std::unique_ptr<SnapshotScrubber> scrubber;
+    std::chrono::milliseconds scrub_max_age;
+
     /* Filesystem handling */
     std::unique_ptr<score::filesystem::Filesystem> filesystem;
 
@@ -377,12 +1002,100 @@ class Kvs final
     std::unique_ptr<score::mw::log::Logger> logger;
 
     /* Private Methods */
-    score::ResultBlank snapshot_rotate();
-    score::Result<std::unordered_map<std::string, KvsValue>> parse_json_data(const std::string& data);
-    score::Result<std::unordered_map<std::string, KvsValue>> open_json(const score::filesystem::Path& prefix,
-                                                                       OpenJsonNeedFile need_file);
+    score::ResultBlank snapshot_rotate(RotationOutcome* outcome = nullptr);
+    score::ResultBlank rotate_files(const score::filesystem::Path& prefix,
+                                    RotationOutcome* outcome = nullptr,
+                                    const RotationOutcome* follow = nullptr);
+    size_t prune_snapshots(const score::filesystem::Path& prefix);
+    void trim_segment_snapshots(const score::filesystem::Path& prefix, size_t kept);
+    std::optional<size_t> find_segment_file(const score::filesystem::Path& prefix, size_t snapshot_id) const;
+    score::Result<std::unordered_map<std::string, KvsValue>> parse_json_data(
+        const std::string& data,
+        score::json::IJsonParser* json_parser = nullptr);
+    score::Result<std::unordered_map<std::string, KvsValue>> open_json(
+        const score::filesystem::Path& prefix,
+        OpenJsonNeedFile need_file,
+        const JsonFileContents* contents = nullptr,
+        bool lazy = false,
+        std::vector<std::string>* corrupted_keys = nullptr,
+        bool verified = false,
+        score::json::IJsonParser* json_parser = nullptr);
+    score::Result<std::unordered_map<std::string, KvsValue>> parse_json_records(
+        const std::string& data,
+        const HashFileInfo& hash_info,
+        std::vector<std::string>& corrupted_keys);
+    size_t recover_records(const score::filesystem::Path& prefix,
+                           const std::vector<std::string>& keys,
+                           std::unordered_map<std::string, KvsValue>& target);
+    void verify_raw_values();
+    void cache_version(std::shared_ptr<const std::unordered_map<std::string, KvsValue>> data,
+                       size_t bytes,
+                       const RotationOutcome& outcome);
     score::ResultBlank write_json_data(const std::string& buf);
-    score::ResultBlank write_and_sync(const std::string& path, const void* data, std::size_t size);
+    score::ResultBlank write_json_data(const score::filesystem::Path& prefix,
+                                       const std::string& buf,
+                                       std::vector<int>* deferred_fds = nullptr,
+                                       ManifestEntry* written = nullptr);
+    ManifestEntry probe_manifest_entry(size_t snapshot_id) const;
+    std::vector<ManifestEntry> probe_manifest() const;
+    void load_manifest();
+    void update_manifest(const ManifestEntry* written,
+                         const RotationOutcome& outcome,
+                         const ManifestEntry* replaced = nullptr);
+    score::ResultBlank write_manifest();
+    score::Result<std::string> get_delta_buffer(const std::unordered_map<std::string, KvsValue>& delta);
+    score::Result<std::string> read_plain_snapshot(const std::string& prefix);
+    score::ResultBlank replace_snapshot(const std::string& buf, ManifestEntry* written);
+    score::Result<std::unordered_map<std::string, KvsValue>> load_delta_snapshot(
+        size_t snapshot_id,
+        std::unordered_map<std::string, KvsValue>&& data);
+    score::Result<std::unordered_map<std::string, KvsValue>> open_snapshot(size_t snapshot_id);
+    score::Result<std::unordered_map<std::string, KvsValue>> load_snapshot_image(size_t snapshot_id);
+    score::Result<std::string> read_snapshot_text(size_t snapshot_id);
+    score::ResultBlank diff_snapshot_images(size_t from, size_t to, const KvsDiffVisitor& visitor);
+    score::ResultBlank diff_snapshot_members(const std::vector<JsonMemberRange>& from_members,
+                                             const std::vector<JsonMemberRange>& to_members,
+                                             const KvsDiffVisitor& visitor);
+    score::Result<bool> json_values_equal(std::string_view lhs, std::string_view rhs);
+    score::Result<score::json::Object> collect_json_object(const ScopeState* owner,
+                                                           std::vector<std::string_view>* raw_members = nullptr);
+    score::Result<KvsValue*> decode_raw_value(const std::string& key);
+    score::ResultBlank decode_raw_values(const std::string_view prefix);
+    bool drop_raw_value(const std::string& key);
+    ScopeState* find_scope(const std::string_view key);
+    void mark_dirty(const std::string_view key);
+    score::ResultBlank flush_scope(const std::string& prefix, std::vector<int>* deferred_fds = nullptr);
+    score::ResultBlank flush_files(std::vector<int>* deferred_fds);
+    score::ResultBlank complete_deferred_flush(bool synced);
+    score::Result<bool> is_dirty();
+    score::ResultBlank restore_scopes(const SnapshotId& snapshot_id, std::unordered_map<std::string, KvsValue>&& data);
+    score::ResultBlank open_scopes();
+    std::unique_lock<std::mutex> lock_instance();
+    score::ResultBlank load_scope(const std::string& prefix);
+    score::ResultBlank write_and_sync(const std::string& path,
+                                      const void* data,
+                                      std::size_t size,
+                                      std::vector<int>* deferred_fds = nullptr);
+    score::ResultBlank sync_written(int file_fd,
+                                    const std::string& path,
+                                    std::size_t size,
+                                    std::vector<int>* deferred_fds);
+    score::ResultBlank write_slot(const std::string& buf, std::vector<int>* deferred_fds);
+    score::ResultBlank write_container(const std::string& buf, std::vector<int>* deferred_fds);
+    score::ResultBlank write_in_place(const std::string& path,
+                                      const std::string& data,
+                                      std::size_t logical_size,
+                                      std::vector<int>* deferred_fds);
+    std::size_t aligned_file_size(const std::string& path, std::size_t size) const;
+    void count_write(std::size_t logical_size, std::size_t size, std::size_t block_size, uint64_t allocated);
+    bool write_json_files_uring(const score::filesystem::Path& prefix,
+                                const std::string& buf,
+                                const std::vector<uint8_t>& hash_bytes,
+                                score::ResultBlank& result);
+    score::ResultBlank resolve_key(const KeyHandle& handle);
+    static score::Result<FrozenKvsMap> load_defaults_image(const KvsDefaultsImage& image);
+    static bool read_json_files_uring(const std::vector<score::filesystem::Path>& prefixes,
+                                      std::vector<JsonFileContents>& contents);
 };
 
 } /* namespace score::mw::per::kvs */
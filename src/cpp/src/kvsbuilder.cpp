@@ -42,6 +42,104 @@ KvsBuilder& KvsBuilder::dir(std::string&& dir_path)
     return *this;
 }
 
+KvsBuilder& KvsBuilder::defaults_from_image(const KvsDefaultsImage& image)
+{
+    options.defaults_image = &image;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::durability(const KvsDurabilityPolicy& policy)
+{
+    options.durability = policy;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::io_backend(KvsIoBackend backend)
+{
+    options.io_backend = backend;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::lazy_values(bool flag)
+{
+    options.lazy_values = flag;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::checksum(KvsChecksum algorithm)
+{
+    options.checksum = algorithm;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::record_checksums(bool flag)
+{
+    options.record_checksums = flag;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::scrubber(const KvsScrubPolicy& policy)
+{
+    options.scrub = true;
+    options.scrub_policy = policy;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::snapshot_cache(const KvsSnapshotCachePolicy& policy)
+{
+    options.snapshot_cache = policy;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::manifest(bool flag)
+{
+    options.manifest = flag;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::snapshot_policy(const KvsSnapshotPolicy& policy)
+{
+    options.snapshot_policy = policy;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::delta_snapshots(bool flag)
+{
+    options.delta_snapshots = flag;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::compression(KvsCompression mode)
+{
+    options.compression = mode;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::slots(const KvsSlotPolicy& policy)
+{
+    options.slots = policy;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::aligned_writes(const KvsAlignedWritePolicy& policy)
+{
+    options.aligned_writes = policy;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::scheduled_flush(KvsFlushClass flush_class)
+{
+    options.scheduled_flush = true;
+    options.flush_class = flush_class;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::container(std::shared_ptr<KvsContainer> container)
+{
+    options.container = std::move(container);
+    return *this;
+}
+
 score::Result<Kvs> KvsBuilder::build()
 {
     score::Result<Kvs> result = score::MakeUnexpected(ErrorCode::UnmappedError);
@@ -55,7 +153,8 @@ score::Result<Kvs> KvsBuilder::build()
     result = Kvs::open(instance_id,
                        need_defaults ? OpenNeedDefaults::Required : OpenNeedDefaults::Optional,
                        need_kvs ? OpenNeedKvs::Required : OpenNeedKvs::Optional,
-                       std::move(directory));
+                       std::move(directory),
+                       options);
 
     return result;
 }
@@ -14,6 +14,11 @@
 #define SCORE_LIB_KVS_KVSBUILDER_HPP
 
 #include "kvs.hpp"
+#include "kvscontainer.hpp"
+#include "kvsflushscheduler.hpp"
+#include "kvsgroup.hpp"
+#include "kvsscope.hpp"
+#include "typedkvs.hpp"
 #include <string>
 
 namespace score::mw::per::kvs
@@ -89,6 +94,195 @@ class KvsBuilder final
      */
     KvsBuilder& dir(std::string&& dir_path);
 
+    /**
+     * @brief Use default values compiled into the binary instead of the defaults file.
+     * @param image Defaults image generated by the `kvs_defaults_library` Bazel rule. The image
+     * must have static storage duration, as generated images do: it is converted on the first
+     * open and the frozen defaults are cached per image address for the lifetime of the process.
+     * The defaults file is not read and need_defaults_flag() has no effect.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& defaults_from_image(const KvsDefaultsImage& image);
+
+    /**
+     * @brief Select how written files are synced to storage.
+     * @param policy KvsDurability::Strict (default) syncs every file on flush,
+     * KvsDurability::GroupCommit batches syncs of all instances in the process and
+     * KvsDurability::None never syncs (e.g. for stores on tmpfs or data that may be lost).
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& durability(const KvsDurabilityPolicy& policy);
+
+    /**
+     * @brief Select the I/O backend for flush and open.
+     * @param backend KvsIoBackend::IoUring submits the snapshot rotation, the writes and the syncs
+     * of a flush as linked io_uring requests and reads all files at open concurrently. It is only
+     * used if the kernel supports it, otherwise KvsIoBackend::Posix (default) is used.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& io_backend(KvsIoBackend backend);
+
+    /**
+     * @brief Decode the values of the KVS file on first access instead of at open.
+     * @param flag If true, open only validates the hash and indexes the keys of the KVS file.
+     * Each value is decoded on its first read, values that were never touched are written back
+     * verbatim on flush. Recommended for large stores of which only a few keys are read per run.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& lazy_values(bool flag);
+
+    /**
+     * @brief Select the checksum algorithm of written hash files.
+     * @param algorithm KvsChecksum::Adler32 (default) writes the legacy 4-byte hash file,
+     * KvsChecksum::Crc32c (hardware accelerated) and KvsChecksum::XxHash64 write a tagged hash
+     * file. Existing files are validated with the algorithm they are tagged with, so the algorithm
+     * of a store can be changed between runs.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& checksum(KvsChecksum algorithm);
+
+    /**
+     * @brief Write a checksum per key into the hash files.
+     * @param flag If true, the hash file also lists a checksum of every key-value record. A damaged
+     * KVS file then only loses the damaged records, which are recovered from the newest snapshot
+     * holding a valid copy (see Kvs::corrupted_records()). Files are read back either way.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& record_checksums(bool flag);
+
+    /**
+     * @brief Verify the snapshots in the background.
+     * @param policy Pause between the verification passes and their read budget in bytes per
+     * second. Results are available through Kvs::snapshot_status(), and Kvs::snapshot_restore()
+     * only parses a snapshot that was verified within policy.max_age.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& scrubber(const KvsScrubPolicy& policy);
+
+    /**
+     * @brief Keep recently flushed versions in memory for Kvs::snapshot_restore().
+     * @param policy Number of snapshots restorable from memory and the memory budget, which is
+     * estimated from the serialized size of the versions. A cached snapshot is restored without
+     * reading, hashing and parsing its file. Flushes without changes share the previous version.
+     * Stores with lazily decoded values or scopes are restored from storage.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& snapshot_cache(const KvsSnapshotCachePolicy& policy);
+
+    /**
+     * @brief Keep a manifest of the snapshots (`kvs_<id>.manifest`).
+     * @param flag If true, the snapshots are listed with their size, checksum and creation time in
+     * a checksummed manifest that is loaded at open and replaced atomically on flush.
+     * Kvs::snapshot_count(), Kvs::get_kvs_filename(), Kvs::get_hash_filename() and
+     * Kvs::snapshot_info() are then answered from memory. A manifest that does not match the
+     * current KVS file is rebuilt from the files at open.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& manifest(bool flag);
+
+    /**
+     * @brief Configure the retention of the snapshots.
+     * @param policy Maximum number of snapshots (0 disables them), total size of the snapshot
+     * files and minimum age difference of the older snapshots (snapshot 1 is always the previous
+     * flush). Without snapshots, the KVS file is overwritten in place: a flush interrupted by a
+     * power loss can then leave no valid file.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& snapshot_policy(const KvsSnapshotPolicy& policy);
+
+    /**
+     * @brief Store the snapshots as reverse deltas.
+     * @param flag If true, snapshot 1 is rewritten on flush to contain only the values that differ
+     * from the current file, and every older snapshot only the values that differ from the next
+     * newer one. Unchanged large values are then stored once instead of once per snapshot.
+     * Kvs::snapshot_restore() reconstructs a delta snapshot from the current file and all newer
+     * snapshots. The contents of the current file are kept in memory as base (not with
+     * lazy_values() until the first flush), and snapshots always move on flush, so
+     * KvsSnapshotPolicy::min_interval is not applied. The key `__kvs_delta__` is reserved.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& delta_snapshots(bool flag);
+
+    /**
+     * @brief Compress the written storage files.
+     * @param mode KvsCompression::Snapshots compresses snapshot 1 after each flush, so the current
+     * file is still opened without decompression. KvsCompression::All also writes the current file
+     * compressed. The JSON text is compressed with a built-in LZ block codec, typically 5-10x, and
+     * the hash files cover the compressed bytes, so verification reads less data. Compressed files
+     * are recognized by their header and read in every mode.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& compression(KvsCompression mode);
+
+    /**
+     * @brief Persist the KVS file in two preallocated slot files written alternately in place.
+     * @param policy Capacity of each slot file, 0 (default) writes rotating JSON and hash files.
+     *
+     * Each slot starts with a sequence number and a digest (in the checksum() algorithm), open
+     * reads the newest slot with a matching digest, so a torn write falls back to the previous
+     * data. A flush is then a single write and sync of one file, without creating, renaming or
+     * resizing files (unless the data outgrows the capacity). Slot mode keeps no snapshots, which
+     * overrides snapshot_policy(), snapshot_cache(), manifest() and delta_snapshots(). An existing
+     * KVS file is read until the first flush writes a slot. Scope segments are still JSON files.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& slots(const KvsSlotPolicy& policy);
+
+    /**
+     * @brief Overwrite the KVS files in place within preallocated, block-aligned extents.
+     * @param policy Block size and preallocation, a block size of 0 (default) truncates and
+     *               rewrites the files on every flush.
+     *
+     * The KVS file is padded with JSON whitespace to a multiple of the block size (use the page
+     * or erase block size) and written over its previous contents without truncating it, so the
+     * filesystem keeps its extents and, within the preallocation, its size. The snapshot file
+     * dropped by the rotation is recycled as the next KVS file. The padding is covered by the
+     * hash file. Files compressed with KvsCompression::All are written as before. The effect is
+     * reported by Kvs::write_stats().
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& aligned_writes(const KvsAlignedWritePolicy& policy);
+
+    /**
+     * @brief Queue flush() in the process-wide KvsFlushScheduler instead of writing right away.
+     * @param flush_class Priority of the instance among the pending flushes.
+     *
+     * The scheduler writes the flush within its I/O budget, see KvsFlushScheduler. flush() then
+     * returns once the flush is queued, errors of the write are counted in
+     * KvsFlushScheduler::stats(). Use it for instances that are flushed opportunistically.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& scheduled_flush(KvsFlushClass flush_class);
+
+    /**
+     * @brief Store the KVS file, and the defaults file if set there, in a container file shared
+     *        with other instances.
+     * @param container Container opened with KvsContainer::open(), nullptr (default) writes the
+     *        files of the instance.
+     *
+     * The KVS file is a segment of the container written alternately in place like slots(), so
+     * the same restrictions apply: no snapshots, and an existing KVS file is read until the first
+     * flush. Ignored if slots() is set.
+     *
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& container(std::shared_ptr<KvsContainer> container);
+
     /**
      * @brief Builds and opens the Kvs instance with the configured options.
      *
@@ -103,6 +297,7 @@ class KvsBuilder final
     bool need_defaults;      ///< Whether default values are required
     bool need_kvs;           ///< Whether an existing KVS is required
     std::string directory;   ///< Directory where to store the KVS Files
+    KvsOpenOptions options;  ///< Additional options passed to Kvs::open
 };
 
 } /* namespace score::mw::per::kvs */
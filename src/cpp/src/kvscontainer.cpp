@@ -0,0 +1,341 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "kvscontainer.hpp"
+#include "internal/kvs_helper.hpp"
+#include <fcntl.h>     // open(), posix_fallocate()
+#include <sys/stat.h>  // fstat()
+#include <sys/uio.h>   // pwritev()
+#include <unistd.h>    // pread(), fdatasync(), close()
+#include <algorithm>
+#include <array>
+
+namespace score::mw::per::kvs
+{
+
+/*********************** KVS Container Implementation *********************/
+score::Result<std::shared_ptr<KvsContainer>> KvsContainer::open(const std::string& path,
+                                                                const KvsContainerPolicy& policy)
+{
+    score::Result<std::shared_ptr<KvsContainer>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    /* Private constructor, make_shared is not possible */
+    std::shared_ptr<KvsContainer> container(new KvsContainer());
+    container->file_path = path;
+    container->policy = policy;
+    container->file_end = 2U * CONTAINER_DIRECTORY_SIZE;
+    container->fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (container->fd < 0)
+    {
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+    else
+    {
+        auto read_res = container->read_file();
+        if (read_res)
+        {
+            result = std::move(container);
+        }
+        else
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*read_res.error()));
+        }
+    }
+
+    return result;
+}
+
+KvsContainer::~KvsContainer()
+{
+    if (fd >= 0)
+    {
+        (void)::close(fd);
+    }
+}
+
+const std::string& KvsContainer::path() const
+{
+    return file_path;
+}
+
+std::size_t KvsContainer::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return order.size();
+}
+
+score::ResultBlank KvsContainer::set_defaults(const InstanceId& instance_id, const std::string& json)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    const uint64_t key = segment_key(instance_id, true);
+    const int file_fd = write(key, json, policy.checksum);
+    if ((file_fd >= 0) && (::fdatasync(file_fd) == 0))
+    {
+        commit(key);
+        result = score::ResultBlank{};
+    }
+
+    return result;
+}
+
+uint64_t KvsContainer::segment_key(const InstanceId& instance_id, bool defaults)
+{
+    return (static_cast<uint64_t>(instance_id.id) << 1U) | (defaults ? 1U : 0U);
+}
+
+/* Read the whole file at open: the newest valid directory and the active half of every segment */
+score::ResultBlank KvsContainer::read_file()
+{
+    score::ResultBlank result = score::ResultBlank{};
+    struct stat info = {};
+    std::string bytes;
+    bool read = (::fstat(fd, &info) == 0);
+    if (read)
+    {
+        bytes.resize(static_cast<std::size_t>(info.st_size));
+        std::size_t pos = 0U;
+        while (read && (pos < bytes.size()))
+        {
+            const ssize_t count = ::pread(fd, bytes.data() + pos, bytes.size() - pos, static_cast<off_t>(pos));
+            read = (count > 0);
+            pos += read ? static_cast<std::size_t>(count) : 0U;
+        }
+    }
+
+    if (!read)
+    {
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+    else if (bytes.empty())
+    {
+        /* New container, the directory is written with the first segment */
+        if (::posix_fallocate(fd, 0, static_cast<off_t>(file_end)) != 0)
+        {
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+    }
+    else
+    {
+        bool found = false;
+        bool damaged = false;
+        std::string directory;
+        for (std::size_t idx = 0U; idx < 2U; ++idx)
+        {
+            const std::size_t start = std::min(bytes.size(), idx * CONTAINER_DIRECTORY_SIZE);
+            const std::string half = bytes.substr(start, CONTAINER_DIRECTORY_SIZE);
+            const auto header = parse_slot(half);
+            if (header.has_value() && (!found || (header->sequence > directory_sequence)))
+            {
+                found = true;
+                directory_active = idx;
+                directory_sequence = header->sequence;
+                directory = half.substr(SLOT_HEADER_SIZE, static_cast<std::size_t>(header->size));
+            }
+            else if (!header.has_value() && !is_empty_slot(half))
+            {
+                damaged = true;
+            }
+        }
+
+        std::vector<ContainerEntry> entries;
+        if ((!found && damaged) || (found && !parse_container_directory(directory, entries)))
+        {
+            result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+        }
+        else
+        {
+            for (const auto& entry : entries)
+            {
+                Segment& segment = segments[entry.key];
+                segment.offset = entry.offset;
+                segment.capacity = entry.capacity;
+                load_segment(segment, bytes);
+                order.push_back(entry.key);
+                file_end = std::max(file_end, entry.offset + (2U * entry.capacity));
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Select the newest valid half of a segment in the container contents */
+void KvsContainer::load_segment(Segment& segment, const std::string& bytes) const
+{
+    bool found = false;
+    bool damaged = false;
+    for (std::size_t idx = 0U; idx < 2U; ++idx)
+    {
+        const uint64_t start = segment.offset + (idx * segment.capacity);
+        const std::string half = (start < bytes.size())
+                                     ? bytes.substr(static_cast<std::size_t>(start),
+                                                    static_cast<std::size_t>(segment.capacity))
+                                     : std::string();
+        const auto header = parse_slot(half);
+        if (header.has_value() && (!found || (header->sequence > segment.sequence)))
+        {
+            found = true;
+            segment.active = idx;
+            segment.sequence = header->sequence;
+            segment.payload = half.substr(SLOT_HEADER_SIZE, static_cast<std::size_t>(header->size));
+        }
+        else if (!header.has_value() && !is_empty_slot(half))
+        {
+            damaged = true;
+        }
+    }
+    segment.cached = found;
+    /* A damaged half next to a valid one is an interrupted write of the newer data */
+    segment.state = found ? LoadState::Valid : (damaged ? LoadState::Corrupted : LoadState::Empty);
+}
+
+KvsContainer::LoadState KvsContainer::load(uint64_t key, std::string& payload)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    LoadState result = LoadState::Empty;
+    auto it = segments.find(key);
+    if (it != segments.end())
+    {
+        Segment& segment = it->second;
+        if (!segment.cached)
+        {
+            /* Written or taken since open, the segment is read again at offset 0 of a buffer */
+            std::string bytes(static_cast<std::size_t>(2U * segment.capacity), '\0');
+            const ssize_t count = ::pread(fd, bytes.data(), bytes.size(), static_cast<off_t>(segment.offset));
+            bytes.resize(static_cast<std::size_t>(std::max<ssize_t>(count, 0)));
+            const uint64_t offset = segment.offset;
+            segment.offset = 0U;
+            load_segment(segment, bytes);
+            segment.offset = offset;
+        }
+        result = segment.state;
+        payload = std::move(segment.payload);
+        segment.payload.clear();
+        segment.cached = false;
+    }
+
+    return result;
+}
+
+/* Write a slot header and the payload at a file position with a single write call */
+bool KvsContainer::write_half(uint64_t position, const std::string& payload, uint64_t sequence, KvsChecksum algorithm)
+{
+    std::vector<uint8_t> header = get_slot_header(payload, sequence, algorithm);
+    std::array<struct iovec, 2> iov{{{header.data(), header.size()},
+                                     {const_cast<char*>(payload.data()), payload.size()}}};
+    const ssize_t written = ::pwritev(fd, iov.data(), static_cast<int>(iov.size()), static_cast<off_t>(position));
+
+    return written == static_cast<ssize_t>(header.size() + payload.size());
+}
+
+/* Write the directory into the inactive directory half and sync it. It only becomes the active
+ * half once it is synced, so a failed sync never lets the next relocation overwrite the last
+ * synced directory. */
+bool KvsContainer::write_directory(const std::vector<ContainerEntry>& entries)
+{
+    const std::string payload = get_container_directory(entries);
+    const std::size_t target = 1U - directory_active;
+    const bool written =
+        ((SLOT_HEADER_SIZE + payload.size()) <= CONTAINER_DIRECTORY_SIZE) &&
+        write_half(target * CONTAINER_DIRECTORY_SIZE, payload, directory_sequence + 1U, policy.checksum) &&
+        (::fdatasync(fd) == 0);
+    if (written)
+    {
+        directory_active = target;
+        ++directory_sequence;
+    }
+
+    return written;
+}
+
+/* Write a segment into its inactive half without syncing it, see SlotStore::write(). A new
+ * segment, or one that outgrew its capacity, is placed at the end of the file: its data is
+ * synced before the directory points to it, and the directory is synced before it is used.
+ * Returns the container descriptor, -1 on failure. */
+int KvsContainer::write(uint64_t key, const std::string& payload, KvsChecksum algorithm)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int result = -1;
+    const uint64_t needed = SLOT_HEADER_SIZE + payload.size();
+    auto it = segments.find(key);
+    if ((it != segments.end()) && (needed <= it->second.capacity))
+    {
+        Segment& segment = it->second;
+        const std::size_t target = 1U - segment.active;
+        const bool written =
+            write_half(segment.offset + (target * segment.capacity), payload, segment.sequence + 1U, algorithm);
+        result = written ? fd : -1;
+    }
+    else
+    {
+        const uint64_t block = CONTAINER_DIRECTORY_SIZE;
+        const uint64_t capacity =
+            ((std::max<uint64_t>(policy.segment_capacity, 2U * needed) + block - 1U) / block) * block;
+        const uint64_t offset = file_end;
+        const uint64_t sequence = (it != segments.end()) ? it->second.sequence : 0U;
+        std::vector<ContainerEntry> entries;
+        for (const uint64_t existing : order)
+        {
+            const Segment& segment = segments.at(existing);
+            entries.push_back(ContainerEntry{existing, segment.offset, segment.capacity});
+        }
+        auto entry = std::find_if(entries.begin(), entries.end(), [key](const ContainerEntry& candidate) {
+            return candidate.key == key;
+        });
+        if (entry == entries.end())
+        {
+            entries.push_back(ContainerEntry{key, offset, capacity});
+        }
+        else
+        {
+            *entry = ContainerEntry{key, offset, capacity};
+        }
+
+        const bool placed =
+            (::posix_fallocate(fd, static_cast<off_t>(offset), static_cast<off_t>(2U * capacity)) == 0) &&
+            write_half(offset, payload, sequence + 1U, algorithm) && (::fdatasync(fd) == 0) &&
+            write_directory(entries);
+        if (placed)
+        {
+            if (it == segments.end())
+            {
+                order.push_back(key);
+            }
+            Segment& segment = segments[key];
+            segment.offset = offset;
+            segment.capacity = capacity;
+            segment.active = 1U; /* commit() activates half 0 */
+            segment.sequence = sequence;
+            segment.state = LoadState::Valid;
+            file_end = offset + (2U * capacity);
+        }
+        result = placed ? fd : -1;
+    }
+
+    return result;
+}
+
+/* Make the last written half of a segment the active one, once it is synced */
+void KvsContainer::commit(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = segments.find(key);
+    if (it != segments.end())
+    {
+        it->second.active = 1U - it->second.active;
+        ++it->second.sequence;
+        it->second.state = LoadState::Valid;
+        it->second.cached = false;
+        it->second.payload.clear();
+    }
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,150 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_KVSCONTAINER_HPP
+#define SCORE_LIB_KVS_KVSCONTAINER_HPP
+
+#include "kvs.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+struct ContainerEntry;
+
+/**
+ * @brief Layout of a new KvsContainer file (see KvsContainer::open()).
+ */
+struct KvsContainerPolicy
+{
+    std::size_t segment_capacity = 4096U;        ///< Initial size of each half of a segment
+    KvsChecksum checksum = KvsChecksum::Adler32; ///< Digest algorithm of the directory
+};
+
+/**
+ * @class KvsContainer
+ * @brief Stores the KVS files of many instances in one file.
+ *
+ * The file starts with a directory of segments, one per instance and, if set with
+ * set_defaults(), one per defaults file. Each segment consists of two preallocated halves that
+ * are written alternately in place like the slots of KvsBuilder::slots(), with a sequence number
+ * and a digest per write. The directory is stored the same way, so it can be replaced atomically
+ * when a segment is added or outgrows its capacity and moves to the end of the file. The space of
+ * a moved segment is not reused.
+ *
+ * open() reads the whole file with one read, so opening many instances of a container costs one
+ * file open instead of several per instance. Instances opened with KvsBuilder::container() share
+ * the file descriptor, KvsGroup::flush_all() then syncs the container once for all of them.
+ * Container instances keep no snapshots, their scope segments are still JSON files.
+ *
+ * \code
+ *  auto container = KvsContainer::open("/persistent/kvs.container");
+ *  auto kvs_a = KvsBuilder(InstanceId{1}).container(container.value()).build();
+ *  auto kvs_b = KvsBuilder(InstanceId{2}).container(container.value()).build();
+ * \endcode
+ */
+class KvsContainer final
+{
+  public:
+    /**
+     * @brief Opens a container file, creating it if it does not exist.
+     *
+     * @param path Path of the container file.
+     * @param policy Layout of new segments.
+     * @return The container, ValidationFailed if no copy of the directory is valid, or
+     *         PhysicalStorageFailure if the file could not be read.
+     */
+    static score::Result<std::shared_ptr<KvsContainer>> open(const std::string& path,
+                                                            const KvsContainerPolicy& policy = KvsContainerPolicy{});
+
+    KvsContainer(const KvsContainer&) = delete;
+    KvsContainer& operator=(const KvsContainer&) = delete;
+    ~KvsContainer();
+
+    /**
+     * @brief Returns the path of the container file.
+     */
+    const std::string& path() const;
+
+    /**
+     * @brief Returns the number of segments in the container.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Stores the defaults file of an instance in the container, it is then used instead of
+     *        `kvs_<id>_default.json` by instances opened afterwards.
+     *
+     * @param instance_id Instance of the defaults.
+     * @param json Contents of the defaults file.
+     * @return A score::Result object that indicates the success or failure of the operation.
+     */
+    score::ResultBlank set_defaults(const InstanceId& instance_id, const std::string& json);
+
+  private:
+    friend class Kvs;
+
+    /* State of a segment read at open */
+    enum class LoadState
+    {
+        Empty = 0,     /* The segment does not exist or was never written */
+        Valid = 1,     /* Payload of the newest valid half was read */
+        Corrupted = 2, /* No half has a matching digest, but at least one was written */
+    };
+
+    struct Segment
+    {
+        uint64_t offset = 0U;
+        uint64_t capacity = 0U;
+        std::size_t active = 1U; /* The first write goes to half 0 */
+        uint64_t sequence = 0U;
+        LoadState state = LoadState::Empty;
+        bool cached = false; /* payload holds the active half read at open */
+        std::string payload; /* Handed to the first Kvs::open of the segment */
+    };
+
+    KvsContainer() = default;
+
+    static uint64_t segment_key(const InstanceId& instance_id, bool defaults);
+
+    /* Called by Kvs, see SlotStore for the write and commit protocol */
+    LoadState load(uint64_t key, std::string& payload);
+    int write(uint64_t key, const std::string& payload, KvsChecksum algorithm);
+    void commit(uint64_t key);
+
+    score::ResultBlank read_file();
+    void load_segment(Segment& segment, const std::string& bytes) const;
+    bool write_half(uint64_t position, const std::string& payload, uint64_t sequence, KvsChecksum algorithm);
+    bool write_directory(const std::vector<ContainerEntry>& entries);
+
+    mutable std::mutex mutex;
+    int fd = -1;
+    std::string file_path;
+    KvsContainerPolicy policy;
+
+    /* Guarded by mutex */
+    std::unordered_map<uint64_t, Segment> segments;
+    std::vector<uint64_t> order; /* Keys in directory order */
+    std::size_t directory_active = 1U;
+    uint64_t directory_sequence = 0U;
+    uint64_t file_end = 0U;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif /* SCORE_LIB_KVS_KVSCONTAINER_HPP */
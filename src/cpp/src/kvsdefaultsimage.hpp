@@ -0,0 +1,58 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_KVSDEFAULTSIMAGE_HPP
+#define SCORE_LIB_KVS_KVSDEFAULTSIMAGE_HPP
+
+#include "kvsvalue.hpp"
+#include <cstdint>
+#include <string_view>
+
+namespace score::mw::per::kvs
+{
+
+/**
+ * @struct KvsDefaultsImageNode
+ * @brief One value of a build-time defaults image.
+ *
+ * Nested arrays and objects are flattened: their elements are stored as a contiguous range of
+ * child nodes behind the parent node.
+ */
+struct KvsDefaultsImageNode
+{
+    std::string_view key;  ///< Key of a top-level or object member node, empty for array elements
+    KvsValue::Type type;   ///< Type of the value
+    uint64_t bits;         ///< Integer and boolean values (two's complement for signed types)
+    double number;         ///< f64 values
+    std::string_view text; ///< String values
+    uint32_t first_child;  ///< Index of the first child node (arrays and objects)
+    uint32_t child_count;  ///< Number of child nodes (arrays and objects)
+};
+
+/**
+ * @struct KvsDefaultsImage
+ * @brief Read-only defaults table generated at build time from a `kvs_<id>_default.json` file.
+ *
+ * Images are emitted as constant data by the `kvs_defaults_library` Bazel rule
+ * (src/cpp/tools/kvs_defaults_library.bzl) and passed to KvsBuilder::defaults_from_image().
+ * The top-level keys are the first `root_count` nodes.
+ */
+struct KvsDefaultsImage
+{
+    const KvsDefaultsImageNode* nodes; ///< All nodes, top-level keys first
+    uint32_t node_count;               ///< Number of nodes
+    uint32_t root_count;               ///< Number of top-level keys
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif /* SCORE_LIB_KVS_KVSDEFAULTSIMAGE_HPP */
@@ -0,0 +1,324 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "kvsflushscheduler.hpp"
+#include <algorithm>
+
+namespace score::mw::per::kvs
+{
+
+/*********************** KVS Flush Scheduler Implementation *********************/
+KvsFlushScheduler& KvsFlushScheduler::instance()
+{
+    static KvsFlushScheduler scheduler;
+    return scheduler;
+}
+
+KvsFlushScheduler::~KvsFlushScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+void KvsFlushScheduler::configure(const KvsFlushBudget& budget)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        limits = budget;
+        byte_tokens = static_cast<double>(limits.bytes_per_second);
+        flush_tokens = std::max(1.0, static_cast<double>(limits.flushes_per_minute) / 60.0);
+        refilled = Clock::now();
+    }
+    wakeup.notify_all();
+}
+
+KvsFlushBudget KvsFlushScheduler::budget() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return limits;
+}
+
+score::ResultBlank KvsFlushScheduler::flush_pending()
+{
+    score::ResultBlank result = score::ResultBlank{};
+    std::vector<const Kvs*> attempted; /* A failed flush is pending again, it is not retried here */
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        /* Flushes are written one at a time, also with the worker */
+        idle.wait(lock, [this]() {
+            return in_flight == nullptr;
+        });
+        Entry* entry = next_entry(attempted);
+        if (entry == nullptr)
+        {
+            break;
+        }
+        attempted.push_back(entry->kvs);
+        score::ResultBlank flush_res = flush_entry(lock, entry->kvs);
+        if ((!flush_res) && result)
+        {
+            result = flush_res;
+        }
+    }
+
+    return result;
+}
+
+std::size_t KvsFlushScheduler::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<std::size_t>(std::count_if(entries.begin(), entries.end(), [](const Entry& entry) {
+        return entry.pending;
+    }));
+}
+
+KvsFlushStats KvsFlushScheduler::stats(KvsFlushClass flush_class) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return class_stats.at(static_cast<std::size_t>(flush_class));
+}
+
+void KvsFlushScheduler::request(Kvs& kvs)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry* entry = find_entry(&kvs);
+        if (entry == nullptr)
+        {
+            entries.push_back(Entry{&kvs, kvs.flush_class, false, false, {}, 0U, {}, false});
+            entry = &entries.back();
+        }
+        KvsFlushStats& stats = class_stats.at(static_cast<std::size_t>(entry->flush_class));
+        ++stats.requested;
+        if (entry->pending)
+        {
+            ++stats.coalesced;
+        }
+        else
+        {
+            entry->pending = true;
+            entry->ready = Clock::now();
+        }
+
+        if (!worker.joinable())
+        {
+            worker = std::thread(&KvsFlushScheduler::run, this);
+        }
+    }
+    wakeup.notify_all();
+}
+
+/* Unregister an instance, waits until a running flush of it finished. Returns true if a flush
+ * was still pending. */
+bool KvsFlushScheduler::remove(Kvs& kvs)
+{
+    bool was_pending = false;
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this, &kvs]() {
+        return in_flight != &kvs;
+    });
+    auto it = std::find_if(entries.begin(), entries.end(), [&kvs](const Entry& entry) {
+        return entry.kvs == &kvs;
+    });
+    if (it != entries.end())
+    {
+        was_pending = it->pending;
+        entries.erase(it);
+    }
+
+    return was_pending;
+}
+
+/* Stop writing an instance that is about to be moved, waits until a running flush of it finished.
+ * The members of the instance are only moved afterwards. */
+void KvsFlushScheduler::hold(Kvs& from)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this, &from]() {
+        return in_flight != &from;
+    });
+    Entry* entry = find_entry(&from);
+    if (entry != nullptr)
+    {
+        entry->held = true;
+    }
+}
+
+/* Follow a moved instance, see hold() */
+void KvsFlushScheduler::moved(Kvs& from, Kvs& to)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry* entry = find_entry(&from);
+        if (entry != nullptr)
+        {
+            entry->kvs = &to;
+            entry->held = false;
+        }
+    }
+    wakeup.notify_all();
+}
+
+/* mutex must be held */
+void KvsFlushScheduler::refill(Clock::time_point now)
+{
+    const double elapsed = std::chrono::duration<double>(now - refilled).count();
+    const double flush_capacity = std::max(1.0, static_cast<double>(limits.flushes_per_minute) / 60.0);
+    byte_tokens = std::min(static_cast<double>(limits.bytes_per_second),
+                           byte_tokens + (elapsed * static_cast<double>(limits.bytes_per_second)));
+    flush_tokens =
+        std::min(flush_capacity, flush_tokens + ((elapsed * static_cast<double>(limits.flushes_per_minute)) / 60.0));
+    refilled = now;
+}
+
+/* mutex must be held */
+KvsFlushScheduler::Entry* KvsFlushScheduler::find_entry(const Kvs* kvs)
+{
+    auto it = std::find_if(entries.begin(), entries.end(), [kvs](const Entry& entry) {
+        return entry.kvs == kvs;
+    });
+    return (it != entries.end()) ? &(*it) : nullptr;
+}
+
+/* Pending entry of the most important class that was requested first, mutex must be held */
+KvsFlushScheduler::Entry* KvsFlushScheduler::next_entry(const std::vector<const Kvs*>& skipped)
+{
+    Entry* result = nullptr;
+    for (Entry& entry : entries)
+    {
+        if (entry.pending && (!entry.held) &&
+            (std::find(skipped.begin(), skipped.end(), entry.kvs) == skipped.end()) &&
+            ((result == nullptr) || (entry.flush_class < result->flush_class) ||
+             ((entry.flush_class == result->flush_class) && (entry.ready < result->ready))))
+        {
+            result = &entry;
+        }
+    }
+
+    return result;
+}
+
+/* Time at which the budget covers the next flush of an entry, mutex must be held */
+KvsFlushScheduler::Clock::time_point KvsFlushScheduler::budget_available(const Entry& entry,
+                                                                         Clock::time_point now) const
+{
+    double wait_seconds = 0.0;
+    if (limits.bytes_per_second > 0U)
+    {
+        /* A flush larger than the bucket only waits for a full bucket */
+        const double needed = std::min(static_cast<double>(entry.estimate), static_cast<double>(limits.bytes_per_second));
+        wait_seconds = std::max(wait_seconds, (needed - byte_tokens) / static_cast<double>(limits.bytes_per_second));
+    }
+    if (limits.flushes_per_minute > 0U)
+    {
+        wait_seconds =
+            std::max(wait_seconds, ((1.0 - flush_tokens) * 60.0) / static_cast<double>(limits.flushes_per_minute));
+    }
+
+    return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(wait_seconds));
+}
+
+/* Write the pending flush of an instance with the mutex released, then charge its bytes */
+score::ResultBlank KvsFlushScheduler::flush_entry(std::unique_lock<std::mutex>& lock, Kvs* kvs)
+{
+    Entry* entry = find_entry(kvs);
+    KvsFlushStats& stats = class_stats.at(static_cast<std::size_t>(entry->flush_class));
+    if (entry->deferred)
+    {
+        stats.deferred_time += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - entry->ready);
+    }
+    entry->pending = false;
+    entry->deferred = false;
+    if (limits.flushes_per_minute > 0U)
+    {
+        flush_tokens -= 1.0;
+    }
+    in_flight = kvs;
+
+    lock.unlock();
+    const KvsWriteStats before = kvs->write_stats();
+    score::ResultBlank result = kvs->flush_files(nullptr);
+    const KvsWriteStats after = kvs->write_stats();
+    lock.lock();
+
+    /* remove() waits for in_flight, the entry still exists */
+    const uint64_t bytes = after.device_bytes - before.device_bytes;
+    entry = find_entry(kvs);
+    entry->estimate = bytes;
+    if (limits.bytes_per_second > 0U)
+    {
+        byte_tokens -= static_cast<double>(bytes);
+    }
+    stats.bytes += bytes;
+    if (result)
+    {
+        ++stats.flushed;
+    }
+    else
+    {
+        /* The instance is still modified, the flush is written again after a delay */
+        ++stats.failed;
+        entry->pending = true;
+        entry->retry = Clock::now() + RETRY_DELAY;
+    }
+    in_flight = nullptr;
+    idle.notify_all();
+
+    return result;
+}
+
+void KvsFlushScheduler::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop)
+    {
+        const Clock::time_point now = Clock::now();
+        refill(now);
+        Entry* entry = (in_flight == nullptr) ? next_entry() : nullptr;
+        if (in_flight != nullptr)
+        {
+            idle.wait(lock);
+        }
+        else if (entry == nullptr)
+        {
+            wakeup.wait(lock);
+        }
+        else
+        {
+            const Clock::time_point budget = budget_available(*entry, now);
+            const Clock::time_point available = std::max(budget, entry->retry);
+            if (available > now)
+            {
+                if ((budget > now) && (!entry->deferred))
+                {
+                    entry->deferred = true;
+                    ++class_stats.at(static_cast<std::size_t>(entry->flush_class)).deferred;
+                }
+                (void)wakeup.wait_until(lock, available);
+            }
+            else
+            {
+                (void)flush_entry(lock, entry->kvs);
+            }
+        }
+    }
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,171 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_KVSFLUSHSCHEDULER_HPP
+#define SCORE_LIB_KVS_KVSFLUSHSCHEDULER_HPP
+
+#include "kvs.hpp"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+/**
+ * @brief Process-wide I/O budget of the KvsFlushScheduler.
+ *
+ * Both limits are token buckets that hold at most one second of budget, so a burst of flushes
+ * writes at most `bytes_per_second` (plus the flush that exceeds it) before flushes are deferred.
+ */
+struct KvsFlushBudget
+{
+    std::size_t bytes_per_second = 0U;   ///< Bytes written by scheduled flushes, 0 for unlimited
+    std::size_t flushes_per_minute = 0U; ///< Number of scheduled flushes, 0 for unlimited
+};
+
+/**
+ * @brief Counters of the KvsFlushScheduler for one flush class (see KvsFlushScheduler::stats()).
+ */
+struct KvsFlushStats
+{
+    uint64_t requested = 0U;                   ///< Calls of Kvs::flush()
+    uint64_t coalesced = 0U;                   ///< Requests merged into an already pending flush
+    uint64_t flushed = 0U;                     ///< Flushes written
+    uint64_t failed = 0U;                      ///< Flushes that failed, they stay pending and are retried
+    uint64_t deferred = 0U;                    ///< Flushes that had to wait for the budget
+    std::chrono::microseconds deferred_time{}; ///< Total time flushes waited for the budget
+    uint64_t bytes = 0U;                       ///< Bytes written by the flushes (see KvsWriteStats)
+};
+
+/**
+ * @class KvsFlushScheduler
+ * @brief Process-wide rate limiting of the flushes of Kvs objects.
+ *
+ * Instances opened with KvsBuilder::scheduled_flush() queue their flush() here instead of
+ * writing right away. A background thread writes the pending instances one at a time, most
+ * important class first and in request order within a class, as long as the budget allows it.
+ * An instance is pending at most once: further flush() calls before it was written are merged.
+ * A flush is charged with the bytes it wrote to the block layer, the next flush of the instance
+ * waits until the budget covers that amount again.
+ *
+ * A failed flush stays pending and is retried after a short delay. While the background thread
+ * writes an instance, the methods of that instance wait for it instead of failing with
+ * MutexLockFailed, and moving the instance waits until the write finished.
+ *
+ * Pending flushes are written when their instance is destroyed, and by flush_pending().
+ * KvsGroup::flush_all() and KvsScope::flush() are not scheduled.
+ *
+ * \code
+ *  KvsFlushScheduler::instance().configure(KvsFlushBudget{512U * 1024U, 60U});
+ *  auto kvs = KvsBuilder(instance_id).scheduled_flush(KvsFlushClass::Background).build();
+ *  kvs.value().flush(); // Queued
+ * \endcode
+ */
+class KvsFlushScheduler final
+{
+  public:
+    static KvsFlushScheduler& instance();
+
+    KvsFlushScheduler(const KvsFlushScheduler&) = delete;
+    KvsFlushScheduler& operator=(const KvsFlushScheduler&) = delete;
+    ~KvsFlushScheduler();
+
+    /**
+     * @brief Sets the budget of all scheduled flushes. The budget starts with full buckets.
+     */
+    void configure(const KvsFlushBudget& budget);
+
+    /**
+     * @brief Returns the budget in effect.
+     */
+    KvsFlushBudget budget() const;
+
+    /**
+     * @brief Writes all pending flushes on the calling thread, ignoring the budget.
+     *
+     * @return A score::Result object that indicates the success or failure of the operation.
+     *         If an instance fails, the other instances are still flushed and the first error
+     *         is returned. The failed instance stays pending.
+     */
+    score::ResultBlank flush_pending();
+
+    /**
+     * @brief Returns the number of instances with a pending flush.
+     */
+    std::size_t pending() const;
+
+    /**
+     * @brief Returns the counters of a flush class since the start of the process.
+     */
+    KvsFlushStats stats(KvsFlushClass flush_class) const;
+
+  private:
+    friend class Kvs;
+
+    using Clock = std::chrono::steady_clock;
+
+    /* Scheduled instance */
+    struct Entry
+    {
+        Kvs* kvs;
+        KvsFlushClass flush_class;
+        bool pending;
+        bool deferred;           /* Waited for the budget since it was requested */
+        Clock::time_point ready; /* Time of the request */
+        uint64_t estimate;       /* Bytes written by the last flush of the instance */
+        Clock::time_point retry; /* A failed flush is not retried before */
+        bool held;               /* The instance is being moved, see hold() */
+    };
+
+    /* Delay before a failed flush is written again */
+    static constexpr std::chrono::milliseconds RETRY_DELAY{100};
+
+    KvsFlushScheduler() = default;
+
+    /* Called by Kvs */
+    void request(Kvs& kvs);
+    bool remove(Kvs& kvs);
+    void hold(Kvs& from);
+    void moved(Kvs& from, Kvs& to);
+
+    void run();
+    void refill(Clock::time_point now);
+    Entry* find_entry(const Kvs* kvs);
+    Entry* next_entry(const std::vector<const Kvs*>& skipped = {});
+    Clock::time_point budget_available(const Entry& entry, Clock::time_point now) const;
+    score::ResultBlank flush_entry(std::unique_lock<std::mutex>& lock, Kvs* kvs);
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable idle;
+    std::thread worker;
+    bool stop = false;
+
+    /* Guarded by mutex */
+    KvsFlushBudget limits;
+    double byte_tokens = 0.0;
+    double flush_tokens = 0.0;
+    Clock::time_point refilled{};
+    std::vector<Entry> entries;
+    const Kvs* in_flight = nullptr;
+    std::array<KvsFlushStats, 3> class_stats;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif /* SCORE_LIB_KVS_KVSFLUSHSCHEDULER_HPP */
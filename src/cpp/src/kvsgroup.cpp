@@ -0,0 +1,184 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "kvsgroup.hpp"
+#include "internal/snapshot_scrubber.hpp"
+#include <fcntl.h>     // open()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>    // fdatasync(), fsync(), close()
+#include <algorithm>
+#include <future>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace score::mw::per::kvs
+{
+
+/*********************** KVS Group Implementation *********************/
+KvsGroup::KvsGroup() = default;
+
+KvsGroup::~KvsGroup() = default; /* SnapshotScrubber is incomplete in the header */
+
+KvsGroup& KvsGroup::add(Kvs& kvs)
+{
+    if (std::find(members.begin(), members.end(), &kvs) == members.end())
+    {
+        members.push_back(&kvs);
+        if (scrubber != nullptr)
+        {
+            scrubber->add(ScrubTarget{kvs.filename_prefix.Native(), kvs.snapshot_policy.max_count, kvs.scrub_cache});
+        }
+    }
+    return *this;
+}
+
+std::size_t KvsGroup::size() const
+{
+    return members.size();
+}
+
+score::ResultBlank KvsGroup::flush_all()
+{
+    score::ResultBlank result = score::ResultBlank{};
+    std::vector<std::vector<int>> deferred_fds(members.size());
+
+    /* Serialize and write all modified instances in parallel, without syncing */
+    std::vector<std::future<score::ResultBlank>> flushes;
+    flushes.reserve(members.size());
+    for (std::size_t i = 0U; i < members.size(); ++i)
+    {
+        flushes.push_back(std::async(std::launch::async, [kvs = members[i], fds = &deferred_fds[i]]() {
+            score::ResultBlank flush_res = score::ResultBlank{};
+            auto dirty_res = kvs->is_dirty();
+            if (!dirty_res)
+            {
+                flush_res = score::MakeUnexpected(static_cast<ErrorCode>(*dirty_res.error()));
+            }
+            else if (dirty_res.value())
+            {
+                flush_res = kvs->flush_files(fds);
+            }
+            else
+            {
+                /* Nothing changed since the last flush */
+            }
+            return flush_res;
+        }));
+    }
+
+    std::set<std::string> directories;
+    std::vector<Kvs*> written;
+    for (std::size_t i = 0U; i < members.size(); ++i)
+    {
+        score::ResultBlank flush_res = flushes[i].get();
+        if ((!flush_res) && result)
+        {
+            result = flush_res;
+        }
+        if (!deferred_fds[i].empty())
+        {
+            written.push_back(members[i]);
+            /* Container segments are written in place, their directory has no renames to persist */
+            std::lock_guard<std::mutex> lock(members[i]->kvs_mutex);
+            if (members[i]->deferred_flush.renamed)
+            {
+                directories.insert(members[i]->filename_prefix.ParentPath().Native());
+            }
+        }
+    }
+
+    /* Instances of a container share its file, it is synced once */
+    std::set<std::pair<dev_t, ino_t>> files;
+    for (auto& fds : deferred_fds)
+    {
+        std::vector<int> unique_fds;
+        for (const int fd : fds)
+        {
+            struct stat info = {};
+            if ((::fstat(fd, &info) != 0) || files.insert(std::make_pair(info.st_dev, info.st_ino)).second)
+            {
+                unique_fds.push_back(fd);
+            }
+            else
+            {
+                (void)::close(fd);
+            }
+        }
+        fds = std::move(unique_fds);
+    }
+
+    /* Shared durability barrier: sync all written files in parallel, then every directory once */
+    std::vector<std::future<bool>> syncs;
+    syncs.reserve(members.size());
+    for (auto& fds : deferred_fds)
+    {
+        if (!fds.empty())
+        {
+            syncs.push_back(std::async(std::launch::async, [&fds]() {
+                bool synced = true;
+                for (const int fd : fds)
+                {
+                    synced = (::fdatasync(fd) == 0) && synced;
+                    (void)::close(fd);
+                }
+                return synced;
+            }));
+        }
+    }
+    bool synced = true;
+    for (auto& sync : syncs)
+    {
+        synced = sync.get() && synced;
+    }
+    for (const auto& directory : directories)
+    {
+        const int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0)
+        {
+            synced = false;
+        }
+        else
+        {
+            synced = (::fsync(fd) == 0) && synced;
+            (void)::close(fd);
+        }
+    }
+
+    /* Without the barrier, the written files are not persisted and stay modified */
+    for (Kvs* kvs : written)
+    {
+        auto complete_res = kvs->complete_deferred_flush(synced);
+        if ((!complete_res) && result)
+        {
+            result = complete_res;
+        }
+    }
+    if ((!synced) && result)
+    {
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+
+    return result;
+}
+
+KvsGroup& KvsGroup::scrub(const KvsScrubPolicy& policy)
+{
+    scrubber = std::make_unique<SnapshotScrubber>(policy.interval, policy.bytes_per_second);
+    for (Kvs* kvs : members)
+    {
+        scrubber->add(ScrubTarget{kvs->filename_prefix.Native(), kvs->snapshot_policy.max_count, kvs->scrub_cache});
+    }
+    return *this;
+}
+
+} /* namespace score::mw::per::kvs */
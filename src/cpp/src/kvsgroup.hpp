@@ -0,0 +1,96 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_KVSGROUP_HPP
+#define SCORE_LIB_KVS_KVSGROUP_HPP
+
+#include "kvs.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+/**
+ * @class KvsGroup
+ * @brief Flushes several Kvs objects together with one shared durability barrier.
+ *
+ * `flush_all()` serializes and writes every modified instance of the group in parallel without
+ * syncing the individual files. Afterwards one barrier makes all written files durable: the
+ * collected files are synced in parallel and every storage directory is synced once, which also
+ * persists the renames of the snapshot rotation. Instances without changes since their last flush
+ * are skipped. Instances opened with KvsDurability::None are written but not synced. A container
+ * file shared by several instances (see KvsContainer) is synced once.
+ *
+ * `scrub()` verifies the snapshots of all instances of the group on one shared background thread.
+ *
+ * The group does not own its instances, they must outlive the group and must not be moved while
+ * they are part of it, see add().
+ *
+ * \code
+ *  KvsGroup group;
+ *  group.add(kvs_a).add(kvs_b);
+ *  auto flush_res = group.flush_all();
+ * \endcode
+ */
+class KvsGroup final
+{
+  public:
+    KvsGroup();
+    ~KvsGroup();
+
+    /**
+     * @brief Adds a Kvs object to the group. Adding an object twice has no effect.
+     *
+     * The group keeps a pointer to the object. Unlike KvsFlushScheduler, it does not follow a
+     * move: the object must not be move-constructed from, move-assigned to or from, or destroyed
+     * while the group exists. To regroup moved instances, create a new group.
+     *
+     * @return Reference to this group (for chaining).
+     */
+    KvsGroup& add(Kvs& kvs);
+
+    /**
+     * @brief Returns the number of Kvs objects in the group.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Flushes all modified Kvs objects of the group with a single durability barrier.
+     *
+     * @return A score::Result object that indicates the success or failure of the operation.
+     *         If an instance fails, the other instances are still flushed and the first error
+     *         is returned. Instances that failed stay marked as modified.
+     */
+    score::ResultBlank flush_all();
+
+    /**
+     * @brief Starts one background scrubber for all Kvs objects of the group.
+     *
+     * The snapshots of all instances (including instances added later) are verified in turn
+     * under the common read budget of the policy. The results are stored in the instances, see
+     * Kvs::snapshot_status(). Calling it again replaces the scrubber. The scrubber is stopped
+     * when the group is destroyed.
+     *
+     * @return Reference to this group (for chaining).
+     */
+    KvsGroup& scrub(const KvsScrubPolicy& policy);
+
+  private:
+    std::vector<Kvs*> members;                  ///< Instances of the group (not owned)
+    std::unique_ptr<SnapshotScrubber> scrubber; ///< Shared scrubber of the group, if started
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif /* SCORE_LIB_KVS_KVSGROUP_HPP */
@@ -0,0 +1,125 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "kvsscope.hpp"
+
+namespace score::mw::per::kvs
+{
+
+/*********************** KVS Scope Implementation *********************/
+KvsScope::KvsScope(Kvs& kvs, std::string prefix) : kvs(&kvs), key_prefix(std::move(prefix))
+{
+}
+
+std::string KvsScope::full_key(const std::string_view key) const
+{
+    std::string full;
+    full.reserve(key_prefix.size() + key.size());
+    full.append(key_prefix);
+    full.append(key);
+    return full;
+}
+
+const std::string& KvsScope::prefix() const
+{
+    return key_prefix;
+}
+
+score::Result<std::vector<std::string>> KvsScope::get_all_keys()
+{
+    score::Result<std::vector<std::string>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unique_lock<std::mutex> lock = kvs->lock_instance();
+    if (lock.owns_lock())
+    {
+        std::vector<std::string> keys;
+        for (const auto& [key, _] : kvs->kvs)
+        {
+            if (key.compare(0, key_prefix.size(), key_prefix) == 0)
+            {
+                keys.emplace_back(key.substr(key_prefix.size()));
+            }
+        }
+        result = std::move(keys);
+    }
+    else
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+score::Result<bool> KvsScope::key_exists(const std::string_view key)
+{
+    return kvs->key_exists(full_key(key));
+}
+
+score::Result<KvsValue> KvsScope::get_value(const std::string_view key)
+{
+    return kvs->get_value(full_key(key));
+}
+
+score::Result<KvsValue> KvsScope::get_default_value(const std::string_view key)
+{
+    return kvs->get_default_value(full_key(key));
+}
+
+score::ResultBlank KvsScope::reset_key(const std::string_view key)
+{
+    return kvs->reset_key(full_key(key));
+}
+
+score::Result<bool> KvsScope::is_value_default(const std::string_view key) const
+{
+    return kvs->is_value_default(full_key(key));
+}
+
+score::ResultBlank KvsScope::set_value(const std::string_view key, const KvsValue& value)
+{
+    return kvs->set_value(full_key(key), value);
+}
+
+score::ResultBlank KvsScope::remove_key(const std::string_view key)
+{
+    return kvs->remove_key(full_key(key));
+}
+
+score::Result<bool> KvsScope::is_dirty()
+{
+    score::Result<bool> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::unique_lock<std::mutex> lock = kvs->lock_instance();
+    if (lock.owns_lock())
+    {
+        auto search = kvs->scopes.find(key_prefix);
+        if (search != kvs->scopes.end())
+        {
+            result = search->second.dirty;
+        }
+        else
+        {
+            result = score::MakeUnexpected(ErrorCode::InvalidArgument);
+        }
+    }
+    else
+    {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+score::ResultBlank KvsScope::flush()
+{
+    return kvs->flush_scope(key_prefix);
+}
+
+} /* namespace score::mw::per::kvs */
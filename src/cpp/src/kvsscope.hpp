@@ -0,0 +1,132 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_KVSSCOPE_HPP
+#define SCORE_LIB_KVS_KVSSCOPE_HPP
+
+#include "kvs.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace score::mw::per::kvs
+{
+
+/**
+ * @class KvsScope
+ * @brief Namespaced sub-view of a Kvs object.
+ *
+ * A KvsScope is a lightweight handle created by Kvs::scope(). All keys passed to a KvsScope are
+ * relative to the scope prefix, e.g. `kvs.scope("calib.")->get_value("gain")` reads the key
+ * "calib.gain" of the underlying Kvs. Default values are looked up with the full key as well.
+ *
+ * Keys owned by a scope are persisted in their own storage segment. The scope tracks whether
+ * its segment was modified, so `flush()` only rewrites this segment and leaves the main file and
+ * the segments of other scopes untouched.
+ *
+ * The handle does not own the Kvs object and must not be used after the Kvs object was moved
+ * or destroyed. All calls are forwarded to the thread-safe Kvs object.
+ *
+ * \code
+ *  auto scope_res = kvs.scope("calib.");
+ *  if (scope_res) {
+ *    KvsScope calib = std::move(scope_res.value());
+ *    calib.set_value("gain", KvsValue(1.5));
+ *    calib.flush(); // Rewrites only the "calib." segment
+ *  }
+ * \endcode
+ */
+class KvsScope final
+{
+  public:
+    /**
+     * @brief Returns the key prefix of this scope.
+     */
+    const std::string& prefix() const;
+
+    /**
+     * @brief Retrieves all written keys below the scope prefix, relative to the prefix.
+     */
+    score::Result<std::vector<std::string>> get_all_keys();
+
+    /**
+     * @brief Checks if a key below the scope prefix was written. See Kvs::key_exists.
+     */
+    score::Result<bool> key_exists(const std::string_view key);
+
+    /**
+     * @brief Retrieves the value of a key below the scope prefix. See Kvs::get_value.
+     */
+    score::Result<KvsValue> get_value(const std::string_view key);
+
+    /**
+     * @brief Retrieves the default value of a key below the scope prefix. See Kvs::get_default_value.
+     */
+    score::Result<KvsValue> get_default_value(const std::string_view key);
+
+    /**
+     * @brief Resets a key below the scope prefix to its default value. See Kvs::reset_key.
+     */
+    score::ResultBlank reset_key(const std::string_view key);
+
+    /**
+     * @brief Checks if a key below the scope prefix uses its default value. See Kvs::is_value_default.
+     */
+    score::Result<bool> is_value_default(const std::string_view key) const;
+
+    /**
+     * @brief Stores a value for a key below the scope prefix. See Kvs::set_value.
+     */
+    score::ResultBlank set_value(const std::string_view key, const KvsValue& value);
+
+    /**
+     * @brief Removes a key below the scope prefix. See Kvs::remove_key.
+     */
+    score::ResultBlank remove_key(const std::string_view key);
+
+    /**
+     * @brief Checks if the storage segment of this scope was modified since its last flush.
+     *
+     * @return score::Result<bool>
+     *         - On success: `true` if the segment has unflushed changes.
+     *         - On failure: An ErrorCode describing the reason for the failure.
+     */
+    score::Result<bool> is_dirty();
+
+    /**
+     * @brief Flushes the storage segment of this scope, if it was modified.
+     *
+     * Only the current file of the segment is rewritten, no snapshot is created: snapshots are
+     * rotated by Kvs::flush(). The main KVS file and the segments of other scopes are not touched.
+     *
+     * @return A score::Result object that indicates the success or failure of the operation.
+     */
+    score::ResultBlank flush();
+
+  private:
+    friend class Kvs;
+
+    /* Only Kvs::scope() creates scopes */
+    KvsScope(Kvs& kvs, std::string prefix);
+
+    /* Build the full key of the underlying Kvs with a single allocation. No hash state of the
+     * prefix is cached: the maps of Kvs hash keys with std::hash, which can't resume from the
+     * hash of a prefix, so the full key is hashed once by the map lookup. */
+    std::string full_key(const std::string_view key) const;
+
+    Kvs* kvs;               ///< Underlying KVS (not owned)
+    std::string key_prefix; ///< Prefix of all keys of this scope
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif /* SCORE_LIB_KVS_KVSSCOPE_HPP */
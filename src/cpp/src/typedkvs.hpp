@@ -0,0 +1,425 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#ifndef SCORE_LIB_KVS_TYPEDKVS_HPP
+#define SCORE_LIB_KVS_TYPEDKVS_HPP
+
+#include "kvs.hpp"
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace score::mw::per::kvs
+{
+
+/**
+ * @brief Maps a C++ type of a schema field to its KvsValue type.
+ *
+ * Only scalar types and strings are supported, nested arrays and objects stay with the
+ * untyped Kvs API. Other types fail to compile with an incomplete type error.
+ */
+template <typename T>
+struct KvsFieldType;
+
+template <>
+struct KvsFieldType<int32_t> : std::integral_constant<KvsValue::Type, KvsValue::Type::i32>
+{
+};
+template <>
+struct KvsFieldType<uint32_t> : std::integral_constant<KvsValue::Type, KvsValue::Type::u32>
+{
+};
+template <>
+struct KvsFieldType<int64_t> : std::integral_constant<KvsValue::Type, KvsValue::Type::i64>
+{
+};
+template <>
+struct KvsFieldType<uint64_t> : std::integral_constant<KvsValue::Type, KvsValue::Type::u64>
+{
+};
+template <>
+struct KvsFieldType<double> : std::integral_constant<KvsValue::Type, KvsValue::Type::f64>
+{
+};
+template <>
+struct KvsFieldType<bool> : std::integral_constant<KvsValue::Type, KvsValue::Type::Boolean>
+{
+};
+template <>
+struct KvsFieldType<std::string> : std::integral_constant<KvsValue::Type, KvsValue::Type::String>
+{
+};
+
+/**
+ * @struct KvsSchema
+ * @brief Compile-time key table of a TypedKvs.
+ *
+ * Each field is a type with a constexpr key name and a value type:
+ *
+ * \code
+ *  struct Gain { static constexpr std::string_view name = "gain"; using type = double; };
+ *  struct Label { static constexpr std::string_view name = "label"; using type = std::string; };
+ *  using CalibSchema = KvsSchema<Gain, Label>;
+ * \endcode
+ *
+ * Fields resolve to fixed slot indices at compile time. Duplicate key names are rejected
+ * by a static_assert.
+ */
+template <typename... Fields>
+struct KvsSchema
+{
+    static constexpr std::size_t size = sizeof...(Fields);
+
+    /* Key names, indexed by slot */
+    static constexpr std::array<std::string_view, sizeof...(Fields)> names = {Fields::name...};
+
+    /* Value storage, one optional per slot */
+    using Values = std::tuple<std::optional<typename Fields::type>...>;
+
+    /* Slot index of a key name, size if the key is not part of the schema */
+    static constexpr std::size_t index_of(std::string_view name)
+    {
+        std::size_t index = size;
+        for (std::size_t i = 0U; i < size; ++i)
+        {
+            if ((index == size) && (names[i] == name))
+            {
+                index = i;
+            }
+        }
+        return index;
+    }
+
+    /* Slot index of a field type */
+    template <typename Field>
+    static constexpr std::size_t index_of()
+    {
+        static_assert((std::is_same_v<Field, Fields> || ...), "Field is not part of the schema");
+        return index_of(Field::name);
+    }
+
+    static constexpr bool unique_names()
+    {
+        bool unique = true;
+        for (std::size_t i = 0U; i < size; ++i)
+        {
+            unique = unique && (index_of(names[i]) == i);
+        }
+        return unique;
+    }
+
+    static_assert(unique_names(), "Duplicate key name in schema");
+};
+
+/**
+ * @class TypedKvs
+ * @brief Statically typed view of a Kvs object with a fixed set of keys.
+ *
+ * TypedKvs resolves all schema keys to KeyHandles once at `open()`. Lookups go through the
+ * cached slot of the handle without building a key string or hashing. The slot is revalidated
+ * with the key generation of the Kvs object, so changes made directly on the Kvs object
+ * (set_value(), reset(), snapshot_restore(), ...) are visible in the typed view. Updates are
+ * kept in a tuple of typed slots and stored in the underlying Kvs object on flush, so the
+ * on-disk JSON format is the same as for the untyped API and keys outside of the schema are
+ * preserved. Until then, an update hides later direct changes of the same key.
+ *
+ * A TypedKvs object is not thread-safe. It does not own the Kvs object and must not be used
+ * after the Kvs object was moved or destroyed.
+ *
+ * \code
+ *  auto typed_res = TypedKvs<CalibSchema>::open(kvs);
+ *  if (typed_res) {
+ *    TypedKvs<CalibSchema> calib = std::move(typed_res.value());
+ *    calib.set_value<Gain>(1.5);
+ *    double gain = calib.get_value<Gain>().value();
+ *    calib.flush();
+ *  }
+ * \endcode
+ */
+template <typename Schema>
+class TypedKvs final
+{
+  public:
+    template <typename Field>
+    using ValueType = typename Field::type;
+
+    /**
+     * @brief Resolves all schema keys of a Kvs object and checks their types.
+     *
+     * @param kvs The Kvs object backing the typed view.
+     * @return A TypedKvs object, or ConversionFailed if a stored value or default value does
+     *         not match the schema type.
+     */
+    static score::Result<TypedKvs> open(Kvs& kvs)
+    {
+        score::Result<TypedKvs> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+        TypedKvs typed(kvs);
+        score::ResultBlank load_res = typed.load_slots(std::make_index_sequence<Schema::size>{});
+        if (!load_res)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*load_res.error()));
+        }
+        else
+        {
+            result = std::move(typed);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Retrieves the value of a field, or its default value if it was not written.
+     *
+     * @return The value, KeyNotFound if neither a value nor a default value exists, or
+     *         ConversionFailed if the value was changed to another type on the Kvs object.
+     */
+    template <typename Field>
+    score::Result<ValueType<Field>> get_value() const
+    {
+        constexpr std::size_t index = Schema::template index_of<Field>();
+        score::Result<ValueType<Field>> result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+        const auto& value = std::get<index>(values);
+        const auto& default_value = std::get<index>(defaults);
+        if (!dirty.test(index))
+        {
+            /* Not changed in the typed view, read through the handle */
+            auto value_res = kvs->get_value(*std::get<index>(handles));
+            std::optional<ValueType<Field>> slot;
+            if (!value_res)
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*value_res.error()));
+            }
+            else if (!convert(value_res.value(), slot))
+            {
+                result = score::MakeUnexpected(ErrorCode::ConversionFailed);
+            }
+            else
+            {
+                result = std::move(*slot);
+            }
+        }
+        else if (value.has_value())
+        {
+            result = *value;
+        }
+        else if (default_value.has_value())
+        {
+            result = *default_value;
+        }
+        else
+        {
+            /* Reset and without default */
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Retrieves the default value of a field.
+     *
+     * @return The default value, or KeyDefaultNotFound.
+     */
+    template <typename Field>
+    score::Result<ValueType<Field>> get_default_value() const
+    {
+        constexpr std::size_t index = Schema::template index_of<Field>();
+        score::Result<ValueType<Field>> result = score::MakeUnexpected(ErrorCode::KeyDefaultNotFound);
+        const auto& default_value = std::get<index>(defaults);
+        if (default_value.has_value())
+        {
+            result = *default_value;
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Checks if a value was written for a field.
+     */
+    template <typename Field>
+    bool key_exists() const
+    {
+        constexpr std::size_t index = Schema::template index_of<Field>();
+        bool exists = std::get<index>(values).has_value();
+        if (!dirty.test(index))
+        {
+            auto exists_res = kvs->key_exists(Schema::names[index]);
+            exists = exists_res && exists_res.value();
+        }
+
+        return exists;
+    }
+
+    /**
+     * @brief Checks if a field holds its default value, i.e. was not written.
+     */
+    template <typename Field>
+    bool is_value_default() const
+    {
+        return !key_exists<Field>();
+    }
+
+    /**
+     * @brief Sets the value of a field. The value is stored in the Kvs object on flush.
+     */
+    template <typename Field>
+    void set_value(ValueType<Field> value)
+    {
+        constexpr std::size_t index = Schema::template index_of<Field>();
+        std::get<index>(values) = std::move(value);
+        dirty.set(index);
+    }
+
+    /**
+     * @brief Resets a field to its default value. The key is removed from the Kvs object on flush.
+     */
+    template <typename Field>
+    void reset_key()
+    {
+        constexpr std::size_t index = Schema::template index_of<Field>();
+        std::get<index>(values).reset();
+        dirty.set(index);
+    }
+
+    /**
+     * @brief Checks if a field was changed since the last flush.
+     */
+    bool is_dirty() const
+    {
+        return dirty.any();
+    }
+
+    /**
+     * @brief Stores all changed fields in the Kvs object and flushes it. See Kvs::flush.
+     */
+    score::ResultBlank flush()
+    {
+        score::ResultBlank result = store_slots(std::make_index_sequence<Schema::size>{});
+        if (result)
+        {
+            dirty.reset();
+            result = kvs->flush();
+        }
+
+        return result;
+    }
+
+  private:
+    explicit TypedKvs(Kvs& backing) : kvs(&backing) {}
+
+    template <typename T>
+    static score::ResultBlank convert(const KvsValue& value, std::optional<T>& slot)
+    {
+        score::ResultBlank result = score::MakeUnexpected(ErrorCode::ConversionFailed);
+        if (value.getType() == KvsFieldType<T>::value)
+        {
+            slot = std::get<T>(value.getValue());
+            result = score::ResultBlank{};
+        }
+
+        return result;
+    }
+
+    template <std::size_t Index>
+    score::ResultBlank load_slot()
+    {
+        score::ResultBlank result{};
+        auto handle_res = kvs->key(Schema::names[Index]);
+        if (!handle_res)
+        {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*handle_res.error()));
+        }
+        else
+        {
+            std::get<Index>(handles) = handle_res.value();
+            auto default_res = kvs->get_default_value(Schema::names[Index]);
+            if (default_res)
+            {
+                result = convert(default_res.value(), std::get<Index>(defaults));
+            }
+
+            /* The stored value is checked once here, later direct changes are checked on access */
+            auto value_res = kvs->get_value(*std::get<Index>(handles));
+            if (result && value_res)
+            {
+                std::tuple_element_t<Index, typename Schema::Values> value;
+                result = convert(value_res.value(), value);
+            }
+            else if (result && (static_cast<ErrorCode>(*value_res.error()) != ErrorCode::KeyNotFound))
+            {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*value_res.error()));
+            }
+            else
+            {
+                /* Neither written nor default */
+            }
+        }
+
+        return result;
+    }
+
+    template <std::size_t Index>
+    score::ResultBlank store_slot()
+    {
+        score::ResultBlank result{};
+        if (dirty.test(Index))
+        {
+            const auto& value = std::get<Index>(values);
+            if (value.has_value())
+            {
+                result = kvs->set_value(*std::get<Index>(handles), KvsValue(*value));
+            }
+            else
+            {
+                auto remove_res = kvs->remove_key(Schema::names[Index]);
+                if (!remove_res && (static_cast<ErrorCode>(*remove_res.error()) != ErrorCode::KeyNotFound))
+                {
+                    result = remove_res;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    template <std::size_t... Index>
+    score::ResultBlank load_slots(std::index_sequence<Index...>)
+    {
+        score::ResultBlank result{};
+        static_cast<void>(((result = load_slot<Index>(), static_cast<bool>(result)) && ...));
+        return result;
+    }
+
+    template <std::size_t... Index>
+    score::ResultBlank store_slots(std::index_sequence<Index...>)
+    {
+        score::ResultBlank result{};
+        static_cast<void>(((result = store_slot<Index>(), static_cast<bool>(result)) && ...));
+        return result;
+    }
+
+    Kvs* kvs;                                                   ///< Backing Kvs object (not owned)
+    std::array<std::optional<KeyHandle>, Schema::size> handles; ///< Resolved key per field
+    typename Schema::Values values;                             ///< Values changed since the last flush
+    typename Schema::Values defaults;                           ///< Default values, frozen at open
+    std::bitset<Schema::size> dirty;                            ///< Fields changed since the last flush
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif /* SCORE_LIB_KVS_TYPEDKVS_HPP */
@@ -12,14 +12,21 @@
  ********************************************************************************/
 
 #include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
 #include <string>
+#include <vector>
 
 #define private public
 #define final
 #include "kvsbuilder.hpp"
 #undef private
 #undef final
+#include "internal/adler32.hpp"
+#include "internal/checksum.hpp"
+#include "internal/group_commit.hpp"
 #include "internal/kvs_helper.hpp"
+#include "internal/lz_block.hpp"
 using namespace score::mw::per::kvs;
 
 static void BM_get_hash_bytes(benchmark::State& state)
@@ -34,6 +41,670 @@ static void BM_get_hash_bytes(benchmark::State& state)
 }
 
 // Register the function as a benchmark with different input sizes
-BENCHMARK(BM_get_hash_bytes)->Range(16, 16 << 10);
+BENCHMARK(BM_get_hash_bytes)->RangeMultiplier(16)->Range(16, 64 << 20);
+
+static void BM_adler32_impl(benchmark::State& state)
+{
+    const auto impl = static_cast<Adler32Impl>(state.range(0));
+    std::string data(state.range(1), 'a');
+    if (!adler32_supported(impl))
+    {
+        state.SkipWithError("not supported by the CPU");
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(adler32_update(impl, ADLER32_INIT, data.data(), data.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(data.size()));
+}
+
+static void BM_checksum(benchmark::State& state)
+{
+    const auto algorithm = static_cast<KvsChecksum>(state.range(0));
+    std::string data(state.range(1), 'a');
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(calculate_checksum(algorithm, data.data(), data.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(data.size()));
+}
+
+BENCHMARK(BM_checksum)
+    ->ArgsProduct({{static_cast<int64_t>(KvsChecksum::Adler32),
+                    static_cast<int64_t>(KvsChecksum::Crc32c),
+                    static_cast<int64_t>(KvsChecksum::XxHash64)},
+                   {16, 256, 4 << 10, 1 << 20, 64 << 20}});
+
+BENCHMARK(BM_adler32_impl)
+    ->ArgsProduct({{static_cast<int64_t>(Adler32Impl::Scalar),
+                    static_cast<int64_t>(Adler32Impl::Sse41),
+                    static_cast<int64_t>(Adler32Impl::Avx2),
+                    static_cast<int64_t>(Adler32Impl::Neon)},
+                   {4 << 10, 1 << 20, 64 << 20}});
+
+/* Open a KVS with `state.range(0)` written keys and a default for every key */
+static Kvs open_bm_kvs(benchmark::State& state)
+{
+    auto open_res = KvsBuilder(0).dir("./bm_data_folder/").build();
+    Kvs kvs = std::move(open_res.value());
+    FrozenKvsMap::Map defaults;
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        kvs.kvs.insert_or_assign("vehicle.speed.limit." + std::to_string(i), KvsValue(int32_t(i)));
+        defaults.insert_or_assign("vehicle.speed.limit." + std::to_string(i), KvsValue(int32_t(0)));
+        defaults.insert_or_assign("vehicle.speed.default." + std::to_string(i), KvsValue(int32_t(0)));
+    }
+    kvs.default_values = FrozenKvsMap(defaults);
+    return kvs;
+}
+
+static void BM_get_value_string(benchmark::State& state)
+{
+    Kvs kvs = open_bm_kvs(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.get_value("vehicle.speed.limit.0"));
+    }
+}
+
+static void BM_get_value_key_handle(benchmark::State& state)
+{
+    Kvs kvs = open_bm_kvs(state);
+    const KeyHandle handle = kvs.key("vehicle.speed.limit.0").value();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.get_value(handle));
+    }
+}
+
+static void BM_set_value_key_handle(benchmark::State& state)
+{
+    Kvs kvs = open_bm_kvs(state);
+    const KeyHandle handle = kvs.key("vehicle.speed.limit.0").value();
+    const KvsValue value(int32_t(42));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.set_value(handle, value));
+    }
+}
+
+static void BM_get_default_value(benchmark::State& state)
+{
+    Kvs kvs = open_bm_kvs(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.get_default_value("vehicle.speed.default.0"));
+    }
+}
+
+static void BM_get_value_default_fallback(benchmark::State& state)
+{
+    Kvs kvs = open_bm_kvs(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.get_value("vehicle.speed.default.0"));
+    }
+}
+
+struct BmSpeedLimitField
+{
+    static constexpr std::string_view name = "vehicle.speed.limit.0";
+    using type = int32_t;
+};
+
+static void BM_get_value_typed(benchmark::State& state)
+{
+    Kvs kvs = open_bm_kvs(state);
+    TypedKvs<KvsSchema<BmSpeedLimitField>> typed = TypedKvs<KvsSchema<BmSpeedLimitField>>::open(kvs).value();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(typed.get_value<BmSpeedLimitField>());
+    }
+}
+
+/* Cold open with `state.range(0)` default values, read from the defaults file */
+static void BM_open_defaults_file(benchmark::State& state)
+{
+    const std::string dir = "./bm_data_folder/";
+    std::filesystem::create_directories(dir);
+    std::string json = "{";
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        json += (i == 0 ? "" : ",") + std::string("\"vehicle.speed.limit.") + std::to_string(i) +
+                "\": {\"t\": \"i32\", \"v\": " + std::to_string(i) + "}";
+    }
+    json += "}";
+    std::ofstream(dir + "kvs_1_default.json") << json;
+    const auto hash = get_hash_bytes(json);
+    std::ofstream(dir + "kvs_1_default.hash", std::ios::binary)
+        .write(reinterpret_cast<const char*>(hash.data()), static_cast<std::streamsize>(hash.size()));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(KvsBuilder(1).dir(std::string(dir)).need_defaults_flag(true).build());
+    }
+    std::filesystem::remove(dir + "kvs_1_default.json");
+    std::filesystem::remove(dir + "kvs_1_default.hash");
+}
+
+/* Cold open with `state.range(0)` default values from a build-time defaults image */
+struct BmDefaultsImage
+{
+    std::vector<std::string> keys;
+    std::vector<KvsDefaultsImageNode> nodes;
+    KvsDefaultsImage image;
+};
+
+static void BM_open_defaults_image(benchmark::State& state)
+{
+    /* Images are cached per address, so they need static storage like generated images */
+    static std::unordered_map<int64_t, BmDefaultsImage> images;
+    BmDefaultsImage& bm_image = images[state.range(0)];
+    if (bm_image.nodes.empty())
+    {
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            bm_image.keys.push_back("vehicle.speed.limit." + std::to_string(i));
+        }
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            bm_image.nodes.push_back(
+                {bm_image.keys[i], KvsValue::Type::i32, static_cast<uint64_t>(i), 0.0, {}, 0U, 0U});
+        }
+        bm_image.image = {bm_image.nodes.data(),
+                          static_cast<uint32_t>(bm_image.nodes.size()),
+                          static_cast<uint32_t>(bm_image.nodes.size())};
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(KvsBuilder(1).dir("./bm_data_folder/").defaults_from_image(bm_image.image).build());
+    }
+}
+
+/* Flush latency of a KVS with 64 keys for the durability mode `state.range(0)` */
+static void BM_flush_durability(benchmark::State& state)
+{
+    KvsDurabilityPolicy policy;
+    policy.mode = static_cast<KvsDurability>(state.range(0));
+    Kvs kvs = KvsBuilder(2).dir("./bm_data_folder/").durability(policy).build().value();
+    for (int32_t i = 0; i < 64; ++i)
+    {
+        (void)kvs.set_value("diag.counter." + std::to_string(i), KvsValue(i));
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.flush());
+    }
+    (void)GroupCommitter::instance().sync_pending();
+}
+
+static void BM_flush_io_backend(benchmark::State& state)
+{
+    const auto backend = static_cast<KvsIoBackend>(state.range(0));
+    Kvs kvs = KvsBuilder(3).dir("./bm_data_folder/").io_backend(backend).build().value();
+    for (int32_t i = 0; i < 64; ++i)
+    {
+        (void)kvs.set_value("diag.counter." + std::to_string(i), KvsValue(i));
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.flush());
+    }
+}
+
+static void BM_open_io_backend(benchmark::State& state)
+{
+    const auto backend = static_cast<KvsIoBackend>(state.range(0));
+    Kvs kvs = KvsBuilder(4).dir("./bm_data_folder/").build().value();
+    for (int32_t i = 0; i < 64; ++i)
+    {
+        (void)kvs.set_value("diag.counter." + std::to_string(i), KvsValue(i));
+    }
+    (void)kvs.flush();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(KvsBuilder(4).dir("./bm_data_folder/").io_backend(backend).build());
+    }
+}
+
+/* Remove the files of a benchmark instance left by a previous run */
+static void remove_bm_instance(std::size_t id)
+{
+    const std::string prefix = "kvs_" + std::to_string(id) + "_";
+    if (std::filesystem::exists("./bm_data_folder/"))
+    {
+        for (const auto& entry : std::filesystem::directory_iterator("./bm_data_folder/"))
+        {
+            if (entry.path().filename().string().rfind(prefix, 0) == 0)
+            {
+                std::filesystem::remove(entry.path());
+            }
+        }
+    }
+}
+
+/* Open a KVS file with `state.range(1)` keys and read 8 of them, eagerly or with lazy values */
+static void BM_open_lazy_values(benchmark::State& state)
+{
+    const bool lazy = (state.range(0) != 0);
+    remove_bm_instance(5);
+    Kvs kvs = KvsBuilder(5).dir("./bm_data_folder/").build().value();
+    for (int64_t i = 0; i < state.range(1); ++i)
+    {
+        (void)kvs.set_value("vehicle.calibration." + std::to_string(i),
+                            KvsValue(std::string("calibration value ") + std::to_string(i)));
+    }
+    (void)kvs.flush();
+    for (auto _ : state)
+    {
+        auto open_res = KvsBuilder(5).dir("./bm_data_folder/").lazy_values(lazy).build();
+        for (int64_t i = 0; i < 8; ++i)
+        {
+            benchmark::DoNotOptimize(open_res.value().get_value("vehicle.calibration." + std::to_string(i)));
+        }
+    }
+}
+
+/* Open a KVS file of about `state.range(0)` bytes, eagerly or with lazy values (read, hash and index only) */
+static void BM_open_file_size(benchmark::State& state)
+{
+    remove_bm_instance(6);
+    Kvs kvs = KvsBuilder(6).dir("./bm_data_folder/").build().value();
+    const std::string value(200U, 'v');
+    for (int64_t i = 0; i < state.range(0) / 256; ++i)
+    {
+        (void)kvs.set_value("vehicle.blob." + std::to_string(i), KvsValue(value));
+    }
+    (void)kvs.flush();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(KvsBuilder(6).dir("./bm_data_folder/").lazy_values(state.range(1) != 0).build());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+/* Restore a snapshot of about `state.range(0)` bytes: hashed on restore (0), verified by the scrubber
+ * before (1) or cached in memory (2) */
+static void BM_snapshot_restore(benchmark::State& state)
+{
+    remove_bm_instance(7);
+    KvsSnapshotCachePolicy cache;
+    cache.versions = (state.range(1) == 2) ? 1U : 0U;
+    cache.max_bytes = 16U << 20U;
+    Kvs kvs = KvsBuilder(7).dir("./bm_data_folder/").snapshot_cache(cache).build().value();
+    const std::string value(200U, 'v');
+    for (int64_t i = 0; i < state.range(0) / 256; ++i)
+    {
+        (void)kvs.set_value("vehicle.blob." + std::to_string(i), KvsValue(value));
+    }
+    (void)kvs.flush();
+    (void)kvs.flush();
+    if (state.range(1) == 1)
+    {
+        (void)kvs.scrub_snapshots();
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.snapshot_restore(1));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+/* Flush with `state.range(0)` snapshots (0 disables the snapshots), optionally one per hour (1) */
+static void BM_flush_snapshot_policy(benchmark::State& state)
+{
+    remove_bm_instance(9);
+    KvsSnapshotPolicy policy;
+    policy.max_count = static_cast<std::size_t>(state.range(0));
+    policy.min_interval = std::chrono::hours(state.range(1));
+    KvsDurabilityPolicy durability;
+    durability.mode = KvsDurability::None;
+    Kvs kvs = KvsBuilder(9).dir("./bm_data_folder/").durability(durability).snapshot_policy(policy).build().value();
+    int32_t counter = 0;
+    for (auto _ : state)
+    {
+        (void)kvs.set_value("diag.counter", KvsValue(++counter));
+        benchmark::DoNotOptimize(kvs.flush());
+    }
+}
+
+/* Flush of a KVS with 64 keys and a changing counter, with rotating files (0) or A/B slots (1) */
+static void BM_flush_slots(benchmark::State& state)
+{
+    remove_bm_instance(29);
+    KvsSlotPolicy slots;
+    slots.capacity = (state.range(0) != 0) ? (16U << 10) : 0U;
+    Kvs kvs = KvsBuilder(29).dir("./bm_data_folder/").slots(slots).build().value();
+    for (int32_t i = 0; i < 64; ++i)
+    {
+        (void)kvs.set_value("diag.counter." + std::to_string(i), KvsValue(i));
+    }
+    int32_t counter = 0;
+    for (auto _ : state)
+    {
+        (void)kvs.set_value("diag.counter", KvsValue(++counter));
+        benchmark::DoNotOptimize(kvs.flush());
+    }
+}
+
+/* Strict flush of a KVS with 256 keys, rewritten (0) or written in place with aligned writes (1).
+ * Reports the written and newly allocated bytes per flush. */
+static void BM_flush_aligned(benchmark::State& state)
+{
+    remove_bm_instance(23);
+    KvsAlignedWritePolicy aligned;
+    aligned.block_size = (state.range(0) != 0) ? 4096U : 0U;
+    aligned.preallocate = 64U << 10;
+    Kvs kvs = KvsBuilder(23).dir("./bm_data_folder/").aligned_writes(aligned).build().value();
+    for (int32_t i = 0; i < 256; ++i)
+    {
+        (void)kvs.set_value("diag.counter." + std::to_string(i), KvsValue(i));
+    }
+    (void)kvs.flush();
+    const KvsWriteStats before = kvs.write_stats();
+    int32_t counter = 0;
+    for (auto _ : state)
+    {
+        (void)kvs.set_value("diag.counter", KvsValue(++counter));
+        benchmark::DoNotOptimize(kvs.flush());
+    }
+    const KvsWriteStats after = kvs.write_stats();
+    const double flushes = static_cast<double>(std::max<int64_t>(state.iterations(), 1));
+    state.counters["device_bytes"] = static_cast<double>(after.device_bytes - before.device_bytes) / flushes;
+    state.counters["allocated_bytes"] = static_cast<double>(after.allocated_bytes - before.allocated_bytes) / flushes;
+}
+
+/* Flush of a 1 MiB store with a changing counter, full (0) or delta snapshots (1). Reports the
+ * total size of the snapshot files. */
+static void BM_flush_delta_snapshots(benchmark::State& state)
+{
+    remove_bm_instance(24);
+    KvsDurabilityPolicy durability;
+    durability.mode = KvsDurability::None;
+    Kvs kvs = KvsBuilder(24)
+                  .dir("./bm_data_folder/")
+                  .durability(durability)
+                  .delta_snapshots(state.range(0) != 0)
+                  .build()
+                  .value();
+    (void)kvs.set_value("blob", KvsValue(std::string(1U << 20U, 'x')));
+    int32_t counter = 0;
+    for (auto _ : state)
+    {
+        (void)kvs.set_value("diag.counter", KvsValue(++counter));
+        benchmark::DoNotOptimize(kvs.flush());
+    }
+    std::uintmax_t snapshot_bytes = 0U;
+    for (std::size_t idx = 1U; idx <= KVS_MAX_SNAPSHOTS; ++idx)
+    {
+        std::error_code error;
+        const std::string path = "./bm_data_folder/kvs_24_" + std::to_string(idx) + ".json";
+        const auto size = std::filesystem::file_size(path, error);
+        snapshot_bytes += error ? 0U : size;
+    }
+    state.counters["snapshot_bytes"] = static_cast<double>(snapshot_bytes);
+}
+
+/* Store of 4096 tagged values under instance `id`, flushed with the given compression */
+static Kvs build_compression_store(std::size_t id, KvsCompression compression)
+{
+    remove_bm_instance(id);
+    KvsDurabilityPolicy durability;
+    durability.mode = KvsDurability::None;
+    Kvs kvs =
+        KvsBuilder(id).dir("./bm_data_folder/").durability(durability).compression(compression).build().value();
+    for (int32_t i = 0; i < 4096; ++i)
+    {
+        (void)kvs.set_value("vehicle.signal." + std::to_string(i), KvsValue(i * 7));
+    }
+    (void)kvs.flush();
+    return kvs;
+}
+
+/* Compress (0) and decompress (1) the KVS file of build_compression_store */
+static void BM_lz_block(benchmark::State& state)
+{
+    (void)build_compression_store(25, KvsCompression::None);
+    std::ifstream in("./bm_data_folder/kvs_25_0.json", std::ios::binary);
+    const std::string json{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    std::string block(lz_block_bound(json.size()), '\0');
+    block.resize(lz_block_compress(json.data(), json.size(), block.data()));
+    std::string output(json.size(), '\0');
+    for (auto _ : state)
+    {
+        if (state.range(0) == 0)
+        {
+            std::string compressed(lz_block_bound(json.size()), '\0');
+            benchmark::DoNotOptimize(lz_block_compress(json.data(), json.size(), compressed.data()));
+        }
+        else
+        {
+            benchmark::DoNotOptimize(lz_block_decompress(block.data(), block.size(), output.data(), output.size()));
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(json.size()));
+    state.counters["ratio"] = static_cast<double>(json.size()) / static_cast<double>(block.size());
+}
+
+/* Flush with a changing value, KvsCompression None (0), Snapshots (1) or All (2). Reports the
+ * size of the current file and of snapshot 1. */
+static void BM_flush_compression(benchmark::State& state)
+{
+    Kvs kvs = build_compression_store(26, static_cast<KvsCompression>(state.range(0)));
+    int32_t counter = 0;
+    for (auto _ : state)
+    {
+        (void)kvs.set_value("diag.counter", KvsValue(++counter));
+        benchmark::DoNotOptimize(kvs.flush());
+    }
+    state.counters["file_bytes"] = static_cast<double>(std::filesystem::file_size("./bm_data_folder/kvs_26_0.json"));
+    state.counters["snapshot_bytes"] =
+        static_cast<double>(std::filesystem::file_size("./bm_data_folder/kvs_26_1.json"));
+}
+
+/* Open the store of build_compression_store, written plain (0) or compressed (2) */
+static void BM_open_compression(benchmark::State& state)
+{
+    (void)build_compression_store(27, static_cast<KvsCompression>(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(KvsBuilder(27).dir("./bm_data_folder/").build());
+    }
+}
+
+/* Diff of two snapshots of 4096 keys with one changed key, written without (0) or with record
+ * checksums (1) */
+static void BM_snapshot_diff(benchmark::State& state)
+{
+    remove_bm_instance(28);
+    KvsDurabilityPolicy durability;
+    durability.mode = KvsDurability::None;
+    Kvs kvs = KvsBuilder(28)
+                  .dir("./bm_data_folder/")
+                  .durability(durability)
+                  .record_checksums(state.range(0) != 0)
+                  .build()
+                  .value();
+    for (int32_t i = 0; i < 4096; ++i)
+    {
+        (void)kvs.set_value("vehicle.signal." + std::to_string(i), KvsValue(i * 7));
+    }
+    (void)kvs.flush();
+    (void)kvs.set_value("vehicle.signal.0", KvsValue(-1));
+    (void)kvs.flush();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.snapshot_diff(SnapshotId(1), SnapshotId(0)));
+    }
+}
+
+/* Snapshot count and filename queries, probing the files (0) or answered by the manifest (1) */
+static void BM_snapshot_queries(benchmark::State& state)
+{
+    remove_bm_instance(8);
+    Kvs kvs = KvsBuilder(8).dir("./bm_data_folder/").manifest(state.range(0) != 0).build().value();
+    for (std::size_t i = 0U; i < KVS_MAX_SNAPSHOTS; ++i)
+    {
+        (void)kvs.flush();
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kvs.snapshot_count());
+        benchmark::DoNotOptimize(kvs.get_kvs_filename(1));
+        benchmark::DoNotOptimize(kvs.get_hash_filename(1));
+    }
+}
+
+/* 12 instances with defaults, opened one by one or with Kvs::open_many */
+static void BM_open_instances(benchmark::State& state)
+{
+    const bool parallel = (state.range(0) != 0);
+    std::vector<InstanceId> ids;
+    const std::string dir = "./bm_data_folder/";
+    std::filesystem::create_directories(dir);
+    std::string json = "{";
+    for (int32_t i = 0; i < 256; ++i)
+    {
+        json += (i == 0 ? "" : ",") + std::string("\"vehicle.speed.limit.") + std::to_string(i) +
+                "\": {\"t\": \"i32\", \"v\": " + std::to_string(i) + "}";
+    }
+    json += "}";
+    const auto hash = get_hash_bytes(json);
+    for (std::size_t i = 0U; i < 12U; ++i)
+    {
+        ids.emplace_back(30U + i);
+        const std::string prefix = dir + "kvs_" + std::to_string(30U + i);
+        std::ofstream(prefix + "_default.json") << json;
+        std::ofstream(prefix + "_default.hash", std::ios::binary)
+            .write(reinterpret_cast<const char*>(hash.data()), static_cast<std::streamsize>(hash.size()));
+        std::ofstream(prefix + "_0.json") << json;
+        std::ofstream(prefix + "_0.hash", std::ios::binary)
+            .write(reinterpret_cast<const char*>(hash.data()), static_cast<std::streamsize>(hash.size()));
+    }
+
+    for (auto _ : state)
+    {
+        if (parallel)
+        {
+            benchmark::DoNotOptimize(
+                Kvs::open_many(ids, OpenNeedDefaults::Required, OpenNeedKvs::Required, dir));
+        }
+        else
+        {
+            for (const auto& id : ids)
+            {
+                benchmark::DoNotOptimize(
+                    Kvs::open(id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(dir)));
+            }
+        }
+    }
+}
+
+/* 12 instances with one modified key each, flushed one by one or as a group */
+static void BM_flush_instances(benchmark::State& state)
+{
+    const bool grouped = (state.range(0) != 0);
+    std::vector<Kvs> instances;
+    KvsGroup group;
+    for (std::size_t i = 0U; i < 12U; ++i)
+    {
+        instances.push_back(KvsBuilder(InstanceId{10U + i}).dir("./bm_data_folder/").build().value());
+    }
+    for (auto& kvs : instances)
+    {
+        (void)group.add(kvs);
+    }
+    int32_t counter = 0;
+    for (auto _ : state)
+    {
+        ++counter;
+        for (auto& kvs : instances)
+        {
+            (void)kvs.set_value("diag.counter", KvsValue(counter));
+        }
+        if (grouped)
+        {
+            benchmark::DoNotOptimize(group.flush_all());
+        }
+        else
+        {
+            for (auto& kvs : instances)
+            {
+                benchmark::DoNotOptimize(kvs.flush());
+            }
+        }
+    }
+}
+
+/* 12 instances with one modified key each, flushed as a group with own files (0) or one container file (1) */
+static void BM_flush_container(benchmark::State& state)
+{
+    const std::string container_path = "./bm_data_folder/kvs.container";
+    std::filesystem::create_directories("./bm_data_folder/");
+    std::filesystem::remove(container_path);
+    const std::shared_ptr<KvsContainer> container =
+        (state.range(0) != 0) ? KvsContainer::open(container_path).value() : nullptr;
+    std::vector<Kvs> instances;
+    KvsGroup group;
+    for (std::size_t i = 0U; i < 12U; ++i)
+    {
+        remove_bm_instance(42U + i);
+        instances.push_back(
+            KvsBuilder(InstanceId{42U + i}).dir("./bm_data_folder/").container(container).build().value());
+    }
+    for (auto& kvs : instances)
+    {
+        (void)group.add(kvs);
+    }
+    int32_t counter = 0;
+    for (auto _ : state)
+    {
+        ++counter;
+        for (auto& kvs : instances)
+        {
+            (void)kvs.set_value("diag.counter", KvsValue(counter));
+        }
+        benchmark::DoNotOptimize(group.flush_all());
+    }
+}
+
+BENCHMARK(BM_get_value_string)->Range(16, 16 << 10);
+BENCHMARK(BM_get_value_key_handle)->Range(16, 16 << 10);
+BENCHMARK(BM_set_value_key_handle)->Range(16, 16 << 10);
+BENCHMARK(BM_get_value_typed)->Range(16, 16 << 10);
+BENCHMARK(BM_get_default_value)->Range(16, 16 << 10);
+BENCHMARK(BM_get_value_default_fallback)->Range(16, 16 << 10);
+
+BENCHMARK(BM_open_defaults_file)->Range(16, 4 << 10);
+BENCHMARK(BM_open_defaults_image)->Range(16, 4 << 10);
+
+BENCHMARK(BM_flush_durability)
+    ->Arg(static_cast<int64_t>(KvsDurability::Strict))
+    ->Arg(static_cast<int64_t>(KvsDurability::GroupCommit))
+    ->Arg(static_cast<int64_t>(KvsDurability::None));
+
+BENCHMARK(BM_open_lazy_values)->ArgsProduct({{0, 1}, {256, 4 << 10}});
+BENCHMARK(BM_open_file_size)->ArgsProduct({{64 << 10, 1 << 20, 8 << 20}, {0, 1}});
+BENCHMARK(BM_snapshot_restore)->ArgsProduct({{64 << 10, 1 << 20, 8 << 20}, {0, 1, 2}});
+BENCHMARK(BM_snapshot_queries)->Arg(0)->Arg(1);
+BENCHMARK(BM_flush_delta_snapshots)->Arg(0)->Arg(1);
+BENCHMARK(BM_flush_slots)->Arg(0)->Arg(1);
+BENCHMARK(BM_flush_aligned)->Arg(0)->Arg(1);
+BENCHMARK(BM_lz_block)->Arg(0)->Arg(1);
+BENCHMARK(BM_flush_compression)->Arg(0)->Arg(1)->Arg(2);
+BENCHMARK(BM_open_compression)->Arg(0)->Arg(2);
+BENCHMARK(BM_snapshot_diff)->Arg(0)->Arg(1);
+BENCHMARK(BM_flush_snapshot_policy)->Args({0, 0})->Args({3, 0})->Args({10, 0})->Args({10, 1});
+BENCHMARK(BM_open_instances)->Arg(0)->Arg(1);
+BENCHMARK(BM_flush_instances)->Arg(0)->Arg(1);
+BENCHMARK(BM_flush_container)->Arg(0)->Arg(1);
+
+BENCHMARK(BM_flush_io_backend)
+    ->Arg(static_cast<int64_t>(KvsIoBackend::Posix))
+    ->Arg(static_cast<int64_t>(KvsIoBackend::IoUring));
+BENCHMARK(BM_open_io_backend)
+    ->Arg(static_cast<int64_t>(KvsIoBackend::Posix))
+    ->Arg(static_cast<int64_t>(KvsIoBackend::IoUring));
 
 BENCHMARK_MAIN();
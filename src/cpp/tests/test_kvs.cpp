@@ -29,7 +29,7 @@ TEST(kvs_constructor, move_constructor)
 
     /* Create Test Data*/
     kvs_b.kvs.insert({"test_kvs", KvsValue(42.0)});
-    kvs_b.default_values.insert({"test_default", KvsValue(true)});
+    set_default_value(kvs_b, "test_default", KvsValue(true));
 
     /* Move assignment operator */
     kvs_a = std::move(kvs_b);
@@ -56,7 +56,7 @@ TEST(kvs_constructor, move_constructor)
     EXPECT_EQ(val.getType(), KvsValue::Type::f64);
     EXPECT_EQ(std::get<double>(val.getValue()), 42.0);
 
-    const auto& def = kvs_a.default_values.at("test_default");
+    const auto& def = *kvs_a.default_values.find("test_default");
     EXPECT_EQ(def.getType(), KvsValue::Type::Boolean);
     EXPECT_EQ(std::get<bool>(def.getValue()), true);
 
@@ -370,7 +370,7 @@ TEST(kvs_get_value, get_value_success)
     result.value().kvs.clear();
     ASSERT_TRUE(result.value().kvs.empty());  // Make sure kvs is empty and it uses the default value
     int32_t default_value(42);
-    result.value().default_values.insert_or_assign("kvs", KvsValue(default_value));
+    set_default_value(result.value(), "kvs", KvsValue(default_value));
     get_value_result = result.value().get_value("kvs");
     ASSERT_TRUE(get_value_result);
     EXPECT_EQ(get_value_result.value().getType(), KvsValue::Type::i32);
@@ -411,7 +411,7 @@ TEST(kvs_get_default_value, get_default_value_success)
 
     /* Check Data existing */
     int32_t default_value(42);
-    result.value().default_values.insert_or_assign("kvs", KvsValue(default_value));
+    set_default_value(result.value(), "kvs", KvsValue(default_value));
 
     /* Check if default value is returned */
     auto get_def_value_result = result.value().get_default_value("kvs");
@@ -445,9 +445,7 @@ TEST(kvs_reset_key, reset_key_success)
     ASSERT_TRUE(result);
     ASSERT_TRUE(result.value().kvs.count("kvs")); /* Check Data existing */
 
-    result.value().default_values.insert_or_assign(/* Create default Value for "kvs"-key */
-                                                   "kvs",
-                                                   KvsValue(42.0));
+    set_default_value(result.value(), "kvs", KvsValue(42.0)); /* Create default Value for "kvs"-key */
     /* Reset a key */
     auto reset_key_result = result.value().reset_key("kvs");
     EXPECT_TRUE(reset_key_result);
@@ -455,7 +453,7 @@ TEST(kvs_reset_key, reset_key_success)
     EXPECT_TRUE(result.value().default_values.count("kvs"));
 
     /* Reset a non written key which has default value */
-    result.value().default_values.insert_or_assign("default", KvsValue(42.0));
+    set_default_value(result.value(), "default", KvsValue(42.0));
     reset_key_result = result.value().reset_key("default");
     EXPECT_TRUE(reset_key_result);
 
@@ -477,8 +475,8 @@ TEST(kvs_reset_key, reset_key_failure)
     /* Reset a key without default value */
     result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
-    result.value().default_values.clear();  // Clear default values to ensure no default value
-                                            // exists for "kvs"
+    result.value().default_values = FrozenKvsMap();  // Clear default values to ensure no default value
+                                                     // exists for "kvs"
     reset_key_result = result.value().reset_key("kvs");
     EXPECT_FALSE(reset_key_result);
     EXPECT_EQ(reset_key_result.error(), ErrorCode::KeyDefaultNotFound);
@@ -504,7 +502,7 @@ TEST(kvs_is_value_default, is_value_default)
 
     /* Create Test Default Data */
     kvs.kvs.insert_or_assign("not-default", KvsValue(123.4));
-    kvs.default_values.insert_or_assign("default", KvsValue(42.0));
+    set_default_value(kvs, "default", KvsValue(42.0));
 
     /* Check non-default value */
     {
@@ -1235,3 +1233,189 @@ TEST(kvs_get_filename, get_hashname_failure)
 
     cleanup_environment();
 }
+
+TEST(kvs_key_handle, key_handle_get_set)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+
+    auto handle = result.value().key("kvs");
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(handle.value().key(), "kvs");
+
+    /* Written value */
+    auto get_result = result.value().get_value(handle.value());
+    ASSERT_TRUE(get_result);
+    EXPECT_EQ(std::get<int32_t>(get_result.value().getValue()), 2);
+
+    /* Set through handle and string API are visible to each other */
+    ASSERT_TRUE(result.value().set_value(handle.value(), KvsValue(int32_t(7))));
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("kvs").value().getValue()), 7);
+    ASSERT_TRUE(result.value().set_value("kvs", KvsValue(int32_t(8))));
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value(handle.value()).value().getValue()), 8);
+
+    /* Default value and new key */
+    auto default_handle = result.value().key("default");
+    ASSERT_TRUE(default_handle);
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value(default_handle.value()).value().getValue()), 5);
+    ASSERT_TRUE(result.value().set_value(default_handle.value(), KvsValue(int32_t(6))));
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("default").value().getValue()), 6);
+
+    /* Unknown key */
+    auto unknown_handle = result.value().key("unknown");
+    ASSERT_TRUE(unknown_handle);
+    auto unknown_result = result.value().get_value(unknown_handle.value());
+    EXPECT_FALSE(unknown_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*unknown_result.error()), ErrorCode::KeyNotFound);
+
+    /* Key written later with the string API */
+    ASSERT_TRUE(result.value().set_value("unknown", KvsValue(true)));
+    EXPECT_TRUE(std::get<bool>(result.value().get_value(unknown_handle.value()).value().getValue()));
+
+    cleanup_environment();
+}
+
+TEST(kvs_key_handle, key_handle_invalidation)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().flush());
+    auto handle = result.value().key("kvs");
+    ASSERT_TRUE(handle);
+    ASSERT_TRUE(result.value().get_value(handle.value()));
+
+    /* remove_key */
+    ASSERT_TRUE(result.value().remove_key("kvs"));
+    EXPECT_FALSE(result.value().get_value(handle.value()));
+
+    /* snapshot_restore */
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value(handle.value()).value().getValue()), 2);
+
+    /* reset */
+    ASSERT_TRUE(result.value().reset());
+    EXPECT_FALSE(result.value().get_value(handle.value()));
+
+    /* reset_key falls back to default */
+    auto default_handle = result.value().key("default");
+    ASSERT_TRUE(result.value().set_value(default_handle.value(), KvsValue(int32_t(6))));
+    ASSERT_TRUE(result.value().reset_key("default"));
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value(default_handle.value()).value().getValue()), 5);
+
+    cleanup_environment();
+}
+
+TEST(kvs_key_handle, key_handle_failure)
+{
+    prepare_environment();
+
+    auto result_a = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    auto result_b = Kvs::open(InstanceId(5), OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result_a);
+    ASSERT_TRUE(result_b);
+
+    /* Handle of another instance */
+    auto handle = result_a.value().key("kvs");
+    ASSERT_TRUE(handle);
+    auto get_result = result_b.value().get_value(handle.value());
+    EXPECT_FALSE(get_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*get_result.error()), ErrorCode::InvalidArgument);
+    auto set_result = result_b.value().set_value(handle.value(), KvsValue(1.0));
+    EXPECT_FALSE(set_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_result.error()), ErrorCode::InvalidArgument);
+
+    /* Mutex locked */
+    std::unique_lock<std::mutex> lock(result_a.value().kvs_mutex);
+    EXPECT_EQ(static_cast<ErrorCode>(*result_a.value().key("kvs").error()), ErrorCode::MutexLockFailed);
+    EXPECT_EQ(static_cast<ErrorCode>(*result_a.value().get_value(handle.value()).error()),
+              ErrorCode::MutexLockFailed);
+    EXPECT_EQ(static_cast<ErrorCode>(*result_a.value().set_value(handle.value(), KvsValue(1.0)).error()),
+              ErrorCode::MutexLockFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_open_many, open_many_success)
+{
+    prepare_environment();
+
+    /* Instances without files are created empty, instance 123 loads its defaults and data */
+    std::vector<InstanceId> ids;
+    for (std::size_t id = 200U; id < 210U; ++id)
+    {
+        ids.emplace_back(id);
+    }
+    ids.emplace_back(instance_id);
+
+    auto results = Kvs::open_many(ids, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, data_dir);
+    ASSERT_EQ(results.size(), ids.size());
+    for (std::size_t i = 0U; i < ids.size(); ++i)
+    {
+        ASSERT_TRUE(results[i]);
+        EXPECT_EQ(results[i].value().filename_prefix.Native(), data_dir + "kvs_" + std::to_string(ids[i].id));
+    }
+    auto& kvs = results.back().value();
+    EXPECT_EQ(std::get<int32_t>(kvs.get_value("kvs").value().getValue()), 2);
+    EXPECT_EQ(std::get<int32_t>(kvs.get_default_value("default").value().getValue()), 5);
+
+    EXPECT_TRUE(Kvs::open_many({}, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, data_dir).empty());
+
+    cleanup_environment();
+}
+
+TEST(kvs_open_many, open_many_failure)
+{
+    prepare_environment();
+
+    /* Every instance gets its own result */
+    auto results =
+        Kvs::open_many({instance_id, InstanceId(200U)}, OpenNeedDefaults::Required, OpenNeedKvs::Required, data_dir);
+    ASSERT_EQ(results.size(), 2U);
+    EXPECT_TRUE(results[0]);
+    ASSERT_FALSE(results[1]);
+    EXPECT_EQ(static_cast<ErrorCode>(*results[1].error()), ErrorCode::KvsFileReadError);
+
+    /* A missing defaults file is reported before a corrupted KVS file */
+    std::filesystem::remove(default_prefix + ".json");
+    std::ofstream(kvs_prefix + ".hash", std::ios::binary | std::ios::trunc) << "0000";
+    results = Kvs::open_many({instance_id}, OpenNeedDefaults::Required, OpenNeedKvs::Required, data_dir);
+    ASSERT_FALSE(results[0]);
+    EXPECT_EQ(static_cast<ErrorCode>(*results[0].error()), ErrorCode::KvsFileReadError);
+
+    cleanup_environment();
+}
+
+TEST(kvs_open_many, open_large_defaults_file)
+{
+    prepare_environment();
+
+    /* A large defaults file is parsed on a second thread, its errors still come first */
+    const std::string large_json = R"({"default": {"t": "i32", "v": 5}, "large": {"t": "str", "v": ")" +
+                                   std::string(128U * 1024U, 'x') + R"("}})";
+    std::ofstream(default_prefix + ".json", std::ios::trunc) << large_json;
+    const uint32_t hash = adler32(large_json);
+    std::ofstream hash_file(default_prefix + ".hash", std::ios::binary | std::ios::trunc);
+    hash_file.put(static_cast<char>((hash >> 24) & 0xFF));
+    hash_file.put(static_cast<char>((hash >> 16) & 0xFF));
+    hash_file.put(static_cast<char>((hash >> 8) & 0xFF));
+    hash_file.put(static_cast<char>(hash & 0xFF));
+    hash_file.close();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    EXPECT_EQ(std::get<int32_t>(result.value().get_default_value("default").value().getValue()), 5);
+    EXPECT_EQ(std::get<std::string>(result.value().get_default_value("large").value().getValue()).size(),
+              128U * 1024U);
+
+    std::ofstream(default_prefix + ".json", std::ios::app) << " ";
+    std::filesystem::remove(kvs_prefix + ".json");
+    result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
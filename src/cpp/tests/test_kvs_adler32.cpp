@@ -0,0 +1,76 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+#include <random>
+
+const Adler32Impl adler32_impls[] = {Adler32Impl::Scalar, Adler32Impl::Sse41, Adler32Impl::Avx2, Adler32Impl::Neon};
+
+TEST(kvs_adler32, adler32_known_values)
+{
+    EXPECT_EQ(adler32_update(ADLER32_INIT, "", 0U), 1U);
+    EXPECT_EQ(adler32_update(ADLER32_INIT, "Wikipedia", 9U), 0x11E60398U);
+    EXPECT_TRUE(adler32_supported(Adler32Impl::Scalar));
+    EXPECT_TRUE(adler32_supported(adler32_active_impl()));
+
+    /* Worst case input for the deferred modulo reduction */
+    const std::string ones(1U << 20, '\xFF');
+    for (const auto impl : adler32_impls)
+    {
+        EXPECT_EQ(adler32_update(impl, ADLER32_INIT, ones.data(), ones.size()), adler32(ones));
+    }
+}
+
+TEST(kvs_adler32, adler32_random_buffers)
+{
+    std::mt19937 rng(0x5EED);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::string data(300000U, '\0');
+    for (auto& c : data)
+    {
+        c = static_cast<char>(byte(rng));
+    }
+
+    /* Unaligned starts, lengths around the block and NMAX boundaries, and random chunks */
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    for (const std::size_t size : {1U, 31U, 32U, 33U, 5551U, 5552U, 5553U, 5568U, 11104U, 65536U, 299000U})
+    {
+        for (const std::size_t offset : {0U, 1U, 7U, 31U})
+        {
+            ranges.emplace_back(offset, size);
+        }
+    }
+    std::uniform_int_distribution<std::size_t> pos(0U, data.size());
+    for (int i = 0; i < 200; ++i)
+    {
+        const std::size_t start = pos(rng);
+        ranges.emplace_back(start, pos(rng) % (data.size() - start + 1U));
+    }
+
+    for (const auto& [offset, size] : ranges)
+    {
+        const uint32_t seed = static_cast<uint32_t>(rng()) % 65521U | ((static_cast<uint32_t>(rng()) % 65521U) << 16);
+        const uint32_t expected = adler32_update(Adler32Impl::Scalar, seed, data.data() + offset, size);
+        for (const auto impl : adler32_impls)
+        {
+            EXPECT_EQ(adler32_update(impl, seed, data.data() + offset, size), expected)
+                << "impl " << static_cast<int>(impl) << " offset " << offset << " size " << size;
+        }
+        EXPECT_EQ(adler32_update(seed, data.data() + offset, size), expected);
+    }
+
+    /* Chained updates match a single update */
+    const uint32_t first = adler32_update(ADLER32_INIT, data.data(), 1000U);
+    EXPECT_EQ(adler32_update(first, data.data() + 1000U, data.size() - 1000U),
+              adler32_update(ADLER32_INIT, data.data(), data.size()));
+    EXPECT_EQ(calculate_hash_adler32(data), adler32(data));
+}
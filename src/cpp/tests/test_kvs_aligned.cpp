@@ -0,0 +1,152 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+#include <sys/stat.h>
+
+static ino_t file_inode(const std::string& path)
+{
+    struct stat info = {};
+    return (::stat(path.c_str(), &info) == 0) ? info.st_ino : 0U;
+}
+
+static score::Result<Kvs> open_aligned(std::size_t max_count, KvsCompression compression = KvsCompression::None)
+{
+    KvsSnapshotPolicy snapshots;
+    snapshots.max_count = max_count;
+    KvsAlignedWritePolicy aligned;
+    aligned.block_size = 4096U;
+    aligned.preallocate = 16384U;
+    return KvsBuilder(instance_id)
+        .dir(std::string(data_dir))
+        .snapshot_policy(snapshots)
+        .aligned_writes(aligned)
+        .compression(compression)
+        .build();
+}
+
+TEST(kvs_aligned, padded_in_place)
+{
+    prepare_environment();
+    {
+        auto result = open_aligned(0U);
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        ASSERT_TRUE(kvs.set_value("text", KvsValue(std::string(5000U, 'a'))));
+        ASSERT_TRUE(kvs.flush());
+
+        /* The file is padded to whole blocks, the padding is covered by the hash file */
+        EXPECT_EQ(std::filesystem::file_size(kvs_prefix + ".json"), 8192U);
+        const ino_t inode = file_inode(kvs_prefix + ".json");
+        const KvsWriteStats first = kvs.write_stats();
+        EXPECT_EQ(first.files, 2U);
+        EXPECT_GT(first.logical_bytes, 5000U);
+        EXPECT_GE(first.device_bytes, 8192U);
+
+        /* A shrinking store keeps the file size and its extents */
+        ASSERT_TRUE(kvs.set_value("text", KvsValue(std::string("short"))));
+        ASSERT_TRUE(kvs.flush());
+        EXPECT_EQ(std::filesystem::file_size(kvs_prefix + ".json"), 8192U);
+        EXPECT_EQ(file_inode(kvs_prefix + ".json"), inode);
+        ASSERT_TRUE(kvs.set_value("text", KvsValue(std::string(6000U, 'b'))));
+        ASSERT_TRUE(kvs.flush());
+        EXPECT_EQ(file_inode(kvs_prefix + ".json"), inode);
+
+        const KvsWriteStats stats = kvs.write_stats();
+        EXPECT_EQ(stats.files, 6U);
+        EXPECT_GT(stats.device_bytes, stats.logical_bytes);
+    }
+
+    auto reopened = open_aligned(0U);
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<std::string>(reopened.value().get_value("text").value().getValue()), std::string(6000U, 'b'));
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("kvs").value().getValue()), 2);
+    EXPECT_EQ(reopened.value().write_stats().files, 0U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_aligned, recycled_snapshot)
+{
+    prepare_environment();
+    auto result = open_aligned(2U);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    for (int32_t generation = 1; generation <= 3; ++generation)
+    {
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+        ASSERT_TRUE(kvs.flush());
+    }
+
+    /* The snapshot dropped by the rotation becomes the next KVS file */
+    const ino_t oldest = file_inode(filename_prefix + "_2.json");
+    ASSERT_NE(oldest, 0U);
+    ASSERT_TRUE(kvs.set_value("generation", KvsValue(4)));
+    ASSERT_TRUE(kvs.flush());
+    EXPECT_EQ(file_inode(kvs_prefix + ".json"), oldest);
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_recycle.json"));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_3.json"));
+
+    ASSERT_TRUE(kvs.snapshot_restore(2U));
+    EXPECT_EQ(std::get<int32_t>(kvs.get_value("generation").value().getValue()), 2);
+    auto reopened = open_aligned(2U);
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("generation").value().getValue()), 4);
+
+    cleanup_environment();
+}
+
+TEST(kvs_aligned, compressed_not_padded)
+{
+    prepare_environment();
+    auto result = open_aligned(1U, KvsCompression::All);
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("text", KvsValue(std::string(5000U, 'a'))));
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_LT(std::filesystem::file_size(kvs_prefix + ".json"), 4096U);
+
+    auto reopened = open_aligned(1U, KvsCompression::All);
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<std::string>(reopened.value().get_value("text").value().getValue()), std::string(5000U, 'a'));
+
+    cleanup_environment();
+}
+
+TEST(kvs_aligned, clean_scope_segment)
+{
+    prepare_environment();
+    {
+        auto result = open_aligned(3U);
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        auto scope = kvs.scope("calib.");
+        ASSERT_TRUE(scope);
+        ASSERT_TRUE(scope.value().set_value("gain", KvsValue(1.5)));
+        ASSERT_TRUE(kvs.flush());
+
+        /* The segment is rotated with the main file, its only copy is never recycled */
+        for (int32_t generation = 1; generation <= 4; ++generation)
+        {
+            ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+            ASSERT_TRUE(kvs.flush());
+        }
+    }
+
+    auto reopened = open_aligned(3U);
+    ASSERT_TRUE(reopened);
+    auto gain = reopened.value().get_value("calib.gain");
+    ASSERT_TRUE(gain);
+    EXPECT_EQ(std::get<double>(gain.value().getValue()), 1.5);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("generation").value().getValue()), 4);
+
+    cleanup_environment();
+}
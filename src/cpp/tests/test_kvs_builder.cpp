@@ -69,3 +69,92 @@ TEST(kvs_kvsbuilder, kvsbuilder_directory_check)
     EXPECT_TRUE(result_build);
     EXPECT_EQ(result_build.value().filename_prefix.CStr(), "./kvs_" + std::to_string(instance_id.id));
 }
+
+TEST(kvs_kvsbuilder, kvsbuilder_durability)
+{
+    prepare_environment();
+
+    /* Strict by default */
+    auto result_build = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result_build);
+    EXPECT_EQ(result_build.value().durability_policy().mode, KvsDurability::Strict);
+
+    for (const KvsDurability mode : {KvsDurability::Strict, KvsDurability::GroupCommit, KvsDurability::None})
+    {
+        KvsDurabilityPolicy policy;
+        policy.mode = mode;
+        policy.group_commit_interval = std::chrono::milliseconds(5);
+        result_build = KvsBuilder(instance_id).dir(std::string(data_dir)).durability(policy).build();
+        ASSERT_TRUE(result_build);
+        Kvs kvs = std::move(result_build.value());
+        EXPECT_EQ(kvs.durability_policy().mode, mode);
+        EXPECT_EQ(kvs.durability_policy().group_commit_interval, std::chrono::milliseconds(5));
+
+        /* The policy survives a move and every mode writes the data */
+        Kvs moved = std::move(kvs);
+        EXPECT_EQ(moved.durability_policy().mode, mode);
+        ASSERT_TRUE(moved.set_value("mode", KvsValue(static_cast<int32_t>(mode))));
+        ASSERT_TRUE(moved.flush());
+        auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+        ASSERT_TRUE(reopened);
+        EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("mode").value().getValue()),
+                  static_cast<int32_t>(mode));
+    }
+    (void)GroupCommitter::instance().sync_pending();
+
+    cleanup_environment();
+}
+
+TEST(kvs_kvsbuilder, group_commit_batches_syncs)
+{
+    prepare_environment();
+    GroupCommitter& committer = GroupCommitter::instance();
+    (void)committer.sync_pending();
+
+    /* Below the byte limit and before the deadline the files stay pending */
+    const int fd_a = ::open((kvs_prefix + ".json").c_str(), O_RDONLY);
+    const int fd_b = ::open((kvs_prefix + ".json").c_str(), O_RDONLY);
+    ASSERT_GE(fd_a, 0);
+    ASSERT_GE(fd_b, 0);
+    committer.submit(fd_a, 10U, std::chrono::hours(1), 1024U);
+    committer.submit(fd_b, 10U, std::chrono::hours(1), 1024U);
+    EXPECT_EQ(committer.pending(), 2U);
+    EXPECT_EQ(committer.sync_pending(), 2U);
+    EXPECT_EQ(committer.pending(), 0U);
+
+    /* Exceeding the byte limit or the interval syncs in the background */
+    const int fd_c = ::open((kvs_prefix + ".json").c_str(), O_RDONLY);
+    ASSERT_GE(fd_c, 0);
+    committer.submit(fd_c, 2048U, std::chrono::hours(1), 1024U);
+    const int fd_d = ::open((kvs_prefix + ".json").c_str(), O_RDONLY);
+    ASSERT_GE(fd_d, 0);
+    committer.submit(fd_d, 1U, std::chrono::milliseconds(1), 1024U);
+    for (int i = 0; (i < 1000) && (committer.pending() != 0U); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(committer.pending(), 0U);
+
+    /* A failed sync is reported to the submitter, a pipe can't be synced */
+    std::array<int, 2> pipe_fds{};
+    ASSERT_EQ(::pipe(pipe_fds.data()), 0);
+    auto failed = std::make_shared<std::atomic<bool>>(false);
+    committer.submit(pipe_fds[0], 1U, std::chrono::hours(1), 1024U, failed);
+    EXPECT_EQ(committer.sync_pending(), 1U);
+    EXPECT_TRUE(failed->load());
+    (void)::close(pipe_fds[1]);
+
+    /* The next write of the instance fails and stays marked modified */
+    KvsDurabilityPolicy policy;
+    policy.mode = KvsDurability::GroupCommit;
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).durability(policy).build();
+    ASSERT_TRUE(result);
+    result.value().group_commit_failed->store(true);
+    ASSERT_TRUE(result.value().set_value("group", KvsValue(1)));
+    EXPECT_FALSE(result.value().flush());
+    EXPECT_TRUE(result.value().is_dirty().value());
+    EXPECT_TRUE(result.value().flush());
+    (void)committer.sync_pending();
+
+    cleanup_environment();
+}
@@ -0,0 +1,171 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+#include <random>
+
+const KvsChecksum checksum_algorithms[] = {KvsChecksum::Adler32, KvsChecksum::Crc32c, KvsChecksum::XxHash64};
+
+TEST(kvs_checksum, checksum_known_values)
+{
+    EXPECT_EQ(calculate_checksum(KvsChecksum::Adler32, "Wikipedia", 9U), 0x11E60398U);
+    EXPECT_EQ(calculate_checksum(KvsChecksum::Crc32c, "123456789", 9U), 0xE3069283U);
+    EXPECT_EQ(crc32c_update(0U, "123456789", 9U, false), 0xE3069283U);
+    EXPECT_EQ(calculate_checksum(KvsChecksum::XxHash64, "", 0U), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(calculate_checksum(KvsChecksum::XxHash64, "abc", 3U), 0x44BC2CF5AD770999ULL);
+    EXPECT_EQ(calculate_checksum(static_cast<KvsChecksum>(0), "abc", 3U), 0U);
+    EXPECT_EQ(make_checksum(static_cast<KvsChecksum>(0)), nullptr);
+}
+
+TEST(kvs_checksum, checksum_streaming)
+{
+    std::mt19937 rng(0xC5C5);
+    std::string data(100000U, '\0');
+    for (auto& c : data)
+    {
+        c = static_cast<char>(rng());
+    }
+
+    for (const auto algorithm : checksum_algorithms)
+    {
+        for (const std::size_t size : {0U, 3U, 31U, 32U, 33U, 64U, 1000U, 99999U})
+        {
+            const uint64_t expected = calculate_checksum(algorithm, data.data() + 1U, size);
+
+            /* Random chunking gives the same digest */
+            auto checksum = make_checksum(algorithm);
+            ASSERT_NE(checksum, nullptr);
+            EXPECT_EQ(checksum->algorithm(), algorithm);
+            std::size_t pos = 0U;
+            while (pos < size)
+            {
+                const std::size_t chunk = std::min<std::size_t>(size - pos, rng() % 70U);
+                checksum->update(data.data() + 1U + pos, chunk);
+                pos += chunk;
+            }
+            EXPECT_EQ(checksum->digest(), expected) << static_cast<int>(algorithm) << " size " << size;
+        }
+    }
+
+    /* Hardware and table CRC-32C are identical */
+    for (std::size_t size = 0U; size < 2000U; size += 13U)
+    {
+        EXPECT_EQ(crc32c_update(0U, data.data() + 3U, size, true), crc32c_update(0U, data.data() + 3U, size, false));
+    }
+}
+
+TEST(kvs_checksum, hash_file_format)
+{
+    const std::string data = "hash file data";
+
+    /* Adler-32 keeps the legacy format */
+    const auto adler = get_hash_file_bytes(data, KvsChecksum::Adler32);
+    const auto legacy = get_hash_bytes(data);
+    EXPECT_EQ(adler, std::vector<uint8_t>(legacy.begin(), legacy.end()));
+
+    for (const auto algorithm : checksum_algorithms)
+    {
+        const auto bytes = get_hash_file_bytes(data, algorithm);
+        const std::string file(bytes.begin(), bytes.end());
+        const auto parsed = parse_hash_file(file);
+        ASSERT_TRUE(parsed.has_value());
+        EXPECT_EQ(parsed->algorithm, algorithm);
+        EXPECT_EQ(parsed->digest, calculate_checksum(algorithm, data.data(), data.size()));
+
+        std::istringstream valid(file);
+        EXPECT_TRUE(check_hash(data, valid));
+        std::istringstream invalid(file);
+        EXPECT_FALSE(check_hash(data + "!", invalid));
+    }
+
+    const auto xxh = get_hash_file_bytes(data, KvsChecksum::XxHash64);
+    ASSERT_EQ(xxh.size(), 14U);
+    EXPECT_EQ(std::string(xxh.begin(), xxh.begin() + 4), "KVSH");
+    EXPECT_EQ(get_hash_file_bytes(data, KvsChecksum::Crc32c).size(), 10U);
+
+    /* Unknown versions, algorithms and truncated digests are rejected */
+    std::string broken(xxh.begin(), xxh.end());
+    broken[4] = 2;
+    EXPECT_FALSE(parse_hash_file(broken).has_value());
+    broken = std::string(xxh.begin(), xxh.end());
+    broken[5] = 9;
+    EXPECT_FALSE(parse_hash_file(broken).has_value());
+    broken = std::string(xxh.begin(), xxh.end() - 1);
+    EXPECT_FALSE(parse_hash_file(broken).has_value());
+    std::istringstream truncated(broken);
+    EXPECT_FALSE(check_hash(data, truncated));
+}
+
+TEST(kvs_checksum, builder_checksum)
+{
+    prepare_environment();
+
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().checksum_algorithm(), KvsChecksum::Adler32);
+
+    for (const auto algorithm : checksum_algorithms)
+    {
+        for (const KvsIoBackend backend : {KvsIoBackend::Posix, KvsIoBackend::IoUring})
+        {
+            auto written =
+                KvsBuilder(instance_id).dir(std::string(data_dir)).checksum(algorithm).io_backend(backend).build();
+            ASSERT_TRUE(written);
+            EXPECT_EQ(written.value().checksum_algorithm(), algorithm);
+            ASSERT_TRUE(written.value().set_value("algorithm", KvsValue(static_cast<int32_t>(algorithm))));
+            ASSERT_TRUE(written.value().flush());
+
+            std::ifstream hash_file(kvs_prefix + ".hash", std::ios::binary);
+            const std::string hash((std::istreambuf_iterator<char>(hash_file)), std::istreambuf_iterator<char>());
+            const auto parsed = parse_hash_file(hash);
+            ASSERT_TRUE(parsed.has_value());
+            EXPECT_EQ(parsed->algorithm, algorithm);
+
+            /* The file is validated with its own algorithm, independent of the configured one */
+            auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+            ASSERT_TRUE(reopened);
+            EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("algorithm").value().getValue()),
+                      static_cast<int32_t>(algorithm));
+        }
+    }
+
+    /* Snapshots written with different algorithms can be restored */
+    result = KvsBuilder(instance_id).dir(std::string(data_dir)).checksum(KvsChecksum::Crc32c).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().snapshot_restore(2));
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("algorithm").value().getValue()),
+              static_cast<int32_t>(KvsChecksum::Crc32c));
+
+    cleanup_environment();
+}
+
+TEST(kvs_checksum, open_corrupted_tagged_file)
+{
+    prepare_environment();
+    {
+        auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).checksum(KvsChecksum::XxHash64).build();
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("key", KvsValue(1.0)));
+        ASSERT_TRUE(result.value().flush());
+    }
+
+    std::fstream json_file(kvs_prefix + ".json", std::ios::in | std::ios::out | std::ios::binary);
+    json_file.seekp(1);
+    json_file.put(' ');
+    json_file.close();
+
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).checksum(KvsChecksum::XxHash64).build();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
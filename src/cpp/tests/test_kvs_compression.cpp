@@ -0,0 +1,213 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+#include <random>
+
+static std::string lz_round_trip(const std::string& input)
+{
+    std::string block(lz_block_bound(input.size()), '\0');
+    block.resize(lz_block_compress(input.data(), input.size(), block.data()));
+    std::string output(input.size(), '\0');
+    EXPECT_TRUE(lz_block_decompress(block.data(), block.size(), output.data(), output.size()));
+    return output;
+}
+
+TEST(kvs_compression, lz_block_round_trip)
+{
+    std::mt19937 rng(7U);
+    std::string random(100000U, '\0');
+    for (auto& byte : random)
+    {
+        byte = static_cast<char>(rng());
+    }
+    std::string tagged;
+    for (int i = 0; i < 2000; ++i)
+    {
+        tagged += "\"key_" + std::to_string(i) + "\": {\"t\": \"i32\", \"v\": " + std::to_string(i * 7) + "}, ";
+    }
+    const std::vector<std::string> inputs{"",
+                                          "a",
+                                          "short input",
+                                          std::string(13U, 'x'),
+                                          std::string(100000U, 'x'),
+                                          random,
+                                          tagged,
+                                          tagged.substr(0U, 70000U) + random.substr(0U, 1000U) + tagged};
+    for (const auto& input : inputs)
+    {
+        EXPECT_EQ(lz_round_trip(input), input);
+    }
+
+    /* The tagged JSON format compresses well */
+    std::string block(lz_block_bound(tagged.size()), '\0');
+    EXPECT_LT(lz_block_compress(tagged.data(), tagged.size(), block.data()) * 3U, tagged.size());
+    block.resize(lz_block_bound(random.size()));
+    EXPECT_LE(lz_block_compress(random.data(), random.size(), block.data()), lz_block_bound(random.size()));
+}
+
+TEST(kvs_compression, lz_block_damaged)
+{
+    const std::string input = std::string(1000U, 'a') + "bcdefgh" + std::string(1000U, 'a');
+    std::string block(lz_block_bound(input.size()), '\0');
+    block.resize(lz_block_compress(input.data(), input.size(), block.data()));
+    std::string output(input.size(), '\0');
+
+    /* Wrong size, truncated block */
+    EXPECT_FALSE(lz_block_decompress(block.data(), block.size(), output.data(), output.size() - 1U));
+    std::string larger(input.size() + 1U, '\0');
+    EXPECT_FALSE(lz_block_decompress(block.data(), block.size(), larger.data(), larger.size()));
+    EXPECT_FALSE(lz_block_decompress(block.data(), block.size() - 1U, output.data(), output.size()));
+
+    /* Every single-byte damage is rejected or stays within the output */
+    for (std::size_t i = 0U; i < block.size(); ++i)
+    {
+        std::string damaged = block;
+        damaged[i] = static_cast<char>(damaged[i] ^ 0x5A);
+        (void)lz_block_decompress(damaged.data(), damaged.size(), output.data(), output.size());
+    }
+    const std::string offset_before_start{"\x1F\x01\x10\x00", 4U};
+    EXPECT_FALSE(lz_block_decompress(offset_before_start.data(), offset_before_start.size(), output.data(), 20U));
+}
+
+TEST(kvs_compression, compressed_file_format)
+{
+    const std::string json = R"({"kvs": {"t": "i32", "v": 2}, "other": {"t": "i32", "v": 3}})";
+    std::string bytes = compress_json_file(json);
+    EXPECT_EQ(bytes.substr(0U, 4U), "KVSZ");
+    EXPECT_TRUE(is_compressed_json_file(bytes));
+    EXPECT_FALSE(is_compressed_json_file(json));
+    ASSERT_TRUE(decompress_json_file(bytes));
+    EXPECT_EQ(bytes, json);
+
+    /* Plain JSON is left unchanged */
+    ASSERT_TRUE(decompress_json_file(bytes));
+    EXPECT_EQ(bytes, json);
+
+    /* Unknown codec and implausible sizes are rejected */
+    bytes = compress_json_file(json);
+    bytes[5] = 2;
+    EXPECT_FALSE(decompress_json_file(bytes));
+    bytes = compress_json_file(json);
+    bytes[6] = 1;
+    EXPECT_FALSE(decompress_json_file(bytes));
+    bytes = "KVSZ";
+    EXPECT_FALSE(decompress_json_file(bytes));
+}
+
+TEST(kvs_compression, compress_all_files)
+{
+    prepare_environment();
+    {
+        auto result =
+            KvsBuilder(instance_id).dir(std::string(data_dir)).compression(KvsCompression::All).build();
+        ASSERT_TRUE(result);
+        for (int i = 0; i < 100; ++i)
+        {
+            ASSERT_TRUE(result.value().set_value("key_" + std::to_string(i), KvsValue(static_cast<int32_t>(i))));
+        }
+        ASSERT_TRUE(result.value().flush());
+        ASSERT_TRUE(result.value().flush());
+    }
+
+    /* The hash file covers the compressed bytes */
+    const std::string stored = read_file(kvs_prefix + ".json");
+    EXPECT_TRUE(is_compressed_json_file(stored));
+    const auto hash_info = parse_hash_file(read_file(kvs_prefix + ".hash"));
+    ASSERT_TRUE(hash_info.has_value());
+    EXPECT_EQ(calculate_checksum(hash_info->algorithm, stored.data(), stored.size()), hash_info->digest);
+
+    /* Compressed files are read without the option, eagerly and lazily */
+    for (const bool lazy : {false, true})
+    {
+        auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).lazy_values(lazy).build();
+        ASSERT_TRUE(reopened);
+        EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("key_42").value().getValue()), 42);
+        EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("kvs").value().getValue()), 2);
+        EXPECT_EQ(reopened.value().scrub_snapshots().value()[0].state, KvsSnapshotState::Valid);
+    }
+
+    /* Written uncompressed again, the file grows */
+    auto plain = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(plain);
+    ASSERT_TRUE(plain.value().flush());
+    EXPECT_FALSE(is_compressed_json_file(read_file(kvs_prefix + ".json")));
+    EXPECT_GT(std::filesystem::file_size(kvs_prefix + ".json"), stored.size() * 3U);
+    ASSERT_TRUE(plain.value().snapshot_restore(1));
+    EXPECT_EQ(std::get<int32_t>(plain.value().get_value("key_99").value().getValue()), 99);
+
+    /* Compressed data that does not decompress fails the verification, even with a matching hash */
+    std::string damaged = stored;
+    damaged[13] = static_cast<char>(damaged[13] ^ 0x01);
+    const std::vector<uint8_t> damaged_hash = get_hash_file_bytes(damaged, KvsChecksum::Adler32);
+    std::ofstream(kvs_prefix + ".json", std::ios::binary | std::ios::trunc) << damaged;
+    std::ofstream(kvs_prefix + ".hash", std::ios::binary | std::ios::trunc)
+        << std::string(damaged_hash.begin(), damaged_hash.end());
+    auto corrupted = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_FALSE(corrupted);
+    EXPECT_EQ(static_cast<ErrorCode>(*corrupted.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_compression, compress_snapshots)
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id)
+                      .dir(std::string(data_dir))
+                      .compression(KvsCompression::Snapshots)
+                      .record_checksums(true)
+                      .manifest(true)
+                      .build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    for (const int32_t generation : {1, 2, 3})
+    {
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+        ASSERT_TRUE(kvs.flush());
+    }
+
+    /* The current file stays plain JSON, the snapshots are compressed */
+    EXPECT_FALSE(is_compressed_json_file(read_file(kvs_prefix + ".json")));
+    for (std::size_t idx = 1U; idx <= 3U; ++idx)
+    {
+        const std::string stored = read_file(filename_prefix + "_" + std::to_string(idx) + ".json");
+        EXPECT_TRUE(is_compressed_json_file(stored));
+        EXPECT_EQ(kvs.snapshot_info().value()[idx].size, stored.size());
+    }
+    EXPECT_EQ(kvs.scrub_snapshots().value()[0].state, KvsSnapshotState::Valid);
+    ASSERT_TRUE(kvs.snapshot_restore(2));
+    EXPECT_EQ(std::get<int32_t>(kvs.get_value("generation").value().getValue()), 1);
+
+    /* Records of compressed snapshots are recovered */
+    std::ofstream(kvs_prefix + ".json", std::ios::binary | std::ios::trunc) << "{}";
+    auto recovered = KvsBuilder(instance_id).dir(std::string(data_dir)).record_checksums(true).build();
+    ASSERT_TRUE(recovered);
+    EXPECT_EQ(std::get<int32_t>(recovered.value().get_value("generation").value().getValue()), 2);
+
+    /* Damaged snapshots are not rewritten */
+    std::ofstream(kvs_prefix + ".json", std::ios::binary | std::ios::trunc) << kvs_json;
+    std::ofstream(kvs_prefix + ".hash", std::ios::binary | std::ios::trunc)
+        << std::string(reinterpret_cast<const char*>(get_hash_bytes(kvs_json).data()), 4U);
+    auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).compression(KvsCompression::Snapshots).build();
+    ASSERT_TRUE(reopened);
+    std::ofstream(kvs_prefix + ".json", std::ios::app) << " ";
+    ASSERT_TRUE(reopened.value().flush());
+    EXPECT_FALSE(is_compressed_json_file(read_file(filename_prefix + "_1.json")));
+
+    /* The text of the previous flush is compressed, the current file is not read back */
+    std::filesystem::remove(kvs_prefix + ".hash");
+    ASSERT_TRUE(reopened.value().flush());
+    EXPECT_TRUE(is_compressed_json_file(read_file(filename_prefix + "_1.json")));
+
+    cleanup_environment();
+}
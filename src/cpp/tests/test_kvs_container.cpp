@@ -0,0 +1,226 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+TEST(kvs_container, directory_format)
+{
+    const std::vector<ContainerEntry> entries{{246U, 8192U, 4096U}, {247U, 16384U, 8192U}};
+    const std::string payload = get_container_directory(entries);
+    EXPECT_EQ(payload.size(), 4U + (2U * 24U));
+
+    std::vector<ContainerEntry> parsed;
+    ASSERT_TRUE(parse_container_directory(payload, parsed));
+    ASSERT_EQ(parsed.size(), 2U);
+    EXPECT_EQ(parsed[1].key, 247U);
+    EXPECT_EQ(parsed[1].offset, 16384U);
+    EXPECT_EQ(parsed[1].capacity, 8192U);
+
+    EXPECT_FALSE(parse_container_directory(payload.substr(0U, payload.size() - 1U), parsed));
+    EXPECT_TRUE(parse_container_directory(get_container_directory({}), parsed));
+    EXPECT_TRUE(parsed.empty());
+}
+
+TEST(kvs_container, many_instances)
+{
+    prepare_environment();
+    const std::size_t files = count_files();
+    {
+        auto container = open_container();
+        ASSERT_NE(container, nullptr);
+        for (std::size_t id = 200U; id < 212U; ++id)
+        {
+            auto result = open_instance(container, InstanceId{id});
+            ASSERT_TRUE(result);
+            ASSERT_TRUE(result.value().set_value("id", KvsValue(static_cast<int32_t>(id))));
+            ASSERT_TRUE(result.value().flush());
+        }
+        EXPECT_EQ(container->size(), 12U);
+    }
+    /* The container file is the only new file */
+    EXPECT_EQ(count_files(), files + 1U);
+
+    auto container = open_container();
+    ASSERT_NE(container, nullptr);
+    for (std::size_t id = 200U; id < 212U; ++id)
+    {
+        auto result = open_instance(container, InstanceId{id});
+        ASSERT_TRUE(result);
+        EXPECT_EQ(std::get<int32_t>(result.value().get_value("id").value().getValue()), static_cast<int32_t>(id));
+        EXPECT_EQ(result.value().snapshot_count().value(), 0U);
+    }
+
+    cleanup_environment();
+}
+
+TEST(kvs_container, migrates_kvs_file)
+{
+    prepare_environment();
+    auto container = open_container();
+    ASSERT_NE(container, nullptr);
+    ASSERT_TRUE(container->set_defaults(instance_id, R"({"from_container": {"t": "i32", "v": 9}})"));
+    {
+        auto result = open_instance(container, instance_id);
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        /* The existing KVS file is read until the first flush, the defaults come from the container */
+        EXPECT_EQ(std::get<int32_t>(kvs.get_value("kvs").value().getValue()), 2);
+        EXPECT_EQ(std::get<int32_t>(kvs.get_default_value("from_container").value().getValue()), 9);
+        EXPECT_FALSE(kvs.get_default_value("default"));
+        ASSERT_TRUE(kvs.set_value("kvs", KvsValue(3)));
+        ASSERT_TRUE(kvs.flush());
+    }
+    std::filesystem::remove(kvs_prefix + ".json");
+
+    auto reopened = open_instance(open_container(), instance_id);
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("kvs").value().getValue()), 3);
+
+    cleanup_environment();
+}
+
+TEST(kvs_container, segment_growth)
+{
+    prepare_environment();
+    auto container = open_container();
+    ASSERT_NE(container, nullptr);
+    auto first = open_instance(container, InstanceId{200});
+    auto second = open_instance(container, InstanceId{201});
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+    ASSERT_TRUE(first.value().set_value("text", KvsValue(std::string("small"))));
+    ASSERT_TRUE(first.value().flush());
+    ASSERT_TRUE(second.value().set_value("text", KvsValue(std::string("small"))));
+    ASSERT_TRUE(second.value().flush());
+    const uint64_t offset = container->segments.at(KvsContainer::segment_key(InstanceId{200}, false)).offset;
+
+    /* The segment outgrows its capacity and moves to the end of the file */
+    ASSERT_TRUE(first.value().set_value("text", KvsValue(std::string(10000U, 'a'))));
+    ASSERT_TRUE(first.value().flush());
+    const auto& segment = container->segments.at(KvsContainer::segment_key(InstanceId{200}, false));
+    EXPECT_GT(segment.offset, offset);
+    EXPECT_GE(segment.capacity, 2U * 10000U);
+
+    auto reopened = open_container();
+    ASSERT_NE(reopened, nullptr);
+    auto first_reopened = open_instance(reopened, InstanceId{200});
+    auto second_reopened = open_instance(reopened, InstanceId{201});
+    ASSERT_TRUE(first_reopened);
+    ASSERT_TRUE(second_reopened);
+    EXPECT_EQ(std::get<std::string>(first_reopened.value().get_value("text").value().getValue()).size(), 10000U);
+    EXPECT_EQ(std::get<std::string>(second_reopened.value().get_value("text").value().getValue()), "small");
+
+    cleanup_environment();
+}
+
+TEST(kvs_container, torn_write)
+{
+    prepare_environment();
+    {
+        auto container = open_container();
+        ASSERT_NE(container, nullptr);
+        auto result = open_instance(container, InstanceId{200});
+        ASSERT_TRUE(result);
+        for (int32_t generation = 1; generation <= 2; ++generation)
+        {
+            ASSERT_TRUE(result.value().set_value("generation", KvsValue(generation)));
+            ASSERT_TRUE(result.value().flush());
+        }
+
+        /* Damage the payload of the newest half, as a write interrupted by a power loss would */
+        const auto& segment = container->segments.at(KvsContainer::segment_key(InstanceId{200}, false));
+        const uint64_t position = segment.offset + (segment.active * segment.capacity) + SLOT_HEADER_SIZE;
+        std::fstream file(container_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(position));
+        file.put('#');
+    }
+
+    auto container = open_container();
+    ASSERT_NE(container, nullptr);
+    auto result = open_instance(container, InstanceId{200});
+    ASSERT_TRUE(result);
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("generation").value().getValue()), 1);
+
+    cleanup_environment();
+}
+
+TEST(kvs_container, group_flush)
+{
+    prepare_environment();
+    auto container = open_container();
+    ASSERT_NE(container, nullptr);
+    std::vector<Kvs> instances;
+    KvsGroup group;
+    for (std::size_t id = 200U; id < 204U; ++id)
+    {
+        auto result = open_instance(container, InstanceId{id});
+        ASSERT_TRUE(result);
+        instances.push_back(std::move(result.value()));
+    }
+    for (std::size_t i = 0U; i < instances.size(); ++i)
+    {
+        ASSERT_TRUE(instances[i].set_value("index", KvsValue(static_cast<int32_t>(i))));
+        group.add(instances[i]);
+    }
+    ASSERT_TRUE(group.flush_all());
+
+    auto reopened = open_container();
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_EQ(reopened->size(), 4U);
+    auto last = open_instance(reopened, InstanceId{203});
+    ASSERT_TRUE(last);
+    EXPECT_EQ(std::get<int32_t>(last.value().get_value("index").value().getValue()), 3);
+
+    cleanup_environment();
+}
+
+TEST(kvs_container, group_flush_failure)
+{
+    prepare_environment();
+    auto container = open_container();
+    ASSERT_NE(container, nullptr);
+    auto result = open_instance(container, InstanceId{200});
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    ASSERT_TRUE(kvs.set_value("generation", KvsValue(1)));
+    ASSERT_TRUE(kvs.flush());
+    const uint64_t key = KvsContainer::segment_key(InstanceId{200}, false);
+    const uint64_t sequence = container->segments.at(key).sequence;
+
+    /* A segment half written for a shared barrier is only activated once the barrier synced it */
+    ASSERT_TRUE(kvs.set_value("generation", KvsValue(2)));
+    auto scope = kvs.scope("app.");
+    ASSERT_TRUE(scope);
+    ASSERT_TRUE(scope.value().set_value("key", KvsValue(true)));
+    std::vector<int> fds;
+    ASSERT_TRUE(kvs.flush_files(&fds));
+    EXPECT_EQ(container->segments.at(key).sequence, sequence);
+    /* The scope segment is a renamed JSON file, its directory is synced */
+    EXPECT_TRUE(kvs.deferred_flush.renamed);
+    for (const int fd : fds)
+    {
+        ::close(fd);
+    }
+    EXPECT_TRUE(kvs.complete_deferred_flush(false));
+    EXPECT_EQ(container->segments.at(key).sequence, sequence);
+    EXPECT_TRUE(kvs.is_dirty().value());
+
+    KvsGroup group;
+    group.add(kvs);
+    ASSERT_TRUE(group.flush_all());
+    EXPECT_EQ(container->segments.at(key).sequence, sequence + 1U);
+    auto reopened = open_instance(open_container(), InstanceId{200});
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("generation").value().getValue()), 2);
+
+    cleanup_environment();
+}
@@ -0,0 +1,46 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+#include "test_kvs_defaults_fixture.hpp"
+
+/* The image generated by the kvs_defaults_library rule from test_kvs_defaults_fixture.json */
+TEST(kvs_defaults_compiler, generated_image)
+{
+    auto map_res = defaults_image_to_map(test_kvs_defaults_fixture);
+    ASSERT_TRUE(map_res);
+    const auto& defaults = map_res.value();
+    ASSERT_EQ(defaults.size(), 6U);
+    EXPECT_EQ(std::get<int32_t>(defaults.at("default").getValue()), -7);
+    EXPECT_EQ(std::get<uint64_t>(defaults.at("count").getValue()), 4294967296U);
+    EXPECT_EQ(std::get<double>(defaults.at("ratio").getValue()), 0.1);
+    EXPECT_EQ(std::get<std::string>(defaults.at("name").getValue()), "fixture \"quoted\"\n");
+
+    const auto& flags = std::get<KvsValue::Array>(defaults.at("flags").getValue());
+    ASSERT_EQ(flags.size(), 2U);
+    EXPECT_TRUE(std::get<bool>(flags[0]->getValue()));
+    EXPECT_EQ(flags[1]->getType(), KvsValue::Type::Null);
+    const auto& nested = std::get<KvsValue::Object>(defaults.at("nested").getValue());
+    EXPECT_EQ(std::get<uint32_t>(nested.at("inner")->getValue()), 3U);
+}
+
+TEST(kvs_defaults_compiler, builder_uses_generated_image)
+{
+    prepare_environment();
+    auto result =
+        KvsBuilder(instance_id).dir(std::string(data_dir)).defaults_from_image(test_kvs_defaults_fixture).build();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("default").value().getValue()), -7);
+    EXPECT_TRUE(result.value().is_value_default("nested").value());
+
+    cleanup_environment();
+}
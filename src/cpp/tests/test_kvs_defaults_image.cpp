@@ -0,0 +1,109 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+/* Image in the layout emitted by kvs_defaults_compiler */
+constexpr KvsDefaultsImageNode image_nodes[] = {
+    {std::string_view{"arr", 3U}, KvsValue::Type::Array, 0x0ULL, 0x0p+0, std::string_view{"", 0U}, 4U, 2U},
+    {std::string_view{"default", 7U}, KvsValue::Type::i32, 0x2aULL, 0x0p+0, std::string_view{"", 0U}, 0U, 0U},
+    {std::string_view{"name", 4U}, KvsValue::Type::String, 0x0ULL, 0x0p+0, std::string_view{"a\000b", 3U}, 0U, 0U},
+    {std::string_view{"neg", 3U}, KvsValue::Type::i64, 0xfffffffffffffffdULL, 0x0p+0, std::string_view{"", 0U}, 0U, 0U},
+    {std::string_view{"", 0U}, KvsValue::Type::f64, 0x0ULL, 0x1.8p+0, std::string_view{"", 0U}, 0U, 0U},
+    {std::string_view{"", 0U}, KvsValue::Type::Object, 0x0ULL, 0x0p+0, std::string_view{"", 0U}, 6U, 1U},
+    {std::string_view{"flag", 4U}, KvsValue::Type::Boolean, 0x1ULL, 0x0p+0, std::string_view{"", 0U}, 0U, 0U},
+};
+const KvsDefaultsImage image = {image_nodes, 7U, 4U};
+
+/* Child range pointing back to the parent */
+constexpr KvsDefaultsImageNode cyclic_nodes[] = {
+    {std::string_view{"arr", 3U}, KvsValue::Type::Array, 0x0ULL, 0x0p+0, std::string_view{"", 0U}, 0U, 1U},
+};
+const KvsDefaultsImage cyclic_image = {cyclic_nodes, 1U, 1U};
+
+TEST(kvs_defaults_image, defaults_image_to_map)
+{
+    auto map_res = defaults_image_to_map(image);
+    ASSERT_TRUE(map_res);
+    const auto& map = map_res.value();
+    ASSERT_EQ(map.size(), 4U);
+
+    EXPECT_EQ(std::get<int32_t>(map.at("default").getValue()), 42);
+    EXPECT_EQ(std::get<std::string>(map.at("name").getValue()), std::string("a\0b", 3U));
+    EXPECT_EQ(std::get<int64_t>(map.at("neg").getValue()), -3);
+
+    const auto& array = std::get<KvsValue::Array>(map.at("arr").getValue());
+    ASSERT_EQ(array.size(), 2U);
+    EXPECT_EQ(std::get<double>(array[0]->getValue()), 1.5);
+    const auto& object = std::get<KvsValue::Object>(array[1]->getValue());
+    ASSERT_EQ(object.size(), 1U);
+    EXPECT_TRUE(std::get<bool>(object.at("flag")->getValue()));
+}
+
+TEST(kvs_defaults_image, defaults_image_invalid)
+{
+    auto map_res = defaults_image_to_map(cyclic_image);
+    ASSERT_FALSE(map_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*map_res.error()), ErrorCode::ValidationFailed);
+
+    const KvsDefaultsImage truncated = {image_nodes, 3U, 4U};
+    map_res = defaults_image_to_map(truncated);
+    ASSERT_FALSE(map_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*map_res.error()), ErrorCode::ValidationFailed);
+
+    const KvsDefaultsImage empty = {nullptr, 0U, 0U};
+    map_res = defaults_image_to_map(empty);
+    ASSERT_TRUE(map_res);
+    EXPECT_TRUE(map_res.value().empty());
+}
+
+TEST(kvs_defaults_image, builder_defaults_from_image)
+{
+    prepare_environment();
+
+    /* The image replaces the defaults file */
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).defaults_from_image(image).build();
+    ASSERT_TRUE(result);
+    auto default_res = result.value().get_default_value("default");
+    ASSERT_TRUE(default_res);
+    EXPECT_EQ(std::get<int32_t>(default_res.value().getValue()), 42);
+    EXPECT_TRUE(result.value().is_value_default("neg").value());
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("kvs").value().getValue()), 2);
+
+    /* Repeated opens share the converted table */
+    auto second = KvsBuilder(instance_id).dir(std::string(data_dir)).defaults_from_image(image).build();
+    ASSERT_TRUE(second);
+    EXPECT_TRUE(second.value().default_values.shares_table_with(result.value().default_values));
+
+    cleanup_environment();
+}
+
+TEST(kvs_defaults_image, builder_defaults_from_image_without_file)
+{
+    prepare_environment();
+    std::filesystem::remove(default_prefix + ".json");
+    std::filesystem::remove(default_prefix + ".hash");
+
+    auto result = KvsBuilder(instance_id)
+                      .dir(std::string(data_dir))
+                      .need_defaults_flag(true)
+                      .defaults_from_image(image)
+                      .build();
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result.value().get_default_value("name"));
+
+    auto invalid = KvsBuilder(instance_id).dir(std::string(data_dir)).defaults_from_image(cyclic_image).build();
+    ASSERT_FALSE(invalid);
+    EXPECT_EQ(static_cast<ErrorCode>(*invalid.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
@@ -0,0 +1,187 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+static std::uintmax_t snapshot_size(std::size_t id)
+{
+    return std::filesystem::file_size(filename_prefix + "_" + std::to_string(id) + ".json");
+}
+
+/* Flush generations 1 to 3 with an unchanged large value, generation 2 adds a key that generation 3
+ * removes again */
+static void flush_generations(Kvs& kvs)
+{
+    ASSERT_TRUE(kvs.set_value("large", KvsValue(std::string(64U * 1024U, 'x'))));
+    for (const double generation : {1.0, 2.0, 3.0})
+    {
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+        if (generation == 2.0)
+        {
+            ASSERT_TRUE(kvs.set_value("added", KvsValue(true)));
+        }
+        if (generation == 3.0)
+        {
+            ASSERT_TRUE(kvs.remove_key("added"));
+        }
+        ASSERT_TRUE(kvs.flush());
+    }
+}
+
+TEST(kvs_delta, delta_helpers)
+{
+    std::unordered_map<std::string, KvsValue> older;
+    older.emplace("same", KvsValue(KvsValue::Object{{"a", std::make_shared<KvsValue>(1.0)}}));
+    older.emplace("changed", KvsValue(1.0));
+    older.emplace("removed", KvsValue(std::string("value")));
+    std::unordered_map<std::string, KvsValue> newer;
+    newer.emplace("same", KvsValue(KvsValue::Object{{"a", std::make_shared<KvsValue>(1.0)}}));
+    newer.emplace("changed", KvsValue(2.0));
+    newer.emplace("added", KvsValue(true));
+
+    auto delta = make_snapshot_delta(older, newer);
+    EXPECT_TRUE(is_snapshot_delta(delta));
+    EXPECT_FALSE(is_snapshot_delta(older));
+    EXPECT_EQ(delta.size(), 3U);
+    EXPECT_EQ(delta.count("same"), 0U);
+    apply_snapshot_delta(newer, std::move(delta));
+    ASSERT_EQ(newer.size(), older.size());
+    for (const auto& [key, value] : older)
+    {
+        ASSERT_EQ(newer.count(key), 1U);
+        EXPECT_TRUE(kvsvalue_equal(newer.at(key), value));
+    }
+    EXPECT_FALSE(kvsvalue_equal(KvsValue(1.0), KvsValue(1)));
+    EXPECT_FALSE(kvsvalue_equal(KvsValue(KvsValue::Array{std::make_shared<KvsValue>(1.0)}),
+                                KvsValue(KvsValue::Array{std::make_shared<KvsValue>(2.0)})));
+}
+
+TEST(kvs_delta, restore_delta_snapshots)
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).delta_snapshots(true).build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    flush_generations(kvs);
+
+    /* The large value is only stored in the current file */
+    EXPECT_GT(snapshot_size(0U), 64U * 1024U);
+    EXPECT_LT(snapshot_size(1U), 1024U);
+    EXPECT_LT(snapshot_size(2U), 1024U);
+    EXPECT_LT(snapshot_size(3U), 1024U);
+
+    ASSERT_TRUE(kvs.snapshot_restore(1));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 2.0);
+    EXPECT_TRUE(std::get<bool>(kvs.get_value("added").value().getValue()));
+    EXPECT_EQ(std::get<std::string>(kvs.get_value("large").value().getValue()).size(), 64U * 1024U);
+    EXPECT_FALSE(kvs.key_exists(std::string(KVS_DELTA_KEY)).value());
+    ASSERT_TRUE(kvs.snapshot_restore(2));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 1.0);
+    EXPECT_FALSE(kvs.key_exists("added").value());
+    ASSERT_TRUE(kvs.snapshot_restore(3));
+    EXPECT_FALSE(kvs.key_exists("generation").value());
+    EXPECT_EQ(std::get<int32_t>(kvs.get_value("kvs").value().getValue()), 2);
+
+    /* A restored version is flushed as new version, the old ones stay restorable */
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_TRUE(kvs.snapshot_restore(1));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 3.0);
+    ASSERT_TRUE(kvs.snapshot_restore(3));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 1.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_delta, reserved_key_and_group_flush)
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).delta_snapshots(true).build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* The key listing the added keys of a delta can't be written */
+    auto set_res = kvs.set_value(KVS_DELTA_KEY, KvsValue(true));
+    ASSERT_FALSE(set_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_res.error()), ErrorCode::InvalidArgument);
+    EXPECT_FALSE(kvs.key(KVS_DELTA_KEY));
+
+    /* With a shared sync barrier, the delta replaces snapshot 1 as well */
+    KvsGroup group;
+    group.add(kvs);
+    for (const double generation : {1.0, 2.0})
+    {
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+        ASSERT_TRUE(group.flush_all());
+    }
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_1.json.tmp"));
+    ASSERT_TRUE(kvs.snapshot_restore(1));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 1.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_delta, restore_from_storage)
+{
+    prepare_environment();
+    {
+        auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).delta_snapshots(true).build();
+        ASSERT_TRUE(result);
+        flush_generations(result.value());
+    }
+
+    /* Without a base in memory, the current file is read */
+    auto lazy = KvsBuilder(instance_id).dir(std::string(data_dir)).lazy_values(true).build();
+    ASSERT_TRUE(lazy);
+    EXPECT_EQ(lazy.value().delta_base, nullptr);
+    ASSERT_TRUE(lazy.value().snapshot_restore(2));
+    EXPECT_EQ(std::get<double>(lazy.value().get_value("generation").value().getValue()), 1.0);
+    EXPECT_EQ(std::get<std::string>(lazy.value().get_value("large").value().getValue()).size(), 64U * 1024U);
+
+    /* A corrupted delta breaks the older snapshots as well */
+    std::ofstream(filename_prefix + "_1.json", std::ios::app) << " ";
+    auto restore_res = lazy.value().snapshot_restore(2);
+    ASSERT_FALSE(restore_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*restore_res.error()), ErrorCode::ValidationFailed);
+    EXPECT_EQ(std::get<double>(lazy.value().get_value("generation").value().getValue()), 1.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_delta, snapshot_policy_and_manifest)
+{
+    prepare_environment();
+    KvsSnapshotPolicy policy;
+    policy.min_interval = std::chrono::hours(1);
+    auto result = KvsBuilder(instance_id)
+                      .dir(std::string(data_dir))
+                      .delta_snapshots(true)
+                      .manifest(true)
+                      .snapshot_policy(policy)
+                      .build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    flush_generations(kvs);
+
+    /* The minimum interval is not applied, all snapshots moved */
+    EXPECT_EQ(kvs.snapshot_count().value(), 3U);
+
+    /* The manifest lists the size of the delta */
+    auto info = kvs.snapshot_info();
+    ASSERT_TRUE(info);
+    ASSERT_EQ(info.value().size(), 4U);
+    EXPECT_EQ(info.value()[1].size, snapshot_size(1U));
+    EXPECT_EQ(kvs.probe_manifest_entry(1U).digest, kvs.manifest[1].digest);
+    ASSERT_TRUE(kvs.snapshot_restore(2));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 1.0);
+
+    cleanup_environment();
+}
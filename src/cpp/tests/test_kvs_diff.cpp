@@ -0,0 +1,119 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+/* Flush two generations: generation 2 changes "changed", removes "removed" and adds "added" */
+static void flush_generations(Kvs& kvs)
+{
+    ASSERT_TRUE(kvs.set_value("same", KvsValue(KvsValue::Object{{"a", std::make_shared<KvsValue>(1.0)}})));
+    ASSERT_TRUE(kvs.set_value("changed", KvsValue(1.0)));
+    ASSERT_TRUE(kvs.set_value("removed", KvsValue(std::string("value"))));
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_TRUE(kvs.set_value("changed", KvsValue(2.0)));
+    ASSERT_TRUE(kvs.remove_key("removed"));
+    ASSERT_TRUE(kvs.set_value("added", KvsValue(true)));
+    ASSERT_TRUE(kvs.flush());
+}
+
+static void expect_generation_diff(Kvs& kvs)
+{
+    auto diff = kvs.snapshot_diff(SnapshotId(1), SnapshotId(0));
+    ASSERT_TRUE(diff);
+    EXPECT_EQ(diff.value().added, std::vector<std::string>{"added"});
+    EXPECT_EQ(diff.value().removed, std::vector<std::string>{"removed"});
+    EXPECT_EQ(diff.value().changed, std::vector<std::string>{"changed"});
+
+    /* The reverse direction swaps added and removed keys */
+    diff = kvs.snapshot_diff(SnapshotId(0), SnapshotId(1));
+    ASSERT_TRUE(diff);
+    EXPECT_EQ(diff.value().added, std::vector<std::string>{"removed"});
+    EXPECT_EQ(diff.value().removed, std::vector<std::string>{"added"});
+    EXPECT_EQ(diff.value().changed, std::vector<std::string>{"changed"});
+
+    diff = kvs.snapshot_diff(SnapshotId(1), SnapshotId(1));
+    ASSERT_TRUE(diff);
+    EXPECT_TRUE(diff.value().added.empty() && diff.value().removed.empty() && diff.value().changed.empty());
+}
+
+TEST(kvs_diff, diff_snapshots)
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    flush_generations(kvs);
+    expect_generation_diff(kvs);
+
+    /* The changes are streamed through the visitor, snapshot 2 is the file of prepare_environment */
+    std::vector<std::pair<std::string, KvsDiffKind>> visited;
+    ASSERT_TRUE(kvs.snapshot_diff(SnapshotId(2), SnapshotId(1), [&visited](std::string_view key, KvsDiffKind kind) {
+        visited.emplace_back(std::string(key), kind);
+    }));
+    std::sort(visited.begin(), visited.end());
+    const std::vector<std::pair<std::string, KvsDiffKind>> expected{{"changed", KvsDiffKind::Added},
+                                                                    {"removed", KvsDiffKind::Added},
+                                                                    {"same", KvsDiffKind::Added}};
+    EXPECT_EQ(visited, expected);
+
+    /* Values with a different text are decoded before they are reported as changed */
+    std::string reformatted;
+    for (const char c : read_file(filename_prefix + "_1.json"))
+    {
+        reformatted += (c == ':') ? std::string(" :  ") : std::string(1U, c);
+    }
+    const std::vector<uint8_t> hash = get_hash_file_bytes(reformatted, KvsChecksum::Adler32);
+    std::ofstream(filename_prefix + "_1.json", std::ios::binary | std::ios::trunc) << reformatted;
+    std::ofstream(filename_prefix + "_1.hash", std::ios::binary | std::ios::trunc)
+        << std::string(hash.begin(), hash.end());
+    expect_generation_diff(kvs);
+
+    auto invalid = kvs.snapshot_diff(SnapshotId(0), SnapshotId(KVS_MAX_SNAPSHOTS + 1));
+    ASSERT_FALSE(invalid);
+    EXPECT_EQ(static_cast<ErrorCode>(*invalid.error()), ErrorCode::InvalidSnapshotId);
+
+    /* Damaged snapshots are not compared */
+    std::ofstream(filename_prefix + "_1.json", std::ios::app) << " ";
+    auto damaged = kvs.snapshot_diff(SnapshotId(1), SnapshotId(0));
+    ASSERT_FALSE(damaged);
+    EXPECT_EQ(static_cast<ErrorCode>(*damaged.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_diff, diff_records_compressed_and_delta)
+{
+    for (const bool delta : {false, true})
+    {
+        prepare_environment();
+        auto result = KvsBuilder(instance_id)
+                          .dir(std::string(data_dir))
+                          .record_checksums(true)
+                          .compression(KvsCompression::All)
+                          .delta_snapshots(delta)
+                          .build();
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        flush_generations(kvs);
+        EXPECT_TRUE(is_compressed_json_file(read_file(filename_prefix + "_1.json")));
+        expect_generation_diff(kvs);
+
+        /* Snapshot 2 is the file of prepare_environment */
+        auto diff = kvs.snapshot_diff(SnapshotId(2), SnapshotId(0));
+        ASSERT_TRUE(diff);
+        EXPECT_TRUE(diff.value().removed.empty());
+        EXPECT_TRUE(diff.value().changed.empty());
+        EXPECT_EQ(diff.value().added, (std::vector<std::string>{"added", "changed", "same"}));
+
+        cleanup_environment();
+    }
+}
@@ -40,6 +40,7 @@ TEST(kvs_MessageFor, MessageFor)
         {ErrorCode::ConversionFailed, "Conversion failed"},
         {ErrorCode::MutexLockFailed, "Mutex failed"},
         {ErrorCode::InvalidValueType, "Invalid value type"},
+        {ErrorCode::InvalidArgument, "Invalid argument"},
     };
     for (const auto& test : test_cases)
     {
@@ -0,0 +1,198 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+/* Wait until the background thread of the scheduler reached a condition */
+template <typename Condition>
+static bool wait_for(Condition condition)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((!condition()) && (std::chrono::steady_clock::now() < deadline))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+}
+
+static int32_t stored_generation(const InstanceId& id)
+{
+    auto reopened = KvsBuilder(id).dir(std::string(data_dir)).build();
+    return std::get<int32_t>(reopened.value().get_value("generation").value().getValue());
+}
+
+/* Restore the unlimited budget for the following tests */
+static void reset_scheduler()
+{
+    KvsFlushScheduler& scheduler = KvsFlushScheduler::instance();
+    scheduler.configure(KvsFlushBudget{});
+    EXPECT_TRUE(scheduler.flush_pending());
+    EXPECT_EQ(scheduler.pending(), 0U);
+}
+
+TEST(kvs_flush_scheduler, coalesced_flush)
+{
+    prepare_environment();
+    KvsFlushScheduler& scheduler = KvsFlushScheduler::instance();
+    const KvsFlushStats start = scheduler.stats(KvsFlushClass::Normal);
+    scheduler.configure(KvsFlushBudget{0U, 1U}); /* One flush, then one per minute */
+    {
+        auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).scheduled_flush(KvsFlushClass::Normal).build();
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(1)));
+        ASSERT_TRUE(kvs.flush());
+        ASSERT_TRUE(wait_for([&]() {
+            return scheduler.stats(KvsFlushClass::Normal).flushed == (start.flushed + 1U);
+        }));
+
+        /* The budget is used up, further flushes are merged and deferred */
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(2)));
+        ASSERT_TRUE(kvs.flush());
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(3)));
+        ASSERT_TRUE(kvs.flush());
+        ASSERT_TRUE(wait_for([&]() {
+            return scheduler.stats(KvsFlushClass::Normal).deferred == (start.deferred + 1U);
+        }));
+        EXPECT_EQ(scheduler.pending(), 1U);
+        EXPECT_EQ(stored_generation(instance_id), 1);
+
+        ASSERT_TRUE(scheduler.flush_pending());
+        EXPECT_EQ(scheduler.pending(), 0U);
+        EXPECT_EQ(stored_generation(instance_id), 3);
+        EXPECT_EQ(kvs.snapshot_count().value(), 3U);
+    }
+
+    const KvsFlushStats stats = scheduler.stats(KvsFlushClass::Normal);
+    EXPECT_EQ(stats.requested - start.requested, 3U);
+    EXPECT_EQ(stats.coalesced - start.coalesced, 1U);
+    EXPECT_EQ(stats.flushed - start.flushed, 2U);
+    EXPECT_GT(stats.deferred_time, start.deferred_time);
+    EXPECT_GT(stats.bytes, start.bytes);
+    reset_scheduler();
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_scheduler, class_priority)
+{
+    prepare_environment();
+    KvsFlushScheduler& scheduler = KvsFlushScheduler::instance();
+    const KvsFlushStats critical_start = scheduler.stats(KvsFlushClass::Critical);
+    {
+        auto background =
+            KvsBuilder(instance_id).dir(std::string(data_dir)).scheduled_flush(KvsFlushClass::Background).build();
+        auto critical =
+            KvsBuilder(InstanceId{124}).dir(std::string(data_dir)).scheduled_flush(KvsFlushClass::Critical).build();
+        ASSERT_TRUE(background);
+        ASSERT_TRUE(critical);
+
+        /* Use up the budget, then queue the background instance first */
+        scheduler.configure(KvsFlushBudget{0U, 1U});
+        ASSERT_TRUE(background.value().set_value("generation", KvsValue(1)));
+        ASSERT_TRUE(background.value().flush());
+        ASSERT_TRUE(wait_for([&]() {
+            return scheduler.pending() == 0U;
+        }));
+        ASSERT_TRUE(background.value().set_value("generation", KvsValue(2)));
+        ASSERT_TRUE(background.value().flush());
+        ASSERT_TRUE(critical.value().set_value("generation", KvsValue(1)));
+        ASSERT_TRUE(critical.value().flush());
+        EXPECT_EQ(scheduler.pending(), 2U);
+
+        /* With budget for one more flush per second, the critical instance goes first */
+        scheduler.configure(KvsFlushBudget{0U, 60U});
+        ASSERT_TRUE(wait_for([&]() {
+            return scheduler.stats(KvsFlushClass::Critical).flushed == (critical_start.flushed + 1U);
+        }));
+        EXPECT_EQ(stored_generation(InstanceId{124}), 1);
+        EXPECT_EQ(stored_generation(instance_id), 1);
+
+        /* A pending flush is written when the instance is destroyed */
+        background = score::MakeUnexpected(ErrorCode::UnmappedError);
+        EXPECT_EQ(stored_generation(instance_id), 2);
+        EXPECT_EQ(scheduler.pending(), 0U);
+    }
+    reset_scheduler();
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_scheduler, byte_budget)
+{
+    prepare_environment();
+    KvsFlushScheduler& scheduler = KvsFlushScheduler::instance();
+    const KvsFlushStats start = scheduler.stats(KvsFlushClass::Background);
+    scheduler.configure(KvsFlushBudget{1024U, 0U});
+    {
+        auto result =
+            KvsBuilder(instance_id).dir(std::string(data_dir)).scheduled_flush(KvsFlushClass::Background).build();
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        ASSERT_TRUE(kvs.set_value("text", KvsValue(std::string(16U * 1024U, 'a'))));
+        ASSERT_TRUE(kvs.flush());
+        ASSERT_TRUE(wait_for([&]() {
+            return scheduler.stats(KvsFlushClass::Background).flushed == (start.flushed + 1U);
+        }));
+
+        /* The first flush overdrew the byte bucket, the next one waits until it is refilled */
+        ASSERT_TRUE(kvs.flush());
+        ASSERT_TRUE(wait_for([&]() {
+            return scheduler.stats(KvsFlushClass::Background).deferred == (start.deferred + 1U);
+        }));
+        EXPECT_EQ(scheduler.pending(), 1U);
+        EXPECT_EQ(scheduler.budget().bytes_per_second, 1024U);
+        EXPECT_GE(scheduler.stats(KvsFlushClass::Background).bytes - start.bytes, 16U * 1024U);
+    }
+    EXPECT_EQ(scheduler.pending(), 0U);
+    reset_scheduler();
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_scheduler, failed_flush_retried)
+{
+    prepare_environment();
+    KvsFlushScheduler& scheduler = KvsFlushScheduler::instance();
+    const KvsFlushStats start = scheduler.stats(KvsFlushClass::Normal);
+    const std::string dir = data_dir + "retry/";
+    std::filesystem::create_directories(dir);
+    {
+        auto result = KvsBuilder(instance_id).dir(std::string(dir)).scheduled_flush(KvsFlushClass::Normal).build();
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+
+        /* The directory is replaced by a file, the flush fails and stays pending */
+        std::filesystem::remove_all(dir);
+        std::ofstream(data_dir + "retry") << "file";
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(1)));
+        ASSERT_TRUE(kvs.flush());
+        ASSERT_TRUE(wait_for([&]() {
+            return scheduler.stats(KvsFlushClass::Normal).failed > start.failed;
+        }));
+        EXPECT_EQ(scheduler.pending(), 1U);
+
+        /* The retry writes it once the directory is back */
+        std::filesystem::remove(data_dir + "retry");
+        std::filesystem::create_directories(dir);
+        ASSERT_TRUE(wait_for([&]() {
+            return scheduler.stats(KvsFlushClass::Normal).flushed == (start.flushed + 1U);
+        }));
+        EXPECT_EQ(scheduler.pending(), 0U);
+    }
+    auto reopened = KvsBuilder(instance_id).dir(std::string(dir)).build();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("generation").value().getValue()), 1);
+    reset_scheduler();
+
+    cleanup_environment();
+}
@@ -0,0 +1,96 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+TEST(kvs_frozen_map, frozen_map_empty)
+{
+    FrozenKvsMap frozen;
+    EXPECT_TRUE(frozen.empty());
+    EXPECT_EQ(frozen.size(), 0U);
+    EXPECT_EQ(frozen.find("key"), nullptr);
+    EXPECT_EQ(frozen.find(""), nullptr);
+
+    FrozenKvsMap from_empty_map(FrozenKvsMap::Map{});
+    EXPECT_TRUE(from_empty_map.empty());
+    EXPECT_EQ(from_empty_map.count("key"), 0U);
+}
+
+TEST(kvs_frozen_map, frozen_map_lookup)
+{
+    /* Sizes around the bucket boundaries */
+    for (std::size_t size : {1U, 2U, 3U, 4U, 5U, 17U, 1000U})
+    {
+        FrozenKvsMap::Map map;
+        for (std::size_t i = 0U; i < size; ++i)
+        {
+            map.emplace("key." + std::to_string(i), KvsValue(static_cast<uint64_t>(i)));
+        }
+        FrozenKvsMap frozen(map);
+        ASSERT_EQ(frozen.size(), size);
+
+        for (std::size_t i = 0U; i < size; ++i)
+        {
+            const KvsValue* value = frozen.find("key." + std::to_string(i));
+            ASSERT_NE(value, nullptr);
+            EXPECT_EQ(std::get<uint64_t>(value->getValue()), i);
+        }
+        EXPECT_EQ(frozen.find("key." + std::to_string(size)), nullptr);
+        EXPECT_EQ(frozen.find("key"), nullptr);
+        EXPECT_EQ(frozen.to_map().size(), size);
+    }
+}
+
+TEST(kvs_frozen_map, frozen_map_move_and_copy)
+{
+    FrozenKvsMap frozen(FrozenKvsMap::Map{{"key", KvsValue(true)}});
+
+    FrozenKvsMap copy = frozen;
+    EXPECT_TRUE(copy.shares_table_with(frozen));
+
+    FrozenKvsMap moved = std::move(frozen);
+    EXPECT_TRUE(moved.shares_table_with(copy));
+    EXPECT_TRUE(frozen.empty());
+    EXPECT_EQ(frozen.find("key"), nullptr);
+}
+
+TEST(kvs_frozen_map, frozen_map_intern)
+{
+    KvsValue::Object object;
+    object.emplace("a", std::make_shared<KvsValue>(1.5));
+    FrozenKvsMap::Map map{{"number", KvsValue(int32_t(5))}, {"object", KvsValue(object)}};
+
+    FrozenKvsMap first = FrozenKvsMap::intern(map);
+    FrozenKvsMap second = FrozenKvsMap::intern(map);
+    EXPECT_TRUE(first.shares_table_with(second));
+
+    /* Different content is not shared */
+    map.insert_or_assign("number", KvsValue(int32_t(6)));
+    FrozenKvsMap third = FrozenKvsMap::intern(map);
+    EXPECT_FALSE(third.shares_table_with(first));
+    EXPECT_EQ(std::get<int32_t>(third.find("number")->getValue()), 6);
+}
+
+TEST(kvs_frozen_map, frozen_map_shared_between_instances)
+{
+    prepare_environment();
+
+    auto result_a = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result_a);
+    auto result_b = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result_b);
+
+    EXPECT_TRUE(result_a.value().default_values.shares_table_with(result_b.value().default_values));
+    EXPECT_EQ(std::get<int32_t>(result_a.value().default_values.find("default")->getValue()), 5);
+
+    cleanup_environment();
+}
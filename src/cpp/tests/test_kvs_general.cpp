@@ -72,3 +72,44 @@ void cleanup_environment()
         std::filesystem::remove_all(data_dir);
     }
 }
+
+/* Default values are frozen after open, so tests replace them with an extended table */
+void set_default_value(Kvs& kvs, const std::string& key, const KvsValue& value)
+{
+    FrozenKvsMap::Map defaults = kvs.default_values.to_map();
+    defaults.insert_or_assign(key, value);
+    kvs.default_values = FrozenKvsMap(defaults);
+}
+
+/* Read a whole file, an unreadable file is empty */
+std::string read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+/* Number of entries in the data directory */
+std::size_t count_files()
+{
+    return static_cast<std::size_t>(std::distance(std::filesystem::directory_iterator(data_dir),
+                                                  std::filesystem::directory_iterator()));
+}
+
+/* Open the test instance in slot mode */
+score::Result<Kvs> open_slots(bool lazy)
+{
+    return KvsBuilder(instance_id).dir(std::string(data_dir)).slots(KvsSlotPolicy{4096U}).lazy_values(lazy).build();
+}
+
+/* Open the container file of the data directory, nullptr on failure */
+std::shared_ptr<KvsContainer> open_container()
+{
+    auto result = KvsContainer::open(container_path);
+    return result ? result.value() : nullptr;
+}
+
+/* Open an instance stored in a container */
+score::Result<Kvs> open_instance(const std::shared_ptr<KvsContainer>& container, const InstanceId& id)
+{
+    return KvsBuilder(id).dir(std::string(data_dir)).container(container).build();
+}
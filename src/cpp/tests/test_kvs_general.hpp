@@ -17,12 +17,15 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <array>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <thread>
 
 /* Change Private Members and final to public to allow access to member variables (kvs and
  * kvsbuilder) and derive from kvsvalue in unittests*/
@@ -31,7 +34,14 @@
 #include "kvsbuilder.hpp"
 #undef private
 #undef final
+#include "internal/adler32.hpp"
+#include "internal/checksum.hpp"
+#include "internal/group_commit.hpp"
 #include "internal/kvs_helper.hpp"
+#include "internal/lz_block.hpp"
+#include "internal/slot_store.hpp"
+#include "internal/snapshot_scrubber.hpp"
+#include "internal/uring_io.hpp"
 #include "score/filesystem/filesystem_mock.h"
 #include "score/json/i_json_parser_mock.h"
 #include "score/json/i_json_writer_mock.h"
@@ -42,6 +52,12 @@ using namespace score::mw::per::kvs;
 uint32_t adler32(const std::string& data);
 void prepare_environment();
 void cleanup_environment();
+void set_default_value(Kvs& kvs, const std::string& key, const KvsValue& value);
+std::string read_file(const std::string& path);
+std::size_t count_files();
+score::Result<Kvs> open_slots(bool lazy = false);
+std::shared_ptr<KvsContainer> open_container();
+score::Result<Kvs> open_instance(const std::shared_ptr<KvsContainer>& container, const InstanceId& id);
 
 ////////////////////////////////////////////////////////////////////////////////
 /* Default data used in unittests*/
@@ -56,6 +72,7 @@ const std::string data_dir = "./data_folder/";
 const std::string default_prefix = data_dir + "kvs_" + std::to_string(instance) + "_default";
 const std::string kvs_prefix = data_dir + "kvs_" + std::to_string(instance) + "_0";
 const std::string filename_prefix = data_dir + "kvs_" + std::to_string(instance);
+const std::string container_path = data_dir + "kvs.container";
 
 const std::string default_json = R"({
     "default": {
@@ -0,0 +1,95 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+TEST(kvs_group, flush_all)
+{
+    prepare_environment();
+
+    auto first = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(first);
+    auto second = KvsBuilder(InstanceId{124}).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(second);
+    auto third = KvsBuilder(InstanceId{125}).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(third);
+
+    KvsGroup group;
+    group.add(first.value()).add(second.value()).add(third.value()).add(first.value());
+    EXPECT_EQ(group.size(), 3U);
+
+    /* Freshly opened instances are clean and not written */
+    ASSERT_TRUE(group.flush_all());
+    EXPECT_FALSE(std::filesystem::exists(data_dir + "kvs_125_0.json"));
+
+    ASSERT_TRUE(first.value().set_value("group", KvsValue(1)));
+    ASSERT_TRUE(second.value().set_value("group", KvsValue(2)));
+    EXPECT_TRUE(first.value().is_dirty().value());
+    EXPECT_FALSE(third.value().is_dirty().value());
+
+    ASSERT_TRUE(group.flush_all());
+    EXPECT_FALSE(first.value().is_dirty().value());
+    EXPECT_FALSE(second.value().is_dirty().value());
+    EXPECT_FALSE(std::filesystem::exists(data_dir + "kvs_125_0.json"));
+    EXPECT_FALSE(std::filesystem::exists(data_dir + "kvs_124_1.json"));
+
+    /* A second flush without changes keeps the snapshots untouched */
+    ASSERT_TRUE(group.flush_all());
+    EXPECT_FALSE(std::filesystem::exists(data_dir + "kvs_124_1.json"));
+
+    auto reopened = KvsBuilder(InstanceId{124}).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("group").value().getValue()), 2);
+    reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("group").value().getValue()), 1);
+
+    cleanup_environment();
+}
+
+TEST(kvs_group, flush_all_failure)
+{
+    prepare_environment();
+
+    auto first = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(first);
+    auto second = KvsBuilder(InstanceId{124}).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(second);
+    ASSERT_TRUE(second.value().set_value("group", KvsValue(2)));
+
+    KvsGroup group;
+    group.add(first.value()).add(second.value());
+
+    /* A locked instance fails, the other one is still written */
+    {
+        std::unique_lock<std::mutex> lock(first.value().kvs_mutex);
+        auto flush_res = group.flush_all();
+        ASSERT_FALSE(flush_res);
+        EXPECT_EQ(static_cast<ErrorCode>(*flush_res.error()), ErrorCode::MutexLockFailed);
+    }
+    EXPECT_TRUE(std::filesystem::exists(data_dir + "kvs_124_0.json"));
+    EXPECT_FALSE(second.value().is_dirty().value());
+
+    /* Written files that failed the shared barrier stay modified */
+    ASSERT_TRUE(second.value().set_value("group", KvsValue(3)));
+    std::vector<int> fds;
+    ASSERT_TRUE(second.value().flush_files(&fds));
+    EXPECT_FALSE(fds.empty());
+    for (const int fd : fds)
+    {
+        ::close(fd);
+    }
+    EXPECT_TRUE(second.value().complete_deferred_flush(false));
+    EXPECT_TRUE(second.value().is_dirty().value());
+
+    cleanup_environment();
+}
@@ -585,3 +585,74 @@ TEST(kvs_kvsvalue_to_any, kvsvalue_to_any_invalid)
     EXPECT_FALSE(result.has_value());
     EXPECT_EQ(result.error(), ErrorCode::InvalidValueType);
 }
+
+TEST(kvs_index_json_object, index_json_object_members)
+{
+    const std::string data = R"({ "a": {"t": "i32", "v": 1},
+        "esc\"apedA": {"t": "str", "v": "}{,\""}, "list" : [1, {"x": [2]}], "n": null })";
+    auto result = index_json_object(data);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result.value().size(), 4U);
+    EXPECT_EQ(result.value()[0].key, "a");
+    EXPECT_EQ(result.value()[0].member, R"("a": {"t": "i32", "v": 1})");
+    EXPECT_EQ(result.value()[0].value, R"({"t": "i32", "v": 1})");
+    EXPECT_EQ(result.value()[1].key, "esc\"apedA");
+    EXPECT_EQ(result.value()[1].value, R"({"t": "str", "v": "}{,\""})");
+    EXPECT_EQ(result.value()[2].value, R"([1, {"x": [2]}])");
+    EXPECT_EQ(result.value()[3].value, "null");
+
+    auto empty = index_json_object(" {} ");
+    ASSERT_TRUE(empty);
+    EXPECT_TRUE(empty.value().empty());
+}
+
+TEST(kvs_index_json_object, index_json_object_invalid)
+{
+    for (const char* data : {"", "[]", "{", R"({"a" 1})", R"({"a": 1,})", R"({"a": {"b": 1})", R"({"a": 1} x)",
+                             R"({"a": "open})", R"({a: 1})"})
+    {
+        auto result = index_json_object(data);
+        ASSERT_FALSE(result) << data;
+        EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::JsonParserError);
+    }
+}
+
+TEST(kvs_index_json_object, append_json_members)
+{
+    std::string buf = "{\n}";
+    append_json_members(buf, {});
+    EXPECT_EQ(buf, "{\n}");
+    append_json_members(buf, {R"("a": 1)"});
+    EXPECT_EQ(buf, "{\n\"a\": 1}");
+    append_json_members(buf, {R"("b": 2)", R"("c": 3)"});
+    EXPECT_EQ(buf, "{\n\"a\": 1,\"b\": 2,\"c\": 3}");
+}
+
+TEST(kvs_read_file_hashed, read_file_hashed)
+{
+    prepare_environment();
+    std::string large(200000U, 'x');
+    for (std::size_t i = 0U; i < large.size(); i += 7U)
+    {
+        large[i] = static_cast<char>('a' + (i % 26U));
+    }
+    std::ofstream(data_dir + "large", std::ios::binary) << large;
+
+    /* The checksum is fed with the whole file across multiple chunks */
+    for (const auto algorithm : {KvsChecksum::Adler32, KvsChecksum::Crc32c, KvsChecksum::XxHash64})
+    {
+        auto checksum = make_checksum(algorithm);
+        std::string data = "stale";
+        ASSERT_TRUE(read_file_hashed(data_dir + "large", data, checksum.get()));
+        EXPECT_EQ(data, large);
+        EXPECT_EQ(checksum->digest(), calculate_checksum(algorithm, large.data(), large.size()));
+    }
+
+    std::string data;
+    ASSERT_TRUE(read_file_hashed(kvs_prefix + ".json", data, nullptr));
+    EXPECT_EQ(data, kvs_json);
+    EXPECT_FALSE(read_file_hashed(data_dir + "missing", data, nullptr));
+    EXPECT_FALSE(read_file_hashed(data_dir, data, nullptr));
+
+    cleanup_environment();
+}
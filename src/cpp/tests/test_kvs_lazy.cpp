@@ -0,0 +1,245 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+/* Write a KVS file with several keys through an eagerly opened instance */
+static void prepare_lazy_environment()
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("number", KvsValue(42.0)));
+    ASSERT_TRUE(result.value().set_value("text", KvsValue(std::string("a \"quoted\" text"))));
+    ASSERT_TRUE(result.value().set_value("list", KvsValue(KvsValue::Array{std::make_shared<KvsValue>(1.0), std::make_shared<KvsValue>(true)})));
+    ASSERT_TRUE(result.value().set_value("cfg.mode", KvsValue(std::string("fast"))));
+    ASSERT_TRUE(result.value().flush());
+}
+
+static score::Result<Kvs> open_lazy()
+{
+    return KvsBuilder(instance_id).dir(std::string(data_dir)).lazy_values(true).build();
+}
+
+TEST(kvs_lazy, builder_lazy_values)
+{
+    prepare_lazy_environment();
+
+    auto eager = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(eager);
+    EXPECT_TRUE(eager.value().raw_values.empty());
+    EXPECT_EQ(eager.value().kvs.size(), 5U);
+
+    auto lazy = open_lazy();
+    ASSERT_TRUE(lazy);
+    EXPECT_TRUE(lazy.value().kvs.empty());
+    EXPECT_EQ(lazy.value().raw_values.size(), 5U);
+    EXPECT_NE(lazy.value().raw_buffer, nullptr);
+    EXPECT_FALSE(lazy.value().is_dirty().value());
+
+    /* Defaults are not affected */
+    EXPECT_EQ(std::get<int32_t>(lazy.value().get_default_value("default").value().getValue()), 5);
+
+    /* The state survives a move */
+    Kvs moved = std::move(lazy.value());
+    EXPECT_EQ(moved.raw_values.size(), 5U);
+    EXPECT_EQ(std::get<double>(moved.get_value("number").value().getValue()), 42.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_lazy, get_value_decodes_on_access)
+{
+    prepare_lazy_environment();
+    auto result = open_lazy();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    EXPECT_EQ(std::get<std::string>(kvs.get_value("text").value().getValue()), "a \"quoted\" text");
+    EXPECT_EQ(kvs.raw_values.size(), 4U);
+    EXPECT_EQ(kvs.kvs.size(), 1U);
+    EXPECT_EQ(std::get<std::string>(kvs.get_value("text").value().getValue()), "a \"quoted\" text");
+
+    auto list = kvs.get_value("list");
+    ASSERT_TRUE(list);
+    const auto& array = std::get<KvsValue::Array>(list.value().getValue());
+    ASSERT_EQ(array.size(), 2U);
+    EXPECT_TRUE(std::get<bool>(array[1]->getValue()));
+
+    /* Reading does not modify the store */
+    EXPECT_FALSE(kvs.is_dirty().value());
+
+    /* Missing keys still fall back to the defaults */
+    EXPECT_EQ(std::get<int32_t>(kvs.get_value("default").value().getValue()), 5);
+    EXPECT_EQ(static_cast<ErrorCode>(*kvs.get_value("missing").error()), ErrorCode::KeyNotFound);
+
+    /* Decoding all values releases the retained file */
+    const auto keys = kvs.get_all_keys();
+    ASSERT_TRUE(keys);
+    for (const auto& key : keys.value())
+    {
+        ASSERT_TRUE(kvs.get_value(key));
+    }
+    EXPECT_TRUE(kvs.raw_values.empty());
+    EXPECT_EQ(kvs.raw_buffer, nullptr);
+
+    cleanup_environment();
+}
+
+TEST(kvs_lazy, key_access_without_decoding)
+{
+    prepare_lazy_environment();
+    auto result = open_lazy();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    EXPECT_TRUE(kvs.key_exists("number").value());
+    EXPECT_FALSE(kvs.key_exists("missing").value());
+    EXPECT_EQ(kvs.get_all_keys().value().size(), 5U);
+    EXPECT_FALSE(kvs.is_value_default("kvs").value());
+    EXPECT_TRUE(kvs.kvs.empty());
+
+    /* Overwriting and removing do not need the stored value */
+    ASSERT_TRUE(kvs.set_value("number", KvsValue(7.0)));
+    EXPECT_EQ(kvs.raw_values.count("number"), 0U);
+    EXPECT_EQ(std::get<double>(kvs.get_value("number").value().getValue()), 7.0);
+    ASSERT_TRUE(kvs.remove_key("text"));
+    EXPECT_FALSE(kvs.key_exists("text").value());
+    EXPECT_EQ(static_cast<ErrorCode>(*kvs.remove_key("text").error()), ErrorCode::KeyNotFound);
+
+    set_default_value(kvs, "list", KvsValue(0.0));
+    ASSERT_TRUE(kvs.reset_key("list"));
+    EXPECT_EQ(std::get<double>(kvs.get_value("list").value().getValue()), 0.0);
+    EXPECT_TRUE(kvs.is_dirty().value());
+
+    ASSERT_TRUE(kvs.reset());
+    EXPECT_TRUE(kvs.raw_values.empty());
+    EXPECT_EQ(kvs.raw_buffer, nullptr);
+
+    cleanup_environment();
+}
+
+TEST(kvs_lazy, flush_keeps_undecoded_values)
+{
+    prepare_lazy_environment();
+    {
+        auto result = open_lazy();
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("added", KvsValue(1.0)));
+        ASSERT_TRUE(result.value().remove_key("kvs"));
+        EXPECT_EQ(std::get<std::string>(result.value().get_value("cfg.mode").value().getValue()), "fast");
+        ASSERT_TRUE(result.value().flush());
+        EXPECT_EQ(result.value().raw_values.size(), 3U);
+
+        /* The instance keeps its raw values valid after the file was rotated */
+        ASSERT_TRUE(result.value().flush());
+        EXPECT_EQ(std::get<double>(result.value().get_value("number").value().getValue()), 42.0);
+    }
+
+    auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(reopened.value().kvs.size(), 5U);
+    EXPECT_EQ(std::get<double>(reopened.value().get_value("added").value().getValue()), 1.0);
+    EXPECT_EQ(std::get<double>(reopened.value().get_value("number").value().getValue()), 42.0);
+    EXPECT_EQ(std::get<std::string>(reopened.value().get_value("text").value().getValue()), "a \"quoted\" text");
+    EXPECT_EQ(std::get<std::string>(reopened.value().get_value("cfg.mode").value().getValue()), "fast");
+    EXPECT_FALSE(reopened.value().key_exists("kvs").value());
+
+    cleanup_environment();
+}
+
+TEST(kvs_lazy, scope_and_key_handle)
+{
+    prepare_lazy_environment();
+    auto result = open_lazy();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Opening a scope decodes its keys, they are migrated to the segment */
+    auto scope = kvs.scope("cfg.");
+    ASSERT_TRUE(scope);
+    EXPECT_EQ(kvs.raw_values.count("cfg.mode"), 0U);
+    EXPECT_EQ(std::get<std::string>(scope.value().get_value("mode").value().getValue()), "fast");
+
+    auto handle = kvs.key("number");
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(kvs.raw_values.count("number"), 0U);
+    EXPECT_EQ(std::get<double>(kvs.get_value(handle.value()).value().getValue()), 42.0);
+    ASSERT_TRUE(kvs.set_value(handle.value(), KvsValue(3.0)));
+    EXPECT_EQ(std::get<double>(kvs.get_value("number").value().getValue()), 3.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_lazy, snapshot_restore)
+{
+    prepare_lazy_environment();
+    {
+        auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("number", KvsValue(1.0)));
+        ASSERT_TRUE(result.value().flush());
+    }
+
+    auto result = open_lazy();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(std::get<double>(result.value().get_value("number").value().getValue()), 1.0);
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    EXPECT_TRUE(result.value().raw_values.empty());
+    EXPECT_EQ(std::get<double>(result.value().get_value("number").value().getValue()), 42.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_lazy, open_invalid_file)
+{
+    prepare_environment();
+
+    /* The hash is still validated at open */
+    std::ofstream(kvs_prefix + ".hash", std::ios::binary | std::ios::trunc) << "0000";
+    auto result = open_lazy();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    /* Structural errors are detected at open, value errors on access */
+    const std::string broken = R"({"broken": {"t": "i32", "v": 1}, "bad": {"t": "unknown", "v": 1})";
+    std::ofstream(kvs_prefix + ".json", std::ios::trunc) << broken;
+    const uint32_t hash = adler32(broken);
+    std::ofstream hash_file(kvs_prefix + ".hash", std::ios::binary | std::ios::trunc);
+    hash_file.put((hash >> 24) & 0xFF);
+    hash_file.put((hash >> 16) & 0xFF);
+    hash_file.put((hash >> 8) & 0xFF);
+    hash_file.put(hash & 0xFF);
+    hash_file.close();
+    result = open_lazy();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::JsonParserError);
+
+    const std::string invalid = R"({"valid": {"t": "i32", "v": 1}, "bad": {"t": "unknown", "v": 1}})";
+    std::ofstream(kvs_prefix + ".json", std::ios::trunc) << invalid;
+    const uint32_t invalid_hash = adler32(invalid);
+    hash_file.open(kvs_prefix + ".hash", std::ios::binary | std::ios::trunc);
+    hash_file.put((invalid_hash >> 24) & 0xFF);
+    hash_file.put((invalid_hash >> 16) & 0xFF);
+    hash_file.put((invalid_hash >> 8) & 0xFF);
+    hash_file.put(invalid_hash & 0xFF);
+    hash_file.close();
+    result = open_lazy();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("valid").value().getValue()), 1);
+    auto bad = result.value().get_value("bad");
+    ASSERT_FALSE(bad);
+    EXPECT_EQ(static_cast<ErrorCode>(*bad.error()), ErrorCode::InvalidValueType);
+    EXPECT_EQ(result.value().raw_values.count("bad"), 1U);
+
+    cleanup_environment();
+}
@@ -0,0 +1,177 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+static score::Result<Kvs> open_with_manifest()
+{
+    return KvsBuilder(instance_id).dir(std::string(data_dir)).manifest(true).build();
+}
+
+TEST(kvs_manifest, manifest_bytes)
+{
+    std::vector<ManifestEntry> entries(KVS_MAX_SNAPSHOTS + 1U);
+    entries[0] = ManifestEntry{true, 123U, KvsChecksum::XxHash64, 0x0123456789ABCDEFU, 1700000000000000000};
+    entries[1] = ManifestEntry{true, 7U, KvsChecksum::Adler32, 0xDEADBEEFU, 1600000000000000000};
+    const std::vector<uint8_t> bytes = get_manifest_bytes(entries);
+    const std::string file(bytes.begin(), bytes.end());
+
+    const auto parsed = parse_manifest(file);
+    ASSERT_TRUE(parsed.has_value());
+    ASSERT_EQ(parsed->size(), entries.size());
+    EXPECT_TRUE(parsed->at(0).present);
+    EXPECT_EQ(parsed->at(0).size, 123U);
+    EXPECT_EQ(parsed->at(0).algorithm, KvsChecksum::XxHash64);
+    EXPECT_EQ(parsed->at(0).digest, 0x0123456789ABCDEFU);
+    EXPECT_EQ(parsed->at(0).created_ns, 1700000000000000000);
+    EXPECT_EQ(parsed->at(1).digest, 0xDEADBEEFU);
+    EXPECT_FALSE(parsed->at(2).present);
+
+    /* Damaged, truncated and extended manifests are rejected */
+    std::string damaged = file;
+    damaged[10] = static_cast<char>(damaged[10] ^ 0x01);
+    EXPECT_FALSE(parse_manifest(damaged).has_value());
+    EXPECT_FALSE(parse_manifest(file.substr(0U, file.size() - 1U)).has_value());
+    EXPECT_FALSE(parse_manifest(file + "x").has_value());
+    EXPECT_FALSE(parse_manifest("").has_value());
+}
+
+TEST(kvs_manifest, queries_from_memory)
+{
+    prepare_environment();
+    auto result = open_with_manifest();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    const auto before = std::chrono::system_clock::now();
+    for (const double generation : {1.0, 2.0})
+    {
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+        ASSERT_TRUE(kvs.flush());
+    }
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + ".manifest"));
+    EXPECT_EQ(kvs.snapshot_count().value(), 3U);
+
+    auto info = kvs.snapshot_info();
+    ASSERT_TRUE(info);
+    ASSERT_EQ(info.value().size(), 3U);
+    for (std::size_t idx = 0U; idx < 3U; ++idx)
+    {
+        const std::string json = filename_prefix + "_" + std::to_string(idx) + ".json";
+        EXPECT_EQ(info.value()[idx].id, idx);
+        EXPECT_EQ(info.value()[idx].size, std::filesystem::file_size(json));
+    }
+    EXPECT_GE(info.value()[0].created, before);
+    EXPECT_GE(info.value()[0].created, info.value()[1].created);
+    EXPECT_LT(info.value()[2].created, before); /* Written by prepare_environment */
+
+    /* The files are not probed again */
+    std::filesystem::remove(filename_prefix + "_2.json");
+    EXPECT_EQ(kvs.snapshot_count().value(), 3U);
+    EXPECT_TRUE(kvs.get_kvs_filename(2));
+    EXPECT_TRUE(kvs.get_hash_filename(2));
+    auto missing = kvs.get_kvs_filename(3);
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(static_cast<ErrorCode>(*missing.error()), ErrorCode::FileNotFound);
+
+    /* The oldest snapshot is dropped by the rotation */
+    for (std::size_t i = 0U; i < KVS_MAX_SNAPSHOTS; ++i)
+    {
+        ASSERT_TRUE(kvs.flush());
+    }
+    EXPECT_EQ(kvs.snapshot_count().value(), KVS_MAX_SNAPSHOTS);
+    EXPECT_EQ(kvs.snapshot_info().value().size(), KVS_MAX_SNAPSHOTS + 1U);
+    ASSERT_TRUE(kvs.snapshot_restore(KVS_MAX_SNAPSHOTS));
+
+    cleanup_environment();
+}
+
+TEST(kvs_manifest, group_flush)
+{
+    prepare_environment();
+    auto result = open_with_manifest();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_TRUE(std::filesystem::exists(filename_prefix + ".manifest"));
+    const auto written = std::filesystem::last_write_time(filename_prefix + ".manifest");
+
+    /* With a shared barrier, the manifest file is replaced after the listed files are synced */
+    ASSERT_TRUE(kvs.set_value("generation", KvsValue(1.0)));
+    std::vector<int> fds;
+    ASSERT_TRUE(kvs.flush_files(&fds));
+    EXPECT_EQ(std::filesystem::last_write_time(filename_prefix + ".manifest"), written);
+    for (const int fd : fds)
+    {
+        ASSERT_EQ(::fdatasync(fd), 0);
+        ::close(fd);
+    }
+    ASSERT_TRUE(kvs.complete_deferred_flush(true));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + ".manifest.tmp"));
+
+    auto loaded = open_with_manifest();
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded.value().snapshot_count().value(), 3U);
+    EXPECT_EQ(loaded.value().snapshot_info().value()[0].size, std::filesystem::file_size(filename_prefix + "_0.json"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_manifest, load_and_rebuild)
+{
+    prepare_environment();
+    std::vector<KvsSnapshotInfo> flushed;
+    {
+        auto result = open_with_manifest();
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().flush());
+        flushed = result.value().snapshot_info().value();
+    }
+
+    /* The manifest is loaded, the creation times are the flush times and not the file times */
+    auto loaded = open_with_manifest();
+    ASSERT_TRUE(loaded);
+    auto info = loaded.value().snapshot_info().value();
+    ASSERT_EQ(info.size(), flushed.size());
+    EXPECT_EQ(info[0].created, flushed[0].created);
+    EXPECT_EQ(info[1].created, flushed[1].created);
+
+    /* A flush without manifest outdates it, it is rebuilt from the files */
+    {
+        auto plain = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+        ASSERT_TRUE(plain);
+        ASSERT_TRUE(plain.value().set_value("plain", KvsValue(1.0)));
+        ASSERT_TRUE(plain.value().flush());
+    }
+    auto rebuilt = open_with_manifest();
+    ASSERT_TRUE(rebuilt);
+    EXPECT_EQ(rebuilt.value().snapshot_count().value(), 3U);
+    info = rebuilt.value().snapshot_info().value();
+    ASSERT_EQ(info.size(), 3U);
+    EXPECT_EQ(info[0].size, std::filesystem::file_size(filename_prefix + "_0.json"));
+
+    /* A damaged manifest is rebuilt as well */
+    std::filesystem::remove(filename_prefix + "_2.json");
+    {
+        std::fstream manifest(filename_prefix + ".manifest", std::ios::in | std::ios::out | std::ios::binary);
+        manifest.seekp(8);
+        manifest.put('\xFF');
+    }
+    auto damaged = open_with_manifest();
+    ASSERT_TRUE(damaged);
+    EXPECT_EQ(damaged.value().snapshot_count().value(), 2U);
+
+    /* The moved object keeps the manifest */
+    Kvs moved = std::move(damaged.value());
+    EXPECT_EQ(moved.snapshot_count().value(), 2U);
+
+    cleanup_environment();
+}
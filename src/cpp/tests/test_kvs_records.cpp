@@ -0,0 +1,209 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+/* Write two generations with per-record checksums: snapshot 1 holds the first, file 0 the second */
+static void prepare_records_environment()
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).record_checksums(true).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("first", KvsValue(1.0)));
+    ASSERT_TRUE(result.value().set_value("second", KvsValue(std::string("text"))));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().set_value("first", KvsValue(2.0)));
+    ASSERT_TRUE(result.value().set_value("latest", KvsValue(3.0)));
+    ASSERT_TRUE(result.value().flush());
+}
+
+/* Flip a character inside the value (or the key) of a member of the KVS file, the hash file is kept */
+static void corrupt_member(const std::string& key, bool corrupt_key)
+{
+    std::string data = read_file(kvs_prefix + ".json");
+    auto members = index_json_object(data);
+    ASSERT_TRUE(members);
+    bool found = false;
+    for (const auto& member : members.value())
+    {
+        if (member.key == key)
+        {
+            const std::string_view range = corrupt_key ? member.member : member.value;
+            const std::size_t pos = static_cast<std::size_t>(range.data() - data.data()) + (corrupt_key ? 1U : 0U);
+            const std::size_t digit = corrupt_key ? pos : data.find_first_of("0123456789", pos);
+            ASSERT_NE(digit, std::string::npos);
+            data[digit] = corrupt_key ? 'X' : '7';
+            found = true;
+        }
+    }
+    ASSERT_TRUE(found);
+    std::ofstream(kvs_prefix + ".json", std::ios::binary | std::ios::trunc) << data;
+}
+
+TEST(kvs_records, hash_file_records_format)
+{
+    const std::string data = R"({"a": {"t": "f64", "v": 1.0}, "b": {"t": "str", "v": "x"}})";
+    auto members = index_json_object(data);
+    ASSERT_TRUE(members);
+
+    for (const auto algorithm : {KvsChecksum::Adler32, KvsChecksum::Crc32c, KvsChecksum::XxHash64})
+    {
+        const auto bytes = get_hash_file_bytes(data, algorithm, true);
+        const std::string file(bytes.begin(), bytes.end());
+        EXPECT_EQ(file.substr(0U, 4U), "KVSH");
+        EXPECT_EQ(bytes[4], 2U);
+
+        const auto parsed = parse_hash_file(file);
+        ASSERT_TRUE(parsed.has_value());
+        EXPECT_EQ(parsed->algorithm, algorithm);
+        EXPECT_EQ(parsed->digest, calculate_checksum(algorithm, data.data(), data.size()));
+        EXPECT_TRUE(parsed->has_records);
+        ASSERT_EQ(parsed->records.size(), 2U);
+        for (const auto& member : members.value())
+        {
+            EXPECT_EQ(parsed->records.at(member.key),
+                      calculate_checksum(algorithm, member.member.data(), member.member.size()));
+        }
+
+        /* Truncated and oversized tables are rejected */
+        EXPECT_FALSE(parse_hash_file(file.substr(0U, file.size() - 1U)).has_value());
+        EXPECT_FALSE(parse_hash_file(file + "x").has_value());
+    }
+
+    /* Without records, the format is unchanged */
+    const auto plain = parse_hash_file(
+        [&]() {
+            const auto bytes = get_hash_file_bytes(data, KvsChecksum::Crc32c);
+            return std::string(bytes.begin(), bytes.end());
+        }());
+    ASSERT_TRUE(plain.has_value());
+    EXPECT_FALSE(plain->has_records);
+
+    /* The records of an invalid JSON object cannot be computed */
+    EXPECT_TRUE(get_hash_file_bytes("{\"a\": ", KvsChecksum::Crc32c, true).empty());
+}
+
+TEST(kvs_records, corrupted_value_recovered)
+{
+    prepare_records_environment();
+    corrupt_member("first", false);
+
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Only the damaged key is replaced with its copy of snapshot 1 */
+    EXPECT_EQ(std::get<double>(kvs.get_value("first").value().getValue()), 1.0);
+    EXPECT_EQ(std::get<std::string>(kvs.get_value("second").value().getValue()), "text");
+    EXPECT_EQ(std::get<double>(kvs.get_value("latest").value().getValue()), 3.0);
+    auto corrupted = kvs.corrupted_records();
+    ASSERT_TRUE(corrupted);
+    ASSERT_EQ(corrupted.value().size(), 1U);
+    EXPECT_EQ(corrupted.value()[0].key, "first");
+    EXPECT_EQ(corrupted.value()[0].recovered_from, 1U);
+
+    /* The repaired file is written on the next flush */
+    EXPECT_TRUE(kvs.is_dirty().value());
+    ASSERT_TRUE(kvs.flush());
+    auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<double>(reopened.value().get_value("first").value().getValue()), 1.0);
+    EXPECT_TRUE(reopened.value().corrupted_records().value().empty());
+
+    cleanup_environment();
+}
+
+TEST(kvs_records, corrupted_value_lost)
+{
+    prepare_records_environment();
+    corrupt_member("latest", false);
+
+    /* No snapshot holds the key, it is dropped and reported */
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(result.value().key_exists("latest").value());
+    EXPECT_EQ(std::get<double>(result.value().get_value("first").value().getValue()), 2.0);
+    auto corrupted = result.value().corrupted_records();
+    ASSERT_TRUE(corrupted);
+    ASSERT_EQ(corrupted.value().size(), 1U);
+    EXPECT_EQ(corrupted.value()[0].key, "latest");
+    EXPECT_EQ(corrupted.value()[0].recovered_from, 0U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_records, corrupted_key_recovered)
+{
+    prepare_records_environment();
+    corrupt_member("second", true);
+
+    /* The garbled key is dropped, the original key is recovered */
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(std::get<std::string>(result.value().get_value("second").value().getValue()), "text");
+    EXPECT_EQ(result.value().get_all_keys().value().size(), 4U);
+    auto corrupted = result.value().corrupted_records();
+    ASSERT_TRUE(corrupted);
+    ASSERT_EQ(corrupted.value().size(), 1U);
+    EXPECT_EQ(corrupted.value()[0].key, "second");
+
+    cleanup_environment();
+}
+
+TEST(kvs_records, corrupted_lazy_value)
+{
+    prepare_records_environment();
+    corrupt_member("first", false);
+
+    /* Lazy values are verified on first access */
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).lazy_values(true).build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    EXPECT_TRUE(kvs.corrupted_records().value().empty());
+    EXPECT_EQ(std::get<std::string>(kvs.get_value("second").value().getValue()), "text");
+    EXPECT_TRUE(kvs.corrupted_records().value().empty());
+    EXPECT_EQ(std::get<double>(kvs.get_value("first").value().getValue()), 1.0);
+    ASSERT_EQ(kvs.corrupted_records().value().size(), 1U);
+    EXPECT_EQ(kvs.corrupted_records().value()[0].recovered_from, 1U);
+    EXPECT_TRUE(kvs.is_dirty().value());
+
+    /* Untouched values are verified before they are written back */
+    prepare_records_environment();
+    corrupt_member("first", false);
+    result = KvsBuilder(instance_id).dir(std::string(data_dir)).lazy_values(true).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_EQ(result.value().corrupted_records().value().size(), 1U);
+    auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<double>(reopened.value().get_value("first").value().getValue()), 1.0);
+    EXPECT_EQ(std::get<double>(reopened.value().get_value("latest").value().getValue()), 3.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_records, corrupted_without_records)
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("first", KvsValue(2.0)));
+    ASSERT_TRUE(result.value().flush());
+    corrupt_member("first", false);
+
+    /* Without per-record checksums, the whole file fails */
+    result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
@@ -0,0 +1,207 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+static bool snapshot_exists(std::size_t id)
+{
+    return std::filesystem::exists(filename_prefix + "_" + std::to_string(id) + ".json");
+}
+
+/* Set the generation and flush */
+static void flush_generation(Kvs& kvs, double generation)
+{
+    ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+    ASSERT_TRUE(kvs.flush());
+}
+
+TEST(kvs_retention, count_policy)
+{
+    prepare_environment();
+    KvsSnapshotPolicy policy;
+    policy.max_count = 5U;
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_policy(policy).build();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().snapshot_max_count(), 5U);
+    for (std::size_t i = 0U; i < 6U; ++i)
+    {
+        flush_generation(result.value(), static_cast<double>(i));
+    }
+    EXPECT_TRUE(snapshot_exists(5U));
+    EXPECT_FALSE(snapshot_exists(6U));
+    EXPECT_EQ(result.value().snapshot_count().value(), 5U);
+    ASSERT_TRUE(result.value().snapshot_restore(4U));
+    EXPECT_EQ(std::get<double>(result.value().get_value("generation").value().getValue()), 1.0);
+
+    /* A smaller count only rotates the snapshots it keeps */
+    cleanup_environment();
+    prepare_environment();
+    policy.max_count = 1U;
+    result = KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_policy(policy).build();
+    ASSERT_TRUE(result);
+    for (std::size_t i = 0U; i < 3U; ++i)
+    {
+        flush_generation(result.value(), static_cast<double>(i));
+    }
+    EXPECT_TRUE(snapshot_exists(1U));
+    EXPECT_FALSE(snapshot_exists(2U));
+    EXPECT_EQ(result.value().snapshot_count().value(), 1U);
+    ASSERT_TRUE(result.value().snapshot_restore(1U));
+    EXPECT_EQ(std::get<double>(result.value().get_value("generation").value().getValue()), 1.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_retention, shrunk_count_policy)
+{
+    prepare_environment();
+    const std::string segment_prefix = filename_prefix + "_scope_" + get_scope_segment_name("app.");
+    KvsSnapshotPolicy policy;
+    policy.max_count = 5U;
+    {
+        auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_policy(policy).build();
+        ASSERT_TRUE(result);
+        auto scope = result.value().scope("app.");
+        ASSERT_TRUE(scope);
+        ASSERT_TRUE(scope.value().set_value("key", KvsValue(true)));
+        for (std::size_t i = 0U; i < 6U; ++i)
+        {
+            flush_generation(result.value(), static_cast<double>(i));
+        }
+        EXPECT_TRUE(snapshot_exists(5U));
+        EXPECT_TRUE(std::filesystem::exists(segment_prefix + "_5.json"));
+    }
+
+    /* The snapshots above a smaller count are removed at open, the segment file holding the data
+     * of the kept snapshots moves down */
+    policy.max_count = 2U;
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_policy(policy).build();
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(snapshot_exists(2U));
+    EXPECT_FALSE(snapshot_exists(3U));
+    EXPECT_FALSE(snapshot_exists(5U));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_5.hash"));
+    EXPECT_TRUE(std::filesystem::exists(segment_prefix + "_2.json"));
+    EXPECT_FALSE(std::filesystem::exists(segment_prefix + "_5.json"));
+    EXPECT_TRUE(std::get<bool>(result.value().get_value("app.key").value().getValue()));
+    ASSERT_TRUE(result.value().snapshot_restore(2U));
+    EXPECT_EQ(std::get<double>(result.value().get_value("generation").value().getValue()), 3.0);
+    EXPECT_TRUE(std::get<bool>(result.value().get_value("app.key").value().getValue()));
+
+    cleanup_environment();
+}
+
+TEST(kvs_retention, snapshots_disabled)
+{
+    prepare_environment();
+    KvsSnapshotPolicy policy;
+    policy.max_count = 0U;
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_policy(policy).build();
+    ASSERT_TRUE(result);
+    flush_generation(result.value(), 1.0);
+    flush_generation(result.value(), 2.0);
+    EXPECT_FALSE(snapshot_exists(1U));
+    EXPECT_EQ(result.value().snapshot_count().value(), 0U);
+    EXPECT_EQ(result.value().snapshot_status().value().size(), 0U);
+    auto restore_res = result.value().snapshot_restore(1U);
+    ASSERT_FALSE(restore_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*restore_res.error()), ErrorCode::InvalidSnapshotId);
+
+    /* The current file is still written */
+    auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_policy(policy).build();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<double>(reopened.value().get_value("generation").value().getValue()), 2.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_retention, byte_budget)
+{
+    prepare_environment();
+    KvsSnapshotPolicy policy;
+    policy.max_bytes = 2500U;
+    auto result =
+        KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_policy(policy).manifest(true).build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    ASSERT_TRUE(kvs.set_value("blob", KvsValue(std::string(1000U, 'x'))));
+    for (std::size_t i = 0U; i < 4U; ++i)
+    {
+        flush_generation(kvs, static_cast<double>(i));
+    }
+
+    /* Two snapshots of about 1 KiB fit into the budget, the third one was removed */
+    EXPECT_TRUE(snapshot_exists(2U));
+    EXPECT_FALSE(snapshot_exists(3U));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_3.hash"));
+    EXPECT_EQ(kvs.snapshot_count().value(), 3U);
+    EXPECT_EQ(kvs.snapshot_info().value().size(), 3U);
+    ASSERT_TRUE(kvs.snapshot_restore(2U));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 1.0);
+
+    /* A snapshot larger than the budget is not kept */
+    policy.max_bytes = 100U;
+    auto small = KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_policy(policy).build();
+    ASSERT_TRUE(small);
+    ASSERT_TRUE(small.value().flush());
+    EXPECT_FALSE(snapshot_exists(1U));
+    EXPECT_EQ(small.value().snapshot_count().value(), 1U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_retention, min_interval)
+{
+    prepare_environment();
+    KvsSnapshotPolicy policy;
+    policy.min_interval = std::chrono::hours(1);
+    KvsSnapshotCachePolicy cache;
+    cache.versions = 3U;
+    auto result = KvsBuilder(instance_id)
+                      .dir(std::string(data_dir))
+                      .snapshot_policy(policy)
+                      .snapshot_cache(cache)
+                      .manifest(true)
+                      .build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    for (std::size_t i = 1U; i <= 5U; ++i)
+    {
+        flush_generation(kvs, static_cast<double>(i));
+    }
+
+    /* Snapshot 1 is the previous flush, snapshot 2 is still the file of the environment */
+    EXPECT_FALSE(snapshot_exists(3U));
+    EXPECT_EQ(kvs.snapshot_count().value(), 3U);
+    EXPECT_EQ(kvs.cached_versions.size(), 2U);
+    auto info = kvs.snapshot_info().value();
+    ASSERT_EQ(info.size(), 3U);
+    EXPECT_EQ(info[2].size, std::filesystem::file_size(filename_prefix + "_2.json"));
+    ASSERT_TRUE(kvs.snapshot_restore(1U));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 4.0);
+    ASSERT_TRUE(kvs.snapshot_restore(2U));
+    EXPECT_FALSE(kvs.key_exists("generation").value());
+
+    /* Once snapshot 1 is older than the interval compared to snapshot 2, all snapshots move */
+    std::filesystem::last_write_time(filename_prefix + "_2.json",
+                                     std::filesystem::last_write_time(filename_prefix + "_1.json") -
+                                         std::chrono::hours(2));
+    flush_generation(kvs, 6.0);
+    EXPECT_TRUE(snapshot_exists(3U));
+    EXPECT_EQ(kvs.cached_versions.size(), 3U);
+    ASSERT_TRUE(kvs.snapshot_restore(2U));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 4.0);
+    ASSERT_TRUE(kvs.snapshot_restore(3U));
+    EXPECT_FALSE(kvs.key_exists("generation").value());
+
+    cleanup_environment();
+}
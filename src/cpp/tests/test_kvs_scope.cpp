@@ -0,0 +1,222 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+const std::string scope_prefix = filename_prefix + "_scope_calib.";
+
+TEST(kvs_scope, scope_invalid_prefix)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+
+    auto scope_result = result.value().scope("");
+    ASSERT_FALSE(scope_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*scope_result.error()), ErrorCode::InvalidArgument);
+
+    /* Mutex locked */
+    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    scope_result = result.value().scope("calib.");
+    ASSERT_FALSE(scope_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*scope_result.error()), ErrorCode::MutexLockFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_scope, scope_set_get_prefixed)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    auto scope_result = result.value().scope("calib.");
+    ASSERT_TRUE(scope_result);
+    KvsScope calib = std::move(scope_result.value());
+    EXPECT_EQ(calib.prefix(), "calib.");
+
+    ASSERT_TRUE(calib.set_value("gain", KvsValue(1.5)));
+    EXPECT_TRUE(result.value().kvs.count("calib.gain"));
+
+    auto value = calib.get_value("gain");
+    ASSERT_TRUE(value);
+    EXPECT_EQ(std::get<double>(value.value().getValue()), 1.5);
+    EXPECT_TRUE(calib.key_exists("gain").value());
+    EXPECT_FALSE(calib.key_exists("kvs").value());
+
+    auto keys = calib.get_all_keys();
+    ASSERT_TRUE(keys);
+    ASSERT_EQ(keys.value().size(), 1U);
+    EXPECT_EQ(keys.value().front(), "gain");
+
+    /* Default values use the full key */
+    set_default_value(result.value(), "calib.offset", KvsValue(3.0));
+    EXPECT_TRUE(calib.is_value_default("offset").value());
+    EXPECT_EQ(std::get<double>(calib.get_default_value("offset").value().getValue()), 3.0);
+
+    ASSERT_TRUE(calib.remove_key("gain"));
+    EXPECT_FALSE(result.value().kvs.count("calib.gain"));
+    EXPECT_FALSE(calib.remove_key("gain"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_scope, scope_flush_only_writes_segment)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    auto calib = result.value().scope("calib.");
+    ASSERT_TRUE(calib);
+    EXPECT_FALSE(calib->is_dirty().value());
+
+    /* Flushing an unmodified scope doesn't write anything */
+    ASSERT_TRUE(calib->flush());
+    EXPECT_FALSE(std::filesystem::exists(scope_prefix + "_0.json"));
+
+    ASSERT_TRUE(calib->set_value("gain", KvsValue(1.5)));
+    EXPECT_TRUE(calib->is_dirty().value());
+    ASSERT_TRUE(calib->flush());
+    EXPECT_FALSE(calib->is_dirty().value());
+
+    /* Only the segment is written, the main file is not rotated */
+    EXPECT_TRUE(std::filesystem::exists(scope_prefix + "_0.json"));
+    EXPECT_TRUE(std::filesystem::exists(scope_prefix + "_0.hash"));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_1.json"));
+
+    /* The main file doesn't contain scope keys, clean segments are not rewritten but move with it */
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_1.json"));
+    EXPECT_TRUE(std::filesystem::exists(scope_prefix + "_1.json"));
+    EXPECT_FALSE(std::filesystem::exists(scope_prefix + "_0.json"));
+    std::ifstream main_file(kvs_prefix + ".json");
+    std::string main_data((std::istreambuf_iterator<char>(main_file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(main_data.find("calib.gain"), std::string::npos);
+
+    /* Kvs::flush writes dirty segments, the clean main file is not rewritten */
+    ASSERT_TRUE(calib->set_value("gain", KvsValue(2.5)));
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_TRUE(std::filesystem::exists(scope_prefix + "_0.json"));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_2.json"));
+    EXPECT_FALSE(calib->is_dirty().value());
+
+    cleanup_environment();
+}
+
+TEST(kvs_scope, scope_reopen_loads_segment)
+{
+    prepare_environment();
+
+    {
+        auto result =
+            Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+        ASSERT_TRUE(result);
+        /* Key written before the scope exists is migrated from the main file into the segment */
+        ASSERT_TRUE(result.value().set_value("calib.offset", KvsValue(1.0)));
+        ASSERT_TRUE(result.value().flush());
+        auto calib = result.value().scope("calib.");
+        ASSERT_TRUE(calib);
+        EXPECT_TRUE(calib->is_dirty().value());
+        ASSERT_TRUE(calib->set_value("gain", KvsValue(1.5)));
+        ASSERT_TRUE(result.value().flush());
+    }
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    /* The segment is loaded at open, scoped keys are visible without a scope handle */
+    EXPECT_EQ(std::get<double>(kvs.get_value("calib.gain").value().getValue()), 1.5);
+    EXPECT_TRUE(kvs.key_exists("calib.offset").value());
+    EXPECT_EQ(kvs.get_all_keys().value().size(), 3U);
+    EXPECT_FALSE(kvs.is_dirty().value());
+
+    /* A key written before the scope is requested is owned by the scope */
+    ASSERT_TRUE(kvs.set_value("calib.gain", KvsValue(2.5)));
+    auto calib = kvs.scope("calib.");
+    ASSERT_TRUE(calib);
+    EXPECT_TRUE(calib->is_dirty().value());
+    EXPECT_EQ(std::get<double>(calib->get_value("gain").value().getValue()), 2.5);
+    EXPECT_EQ(std::get<double>(calib->get_value("offset").value().getValue()), 1.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_scope, scope_snapshot_restore)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    auto calib = result.value().scope("calib.");
+    ASSERT_TRUE(calib);
+
+    ASSERT_TRUE(calib->set_value("gain", KvsValue(1.0)));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(calib->set_value("gain", KvsValue(2.0)));
+    ASSERT_TRUE(result.value().set_value("main", KvsValue(true)));
+    ASSERT_TRUE(result.value().flush());
+
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    EXPECT_EQ(std::get<double>(calib->get_value("gain").value().getValue()), 1.0);
+    EXPECT_FALSE(result.value().kvs.count("main"));
+    EXPECT_TRUE(calib->is_dirty().value());
+
+    cleanup_environment();
+}
+
+TEST(kvs_scope, scope_snapshot_same_point_in_time)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    auto calib = kvs.scope("calib.");
+    ASSERT_TRUE(calib);
+
+    ASSERT_TRUE(kvs.set_value("main", KvsValue(1)));
+    ASSERT_TRUE(calib->set_value("gain", KvsValue(1)));
+    ASSERT_TRUE(kvs.flush());
+    /* Only the segment changed, the main file is not rotated */
+    ASSERT_TRUE(calib->set_value("gain", KvsValue(2)));
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_TRUE(kvs.set_value("main", KvsValue(2)));
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_TRUE(calib->set_value("gain", KvsValue(3)));
+    ASSERT_TRUE(calib->flush());
+
+    /* Snapshot 1 holds the state before the main file was last written */
+    ASSERT_TRUE(kvs.snapshot_restore(1));
+    EXPECT_EQ(std::get<int32_t>(kvs.get_value("main").value().getValue()), 1);
+    EXPECT_EQ(std::get<int32_t>(calib->get_value("gain").value().getValue()), 2);
+
+    /* Before the segment existed, its keys were not stored yet */
+    ASSERT_TRUE(kvs.snapshot_restore(2));
+    EXPECT_FALSE(kvs.key_exists("main").value());
+    EXPECT_FALSE(calib->key_exists("gain").value());
+
+    cleanup_environment();
+}
+
+TEST(kvs_scope, scope_segment_name)
+{
+    EXPECT_EQ(get_scope_segment_name("calib."), "calib.");
+    EXPECT_EQ(get_scope_segment_name("a/b c"), "a%2Fb%20c");
+    EXPECT_NE(get_scope_segment_name("a/"), get_scope_segment_name("a_"));
+
+    EXPECT_EQ(parse_scope_segment_name("a%2Fb%20c").value(), "a/b c");
+    EXPECT_EQ(parse_scope_segment_name(get_scope_segment_name("x%y")).value(), "x%y");
+    EXPECT_FALSE(parse_scope_segment_name("a%2"));
+    EXPECT_FALSE(parse_scope_segment_name("a b"));
+}
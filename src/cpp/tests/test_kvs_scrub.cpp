@@ -0,0 +1,217 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+/* Flush a few generations, so snapshots 1 and 2 exist */
+static void prepare_scrub_environment()
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    for (std::size_t i = 0U; i < 2U; ++i)
+    {
+        ASSERT_TRUE(result.value().set_value("generation", KvsValue(static_cast<double>(i))));
+        ASSERT_TRUE(result.value().flush());
+    }
+}
+
+/* Poll the snapshot status until the predicate holds or the timeout expires */
+template <typename Predicate>
+static bool wait_for_status(Kvs& kvs, Predicate predicate)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    bool done = false;
+    while ((!done) && (std::chrono::steady_clock::now() < deadline))
+    {
+        done = predicate(kvs.snapshot_status().value());
+        if (!done)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    return done;
+}
+
+TEST(kvs_scrub, scrub_snapshots_status)
+{
+    prepare_scrub_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    auto status = kvs.snapshot_status();
+    ASSERT_TRUE(status);
+    ASSERT_EQ(status.value().size(), KVS_MAX_SNAPSHOTS);
+    EXPECT_EQ(status.value()[0].id, 1U);
+    EXPECT_EQ(status.value()[0].state, KvsSnapshotState::Unverified);
+    EXPECT_EQ(status.value()[1].state, KvsSnapshotState::Unverified);
+    EXPECT_EQ(status.value()[2].state, KvsSnapshotState::Missing);
+
+    status = kvs.scrub_snapshots();
+    ASSERT_TRUE(status);
+    EXPECT_EQ(status.value()[0].state, KvsSnapshotState::Valid);
+    EXPECT_EQ(status.value()[1].state, KvsSnapshotState::Valid);
+    EXPECT_NE(status.value()[1].verified_at, std::chrono::system_clock::time_point{});
+    EXPECT_EQ(status.value()[2].state, KvsSnapshotState::Missing);
+
+    /* A modified snapshot is unverified until it is scrubbed again */
+    std::ofstream(filename_prefix + "_2.json", std::ios::app) << " ";
+    EXPECT_EQ(kvs.snapshot_status().value()[1].state, KvsSnapshotState::Unverified);
+    status = kvs.scrub_snapshots();
+    EXPECT_EQ(status.value()[0].state, KvsSnapshotState::Valid);
+    EXPECT_EQ(status.value()[1].state, KvsSnapshotState::Corrupted);
+
+    /* The rotation moves the results with the files */
+    ASSERT_TRUE(kvs.set_value("generation", KvsValue(5.0)));
+    ASSERT_TRUE(kvs.flush());
+    status = kvs.snapshot_status();
+    EXPECT_EQ(status.value()[0].state, KvsSnapshotState::Unverified);
+    EXPECT_EQ(status.value()[1].state, KvsSnapshotState::Valid);
+    EXPECT_EQ(status.value()[2].state, KvsSnapshotState::Corrupted);
+
+    cleanup_environment();
+}
+
+TEST(kvs_scrub, restore_skips_verified_snapshot)
+{
+    prepare_scrub_environment();
+
+    /* Tamper with the hash file without changing its stamp */
+    auto tamper_hash = []() {
+        const std::string hash_file = filename_prefix + "_1.hash";
+        const auto mtime = std::filesystem::last_write_time(hash_file);
+        std::fstream hash(hash_file, std::ios::in | std::ios::out | std::ios::binary);
+        hash.seekg(-1, std::ios::end);
+        const char last = static_cast<char>(hash.get());
+        hash.seekp(-1, std::ios::end);
+        hash.put(static_cast<char>(last ^ 0x01));
+        hash.close();
+        std::filesystem::last_write_time(hash_file, mtime);
+    };
+
+    /* The verification was trusted, the data was only parsed */
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().scrub_snapshots().value()[0].state, KvsSnapshotState::Valid);
+    tamper_hash();
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    EXPECT_EQ(std::get<double>(result.value().get_value("generation").value().getValue()), 0.0);
+
+    /* Without a verification, the snapshot is hashed on restore */
+    auto unverified = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(unverified);
+    auto restore_res = unverified.value().snapshot_restore(1);
+    ASSERT_FALSE(restore_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*restore_res.error()), ErrorCode::ValidationFailed);
+
+    /* Outdated verifications are not trusted */
+    KvsScrubPolicy policy;
+    policy.interval = std::chrono::hours(1);
+    policy.max_age = std::chrono::milliseconds(0);
+    prepare_scrub_environment();
+    auto outdated = KvsBuilder(instance_id).dir(std::string(data_dir)).scrubber(policy).build();
+    ASSERT_TRUE(outdated);
+    EXPECT_EQ(outdated.value().scrub_snapshots().value()[0].state, KvsSnapshotState::Valid);
+    tamper_hash();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    restore_res = outdated.value().snapshot_restore(1);
+    ASSERT_FALSE(restore_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*restore_res.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_scrub, background_scrubber)
+{
+    prepare_scrub_environment();
+    KvsScrubPolicy policy;
+    policy.interval = std::chrono::milliseconds(10);
+    policy.bytes_per_second = 0U;
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).scrubber(policy).build();
+    ASSERT_TRUE(result);
+
+    /* The scrubber follows the moved object */
+    Kvs kvs = std::move(result.value());
+    EXPECT_TRUE(wait_for_status(kvs, [](const std::vector<KvsSnapshotStatus>& status) {
+        return (status[0].state == KvsSnapshotState::Valid) && (status[1].state == KvsSnapshotState::Valid);
+    }));
+
+    /* Modified snapshots are verified again by the next pass */
+    std::ofstream(filename_prefix + "_1.json", std::ios::app) << " ";
+    EXPECT_TRUE(wait_for_status(kvs, [](const std::vector<KvsSnapshotStatus>& status) {
+        return status[0].state == KvsSnapshotState::Corrupted;
+    }));
+
+    cleanup_environment();
+}
+
+TEST(kvs_scrub, scrubber_byte_budget)
+{
+    prepare_environment();
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("large", KvsValue(std::string(200U * 1024U, 'x'))));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().flush());
+
+    /* Reading snapshot 1 (> 200 KiB) at 1 MiB/s takes more than 150 ms */
+    auto cache = std::make_shared<ScrubCache>();
+    const auto start = std::chrono::steady_clock::now();
+    {
+        SnapshotScrubber scrubber(std::chrono::hours(1), 1024U * 1024U);
+        scrubber.add(ScrubTarget{filename_prefix, KVS_MAX_SNAPSHOTS, cache});
+        while (scrubber.passes() == 0U)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+    auto scrubbed = cache->lookup(filename_prefix + "_1");
+    ASSERT_TRUE(scrubbed.has_value());
+    EXPECT_TRUE(scrubbed->valid);
+
+    /* Stopping the scrubber aborts a paced pass, partial results are not stored */
+    auto aborted = std::make_shared<ScrubCache>();
+    {
+        SnapshotScrubber scrubber(std::chrono::hours(1), 1024U);
+        scrubber.add(ScrubTarget{filename_prefix, KVS_MAX_SNAPSHOTS, aborted});
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_FALSE(aborted->lookup(filename_prefix + "_1").has_value());
+
+    cleanup_environment();
+}
+
+TEST(kvs_scrub, group_scrubber)
+{
+    prepare_scrub_environment();
+    auto first = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(first);
+    auto second = KvsBuilder(InstanceId{124}).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(second);
+    ASSERT_TRUE(second.value().set_value("group", KvsValue(1.0)));
+    ASSERT_TRUE(second.value().flush());
+    ASSERT_TRUE(second.value().flush());
+
+    KvsScrubPolicy policy;
+    policy.interval = std::chrono::milliseconds(10);
+    KvsGroup group;
+    group.add(first.value()).scrub(policy).add(second.value());
+    auto first_valid = [](const std::vector<KvsSnapshotStatus>& status) {
+        return status[0].state == KvsSnapshotState::Valid;
+    };
+    EXPECT_TRUE(wait_for_status(first.value(), first_valid));
+    EXPECT_TRUE(wait_for_status(second.value(), first_valid));
+
+    cleanup_environment();
+}
@@ -0,0 +1,192 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+TEST(kvs_slots, slot_format)
+{
+    const std::string payload = R"({"kvs": {"t": "i32", "v": 2}})";
+    const std::vector<uint8_t> header = get_slot_header(payload, 7U, KvsChecksum::Crc32c);
+    ASSERT_EQ(header.size(), SLOT_HEADER_SIZE);
+    std::string bytes = std::string(header.begin(), header.end()) + payload + std::string(100U, 'x');
+    EXPECT_EQ(bytes.substr(0U, 4U), "KVSS");
+    const auto parsed = parse_slot(bytes);
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_EQ(parsed->sequence, 7U);
+    EXPECT_EQ(parsed->size, payload.size());
+
+    /* Any damage of the header or the payload is detected, stale bytes after the payload are not covered */
+    for (const std::size_t pos : {0U, 4U, 5U, 8U, 15U, 16U, 24U, 31U, 32U, 40U})
+    {
+        std::string damaged = bytes;
+        damaged[pos] = static_cast<char>(damaged[pos] ^ 0x01);
+        EXPECT_FALSE(parse_slot(damaged).has_value()) << pos;
+    }
+    bytes.back() = 'y';
+    EXPECT_TRUE(parse_slot(bytes).has_value());
+    EXPECT_FALSE(parse_slot(bytes.substr(0U, SLOT_HEADER_SIZE + payload.size() - 1U)).has_value());
+
+    EXPECT_TRUE(is_empty_slot(std::string(4096U, '\0')));
+    EXPECT_TRUE(is_empty_slot(""));
+    EXPECT_FALSE(is_empty_slot(bytes));
+}
+
+TEST(kvs_slots, alternating_writes)
+{
+    prepare_environment();
+    const std::string prefix = std::string(data_dir) + "kvs_" + std::to_string(instance_id.id);
+    {
+        auto result = open_slots();
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        /* The existing KVS file is read until the first flush */
+        EXPECT_EQ(std::get<int32_t>(kvs.get_value("kvs").value().getValue()), 2);
+        EXPECT_EQ(std::filesystem::file_size(prefix + "_a.slot"), 4096U);
+        EXPECT_EQ(std::filesystem::file_size(prefix + "_b.slot"), 4096U);
+        const std::size_t files = count_files();
+
+        for (int32_t generation = 1; generation <= 5; ++generation)
+        {
+            ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+            ASSERT_TRUE(kvs.flush());
+            const auto slot_a = parse_slot(read_file(prefix + "_a.slot"));
+            const auto slot_b = parse_slot(read_file(prefix + "_b.slot"));
+            ASSERT_TRUE(slot_a.has_value());
+            EXPECT_EQ(slot_b.has_value(), generation > 1);
+            EXPECT_EQ(((generation % 2) == 1) ? slot_a->sequence : slot_b->sequence, static_cast<uint64_t>(generation));
+            EXPECT_EQ(kvs.slots->sequence(), static_cast<uint64_t>(generation));
+        }
+
+        /* Neither files nor snapshots are created, the slots keep their size */
+        EXPECT_EQ(count_files(), files);
+        EXPECT_EQ(std::filesystem::file_size(prefix + "_a.slot"), 4096U);
+        EXPECT_EQ(kvs.snapshot_max_count(), 0U);
+        EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_1.json"));
+    }
+
+    /* Open picks the newest slot, eagerly and lazily */
+    for (const bool lazy : {false, true})
+    {
+        auto reopened = open_slots(lazy);
+        ASSERT_TRUE(reopened);
+        EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("generation").value().getValue()), 5);
+        EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("kvs").value().getValue()), 2);
+        EXPECT_EQ(reopened.value().slots->sequence(), 5U);
+    }
+
+    cleanup_environment();
+}
+
+TEST(kvs_slots, group_flush)
+{
+    prepare_environment();
+    auto result = open_slots();
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    ASSERT_TRUE(kvs.set_value("generation", KvsValue(1)));
+    ASSERT_TRUE(kvs.flush());
+
+    /* A half written for a shared barrier is only activated once the barrier synced it */
+    ASSERT_TRUE(kvs.set_value("generation", KvsValue(2)));
+    std::vector<int> fds;
+    ASSERT_TRUE(kvs.flush_files(&fds));
+    EXPECT_EQ(kvs.slots->sequence(), 1U);
+    for (const int fd : fds)
+    {
+        ::close(fd);
+    }
+    EXPECT_TRUE(kvs.complete_deferred_flush(false));
+    EXPECT_EQ(kvs.slots->sequence(), 1U);
+    EXPECT_TRUE(kvs.is_dirty().value());
+
+    KvsGroup group;
+    group.add(kvs);
+    ASSERT_TRUE(group.flush_all());
+    EXPECT_EQ(kvs.slots->sequence(), 2U);
+    auto reopened = open_slots();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("generation").value().getValue()), 2);
+
+    cleanup_environment();
+}
+
+TEST(kvs_slots, torn_write)
+{
+    prepare_environment();
+    const std::string prefix = std::string(data_dir) + "kvs_" + std::to_string(instance_id.id);
+    {
+        auto result = open_slots();
+        ASSERT_TRUE(result);
+        for (int32_t generation = 1; generation <= 3; ++generation)
+        {
+            ASSERT_TRUE(result.value().set_value("generation", KvsValue(generation)));
+            ASSERT_TRUE(result.value().flush());
+        }
+    }
+
+    /* A damaged newer slot falls back to the older one, which is overwritten next */
+    std::fstream(prefix + "_a.slot", std::ios::binary | std::ios::in | std::ios::out).seekp(40) << "#";
+    {
+        auto reopened = open_slots();
+        ASSERT_TRUE(reopened);
+        EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("generation").value().getValue()), 2);
+        ASSERT_TRUE(reopened.value().set_value("generation", KvsValue(4)));
+        ASSERT_TRUE(reopened.value().flush());
+        EXPECT_EQ(parse_slot(read_file(prefix + "_a.slot"))->sequence, 3U);
+        EXPECT_EQ(parse_slot(read_file(prefix + "_b.slot"))->sequence, 2U);
+    }
+    auto recovered = open_slots();
+    ASSERT_TRUE(recovered);
+    EXPECT_EQ(std::get<int32_t>(recovered.value().get_value("generation").value().getValue()), 4);
+
+    /* Without any valid slot, open fails instead of falling back to the KVS file */
+    std::fstream(prefix + "_a.slot", std::ios::binary | std::ios::in | std::ios::out).seekp(40) << "#";
+    std::fstream(prefix + "_b.slot", std::ios::binary | std::ios::in | std::ios::out).seekp(40) << "#";
+    auto corrupted = open_slots();
+    ASSERT_FALSE(corrupted);
+    EXPECT_EQ(static_cast<ErrorCode>(*corrupted.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_slots, compressed_and_oversized)
+{
+    prepare_environment();
+    const std::string prefix = std::string(data_dir) + "kvs_" + std::to_string(instance_id.id);
+    {
+        auto result = KvsBuilder(instance_id)
+                          .dir(std::string(data_dir))
+                          .slots(KvsSlotPolicy{1024U})
+                          .compression(KvsCompression::All)
+                          .checksum(KvsChecksum::Crc32c)
+                          .build();
+        ASSERT_TRUE(result);
+        for (int i = 0; i < 200; ++i)
+        {
+            ASSERT_TRUE(result.value().set_value("key_" + std::to_string(i), KvsValue(static_cast<int32_t>(i))));
+        }
+        ASSERT_TRUE(result.value().flush());
+        ASSERT_TRUE(result.value().flush());
+    }
+
+    /* Compressed payloads are read without the option, a payload beyond the capacity grows the slot */
+    const std::string slot = read_file(prefix + "_b.slot");
+    const auto header = parse_slot(slot);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_TRUE(is_compressed_json_file(slot.substr(SLOT_HEADER_SIZE)));
+    EXPECT_EQ(slot.size(), std::max<std::size_t>(1024U, SLOT_HEADER_SIZE + header->size));
+    auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).slots(KvsSlotPolicy{1024U}).build();
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("key_199").value().getValue()), 199);
+
+    cleanup_environment();
+}
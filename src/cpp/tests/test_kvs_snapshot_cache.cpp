@@ -0,0 +1,125 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+static score::Result<Kvs> open_cached(std::size_t versions, std::size_t max_bytes = 1024U * 1024U)
+{
+    KvsSnapshotCachePolicy policy;
+    policy.versions = versions;
+    policy.max_bytes = max_bytes;
+    return KvsBuilder(instance_id).dir(std::string(data_dir)).snapshot_cache(policy).build();
+}
+
+TEST(kvs_snapshot_cache, restore_from_memory)
+{
+    prepare_environment();
+    auto result = open_cached(2U);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    for (const double generation : {1.0, 2.0, 3.0})
+    {
+        ASSERT_TRUE(kvs.set_value("generation", KvsValue(generation)));
+        ASSERT_TRUE(kvs.flush());
+    }
+    EXPECT_EQ(kvs.cached_versions.size(), 3U);
+
+    /* Cached snapshots are restored without the files */
+    std::filesystem::rename(filename_prefix + "_1.json", filename_prefix + "_1.bak");
+    std::filesystem::rename(filename_prefix + "_2.json", filename_prefix + "_2.bak");
+    ASSERT_TRUE(kvs.snapshot_restore(2));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 1.0);
+    EXPECT_TRUE(kvs.is_dirty().value());
+    ASSERT_TRUE(kvs.snapshot_restore(1));
+    EXPECT_EQ(std::get<double>(kvs.get_value("generation").value().getValue()), 2.0);
+
+    /* Older snapshots are read from storage */
+    std::filesystem::rename(filename_prefix + "_1.bak", filename_prefix + "_1.json");
+    std::filesystem::rename(filename_prefix + "_2.bak", filename_prefix + "_2.json");
+    ASSERT_TRUE(kvs.snapshot_restore(3));
+    EXPECT_FALSE(kvs.key_exists("generation").value());
+    EXPECT_EQ(std::get<int32_t>(kvs.get_value("kvs").value().getValue()), 2);
+    auto restore_res = kvs.snapshot_restore(0);
+    ASSERT_FALSE(restore_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*restore_res.error()), ErrorCode::InvalidSnapshotId);
+
+    /* The cache moves with the object */
+    Kvs moved = std::move(kvs);
+    EXPECT_EQ(moved.cached_versions.size(), 3U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_snapshot_cache, shared_versions_and_budget)
+{
+    prepare_environment();
+    auto result = open_cached(3U, 4096U);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Flushes without changes share the version */
+    ASSERT_TRUE(kvs.set_value("small", KvsValue(1.0)));
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_EQ(kvs.cached_versions.size(), 2U);
+    EXPECT_EQ(kvs.cached_versions[0].data, kvs.cached_versions[1].data);
+
+    /* Versions beyond the budget are dropped, oldest first */
+    ASSERT_TRUE(kvs.set_value("large", KvsValue(std::string(3000U, 'x'))));
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_EQ(kvs.cached_versions.size(), 3U);
+    ASSERT_TRUE(kvs.set_value("large", KvsValue(std::string(3001U, 'x'))));
+    ASSERT_TRUE(kvs.flush());
+    EXPECT_EQ(kvs.cached_versions.size(), 1U);
+
+    /* A single version beyond the budget is not cached at all */
+    ASSERT_TRUE(kvs.set_value("large", KvsValue(std::string(5000U, 'x'))));
+    ASSERT_TRUE(kvs.flush());
+    EXPECT_TRUE(kvs.cached_versions.empty());
+    ASSERT_TRUE(kvs.snapshot_restore(1));
+    EXPECT_EQ(std::get<std::string>(kvs.get_value("large").value().getValue()).size(), 3001U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_snapshot_cache, uncached_stores)
+{
+    prepare_environment();
+
+    /* Disabled by default */
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_TRUE(result.value().cached_versions.empty());
+
+    /* Scope segments are restored from storage, the cache is dropped */
+    result = open_cached(2U);
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_EQ(result.value().cached_versions.size(), 1U);
+    ASSERT_TRUE(result.value().scope("cfg."));
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_TRUE(result.value().cached_versions.empty());
+
+    /* Undecoded values are not copied into the cache */
+    KvsSnapshotCachePolicy policy;
+    policy.versions = 2U;
+    result = KvsBuilder(instance_id).dir(std::string(data_dir)).lazy_values(true).snapshot_cache(policy).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_TRUE(result.value().cached_versions.empty());
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("kvs").value().getValue()), 2);
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_EQ(result.value().cached_versions.size(), 1U);
+
+    cleanup_environment();
+}
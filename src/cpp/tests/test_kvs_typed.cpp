@@ -0,0 +1,148 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+struct DefaultField
+{
+    static constexpr std::string_view name = "default";
+    using type = int32_t;
+};
+struct KvsField
+{
+    static constexpr std::string_view name = "kvs";
+    using type = int32_t;
+};
+struct LabelField
+{
+    static constexpr std::string_view name = "label";
+    using type = std::string;
+};
+using TestSchema = KvsSchema<DefaultField, KvsField, LabelField>;
+
+static_assert(TestSchema::index_of<KvsField>() == 1U);
+static_assert(TestSchema::index_of("label") == 2U);
+static_assert(TestSchema::index_of("unknown") == TestSchema::size);
+
+TEST(kvs_typed, typed_open_load)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    auto typed_result = TypedKvs<TestSchema>::open(result.value());
+    ASSERT_TRUE(typed_result);
+    TypedKvs<TestSchema> typed = std::move(typed_result.value());
+
+    EXPECT_EQ(typed.get_value<KvsField>().value(), 2);
+    EXPECT_TRUE(typed.key_exists<KvsField>());
+    EXPECT_EQ(typed.get_value<DefaultField>().value(), 5);
+    EXPECT_TRUE(typed.is_value_default<DefaultField>());
+    EXPECT_EQ(typed.get_default_value<DefaultField>().value(), 5);
+
+    auto label = typed.get_value<LabelField>();
+    ASSERT_FALSE(label);
+    EXPECT_EQ(static_cast<ErrorCode>(*label.error()), ErrorCode::KeyNotFound);
+    EXPECT_FALSE(typed.is_dirty());
+
+    cleanup_environment();
+}
+
+TEST(kvs_typed, typed_open_type_mismatch)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    result.value().kvs.insert_or_assign("label", KvsValue(1.0));
+
+    auto typed_result = TypedKvs<TestSchema>::open(result.value());
+    ASSERT_FALSE(typed_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*typed_result.error()), ErrorCode::ConversionFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_typed, typed_set_flush_roundtrip)
+{
+    prepare_environment();
+
+    {
+        auto result =
+            Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+        ASSERT_TRUE(result);
+        auto typed_result = TypedKvs<TestSchema>::open(result.value());
+        ASSERT_TRUE(typed_result);
+        TypedKvs<TestSchema> typed = std::move(typed_result.value());
+
+        typed.set_value<LabelField>("calibrated");
+        typed.set_value<DefaultField>(7);
+        typed.reset_key<KvsField>();
+        EXPECT_TRUE(typed.is_dirty());
+        EXPECT_EQ(typed.get_value<LabelField>().value(), "calibrated");
+        EXPECT_FALSE(typed.get_value<KvsField>());
+
+        /* Untyped view is only updated on flush */
+        EXPECT_FALSE(result.value().kvs.count("label"));
+        ASSERT_TRUE(typed.flush());
+        EXPECT_FALSE(typed.is_dirty());
+        EXPECT_FALSE(result.value().kvs.count("kvs"));
+    }
+
+    /* Stored in the regular JSON format */
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    auto label = result.value().get_value("label");
+    ASSERT_TRUE(label);
+    EXPECT_EQ(std::get<std::string>(label.value().getValue()), "calibrated");
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("default").value().getValue()), 7);
+    EXPECT_FALSE(result.value().key_exists("kvs").value());
+
+    cleanup_environment();
+}
+
+TEST(kvs_typed, typed_direct_changes)
+{
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    auto typed_result = TypedKvs<TestSchema>::open(kvs);
+    ASSERT_TRUE(typed_result);
+    TypedKvs<TestSchema> typed = std::move(typed_result.value());
+
+    /* Changes made directly on the Kvs object are visible in the typed view */
+    ASSERT_TRUE(kvs.set_value("kvs", KvsValue(9)));
+    EXPECT_EQ(typed.get_value<KvsField>().value(), 9);
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_TRUE(kvs.snapshot_restore(1));
+    EXPECT_EQ(typed.get_value<KvsField>().value(), 2);
+    ASSERT_TRUE(kvs.reset());
+    EXPECT_FALSE(typed.get_value<KvsField>());
+    EXPECT_FALSE(typed.key_exists<KvsField>());
+    EXPECT_EQ(typed.get_value<DefaultField>().value(), 5);
+
+    /* An update of the typed view hides direct changes until it is flushed */
+    typed.set_value<KvsField>(4);
+    ASSERT_TRUE(kvs.set_value("kvs", KvsValue(8)));
+    EXPECT_EQ(typed.get_value<KvsField>().value(), 4);
+    ASSERT_TRUE(typed.flush());
+    EXPECT_EQ(std::get<int32_t>(kvs.get_value("kvs").value().getValue()), 4);
+
+    ASSERT_TRUE(kvs.set_value("label", KvsValue(1.0)));
+    auto label = typed.get_value<LabelField>();
+    ASSERT_FALSE(label);
+    EXPECT_EQ(static_cast<ErrorCode>(*label.error()), ErrorCode::ConversionFailed);
+
+    cleanup_environment();
+}
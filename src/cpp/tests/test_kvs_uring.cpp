@@ -0,0 +1,161 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+#include "test_kvs_general.hpp"
+
+/* Without kernel support, the io_uring tests run the Posix fallback and must behave the same */
+const KvsIoBackend expected_backend =
+    UringIo::instance().available() ? KvsIoBackend::IoUring : KvsIoBackend::Posix;
+
+TEST(kvs_uring, uring_rename_chain)
+{
+    prepare_environment();
+    UringIo& uring = UringIo::instance();
+    if (uring.available())
+    {
+        std::ofstream(data_dir + "a") << "a";
+        std::ofstream(data_dir + "c") << "c";
+
+        /* Missing files are skipped, the remaining renames are still executed in order */
+        int error = -1;
+        ASSERT_TRUE(uring.rename_chain({{data_dir + "c", data_dir + "d"},
+                                        {data_dir + "b", data_dir + "c"},
+                                        {data_dir + "a", data_dir + "b"}},
+                                       error));
+        EXPECT_EQ(error, 0);
+        EXPECT_FALSE(std::filesystem::exists(data_dir + "a"));
+        EXPECT_TRUE(std::filesystem::exists(data_dir + "b"));
+        EXPECT_FALSE(std::filesystem::exists(data_dir + "c"));
+        EXPECT_TRUE(std::filesystem::exists(data_dir + "d"));
+
+        /* Other errors are reported */
+        std::filesystem::create_directories(data_dir + "dir/sub");
+        ASSERT_TRUE(
+            uring.rename_chain({{data_dir + "b", data_dir + "dir"}, {data_dir + "d", data_dir + "e"}}, error));
+        EXPECT_EQ(error, EISDIR);
+        EXPECT_TRUE(std::filesystem::exists(data_dir + "b"));
+    }
+    else
+    {
+        int error = -1;
+        EXPECT_FALSE(uring.rename_chain({{data_dir + "a", data_dir + "b"}}, error));
+    }
+
+    cleanup_environment();
+}
+
+TEST(kvs_uring, uring_write_read_files)
+{
+    prepare_environment();
+    UringIo& uring = UringIo::instance();
+    if (uring.available())
+    {
+        const std::string data = "uring data";
+        std::vector<UringWrite> writes(2U);
+        writes[0].path = data_dir + "written";
+        writes[0].data = data.data();
+        writes[0].size = data.size();
+        writes[1].path = data_dir + "missing/written";
+        writes[1].data = data.data();
+        writes[1].size = data.size();
+        ASSERT_TRUE(uring.write_files(writes, true));
+        EXPECT_EQ(writes[0].error, 0);
+        EXPECT_EQ(writes[1].error, ENOENT);
+
+        std::vector<UringRead> reads(3U);
+        reads[0].path = data_dir + "written";
+        reads[1].path = data_dir + "missing";
+        reads[2].path = kvs_prefix + ".json";
+        ASSERT_TRUE(uring.read_files(reads));
+        EXPECT_EQ(reads[0].error, 0);
+        EXPECT_EQ(reads[0].data, data);
+        EXPECT_EQ(reads[1].error, ENOENT);
+        EXPECT_EQ(reads[2].data, kvs_json);
+    }
+
+    cleanup_environment();
+}
+
+TEST(kvs_uring, builder_io_backend)
+{
+    prepare_environment();
+
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().active_io_backend(), KvsIoBackend::Posix);
+
+    result = KvsBuilder(instance_id).dir(std::string(data_dir)).io_backend(KvsIoBackend::IoUring).build();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().active_io_backend(), expected_backend);
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("kvs").value().getValue()), 2);
+    EXPECT_EQ(std::get<int32_t>(result.value().get_default_value("default").value().getValue()), 5);
+
+    /* The backend survives a move */
+    Kvs moved = std::move(result.value());
+    EXPECT_EQ(moved.active_io_backend(), expected_backend);
+
+    cleanup_environment();
+}
+
+TEST(kvs_uring, flush_and_reopen)
+{
+    prepare_environment();
+
+    for (const KvsDurability mode : {KvsDurability::Strict, KvsDurability::None, KvsDurability::GroupCommit})
+    {
+        KvsDurabilityPolicy policy;
+        policy.mode = mode;
+        auto result = KvsBuilder(instance_id)
+                          .dir(std::string(data_dir))
+                          .io_backend(KvsIoBackend::IoUring)
+                          .durability(policy)
+                          .build();
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("mode", KvsValue(static_cast<int32_t>(mode))));
+        ASSERT_TRUE(result.value().flush());
+
+        auto reopened = KvsBuilder(instance_id).dir(std::string(data_dir)).build();
+        ASSERT_TRUE(reopened);
+        EXPECT_EQ(std::get<int32_t>(reopened.value().get_value("mode").value().getValue()),
+                  static_cast<int32_t>(mode));
+    }
+    (void)GroupCommitter::instance().sync_pending();
+
+    /* The rotation keeps the same number of snapshots as the Posix backend */
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).io_backend(KvsIoBackend::IoUring).build();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_EQ(result.value().snapshot_count().value(), KVS_MAX_SNAPSHOTS);
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".hash"));
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("mode").value().getValue()),
+              static_cast<int32_t>(KvsDurability::GroupCommit));
+
+    cleanup_environment();
+}
+
+TEST(kvs_uring, open_corrupted_hash)
+{
+    prepare_environment();
+    std::ofstream(kvs_prefix + ".hash", std::ios::binary | std::ios::trunc) << "0000";
+
+    auto result = KvsBuilder(instance_id).dir(std::string(data_dir)).io_backend(KvsIoBackend::IoUring).build();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    std::filesystem::remove(kvs_prefix + ".hash");
+    result = KvsBuilder(instance_id).dir(std::string(data_dir)).io_backend(KvsIoBackend::IoUring).build();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::KvsHashFileReadError);
+
+    cleanup_environment();
+}
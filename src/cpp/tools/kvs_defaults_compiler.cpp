@@ -0,0 +1,312 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/*
+ * Build-time defaults compiler, used by the kvs_defaults_library rule.
+ *
+ * Validates a kvs_<id>_default.json file with the same conversion as Kvs::open and emits a C++
+ * source and header that define the defaults as a constant KvsDefaultsImage.
+ *
+ * Usage: kvs_defaults_compiler <input.json> <output.cpp> <output.hpp> <symbol>
+ */
+#include "internal/kvs_helper.hpp"
+#include "kvsdefaultsimage.hpp"
+#include "score/json/json_parser.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace score::mw::per::kvs;
+
+namespace
+{
+
+struct PendingNode
+{
+    std::string key;
+    const KvsValue* value;
+    uint32_t first_child;
+    uint32_t child_count;
+};
+
+bool is_identifier(const std::string& symbol)
+{
+    bool valid = (!symbol.empty()) && (std::isdigit(static_cast<unsigned char>(symbol.front())) == 0);
+    for (const char c : symbol)
+    {
+        valid = valid && ((std::isalnum(static_cast<unsigned char>(c)) != 0) || (c == '_'));
+    }
+    return valid;
+}
+
+std::string string_literal(const std::string& text)
+{
+    std::ostringstream out;
+    out << "std::string_view{\"";
+    for (const char c : text)
+    {
+        const auto uc = static_cast<unsigned char>(c);
+        if ((c == '"') || (c == '\\'))
+        {
+            out << '\\' << c;
+        }
+        else if ((uc >= 0x20U) && (uc < 0x7FU))
+        {
+            out << c;
+        }
+        else
+        {
+            /* Always three octal digits, so a following digit is not part of the escape */
+            char escape[8];
+            (void)std::snprintf(escape, sizeof(escape), "\\%03o", uc);
+            out << escape;
+        }
+    }
+    out << "\", " << text.size() << "U}";
+    return out.str();
+}
+
+const char* type_name(KvsValue::Type type)
+{
+    switch (type)
+    {
+        case KvsValue::Type::i32:
+            return "i32";
+        case KvsValue::Type::u32:
+            return "u32";
+        case KvsValue::Type::i64:
+            return "i64";
+        case KvsValue::Type::u64:
+            return "u64";
+        case KvsValue::Type::f64:
+            return "f64";
+        case KvsValue::Type::Boolean:
+            return "Boolean";
+        case KvsValue::Type::String:
+            return "String";
+        case KvsValue::Type::Array:
+            return "Array";
+        case KvsValue::Type::Object:
+            return "Object";
+        case KvsValue::Type::Null:
+        default:
+            return "Null";
+    }
+}
+
+/* Flatten the value tree breadth-first, so the children of every node are contiguous */
+std::vector<PendingNode> flatten(const std::unordered_map<std::string, KvsValue>& defaults)
+{
+    std::vector<PendingNode> nodes;
+    for (const auto& element : defaults)
+    {
+        nodes.push_back({element.first, &element.second, 0U, 0U});
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const PendingNode& lhs, const PendingNode& rhs) {
+        return lhs.key < rhs.key;
+    });
+
+    for (std::size_t i = 0U; i < nodes.size(); ++i)
+    {
+        const KvsValue* value = nodes[i].value;
+        const auto first_child = static_cast<uint32_t>(nodes.size());
+        if (value->getType() == KvsValue::Type::Array)
+        {
+            for (const auto& element : std::get<KvsValue::Array>(value->getValue()))
+            {
+                nodes.push_back({std::string(), element.get(), 0U, 0U});
+            }
+        }
+        else if (value->getType() == KvsValue::Type::Object)
+        {
+            const std::size_t begin = nodes.size();
+            for (const auto& element : std::get<KvsValue::Object>(value->getValue()))
+            {
+                nodes.push_back({element.first, element.second.get(), 0U, 0U});
+            }
+            std::sort(nodes.begin() + static_cast<std::ptrdiff_t>(begin),
+                      nodes.end(),
+                      [](const PendingNode& lhs, const PendingNode& rhs) {
+                          return lhs.key < rhs.key;
+                      });
+        }
+        else
+        {
+            /* Scalar, no children */
+        }
+        if (nodes.size() != first_child)
+        {
+            nodes[i].first_child = first_child;
+            nodes[i].child_count = static_cast<uint32_t>(nodes.size()) - first_child;
+        }
+    }
+    return nodes;
+}
+
+std::string node_initializer(const PendingNode& node)
+{
+    uint64_t bits = 0U;
+    double number = 0.0;
+    std::string text;
+    const auto& value = node.value->getValue();
+    switch (node.value->getType())
+    {
+        case KvsValue::Type::i32:
+            bits = static_cast<uint64_t>(static_cast<int64_t>(std::get<int32_t>(value)));
+            break;
+        case KvsValue::Type::u32:
+            bits = std::get<uint32_t>(value);
+            break;
+        case KvsValue::Type::i64:
+            bits = static_cast<uint64_t>(std::get<int64_t>(value));
+            break;
+        case KvsValue::Type::u64:
+            bits = std::get<uint64_t>(value);
+            break;
+        case KvsValue::Type::f64:
+            number = std::get<double>(value);
+            break;
+        case KvsValue::Type::Boolean:
+            bits = std::get<bool>(value) ? 1U : 0U;
+            break;
+        case KvsValue::Type::String:
+            text = std::get<std::string>(value);
+            break;
+        default:
+            break;
+    }
+
+    /* Hexadecimal floating point literals keep doubles exact */
+    char number_literal[64];
+    (void)std::snprintf(number_literal, sizeof(number_literal), "%a", number);
+    char bits_literal[32];
+    (void)std::snprintf(bits_literal, sizeof(bits_literal), "0x%llxULL", static_cast<unsigned long long>(bits));
+
+    std::ostringstream out;
+    out << "{" << string_literal(node.key) << ", Type::" << type_name(node.value->getType()) << ", " << bits_literal
+        << ", " << number_literal << ", " << string_literal(text) << ", " << node.first_child << "U, "
+        << node.child_count << "U}";
+    return out.str();
+}
+
+std::string base_name(const std::string& path)
+{
+    const std::size_t pos = path.find_last_of('/');
+    return (pos == std::string::npos) ? path : path.substr(pos + 1U);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 5)
+    {
+        std::cerr << "usage: " << argv[0] << " <input.json> <output.cpp> <output.hpp> <symbol>\n";
+        return 2;
+    }
+    const std::string input_path(argv[1]);
+    const std::string cpp_path(argv[2]);
+    const std::string hpp_path(argv[3]);
+    const std::string symbol(argv[4]);
+
+    if (!is_identifier(symbol))
+    {
+        std::cerr << "error: invalid symbol name '" << symbol << "'\n";
+        return 1;
+    }
+
+    std::ifstream in(input_path);
+    if (!in)
+    {
+        std::cerr << "error: file " << input_path << " could not be read\n";
+        return 1;
+    }
+    std::ostringstream data;
+    data << in.rdbuf();
+
+    /* Same conversion as Kvs::open, so an image never contains values the runtime would reject */
+    score::json::JsonParser parser;
+    auto any_res = parser.FromBuffer(data.str());
+    if (!any_res)
+    {
+        std::cerr << "error: " << input_path << " is not valid JSON\n";
+        return 1;
+    }
+    auto obj = any_res.value().As<score::json::Object>();
+    if (!obj.has_value())
+    {
+        std::cerr << "error: " << input_path << " is not a JSON object\n";
+        return 1;
+    }
+    std::unordered_map<std::string, KvsValue> defaults;
+    for (const auto& element : obj.value().get())
+    {
+        const auto key = element.first.GetAsStringView();
+        auto conv = any_to_kvsvalue(element.second);
+        if (!conv)
+        {
+            std::cerr << "error: " << input_path << ": invalid value for key '" << key << "'\n";
+            return 1;
+        }
+        defaults.emplace(std::string(key.data(), key.size()), std::move(conv.value()));
+    }
+
+    const std::vector<PendingNode> nodes = flatten(defaults);
+    const std::string header_guard = "KVS_DEFAULTS_IMAGE_" + symbol + "_HPP";
+
+    std::ofstream hpp(hpp_path);
+    hpp << "/* Generated by kvs_defaults_compiler from " << base_name(input_path) << ". Do not edit. */\n"
+        << "#ifndef " << header_guard << "\n"
+        << "#define " << header_guard << "\n\n"
+        << "#include \"kvsdefaultsimage.hpp\"\n\n"
+        << "extern const score::mw::per::kvs::KvsDefaultsImage " << symbol << ";\n\n"
+        << "#endif /* " << header_guard << " */\n";
+
+    std::ofstream cpp(cpp_path);
+    cpp << "/* Generated by kvs_defaults_compiler from " << base_name(input_path) << ". Do not edit. */\n"
+        << "#include \"" << base_name(hpp_path) << "\"\n\n";
+    if (nodes.empty())
+    {
+        cpp << "const score::mw::per::kvs::KvsDefaultsImage " << symbol << " = {nullptr, 0U, 0U};\n";
+    }
+    else
+    {
+        cpp << "namespace\n{\n\n"
+            << "using score::mw::per::kvs::KvsDefaultsImageNode;\n"
+            << "using Type = score::mw::per::kvs::KvsValue::Type;\n\n"
+            << "constexpr KvsDefaultsImageNode nodes[] = {\n";
+        for (const auto& node : nodes)
+        {
+            cpp << "    " << node_initializer(node) << ",\n";
+        }
+        cpp << "};\n\n"
+            << "}  // namespace\n\n"
+            << "const score::mw::per::kvs::KvsDefaultsImage " << symbol << " = {nodes, " << nodes.size() << "U, "
+            << defaults.size() << "U};\n";
+    }
+
+    hpp.close();
+    cpp.close();
+    if ((!hpp) || (!cpp))
+    {
+        std::cerr << "error: output files could not be written\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+# *******************************************************************************
+# Copyright (c) 2025 Contributors to the Eclipse Foundation
+#
+# See the NOTICE file(s) distributed with this work for additional
+# information regarding copyright ownership.
+#
+# This program and the accompanying materials are made available under the
+# terms of the Apache License Version 2.0 which is available at
+# https://www.apache.org/licenses/LICENSE-2.0
+#
+# SPDX-License-Identifier: Apache-2.0
+# *******************************************************************************
+
+"""Compiles a kvs_<id>_default.json file into a linkable defaults image."""
+
+load("@rules_cc//cc:defs.bzl", "cc_library")
+
+_COMPILER = Label("//src/cpp/tools:kvs_defaults_compiler")
+_IMAGE = Label("//src/cpp/src:kvs_defaults_image")
+
+def kvs_defaults_library(name, src, symbol = None, **kwargs):
+    """Validates a defaults file at build time and emits it as a constant KvsDefaultsImage.
+
+    The generated header `<name>.hpp` declares
+    `extern const score::mw::per::kvs::KvsDefaultsImage <symbol>;`, which is passed to
+    `KvsBuilder::defaults_from_image()`. The build fails if the file is not a valid defaults file.
+
+    Args:
+        name: Name of the cc_library, also used for the generated files.
+        src: The kvs_<id>_default.json file.
+        symbol: Name of the image variable, defaults to `name`.
+        **kwargs: Further attributes of the cc_library (e.g. visibility).
+    """
+    symbol = symbol or name
+    native.genrule(
+        name = name + "_gen",
+        srcs = [src],
+        outs = [name + ".cpp", name + ".hpp"],
+        cmd = "$(execpath {compiler}) $(execpath {src}) $(execpath {cpp}) $(execpath {hpp}) {symbol}".format(
+            compiler = _COMPILER,
+            src = src,
+            cpp = name + ".cpp",
+            hpp = name + ".hpp",
+            symbol = symbol,
+        ),
+        tools = [_COMPILER],
+    )
+    cc_library(
+        name = name,
+        srcs = [name + ".cpp"],
+        hdrs = [name + ".hpp"],
+        includes = ["."],
+        deps = [_IMAGE],
+        **kwargs
+    )
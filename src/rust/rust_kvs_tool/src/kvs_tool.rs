@@ -25,10 +25,11 @@
 //!
 //!    Options:
 //!    -h, --help          Show this help message and exit
-//!    -o, --operation     Specify the operation to perform (setkey, getkey, removekey, listkeys, reset, snapshotcount, snapshotmaxcount, snapshotrestore, getkvsfilename, gethashfilename, createtestdata)
+//!    -o, --operation     Specify the operation to perform (setkey, getkey, removekey, listkeys, reset, snapshotcount, snapshotmaxcount, snapshotrestore, snapshotdiff, getkvsfilename, gethashfilename, createtestdata)
 //!    -k, --key           Specify the key to operate on (for key operations)
 //!    -p, --payload       Specify the value to write (for set operations)
 //!    -s, --snapshotid    Specify the snapshot ID for Snapshot operations
+//!    -t, --targetid      Specify the snapshot ID to compare with (for snapshotdiff, default is 0 = current KVS)
 //!    -d, --directory     Specify the directory of the Key-Files (default is current directory)
 //!
 //!    ---------------------------------------
@@ -60,6 +61,9 @@
 //!    Snapshot Restore:
 //!        kvs_tool -o snapshotrestore -s 1
 //!
+//!    Snapshot Diff (keys added (+), removed (-) or changed (~) from snapshot 2 to snapshot 1):
+//!        kvs_tool -o snapshotdiff -s 2 -t 1
+//!
 //!    Get KVS Filename:
 //!        kvs_tool -o getkvsfilename -s 1
 //!
@@ -78,6 +82,8 @@ use pico_args::Arguments;
 use rust_kvs::prelude::*;
 use score_log::error;
 use std::collections::HashMap;
+use std::fs::File;
+use std::io::Read;
 use tinyjson::JsonValue;
 
 /// Defines the available operation modes for key and file management.
@@ -91,6 +97,7 @@ enum OperationMode {
     SnapshotCount,
     SnapshotMaxCount,
     SnapshotRestore,
+    SnapshotDiff,
     GetKvsFilename,
     GetHashFilename,
     CreateTestData,
@@ -323,6 +330,100 @@ fn _snapshotrestore(kvs: Kvs, mut args: Arguments) -> Result<(), ErrorCode> {
     Ok(())
 }
 
+/// Lists the keys added, removed or changed between two snapshots.
+/// The snapshots are loaded from the backend without restoring them.
+fn _snapshotdiff(kvs: Kvs, mut args: Arguments) -> Result<(), ErrorCode> {
+    println!("----------------------");
+    println!("Snapshot Diff");
+
+    let from_id: u32 = match args.opt_value_from_str("--snapshotid") {
+        Ok(Some(val)) => val,
+        Ok(None) | Err(_) => match args.opt_value_from_str("-s") {
+            Ok(Some(val)) => val,
+            _ => {
+                error!("Snapshot ID (-s or --snapshotid) needs to be specified!");
+                return Err(ErrorCode::UnmappedError);
+            },
+        },
+    };
+    let to_id: u32 = match args.opt_value_from_str("--targetid") {
+        Ok(Some(val)) => val,
+        Ok(None) | Err(_) => match args.opt_value_from_str("-t") {
+            Ok(Some(val)) => val,
+            _ => 0,
+        },
+    };
+    println!("Diff Snapshot {from_id} -> {to_id}");
+
+    let from = _load_snapshot(&kvs, SnapshotId(from_id as usize))?;
+    let to = _load_snapshot(&kvs, SnapshotId(to_id as usize))?;
+
+    let mut changes: Vec<(&String, char)> = Vec::new();
+    for (key, value) in &from {
+        match to.get(key) {
+            None => changes.push((key, '-')),
+            Some(other) if other != value => changes.push((key, '~')),
+            Some(_) => {},
+        }
+    }
+    for key in to.keys() {
+        if !from.contains_key(key) {
+            changes.push((key, '+'));
+        }
+    }
+    changes.sort();
+
+    for (key, kind) in &changes {
+        println!("{kind} {key}");
+    }
+    println!("{} changed key(s)", changes.len());
+    println!("----------------------");
+    Ok(())
+}
+
+/// Magic of snapshot files compressed by the C++ KVS (`KvsCompression`).
+const COMPRESSED_SNAPSHOT_MAGIC: &[u8] = b"KVSZ";
+
+/// Key of the added keys in delta snapshots written by the C++ KVS (`delta_snapshots`).
+const DELTA_SNAPSHOT_KEY: &str = "__kvs_delta__";
+
+/// Fails for the start of a compressed snapshot file, which the JSON backend can't decode.
+fn _check_snapshot_magic(snapshot_id: SnapshotId, head: &[u8]) -> Result<(), ErrorCode> {
+    if head.starts_with(COMPRESSED_SNAPSHOT_MAGIC) {
+        error!("Snapshot {} is compressed and can't be decoded", snapshot_id.0);
+        return Err(ErrorCode::DeserializationFailed("compressed snapshot".to_string()));
+    }
+    Ok(())
+}
+
+/// Fails for a delta snapshot, which only holds the changes to the next newer snapshot.
+fn _check_full_snapshot(snapshot_id: SnapshotId, map: &KvsMap) -> Result<(), ErrorCode> {
+    if map.contains_key(DELTA_SNAPSHOT_KEY) {
+        error!("Snapshot {} is a delta snapshot and can't be decoded", snapshot_id.0);
+        return Err(ErrorCode::DeserializationFailed("delta snapshot".to_string()));
+    }
+    Ok(())
+}
+
+/// Loads a snapshot from the backend without restoring it.
+/// Compressed and delta snapshots written by the C++ KVS are refused.
+fn _load_snapshot(kvs: &Kvs, snapshot_id: SnapshotId) -> Result<KvsMap, ErrorCode> {
+    let instance_id = kvs.parameters().instance_id;
+    let backend = &kvs.parameters().backend;
+    if let Some(json_backend) = backend.as_any().downcast_ref::<JsonBackend>() {
+        let path = json_backend.kvs_file_path(instance_id, snapshot_id);
+        let mut head = [0u8; 4];
+        if let Ok(read) = File::open(path).and_then(|mut file| file.read(&mut head)) {
+            _check_snapshot_magic(snapshot_id, &head[..read])?;
+        }
+    }
+    let map = backend.load_kvs(instance_id, snapshot_id).inspect_err(|e| {
+        error!("KVS diff:load_kvs failed: {:?}", e);
+    })?;
+    _check_full_snapshot(snapshot_id, &map)?;
+    Ok(map)
+}
+
 /// Take backend and downcast it to `JsonBackend`.
 fn _downcast_backend(kvs: &Kvs) -> Result<&JsonBackend, ErrorCode> {
     match kvs.parameters().backend.as_any().downcast_ref() {
@@ -456,10 +557,12 @@ fn main() -> Result<(), ErrorCode> {
         -h, --help          Show this help message and exit
         -o, --operation     Specify the operation to perform (setkey, getkey, removekey, 
                             listkeys, reset, snapshotcount, snapshotmaxcount, snapshotrestore, 
-                            getkvsfilename, gethashfilename, createtestdata)
+                            snapshotdiff, getkvsfilename, gethashfilename, createtestdata)
         -k, --key           Specify the key to operate on (for key operations)
         -p, --payload       Specify the value to write (for set operations)
         -s, --snapshotid    Specify the snapshot ID for Snapshot operations
+        -t, --targetid      Specify the snapshot ID to compare with (for snapshotdiff,
+                            default is 0 = current KVS)
         -d, --directory     Specify the directory of the Key-Files (default is current directory)
 
         ---------------------------------------
@@ -492,6 +595,9 @@ fn main() -> Result<(), ErrorCode> {
         Snapshot Restore:
             kvs_tool -o snapshotrestore -s 1
 
+        Snapshot Diff (keys added (+), removed (-) or changed (~) from snapshot 2 to snapshot 1):
+            kvs_tool -o snapshotdiff -s 2 -t 1
+
         Get KVS Filename:
             kvs_tool -o getkvsfilename -s 1
 
@@ -557,6 +663,7 @@ fn main() -> Result<(), ErrorCode> {
             "snapshotcount" => OperationMode::SnapshotCount,
             "snapshotmaxcount" => OperationMode::SnapshotMaxCount,
             "snapshotrestore" => OperationMode::SnapshotRestore,
+            "snapshotdiff" => OperationMode::SnapshotDiff,
             "getkvsfilename" => OperationMode::GetKvsFilename,
             "gethashfilename" => OperationMode::GetHashFilename,
             _ => OperationMode::Invalid,
@@ -597,6 +704,10 @@ fn main() -> Result<(), ErrorCode> {
             _snapshotrestore(kvs, args)?;
             Ok(())
         },
+        OperationMode::SnapshotDiff => {
+            _snapshotdiff(kvs, args)?;
+            Ok(())
+        },
         OperationMode::GetKvsFilename => {
             _getkvsfilename(kvs, args)?;
             Ok(())
@@ -615,3 +726,29 @@ fn main() -> Result<(), ErrorCode> {
         },
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_compressed_snapshot_refused() {
+        let result = _check_snapshot_magic(SnapshotId(1), b"KVSZ\x01\x01");
+        assert!(matches!(result, Err(ErrorCode::DeserializationFailed(_))));
+        assert!(_check_snapshot_magic(SnapshotId(1), b"{\"key\"").is_ok());
+        assert!(_check_snapshot_magic(SnapshotId(1), b"KV").is_ok());
+    }
+
+    #[test]
+    fn test_delta_snapshot_refused() {
+        let mut map = KvsMap::new();
+        map.insert("key".to_string(), KvsValue::from(1.0));
+        assert!(_check_full_snapshot(SnapshotId(1), &map).is_ok());
+        map.insert(
+            DELTA_SNAPSHOT_KEY.to_string(),
+            KvsValue::from(vec![KvsValue::from("key")]),
+        );
+        let result = _check_full_snapshot(SnapshotId(1), &map);
+        assert!(matches!(result, Err(ErrorCode::DeserializationFailed(_))));
+    }
+}
@@ -33,6 +33,12 @@ score::mw::per::kvs::Kvs kvs_instance(const KvsParameters& params)
     {
         builder = builder.dir(std::string(*params.dir));
     }
+    if (params.snapshot_max_count.has_value())
+    {
+        KvsSnapshotPolicy policy;
+        policy.max_count = *params.snapshot_max_count;
+        builder = builder.snapshot_policy(policy);
+    }
 
     // Build KVS instance.
     auto build_result{builder.build()};